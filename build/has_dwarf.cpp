@@ -0,0 +1,23 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+
+#include <elf.h>
+#include <link.h>
+#include <unwind.h>
+#include <sys/mman.h>
+
+static int callback(dl_phdr_info* info, std::size_t, void*) {
+    return info->dlpi_phnum > 0 && info->dlpi_phdr[0].p_type != PT_NULL;
+}
+
+int main() {
+    ElfW(Shdr) section = {};
+    (void)section;
+    (void)&::mmap;
+    return ::dl_iterate_phdr(&callback, nullptr) >= 0 ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_ALL_THREADS_HPP
+#define BOOST_STACKTRACE_ALL_THREADS_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/signal_frames.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <signal.h>     // ::sigaction
+#   include <unistd.h>     // ::syscall
+#   include <sys/syscall.h>
+#   if defined(SYS_gettid) && defined(SYS_tgkill)
+#       define BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED
+#   endif
+#endif
+
+#if defined(BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED) && !defined(BOOST_STACKTRACE_ALL_THREADS_SIGNAL)
+/// Signal that is sent to the threads by boost::stacktrace::all_threads_stacktraces(). Must be the same in all the
+/// translation units of the program.
+#   define BOOST_STACKTRACE_ALL_THREADS_SIGNAL SIGURG
+#endif
+
+/// @file all_threads.hpp Stacktraces of all the threads of the current process, captured on demand.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+#if defined(BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED)
+
+    // A pending slot is claimed either by the signal handler of the thread (pending -> capturing -> captured) or
+    // by all_threads_stacktraces() at the deadline (pending -> abandoned).
+    enum all_threads_slot_state {
+        all_threads_pending, all_threads_capturing, all_threads_captured, all_threads_abandoned, all_threads_gone
+    };
+
+    // Preallocated place for the frames of a single thread. Written by the signal handler of that thread only.
+    struct all_threads_slot {
+        long tid;
+        std::atomic<int> state;
+        std::size_t size;
+        native_frame_ptr_t frames[boost::stacktrace::detail::max_frames_dump + 1]; // with a terminating null frame
+    };
+
+    struct all_threads_request {
+        std::unique_ptr<all_threads_slot[]> slots;  // sorted by tid
+        std::size_t count;
+        std::unique_ptr<all_threads_request> next;  // list of the requests that a handler could still use
+    };
+
+    // Both are constant initialized, so they are safe to use from the signal handler
+    inline std::atomic<all_threads_request*>& all_threads_active() noexcept {
+        static std::atomic<all_threads_request*> request(nullptr);
+        return request;
+    }
+
+    inline std::atomic<std::size_t>& all_threads_handlers_running() noexcept {
+        static std::atomic<std::size_t> count(0);
+        return count;
+    }
+
+    struct all_threads_handler {
+        static void capture(all_threads_request& request, const void* context) noexcept {
+            const long tid = static_cast<long>(::syscall(SYS_gettid));
+            std::size_t first = 0;
+            std::size_t last = request.count;
+            while (first < last) {
+                const std::size_t middle = first + (last - first) / 2;
+                if (request.slots[middle].tid < tid) {
+                    first = middle + 1;
+                } else {
+                    last = middle;
+                }
+            }
+            if (first == request.count || request.slots[first].tid != tid) {
+                return; // thread was created after the request
+            }
+
+            all_threads_slot& slot = request.slots[first];
+            int expected = all_threads_pending;
+            if (!slot.state.compare_exchange_strong(expected, all_threads_capturing, std::memory_order_acquire)) {
+                return; // already captured or abandoned
+            }
+
+            const std::size_t size = boost::stacktrace::detail::this_thread_frames::collect(
+                slot.frames, boost::stacktrace::detail::max_frames_dump, 0
+            );
+
+            // Dropping the frames of the handler and of the signal trampoline
+            const std::size_t skip = boost::stacktrace::detail::first_interrupted_frame(slot.frames, size, context, 3);
+            for (std::size_t i = skip; i < size; ++i) {
+                slot.frames[i - skip] = slot.frames[i];
+            }
+            slot.size = size - skip;
+            slot.frames[slot.size] = 0;
+            slot.state.store(all_threads_captured, std::memory_order_release);
+        }
+
+        static void on_signal(int, ::siginfo_t*, void* context) noexcept {
+            const int saved_errno = errno;
+
+            // all_threads_stacktraces() frees the request only if the counter is 0 after resetting the active request
+            std::atomic<std::size_t>& running = boost::stacktrace::detail::all_threads_handlers_running();
+            running.fetch_add(1);
+            all_threads_request* const request = boost::stacktrace::detail::all_threads_active().load();
+            if (request) {
+                capture(*request, context);
+            }
+            running.fetch_sub(1);
+
+            errno = saved_errno;
+        }
+
+        static bool install() noexcept {
+            struct sigaction old_action;
+            if (::sigaction(BOOST_STACKTRACE_ALL_THREADS_SIGNAL, 0, &old_action) != 0) {
+                return false;
+            }
+            if (old_action.sa_flags & SA_SIGINFO) {
+                return old_action.sa_sigaction == &all_threads_handler::on_signal;
+            }
+            if (old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN) {
+                return false;
+            }
+
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_sigaction = &all_threads_handler::on_signal;
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            ::sigemptyset(&action.sa_mask);
+            return ::sigaction(BOOST_STACKTRACE_ALL_THREADS_SIGNAL, &action, 0) == 0;
+        }
+    };
+
+    // Only one request at a time, the slots are shared with the signal handlers
+    inline std::mutex& all_threads_mutex() noexcept {
+        static std::mutex m;
+        return m;
+    }
+
+    // Requests that were in use by a signal handler at their deadline. Guarded by all_threads_mutex().
+    inline std::unique_ptr<all_threads_request>& all_threads_abandoned_requests() noexcept {
+        static std::unique_ptr<all_threads_request> head;
+        return head;
+    }
+
+#endif // defined(BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED)
+
+} // namespace detail
+/// @endcond
+
+/// @brief Captures the stacktraces of all the threads of the current process, without stopping the process.
+///
+/// Threads are listed in `/proc/self/task`. Each thread except the current one gets the
+/// `BOOST_STACKTRACE_ALL_THREADS_SIGNAL` signal (SIGURG by default) and its handler captures the frames with the
+/// async signal safe boost::stacktrace::safe_dump_to() machinery into a slot that was preallocated for the thread.
+/// Frames are symbolized only when the returned stacktraces are printed. Usually all the threads respond in well
+/// under a millisecond.
+///
+/// The signal handler is installed on the first call and stays installed. Signals may interrupt blocking system
+/// calls that are not restarted automatically, making them fail with `EINTR`.
+///
+/// @param timeout Maximal time to wait for the threads to respond. Threads that did not respond in time, for example
+/// because they block the signal, get empty stacktraces. The call returns after the timeout even if some thread is still
+/// in the signal handler, the memory that the handler uses is freed by one of the next calls.
+///
+/// @returns Pairs of the thread id, as shown by the OS tools and debuggers, and the stacktrace of the thread,
+/// sorted by the thread id. Threads that exited during the call are not included. On platforms other than Linux or
+/// if the signal has a handler that is not of Boost.Stacktrace only the current thread has a non empty stacktrace.
+///
+/// @b Async-Handler-Safety: Unsafe.
+inline std::vector<std::pair<std::uint64_t, stacktrace> > all_threads_stacktraces(
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+{
+    std::vector<std::pair<std::uint64_t, stacktrace> > res;
+    const std::uint64_t self = boost::stacktrace::detail::current_thread_id();
+
+    std::vector<std::uint64_t> tids;
+#if defined(__linux__)
+    boost::stacktrace::detail::for_each_thread_id([&tids](std::uint64_t tid) {
+        tids.push_back(tid);
+    });
+#endif
+    if (std::find(tids.begin(), tids.end(), self) == tids.end()) {
+        tids.push_back(self);
+    }
+    std::sort(tids.begin(), tids.end());
+
+    res.reserve(tids.size());
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        res.emplace_back(tids[i], stacktrace(0, 0));
+        if (tids[i] == self) {
+            res.back().second = stacktrace();
+        }
+    }
+
+#if defined(BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED)
+    std::lock_guard<std::mutex> lock(boost::stacktrace::detail::all_threads_mutex());
+    if (!boost::stacktrace::detail::all_threads_handler::install()) {
+        return res;
+    }
+
+    // No request is active, so the handlers that are not running any more could not start using the abandoned ones
+    std::unique_ptr<boost::stacktrace::detail::all_threads_request>& abandoned = boost::stacktrace::detail::all_threads_abandoned_requests();
+    if (boost::stacktrace::detail::all_threads_handlers_running().load() == 0) {
+        while (abandoned) {
+            abandoned = std::move(abandoned->next);
+        }
+    }
+
+    std::unique_ptr<boost::stacktrace::detail::all_threads_request> request(new boost::stacktrace::detail::all_threads_request);
+    request->slots.reset(new boost::stacktrace::detail::all_threads_slot[tids.size()]);
+    request->count = tids.size();
+    boost::stacktrace::detail::all_threads_slot* const slots = request->slots.get();
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        slots[i].tid = static_cast<long>(tids[i]);
+        slots[i].state.store(tids[i] == self ? boost::stacktrace::detail::all_threads_captured : boost::stacktrace::detail::all_threads_pending, std::memory_order_relaxed);
+        slots[i].size = 0;
+    }
+    boost::stacktrace::detail::all_threads_active().store(request.get());
+
+    const ::pid_t pid = ::getpid();
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        if (tids[i] != self && ::syscall(SYS_tgkill, pid, slots[i].tid, BOOST_STACKTRACE_ALL_THREADS_SIGNAL) != 0) {
+            slots[i].state.store(boost::stacktrace::detail::all_threads_gone, std::memory_order_relaxed);
+        }
+    }
+
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        while (slots[i].state.load(std::memory_order_acquire) == boost::stacktrace::detail::all_threads_pending
+            && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Late handlers see no request and do nothing, the ones that already took it could not claim a slot any more
+    boost::stacktrace::detail::all_threads_active().store(nullptr);
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        int expected = boost::stacktrace::detail::all_threads_pending;
+        slots[i].state.compare_exchange_strong(expected, boost::stacktrace::detail::all_threads_abandoned, std::memory_order_acq_rel);
+    }
+
+    // Running handlers may still read the request or write a slot that they have claimed. The counter is global, so
+    // a non zero value after the deadline is conservatively treated as such a handler and the request is kept alive
+    // till the next call.
+    while (boost::stacktrace::detail::all_threads_handlers_running().load() != 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            request->next = std::move(abandoned);
+            abandoned = std::move(request);
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < tids.size(); ++i) {
+        const int state = slots[i].state.load(std::memory_order_acquire);
+        if (state == boost::stacktrace::detail::all_threads_gone) {
+            continue;
+        }
+        if (state == boost::stacktrace::detail::all_threads_captured && tids[i] != self) {
+            res[i].second = stacktrace::from_dump(slots[i].frames, (slots[i].size + 1) * sizeof(slots[i].frames[0]));
+        }
+        if (out != i) {
+            res[out] = std::move(res[i]);
+        }
+        ++out;
+    }
+    res.erase(res.begin() + static_cast<std::ptrdiff_t>(out), res.end());
+#endif
+
+    return res;
+}
+
+}} // namespace boost::stacktrace
+
+#undef BOOST_STACKTRACE_DETAIL_ALL_THREADS_SUPPORTED
+
+#endif // BOOST_STACKTRACE_ALL_THREADS_HPP
@@ -0,0 +1,265 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_ASYNC_SYMBOLIZER_HPP
+#define BOOST_STACKTRACE_ASYNC_SYMBOLIZER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/symbolizer.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// @file async_symbolizer.hpp Background symbolization of stacktraces: threads that capture the traces
+/// only copy the frames, descriptions are produced by a pool of worker threads.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Pool of worker threads that turn stacktraces into strings.
+///
+/// submit() copies the frames into a bounded queue and returns immediately, the description is delivered through
+/// a `std::future` or a callback. Each worker takes its share of the pending requests at once and formats them with its
+/// own boost::stacktrace::symbolizer, so the frames that repeat in the requests are resolved only once.
+/// The output is the same as of boost::stacktrace::to_string().
+///
+/// The destructor completes all the pending requests.
+class async_symbolizer {
+    /// @cond
+    struct request {
+        std::vector<boost::stacktrace::frame> frames;
+        std::promise<std::string> promise;
+        std::function<void(std::string)> callback;
+    };
+
+    const symbolizer_backend backend_;
+    const std::size_t max_pending_;
+    const std::size_t threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<request> requests_;
+    bool stop_;
+
+    std::atomic<std::uint64_t> generation_;
+    std::atomic<std::uint64_t> dropped_;
+    std::vector<std::thread> workers_;
+
+    // Symbolizers remember all the frames they have seen, starting from scratch after that many frames
+    enum { max_remembered_frames = 64 * 1024 };
+
+    async_symbolizer(const async_symbolizer&) = delete;
+    async_symbolizer& operator=(const async_symbolizer&) = delete;
+
+    template <class Allocator>
+    bool push(const basic_stacktrace<Allocator>& bt, request& r) {
+        r.frames.assign(bt.as_vector().begin(), bt.as_vector().end());
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (requests_.size() >= max_pending_) {
+            lock.unlock();
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        requests_.push_back(std::move(r));
+        lock.unlock();
+
+        wake_.notify_one();
+        return true;
+    }
+
+    static void complete(boost::stacktrace::symbolizer& s, request& r) {
+        std::string res;
+        try {
+            res = s.to_string(r.frames.data(), r.frames.size());
+        } catch (...) {
+            if (!r.callback) {
+                r.promise.set_exception(std::current_exception());
+            }
+            return;
+        }
+
+        if (!r.callback) {
+            r.promise.set_value(std::move(res));
+            return;
+        }
+
+        try {
+            r.callback(std::move(res));
+        } catch (...) {
+            // Callbacks must not throw, there's no one to report the error to
+        }
+    }
+
+    void run() {
+        boost::stacktrace::symbolizer s(backend_);
+        std::uint64_t generation = generation_.load(std::memory_order_acquire);
+        std::size_t remembered = 0;
+        std::vector<request> batch;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return stop_ || !requests_.empty(); });
+                if (requests_.empty()) {
+                    return;
+                }
+
+                // An equal share for each worker, rounded up
+                const std::size_t share = (requests_.size() + threads_ - 1) / threads_;
+                batch.reserve(share);
+                for (std::size_t i = 0; i < share; ++i) {
+                    batch.push_back(std::move(requests_.front()));
+                    requests_.pop_front();
+                }
+                if (!requests_.empty()) {
+                    lock.unlock();
+                    wake_.notify_one();
+                }
+            }
+
+            const std::uint64_t current_generation = generation_.load(std::memory_order_acquire);
+            if (current_generation != generation || remembered > max_remembered_frames) {
+                s.clear();
+                generation = current_generation;
+                remembered = 0;
+            }
+
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                remembered += batch[i].frames.size();
+                async_symbolizer::complete(s, batch[i]);
+            }
+            batch.clear();
+        }
+    }
+
+    void stop() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (std::size_t i = 0; i < workers_.size(); ++i) {
+            workers_[i].join();
+        }
+    }
+    /// @endcond
+
+public:
+    /// @brief Starts the worker threads.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @throws std::bad_alloc or std::system_error if failed to allocate memory or start the threads.
+    ///
+    /// @param threads Count of the worker threads, at least one thread is started.
+    ///
+    /// @param backend Implementation to use, see boost::stacktrace::symbolizer::symbolizer(symbolizer_backend).
+    ///
+    /// @param max_pending Maximal count of the requests that wait for a worker. Requests that do not fit are dropped.
+    explicit async_symbolizer(std::size_t threads = 1,
+            symbolizer_backend backend = symbolizer_backend::default_backend,
+            std::size_t max_pending = 4096)
+        : backend_(backend)
+        , max_pending_(max_pending)
+        , threads_(threads ? threads : 1)
+        , stop_(false)
+        , generation_(0)
+        , dropped_(0)
+    {
+        workers_.reserve(threads_);
+        try {
+            for (std::size_t i = 0; i < threads_; ++i) {
+                workers_.emplace_back(&async_symbolizer::run, this);
+            }
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+
+    /// @brief Completes all the pending requests and stops the worker threads.
+    ~async_symbolizer() {
+        stop();
+    }
+
+    /// @brief Queues the stacktrace for symbolization.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @throws std::bad_alloc if not enough memory to copy the frames.
+    ///
+    /// @returns Future that gets the same string as boost::stacktrace::to_string(bt) would return. If the queue
+    /// is full the request is dropped and the returned future is not `valid()`.
+    template <class Allocator>
+    std::future<std::string> submit(const basic_stacktrace<Allocator>& bt) {
+        request r;
+        std::future<std::string> res = r.promise.get_future();
+        if (!push(bt, r)) {
+            return std::future<std::string>();
+        }
+
+        return res;
+    }
+
+    /// @brief Queues the stacktrace for symbolization.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @throws std::bad_alloc if not enough memory to copy the frames.
+    ///
+    /// @param callback Function that accepts a `std::string`. Called from a worker thread with the same string
+    /// as boost::stacktrace::to_string(bt) would return. Exceptions from the callback are ignored.
+    ///
+    /// @returns `false` if the queue is full and the request was dropped, the callback is not called in that case.
+    template <class Allocator, class Callback>
+    bool submit(const basic_stacktrace<Allocator>& bt, Callback&& callback) {
+        request r;
+        r.callback = std::forward<Callback>(callback);
+        return push(bt, r);
+    }
+
+    /// @brief Makes the workers forget the descriptions of the already seen frames. Call it after unloading
+    /// shared libraries, as their addresses could be reused by other libraries.
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    void clear() noexcept {
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /// @returns Count of the requests that wait for a worker.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests_.size();
+    }
+
+    /// @returns Count of the requests that were dropped because the queue was full.
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#endif // BOOST_STACKTRACE_ASYNC_SYMBOLIZER_HPP
@@ -0,0 +1,436 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_COMPACT_STACKTRACE_HPP
+#define BOOST_STACKTRACE_COMPACT_STACKTRACE_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file compact_stacktrace.hpp Stacktrace that keeps each frame in 32 bits.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+// Process wide append-only table of code regions. Address is encoded as a 32 bit value: index of
+// the 1MiB aligned region of the address space in the upper bits and the offset inside the region
+// in the lower bits. Code of all the loaded modules usually spans less than `regions_max` regions.
+//
+// Lookups are lock free; a mutex is taken only when a new region is seen for the first time.
+class compact_frame_table {
+    static constexpr unsigned index_bits = 12;
+    static constexpr unsigned offset_bits = 32 - index_bits;
+    static constexpr std::uint32_t offset_mask = (1u << offset_bits) - 1;
+    static constexpr std::uint32_t regions_max = 1u << index_bits;
+    static constexpr std::uint32_t slots_count = regions_max * 2;
+
+    std::atomic<std::uintptr_t> regions_[regions_max];  // index -> region number
+    std::atomic<std::uint64_t> slots_[slots_count];     // open addressing hash of `(region + 1) << index_bits | index`, 0 - empty
+    std::uint32_t count_;                               // guarded by mutex_
+    std::mutex mutex_;
+
+    static std::size_t slot_of(std::uint64_t region) noexcept {
+        return static_cast<std::size_t>((region * 0x9E3779B97F4A7C15ull) >> 40) & (slots_count - 1);
+    }
+
+    // Returns the index + 1 of the region or 0 and sets `pos` to the empty slot for the region.
+    std::uint32_t find(std::uint64_t region, std::size_t& pos) const noexcept {
+        const std::uint64_t key = (region + 1) << index_bits;
+        for (pos = slot_of(region);; pos = (pos + 1) & (slots_count - 1)) {
+            const std::uint64_t v = slots_[pos].load(std::memory_order_acquire);
+            if (!v) {
+                return 0;
+            }
+            if ((v & ~static_cast<std::uint64_t>(regions_max - 1)) == key) {
+                return static_cast<std::uint32_t>(v & (regions_max - 1)) + 1;
+            }
+        }
+    }
+
+public:
+    static compact_frame_table& instance() noexcept {
+        static compact_frame_table table;
+        return table;
+    }
+
+    // Returns false if the table is full and the address could not be encoded.
+    bool encode(native_frame_ptr_t frame, std::uint32_t& out) {
+        const std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(frame);
+        if (sizeof(std::uintptr_t) <= sizeof(std::uint32_t)) {
+            out = static_cast<std::uint32_t>(addr);
+            return true;
+        }
+
+        const std::uint64_t region = static_cast<std::uint64_t>(addr) >> offset_bits;
+        std::size_t pos;
+        std::uint32_t index = find(region, pos);
+        if (!index) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            index = find(region, pos);
+            if (!index) {
+                if (count_ == regions_max) {
+                    return false;
+                }
+
+                regions_[count_].store(static_cast<std::uintptr_t>(region), std::memory_order_relaxed);
+                slots_[pos].store(((region + 1) << index_bits) | count_, std::memory_order_release);
+                index = ++count_;
+            }
+        }
+
+        out = ((index - 1) << offset_bits) | static_cast<std::uint32_t>(addr & offset_mask);
+        return true;
+    }
+
+    native_frame_ptr_t decode(std::uint32_t v) const noexcept {
+        if (sizeof(std::uintptr_t) <= sizeof(std::uint32_t)) {
+            return reinterpret_cast<native_frame_ptr_t>(static_cast<std::uintptr_t>(v));
+        }
+
+        const std::uint64_t region = regions_[v >> offset_bits].load(std::memory_order_relaxed);
+        return reinterpret_cast<native_frame_ptr_t>(
+            static_cast<std::uintptr_t>((region << offset_bits) | (v & offset_mask))
+        );
+    }
+};
+
+} // namespace detail
+/// @endcond
+
+/// @brief Stacktrace that keeps each frame in 32 bits and uses a single allocation.
+///
+/// Designed for retaining a huge amount of stacktraces in memory. Frames are stored as an index of a code region
+/// from a process wide table plus the offset inside that region. If the table is full the frames of the stacktrace
+/// are stored as is, so the conversion back to boost::stacktrace::frame is always lossless.
+///
+/// `sizeof(compact_stacktrace)` is the size of a pointer, and the heap block of N frames takes `4 + 4 * N` bytes,
+/// while boost::stacktrace::stacktrace takes three pointers plus `sizeof(void*) * N` bytes.
+///
+/// Provides the same comparison, hashing and output as boost::stacktrace::basic_stacktrace. Hash of a compact_stacktrace
+/// is equal to the hash of the basic_stacktrace with the same frames.
+class compact_stacktrace {
+    /// @cond
+    typedef boost::stacktrace::detail::native_frame_ptr_t native_frame_ptr_t;
+
+    static constexpr std::uint32_t wide_flag = 0x80000000u;
+    static constexpr std::uint32_t size_mask = ~wide_flag;
+
+    // data_[0] - count of frames with the optional `wide_flag`. Followed by the encoded frames,
+    // or by the raw frames if `wide_flag` is set.
+    std::unique_ptr<std::uint32_t[]> data_;
+
+    bool is_wide() const noexcept {
+        return data_ && (data_[0] & wide_flag);
+    }
+
+    std::size_t words_count() const noexcept {
+        if (!data_) {
+            return 0;
+        }
+        return 1 + size() * (is_wide() ? sizeof(native_frame_ptr_t) / sizeof(std::uint32_t) : 1);
+    }
+
+    void assign(const native_frame_ptr_t* frames, std::size_t size) {
+        std::size_t count = 0;
+        while (count < size && count < size_mask && frames[count]) {
+            ++count;
+        }
+        if (!count) {
+            data_.reset();
+            return;
+        }
+
+        data_.reset(new std::uint32_t[1 + count]);
+        data_[0] = static_cast<std::uint32_t>(count);
+        boost::stacktrace::detail::compact_frame_table& table = boost::stacktrace::detail::compact_frame_table::instance();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!table.encode(frames[i], data_[1 + i])) {
+                // Out of regions, falling back to the raw frames
+                data_.reset(new std::uint32_t[1 + count * (sizeof(native_frame_ptr_t) / sizeof(std::uint32_t))]);
+                data_[0] = static_cast<std::uint32_t>(count) | wide_flag;
+                std::memcpy(&data_[1], frames, count * sizeof(native_frame_ptr_t));
+                return;
+            }
+        }
+    }
+
+    BOOST_NOINLINE void init(std::size_t frames_to_skip, std::size_t max_depth) {
+        constexpr std::size_t buffer_size = 128;
+        if (!max_depth) {
+            return;
+        }
+
+        native_frame_ptr_t buffer[buffer_size];
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(buffer, buffer_size < max_depth ? buffer_size : max_depth, frames_to_skip + 1);
+        if (buffer_size > frames_count || frames_count == max_depth) {
+            assign(buffer, frames_count);
+            return;
+        }
+
+        // Does not fit in `buffer_size`
+        *this = compact_stacktrace(boost::stacktrace::stacktrace(frames_to_skip + 1, max_depth));
+    }
+    /// @endcond
+
+public:
+    typedef boost::stacktrace::frame    value_type;
+    typedef boost::stacktrace::frame    reference;
+    typedef boost::stacktrace::frame    const_reference;
+    typedef std::size_t                 size_type;
+    typedef std::ptrdiff_t              difference_type;
+
+    /// Iterator over the frames, returns boost::stacktrace::frame by value.
+    class const_iterator {
+        const compact_stacktrace* st_;
+        std::size_t i_;
+
+    public:
+        typedef std::input_iterator_tag     iterator_category;
+        typedef boost::stacktrace::frame    value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const boost::stacktrace::frame* pointer;
+        typedef boost::stacktrace::frame    reference;
+
+        constexpr const_iterator() noexcept : st_(nullptr), i_(0) {}
+        constexpr const_iterator(const compact_stacktrace* st, std::size_t i) noexcept : st_(st), i_(i) {}
+
+        frame operator*() const noexcept { return (*st_)[i_]; }
+        const_iterator& operator++() noexcept { ++i_; return *this; }
+        const_iterator operator++(int) noexcept { const_iterator tmp = *this; ++i_; return tmp; }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.st_ == rhs.st_ && lhs.i_ == rhs.i_;
+        }
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+    };
+    typedef const_iterator iterator;
+
+    /// @brief Stores the current function call sequence inside *this without any decoding or any other heavy platform specific operations.
+    ///
+    /// @b Complexity: O(N) where N is call sequence length, O(1) if BOOST_STACKTRACE_USE_NOOP is defined.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_FORCEINLINE compact_stacktrace() {
+        init(0, static_cast<std::size_t>(-1));
+    }
+
+    /// @brief Stores [skip, skip + max_depth) of the current function call sequence inside *this without any decoding or any other heavy platform specific operations.
+    ///
+    /// @b Complexity: O(N) where N is call sequence length, O(1) if BOOST_STACKTRACE_USE_NOOP is defined.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @param skip How many top calls to skip and do not store in *this.
+    ///
+    /// @param max_depth Max call sequence depth to collect.
+    BOOST_FORCEINLINE compact_stacktrace(std::size_t skip, std::size_t max_depth) {
+        init(skip, max_depth);
+    }
+
+    /// @brief Stores the frames of `st` inside *this.
+    ///
+    /// @b Complexity: O(st.size()).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class Allocator>
+    explicit compact_stacktrace(const basic_stacktrace<Allocator>& st) {
+        if (!st) {
+            return;
+        }
+
+        std::vector<native_frame_ptr_t> frames(st.size());
+        for (std::size_t i = 0; i < st.size(); ++i) {
+            frames[i] = st[i].address();
+        }
+        assign(frames.data(), frames.size());
+    }
+
+
+    /// Constructs stacktrace from raw memory dump. Terminating zero frame is discarded.
+    ///
+    /// @param begin Beginning of the memory where the stacktrace was saved using the boost::stacktrace::safe_dump_to
+    ///
+    /// @param buffer_size_in_bytes Size of the memory. Usually the same value that was passed to the boost::stacktrace::safe_dump_to
+    ///
+    /// @b Complexity: O(size) in worst case
+    static compact_stacktrace from_dump(const void* begin, std::size_t buffer_size_in_bytes) {
+        compact_stacktrace ret(0, 0);
+        ret.assign(static_cast<const native_frame_ptr_t*>(begin), buffer_size_in_bytes / sizeof(native_frame_ptr_t));
+        return ret;
+    }
+
+    /// @b Complexity: O(st.size())
+    compact_stacktrace(const compact_stacktrace& st) {
+        *this = st;
+    }
+
+    /// @b Complexity: O(st.size())
+    compact_stacktrace& operator=(const compact_stacktrace& st) {
+        if (this == &st) {
+            return *this;
+        }
+
+        if (!st.data_) {
+            data_.reset();
+            return *this;
+        }
+
+        const std::size_t words = st.words_count();
+        data_.reset(new std::uint32_t[words]);
+        std::memcpy(data_.get(), st.data_.get(), words * sizeof(std::uint32_t));
+        return *this;
+    }
+
+    /// @b Complexity: O(1)
+    compact_stacktrace(compact_stacktrace&& st) noexcept = default;
+
+    /// @b Complexity: O(1)
+    compact_stacktrace& operator=(compact_stacktrace&& st) noexcept = default;
+
+    /// @returns Number of frames stored inside the class.
+    ///
+    /// @b Complexity: O(1)
+    size_type size() const noexcept {
+        return data_ ? (data_[0] & size_mask) : 0;
+    }
+
+    /// @returns true if no frames are stored.
+    ///
+    /// @b Complexity: O(1)
+    bool empty() const noexcept { return !data_; }
+
+    /// @b Complexity: O(1)
+    explicit operator bool () const noexcept { return !empty(); }
+
+    /// @param frame_no Zero based index of frame to return, must be less than size().
+    ///
+    /// @b Complexity: O(1)
+    frame operator[](std::size_t frame_no) const noexcept {
+        if (is_wide()) {
+            native_frame_ptr_t res;
+            std::memcpy(&res, &data_[1 + frame_no * (sizeof(native_frame_ptr_t) / sizeof(std::uint32_t))], sizeof(res));
+            return frame(res);
+        }
+        return frame(boost::stacktrace::detail::compact_frame_table::instance().decode(data_[1 + frame_no]));
+    }
+
+    /// @b Complexity: O(1)
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    /// @b Complexity: O(1)
+    const_iterator cbegin() const noexcept { return begin(); }
+    /// @b Complexity: O(1)
+    const_iterator end() const noexcept { return const_iterator(this, size()); }
+    /// @b Complexity: O(1)
+    const_iterator cend() const noexcept { return end(); }
+
+    /// @brief Converts *this into boost::stacktrace::basic_stacktrace with the same frames.
+    ///
+    /// @b Complexity: O(size())
+    template <class Allocator = std::allocator<boost::stacktrace::frame> >
+    basic_stacktrace<Allocator> to_stacktrace(const Allocator& a = Allocator()) const {
+        std::vector<native_frame_ptr_t> frames(size() + 1, nullptr);
+        for (std::size_t i = 0; i < size(); ++i) {
+            frames[i] = (*this)[i].address();
+        }
+        return basic_stacktrace<Allocator>::from_dump(frames.data(), frames.size() * sizeof(native_frame_ptr_t), a);
+    }
+
+    /// @cond
+    friend bool operator==(const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        if (lhs.is_wide() == rhs.is_wide()) {
+            // Encoding of an address never changes, comparing the raw storage
+            return !lhs.data_ || std::memcmp(lhs.data_.get(), rhs.data_.get(), lhs.words_count() * sizeof(std::uint32_t)) == 0;
+        }
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i] != rhs[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /// @endcond
+};
+
+/// Comparison operators that provide the same ordering as for boost::stacktrace::basic_stacktrace; O(size()) complexity.
+inline bool operator< (const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size();
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        const frame l = lhs[i];
+        const frame r = rhs[i];
+        if (l != r) {
+            return l < r;
+        }
+    }
+    return false;
+}
+inline bool operator> (const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept { return rhs < lhs; }
+inline bool operator<=(const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept { return !(lhs > rhs); }
+inline bool operator>=(const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept { return !(lhs < rhs); }
+inline bool operator!=(const compact_stacktrace& lhs, const compact_stacktrace& rhs) noexcept { return !(lhs == rhs); }
+
+/// Hashing support, O(st.size()) complexity. Equal to the hash_value of the basic_stacktrace with the same frames.
+inline std::size_t hash_value(const compact_stacktrace& st) noexcept {
+    std::size_t seed = 0;
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        boost::hash_combine(seed, st[i]);
+    }
+    return seed;
+}
+
+/// Returns std::string with the stacktrace in a human readable format; unsafe to use in async handlers.
+inline std::string to_string(const compact_stacktrace& st) {
+    if (!st) {
+        return std::string();
+    }
+
+    std::vector<frame> frames(st.begin(), st.end());
+    return boost::stacktrace::detail::to_string(&frames[0], frames.size());
+}
+
+/// Outputs stacktrace in a human readable format to the output stream `os`; unsafe to use in async handlers.
+template <class CharT, class TraitsT>
+std::basic_ostream<CharT, TraitsT>& operator<<(std::basic_ostream<CharT, TraitsT>& os, const compact_stacktrace& st) {
+    return os << boost::stacktrace::to_string(st);
+}
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_COMPACT_STACKTRACE_HPP
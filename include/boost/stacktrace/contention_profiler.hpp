@@ -0,0 +1,453 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_CONTENTION_PROFILER_HPP
+#define BOOST_STACKTRACE_CONTENTION_PROFILER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/pprof_writer.hpp>
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/stacktrace.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file contention_profiler.hpp Mutex contention profiler that attributes the time spent waiting for locks to the
+/// stacks of the waiters.
+
+namespace boost { namespace stacktrace {
+
+class contention_profiler;
+
+/// @cond
+namespace detail {
+
+    // Trivial, so it is constant initialized and usable from the lock functions at any time of the thread life
+    struct contention_profiler_thread {
+        std::uint64_t slow_acquisitions;
+        bool busy;      // inside the profiler, locks of the profiler itself are not recorded
+    };
+
+    inline contention_profiler_thread& contention_profiler_this_thread() noexcept {
+        static thread_local contention_profiler_thread state;
+        return state;
+    }
+
+    // All of them are constant initialized, so they could be used by the locks before main()
+    inline std::atomic<contention_profiler*>& contention_profiler_active() noexcept {
+        static std::atomic<contention_profiler*> profiler(nullptr);
+        return profiler;
+    }
+
+    inline std::atomic<std::size_t>& contention_profiler_in_flight() noexcept {
+        static std::atomic<std::size_t> count(0);
+        return count;
+    }
+
+    inline std::atomic<std::uint64_t>& contention_profiler_threshold() noexcept {
+        static std::atomic<std::uint64_t> threshold_ns(0);
+        return threshold_ns;
+    }
+
+    inline std::atomic<std::uint64_t>& contention_profiler_rate() noexcept {
+        static std::atomic<std::uint64_t> rate(1);
+        return rate;
+    }
+
+    inline std::uint64_t contention_profiler_clock_ns() noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+    }
+
+} // namespace detail
+/// @endcond
+
+/// @brief Estimated contention of a single stack, see boost::stacktrace::contention_profiler::snapshot().
+struct contention_profile_entry {
+    stacktrace stack;                   ///< Stack of the waiter, innermost frame first.
+    std::uint64_t contentions;          ///< Count of the acquisitions that waited longer than the threshold.
+    std::uint64_t wait_ns;              ///< Total time spent waiting in those acquisitions, in nanoseconds.
+};
+
+/// @brief Mutex contention profiler: captures the stacks of the threads that waited for a lock longer than a threshold
+/// and accumulates the wait time per stack.
+///
+/// Waits are reported to the running profiler through record_wait(). boost::stacktrace::contention_profiler::lock()
+/// and boost::stacktrace::profiled_mutex measure the waits of any Lockable: the lock is acquired with `try_lock()` first,
+/// so uncontended acquisitions cost a load of an atomic and are not timed. On Linux define the
+/// `BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX` macro in exactly one translation unit of the program
+/// before including this header and link with `-Wl,--wrap=pthread_mutex_lock` to report the waits in `pthread_mutex_lock`,
+/// including the ones of `std::mutex` and `std::lock_guard` from the code compiled into the program.
+///
+/// Every `sample_rate`-th slow acquisition of a thread captures the stack with boost::stacktrace::safe_dump_to() machinery
+/// into a buffer on the stack and takes a lock. Reported values are scaled by the `sample_rate`.
+///
+/// Only one profiler could be running at a time. Locks taken by the profiler itself are not recorded.
+class contention_profiler {
+    /// @cond
+    typedef boost::stacktrace::detail::native_frame_ptr_t native_frame_ptr_t;
+
+    struct stack_info {
+        std::size_t first;          // position in frames_
+        std::size_t size;
+        std::uint64_t contentions;
+        std::uint64_t wait_ns;
+    };
+
+    class busy_scope {
+        boost::stacktrace::detail::contention_profiler_thread& state_;
+        const bool was_busy_;
+
+        busy_scope(const busy_scope&) = delete;
+        busy_scope& operator=(const busy_scope&) = delete;
+
+    public:
+        busy_scope() noexcept
+            : state_(boost::stacktrace::detail::contention_profiler_this_thread())
+            , was_busy_(state_.busy)
+        {
+            state_.busy = true;
+        }
+
+        ~busy_scope() {
+            state_.busy = was_busy_;
+        }
+    };
+
+    const std::uint64_t threshold_ns_;
+    const std::uint64_t rate_;
+
+    mutable std::mutex mutex_;
+    std::vector<native_frame_ptr_t> frames_;                        // stacks one after another, innermost frame first
+    std::vector<stack_info> stacks_;
+    std::unordered_multimap<std::size_t, std::size_t> stack_ids_;   // hash of the frames -> index in stacks_
+    std::uint64_t samples_;
+
+    contention_profiler(const contention_profiler&) = delete;
+    contention_profiler& operator=(const contention_profiler&) = delete;
+
+    std::size_t intern(const native_frame_ptr_t* frames, std::size_t size) {
+        const std::size_t hash = boost::hash_range(frames, frames + size);
+        const std::pair<std::unordered_multimap<std::size_t, std::size_t>::iterator,
+            std::unordered_multimap<std::size_t, std::size_t>::iterator> range = stack_ids_.equal_range(hash);
+        for (std::unordered_multimap<std::size_t, std::size_t>::iterator it = range.first; it != range.second; ++it) {
+            const stack_info& s = stacks_[it->second];
+            if (s.size == size && std::equal(frames, frames + size, frames_.begin() + static_cast<std::ptrdiff_t>(s.first))) {
+                return it->second;
+            }
+        }
+
+        const stack_info s = {frames_.size(), size, 0, 0};
+        frames_.insert(frames_.end(), frames, frames + size);
+        stacks_.push_back(s);
+        stack_ids_.emplace(hash, stacks_.size() - 1);
+        return stacks_.size() - 1;
+    }
+
+    BOOST_NOINLINE void sample(std::uint64_t wait_ns) noexcept {
+        native_frame_ptr_t frames[boost::stacktrace::detail::max_frames_dump];
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(
+            frames, boost::stacktrace::detail::max_frames_dump, 2 // this function and record_wait()
+        );
+
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stack_info& s = stacks_[intern(frames, frames_count)];
+            s.contentions += rate_;
+            s.wait_ns += wait_ns * rate_;
+            ++samples_;
+        } catch (...) {
+            // Not enough memory for the sample, skipping it
+        }
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates a stopped profiler.
+    ///
+    /// @param threshold Acquisitions that waited for less are not recorded.
+    /// @param sample_rate Stack of one of `sample_rate` slow acquisitions of a thread is captured. 1 records all of them.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    explicit contention_profiler(std::chrono::nanoseconds threshold = std::chrono::microseconds(10), unsigned sample_rate = 1)
+        : threshold_ns_(threshold.count() > 0 ? static_cast<std::uint64_t>(threshold.count()) : 0)
+        , rate_(sample_rate ? sample_rate : 1)
+        , samples_(0)
+    {}
+
+    /// @brief Stops the profiling, see stop().
+    ~contention_profiler() {
+        stop();
+    }
+
+    /// @brief Starts recording the waits of all the threads. Counters are kept from the previous runs.
+    ///
+    /// @returns false if another profiler is running.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool start() noexcept {
+        contention_profiler* expected = 0;
+        if (boost::stacktrace::detail::contention_profiler_active().load() == this) {
+            return true;
+        }
+
+        if (!boost::stacktrace::detail::contention_profiler_active().compare_exchange_strong(expected, this)) {
+            return false;
+        }
+        boost::stacktrace::detail::contention_profiler_threshold().store(threshold_ns_);
+        boost::stacktrace::detail::contention_profiler_rate().store(rate_);
+        return true;
+    }
+
+    /// @brief Stops recording. Does nothing if not running.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void stop() noexcept {
+        contention_profiler* expected = this;
+        if (!boost::stacktrace::detail::contention_profiler_active().compare_exchange_strong(expected, 0)) {
+            return;
+        }
+        while (boost::stacktrace::detail::contention_profiler_in_flight().load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @returns true if the profiler was started and not stopped yet.
+    bool running() const noexcept {
+        return boost::stacktrace::detail::contention_profiler_active().load() == this;
+    }
+
+    /// @returns Minimal wait that is recorded.
+    std::chrono::nanoseconds threshold() const noexcept {
+        return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(threshold_ns_));
+    }
+
+    /// @returns Count of the slow acquisitions per captured stack.
+    unsigned sample_rate() const noexcept {
+        return static_cast<unsigned>(rate_);
+    }
+
+    /// @returns Count of the captured stacks.
+    std::uint64_t samples() const {
+        busy_scope busy;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return samples_;
+    }
+
+    /// @brief Reports to the running profiler that the current thread waited `wait` for a lock. Waits below the
+    /// threshold are ignored. Does nothing if no profiler is running.
+    ///
+    /// @b Complexity: O(1), the stack is captured for the sampled waits only.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_NOINLINE static void record_wait(std::chrono::nanoseconds wait) noexcept {
+        if (!boost::stacktrace::detail::contention_profiler_active().load(std::memory_order_acquire)) {
+            return;
+        }
+
+        const std::uint64_t wait_ns = wait.count() > 0 ? static_cast<std::uint64_t>(wait.count()) : 0;
+        if (wait_ns < boost::stacktrace::detail::contention_profiler_threshold().load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        boost::stacktrace::detail::contention_profiler_thread& t = boost::stacktrace::detail::contention_profiler_this_thread();
+        if (t.busy) {
+            return;
+        }
+        if (++t.slow_acquisitions % boost::stacktrace::detail::contention_profiler_rate().load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // stop() waits for the counter to become 0 after resetting the active profiler
+        busy_scope busy;
+        boost::stacktrace::detail::contention_profiler_in_flight().fetch_add(1);
+        if (contention_profiler* const profiler = boost::stacktrace::detail::contention_profiler_active().load()) {
+            profiler->sample(wait_ns);
+        }
+        boost::stacktrace::detail::contention_profiler_in_flight().fetch_sub(1);
+    }
+
+    /// @brief Locks `m` and reports the wait to the running profiler, see record_wait().
+    ///
+    /// @b Complexity: Uncontended acquisitions cost a `try_lock()` and a load of an atomic.
+    template <class Lockable>
+    static void lock(Lockable& m) {
+        if (!boost::stacktrace::detail::contention_profiler_active().load(std::memory_order_relaxed)) {
+            m.lock();
+            return;
+        }
+        if (m.try_lock()) {
+            return;
+        }
+
+        const std::uint64_t started = boost::stacktrace::detail::contention_profiler_clock_ns();
+        m.lock();
+        record_wait(std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(
+            boost::stacktrace::detail::contention_profiler_clock_ns() - started
+        )));
+    }
+
+    /// @returns Estimated contention per stack, sorted by the wait time in descending order.
+    ///
+    /// @b Complexity: O(N) where N is the total count of frames in the distinct stacks, no symbolization is done.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::vector<contention_profile_entry> snapshot() const {
+        busy_scope busy;
+        std::vector<contention_profile_entry> res;
+        std::vector<native_frame_ptr_t> buffer;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        res.reserve(stacks_.size());
+        for (std::size_t i = 0; i < stacks_.size(); ++i) {
+            const stack_info& s = stacks_[i];
+            buffer.assign(frames_.begin() + static_cast<std::ptrdiff_t>(s.first), frames_.begin() + static_cast<std::ptrdiff_t>(s.first + s.size));
+            buffer.push_back(0); // terminating frame, as in the buffers of boost::stacktrace::safe_dump_to()
+            const contention_profile_entry e = {
+                stacktrace::from_dump(&buffer[0], buffer.size() * sizeof(buffer[0])), s.contentions, s.wait_ns
+            };
+            res.push_back(e);
+        }
+        lock.unlock();
+
+        std::sort(res.begin(), res.end(), [](const contention_profile_entry& lhs, const contention_profile_entry& rhs) {
+            return lhs.wait_ns > rhs.wait_ns;
+        });
+        return res;
+    }
+
+    /// @returns At most `count` most contended stacks, see snapshot().
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::vector<contention_profile_entry> top(std::size_t count) const {
+        std::vector<contention_profile_entry> res = snapshot();
+        if (res.size() > count) {
+            res.erase(res.begin() + static_cast<std::ptrdiff_t>(count), res.end());
+        }
+        return res;
+    }
+
+    /// @brief Writes the snapshot() to the gzipped pprof profile `file` with the "contentions" and "delay" values
+    /// per sample, as in the mutex profiles of Go.
+    ///
+    /// @returns false on I/O errors.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool write_pprof(const char* file, symbolizer_backend backend = symbolizer_backend::default_backend) const {
+        busy_scope busy;
+        const std::vector<contention_profile_entry> entries = snapshot();
+
+        boost::stacktrace::pprof_writer writer(file, {
+            pprof_value_type{"contentions", "count"}, pprof_value_type{"delay", "nanoseconds"}
+        }, backend);
+        writer.set_period(pprof_value_type{"contentions", "count"}, static_cast<std::int64_t>(rate_));
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            writer.add(entries[i].stack, {
+                static_cast<std::int64_t>(entries[i].contentions), static_cast<std::int64_t>(entries[i].wait_ns)
+            });
+        }
+        return writer.close();
+    }
+
+    /// @brief Drops all the stacks and counters.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void clear() {
+        busy_scope busy;
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_.clear();
+        stacks_.clear();
+        stack_ids_.clear();
+        samples_ = 0;
+    }
+};
+
+/// @brief Wrapper of a Lockable that reports the waits for the lock to the running boost::stacktrace::contention_profiler.
+///
+/// Could be used as a drop-in replacement of `std::mutex` with `std::lock_guard` and `std::unique_lock`.
+template <class Mutex = std::mutex>
+class profiled_mutex {
+    Mutex mutex_;
+
+    profiled_mutex(const profiled_mutex&) = delete;
+    profiled_mutex& operator=(const profiled_mutex&) = delete;
+
+public:
+    profiled_mutex() = default;
+
+    /// @brief Locks the mutex, the wait is reported with boost::stacktrace::contention_profiler::record_wait().
+    void lock() {
+        boost::stacktrace::contention_profiler::lock(mutex_);
+    }
+
+    bool try_lock() {
+        return mutex_.try_lock();
+    }
+
+    void unlock() {
+        mutex_.unlock();
+    }
+
+    /// @returns The wrapped mutex.
+    Mutex& get() noexcept {
+        return mutex_;
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#if defined(BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX)
+
+#include <cerrno>
+#include <pthread.h>
+
+extern "C" int __real_pthread_mutex_lock(pthread_mutex_t* m);
+
+// Called instead of pthread_mutex_lock when the program is linked with -Wl,--wrap=pthread_mutex_lock
+extern "C" int __wrap_pthread_mutex_lock(pthread_mutex_t* m) {
+    if (!boost::stacktrace::detail::contention_profiler_active().load(std::memory_order_relaxed)) {
+        return __real_pthread_mutex_lock(m);
+    }
+    // Robust mutexes are acquired by the trylock even if it returns EOWNERDEAD
+    const int try_res = ::pthread_mutex_trylock(m);
+    if (try_res != EBUSY) {
+        return try_res;
+    }
+
+    const std::uint64_t started = boost::stacktrace::detail::contention_profiler_clock_ns();
+    const int res = __real_pthread_mutex_lock(m);
+    boost::stacktrace::contention_profiler::record_wait(std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(
+        boost::stacktrace::detail::contention_profiler_clock_ns() - started
+    )));
+    return res;
+}
+
+#endif // defined(BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX)
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_CONTENTION_PROFILER_HPP
@@ -0,0 +1,713 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_CPU_PROFILER_HPP
+#define BOOST_STACKTRACE_CPU_PROFILER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/folded_stacks.hpp>
+#include <boost/stacktrace/perf_event_sampler.hpp>
+#include <boost/stacktrace/pprof_writer.hpp>
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/detail/signal_frames.hpp>
+#include <boost/stacktrace/detail/spsc_ring.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <signal.h>     // ::sigaction
+#   include <time.h>       // ::timer_create
+#   include <unistd.h>     // ::syscall
+#   include <sys/syscall.h>
+#   if defined(SIGEV_THREAD_ID) && defined(SYS_gettid)
+#       define BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED
+#   endif
+#endif
+
+/// @file cpu_profiler.hpp In-process sampling CPU profiler that aggregates the stacks of all the threads of the process.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+
+    // Record in the per thread ring: frames count, sampling period in ns, frames. All the values are 64 bit words.
+    enum cpu_profiler_layout { cpu_profiler_record_header_words = 2 };
+
+    // Entry of the open addressing table of the sampled threads. Written only by the thread that owns the
+    // cpu_profiler, read by the signal handlers. `tid` is 0 for never used entries and -1 for released ones.
+    struct cpu_profiler_slot {
+        cpu_profiler_slot() noexcept : tid(0), handler_ns(0), start_time(0), timer(), armed(false), seen(false) {}
+
+        std::atomic<long> tid;
+        std::unique_ptr<boost::stacktrace::detail::spsc_ring> ring; // set before the tid is published, kept on release
+        std::atomic<std::uint64_t> handler_ns;                      // time spent in the signal handler on the thread
+
+        std::uint64_t start_time;   // tells apart the threads that got the tid of an exited one
+        ::timer_t timer;
+        bool armed;
+        bool seen;
+    };
+
+    struct cpu_profiler_state {
+        explicit cpu_profiler_state(std::size_t capacity)
+            : slots(new cpu_profiler_slot[capacity])
+            , mask(capacity - 1)
+            , period_ns(0)
+            , dropped(0)
+        {}
+
+        std::unique_ptr<cpu_profiler_slot[]> slots;
+        const std::size_t mask;
+        std::atomic<std::uint64_t> period_ns;
+        std::atomic<std::uint64_t> dropped;
+    };
+
+    // Both are constant initialized, so they are safe to use from the signal handler
+    inline std::atomic<cpu_profiler_state*>& cpu_profiler_active() noexcept {
+        static std::atomic<cpu_profiler_state*> state(nullptr);
+        return state;
+    }
+
+    inline std::atomic<std::size_t>& cpu_profiler_handlers_running() noexcept {
+        static std::atomic<std::size_t> count(0);
+        return count;
+    }
+
+    inline cpu_profiler_slot* cpu_profiler_find(cpu_profiler_state& state, long tid) noexcept {
+        std::size_t index = (static_cast<std::size_t>(tid) * 2654435761u) & state.mask;
+        for (std::size_t i = 0; i <= state.mask; ++i, index = (index + 1) & state.mask) {
+            const long t = state.slots[index].tid.load(std::memory_order_acquire);
+            if (t == tid) {
+                return &state.slots[index];
+            } else if (t == 0) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    inline std::uint64_t cpu_profiler_clock_ns(::clockid_t clock) noexcept {
+        ::timespec ts;
+        if (::clock_gettime(clock, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec);
+    }
+
+    struct cpu_profiler_handler {
+        static void sample(cpu_profiler_state& state, const void* context) noexcept {
+            const std::uint64_t start = boost::stacktrace::detail::cpu_profiler_clock_ns(CLOCK_MONOTONIC);
+            cpu_profiler_slot* const slot = boost::stacktrace::detail::cpu_profiler_find(state, static_cast<long>(::syscall(SYS_gettid)));
+            if (!slot) {
+                state.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            native_frame_ptr_t frames[boost::stacktrace::detail::max_frames_dump];
+            const std::size_t size = boost::stacktrace::detail::this_thread_frames::collect(
+                frames, boost::stacktrace::detail::max_frames_dump, 0
+            );
+
+            // Dropping the frames of the handler and of the signal trampoline
+            const std::size_t first = boost::stacktrace::detail::first_interrupted_frame(frames, size, context, 2);
+
+            const std::uint64_t header[cpu_profiler_record_header_words] = {
+                size - first,
+                state.period_ns.load(std::memory_order_relaxed)
+            };
+            const bool pushed = slot->ring->try_push(
+                cpu_profiler_record_header_words + size - first,
+                [&header, &frames, first](std::size_t i) -> std::uint64_t {
+                    return i < cpu_profiler_record_header_words
+                        ? header[i]
+                        : reinterpret_cast<std::uintptr_t>(frames[first + i - cpu_profiler_record_header_words]);
+                }
+            );
+            if (!pushed) {
+                state.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            slot->handler_ns.fetch_add(
+                boost::stacktrace::detail::cpu_profiler_clock_ns(CLOCK_MONOTONIC) - start,
+                std::memory_order_relaxed
+            );
+        }
+
+        static void on_signal(int, ::siginfo_t*, void* context) noexcept {
+            const int saved_errno = errno;
+
+            // cpu_profiler::stop() waits for the counter to become 0 after resetting the active state
+            std::atomic<std::size_t>& running = boost::stacktrace::detail::cpu_profiler_handlers_running();
+            running.fetch_add(1);
+            cpu_profiler_state* const state = boost::stacktrace::detail::cpu_profiler_active().load();
+            if (state) {
+                sample(*state, context);
+            }
+            running.fetch_sub(1);
+
+            errno = saved_errno;
+        }
+    };
+
+#endif // defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+
+} // namespace detail
+/// @endcond
+
+/// @brief The way cpu_profiler collects the samples.
+enum class cpu_profiler_mode {
+    signals,        ///< Timers of the threads CPU time deliver SIGPROF, the signal handler unwinds the stack.
+    perf_events     ///< Kernel collects the callchains, see boost::stacktrace::perf_event_sampler.
+};
+
+/// @brief Sampling profiler of the CPU time of all the threads of the process, without external tools.
+///
+/// Each thread gets a timer of its own CPU time that delivers SIGPROF to that thread. The signal handler
+/// captures the frames with the async signal safe boost::stacktrace::safe_dump_to() machinery into a preallocated
+/// wait-free ring of the thread and never locks or allocates. A background thread drains the rings, aggregates
+/// the identical stacks and looks for the new threads in `/proc/self/task` once a second.
+///
+/// The time spent in the signal handlers and in the background thread is measured. If it exceeds the configured
+/// share of the CPU time of the process, the sampling frequency is halved, down to one sample per second of
+/// CPU time. When the overhead gets well below the budget the frequency is raised back, up to the requested one.
+/// Samples are weighted by the sampling period, so the results stay comparable whatever the frequency was.
+///
+/// Only one profiler could be running in a process at a time. The SIGPROF handler is installed on the first
+/// start() and stays installed, doing nothing after stop(). start() fails if SIGPROF is used by someone else.
+///
+/// Works on Linux only, start() returns false on other platforms. Unwinding in the signal handler relies on
+/// the unwinder being async signal safe, which is the case for glibc with libgcc. Timer signals may interrupt
+/// blocking system calls that are not restarted automatically, making them fail with `EINTR`.
+///
+/// In the cpu_profiler_mode::perf_events mode the samples are collected by the kernel with boost::stacktrace::perf_event_sampler
+/// instead: no signals are used, several profilers could run at the same time, but the code has to keep the frame pointers.
+class cpu_profiler {
+    /// @cond
+    typedef boost::stacktrace::detail::spsc_ring ring_t;
+
+    enum {
+        thread_ring_words = 16 * 1024,
+        drain_interval_ms = 100,
+        rescan_interval_ms = 1000
+    };
+
+    const std::uint64_t target_period_ns_;
+    const double max_overhead_;
+    const std::size_t max_threads_;
+    const cpu_profiler_mode mode_;
+    std::unique_ptr<boost::stacktrace::perf_event_sampler> sampler_;
+    std::uint64_t sampler_lost_;    // by the samplers of the previous runs
+
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+    boost::stacktrace::detail::cpu_profiler_state state_;
+#endif
+
+    mutable std::mutex stacks_mutex_;
+    boost::stacktrace::folded_stacks stacks_;
+    std::vector<frame> frames_;
+    std::uint64_t samples_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+    bool running_;
+    std::thread thread_;
+
+    // Accounting of the overhead, used only by the background thread
+    std::uint64_t last_handler_ns_;
+    std::uint64_t last_own_ns_;
+    std::uint64_t last_process_ns_;
+
+    cpu_profiler(const cpu_profiler&) = delete;
+    cpu_profiler& operator=(const cpu_profiler&) = delete;
+
+    static std::size_t table_capacity(std::size_t max_threads) noexcept {
+        std::size_t res = 16;
+        while (res < max_threads * 2) {
+            res <<= 1;
+        }
+        return res;
+    }
+
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+    static bool install_handler() noexcept {
+        struct sigaction old_action;
+        if (::sigaction(SIGPROF, 0, &old_action) != 0) {
+            return false;
+        }
+        if (old_action.sa_flags & SA_SIGINFO) {
+            return old_action.sa_sigaction == &boost::stacktrace::detail::cpu_profiler_handler::on_signal;
+        }
+        if (old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN) {
+            return false;
+        }
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &boost::stacktrace::detail::cpu_profiler_handler::on_signal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        ::sigemptyset(&action.sa_mask);
+        return ::sigaction(SIGPROF, &action, 0) == 0;
+    }
+
+    ::itimerspec timer_spec() const noexcept {
+        const std::uint64_t period = state_.period_ns.load(std::memory_order_relaxed);
+        ::itimerspec spec;
+        spec.it_interval.tv_sec = static_cast<::time_t>(period / 1000000000u);
+        spec.it_interval.tv_nsec = static_cast<long>(period % 1000000000u);
+        spec.it_value = spec.it_interval;
+        return spec;
+    }
+
+    bool add_thread(long tid, std::uint64_t start_time) {
+        std::size_t index = (static_cast<std::size_t>(tid) * 2654435761u) & state_.mask;
+        for (std::size_t i = 0; i <= state_.mask; ++i, index = (index + 1) & state_.mask) {
+            boost::stacktrace::detail::cpu_profiler_slot& slot = state_.slots[index];
+            const long t = slot.tid.load(std::memory_order_relaxed);
+            if (t > 0) {
+                continue;
+            }
+
+            if (!slot.ring) {
+                slot.ring.reset(new ring_t(thread_ring_words));
+            }
+
+            ::sigevent event;
+            std::memset(&event, 0, sizeof(event));
+            event.sigev_notify = SIGEV_THREAD_ID;
+            event.sigev_signo = SIGPROF;
+#if defined(sigev_notify_thread_id)
+            event.sigev_notify_thread_id = static_cast<::pid_t>(tid);
+#else
+            event._sigev_un._tid = static_cast<::pid_t>(tid);
+#endif
+            // Same as MAKE_THREAD_CPUCLOCK(tid, CPUCLOCK_SCHED) of the Linux kernel, as in pthread_getcpuclockid()
+            const ::clockid_t clock = static_cast<::clockid_t>(~static_cast<::clockid_t>(tid) * 8 + 6);
+            if (::timer_create(clock, &event, &slot.timer) != 0) {
+                return false; // thread has already exited or the limit of timers is reached
+            }
+
+            slot.armed = true;
+            slot.seen = true;
+            slot.start_time = start_time;
+            slot.tid.store(tid, std::memory_order_release);
+
+            const ::itimerspec spec = timer_spec();
+            ::timer_settime(slot.timer, 0, &spec, 0);
+            return true;
+        }
+        return false;
+    }
+
+    void release_slot(boost::stacktrace::detail::cpu_profiler_slot& slot) noexcept {
+        if (slot.armed) {
+            ::timer_delete(slot.timer);
+            slot.armed = false;
+        }
+        slot.tid.store(-1, std::memory_order_release);
+    }
+
+    // Starts sampling the new threads and stops sampling the exited ones
+    void scan_threads() {
+        if (sampler_) {
+            sampler_->update_threads();
+            return;
+        }
+
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            state_.slots[i].seen = false;
+        }
+        const bool listed = boost::stacktrace::detail::for_each_thread_id([this](std::uint64_t id) {
+            const long tid = static_cast<long>(id);
+            const std::uint64_t start_time = boost::stacktrace::detail::thread_start_time(id);
+            boost::stacktrace::detail::cpu_profiler_slot* slot = boost::stacktrace::detail::cpu_profiler_find(state_, tid);
+            if (slot && slot->start_time == start_time) {
+                slot->seen = true;
+                return;
+            }
+            if (slot) {
+                release_slot(*slot);    // the timer measures the CPU time of the exited thread
+            }
+            add_thread(tid, start_time);
+        });
+        if (!listed) {
+            return;
+        }
+
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            boost::stacktrace::detail::cpu_profiler_slot& slot = state_.slots[i];
+            if (!slot.seen && slot.tid.load(std::memory_order_relaxed) > 0) {
+                release_slot(slot);
+            }
+        }
+    }
+
+    void rearm_timers() noexcept {
+        if (sampler_) {
+            sampler_->set_period(state_.period_ns.load(std::memory_order_relaxed));
+            return;
+        }
+
+        const ::itimerspec spec = timer_spec();
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            if (state_.slots[i].armed) {
+                ::timer_settime(state_.slots[i].timer, 0, &spec, 0);
+            }
+        }
+    }
+
+    // Halves or doubles the sampling frequency, keeping the overhead within the budget
+    void adjust_period() noexcept {
+        std::uint64_t handler_ns = 0;
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            handler_ns += state_.slots[i].handler_ns.load(std::memory_order_relaxed);
+        }
+        const std::uint64_t own_ns = boost::stacktrace::detail::cpu_profiler_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+        const std::uint64_t process_ns = boost::stacktrace::detail::cpu_profiler_clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+        const double cost = static_cast<double>(handler_ns - last_handler_ns_ + own_ns - last_own_ns_);
+        const double total = static_cast<double>(process_ns - last_process_ns_);
+        last_handler_ns_ = handler_ns;
+        last_own_ns_ = own_ns;
+        last_process_ns_ = process_ns;
+        if (total <= 0) {
+            return;
+        }
+
+        const std::uint64_t max_period_ns = 1000000000u;
+        const std::uint64_t period = state_.period_ns.load(std::memory_order_relaxed);
+        std::uint64_t new_period = period;
+        if (cost > total * max_overhead_ && period < max_period_ns) {
+            new_period = (period * 2 < max_period_ns ? period * 2 : max_period_ns);
+        } else if (cost * 4 < total * max_overhead_ && period > target_period_ns_) {
+            new_period = (period / 2 > target_period_ns_ ? period / 2 : target_period_ns_);
+        }
+
+        if (new_period != period) {
+            state_.period_ns.store(new_period, std::memory_order_relaxed);
+            rearm_timers();
+        }
+    }
+
+    void run() {
+        std::chrono::steady_clock::time_point next_rescan = std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(rescan_interval_ms);
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (!stop_) {
+            wake_.wait_for(lock, std::chrono::milliseconds(drain_interval_ms));
+            if (stop_) {
+                break;
+            }
+            lock.unlock();
+
+            try {
+                drain();
+                if (std::chrono::steady_clock::now() >= next_rescan) {
+                    next_rescan += std::chrono::milliseconds(rescan_interval_ms);
+                    scan_threads();
+                    adjust_period();
+                }
+            } catch (...) {
+                // Out of memory. Samples stay in the rings, new ones are dropped when the rings are full.
+            }
+
+            lock.lock();
+        }
+    }
+#endif // defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+
+    // Moves the samples from the rings of the threads into the aggregated stacks
+    void drain() {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        const std::size_t header_words = boost::stacktrace::detail::cpu_profiler_record_header_words;
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        if (sampler_) {
+            const std::uint64_t weight = sampler_->period() / 1000;
+            samples_ += sampler_->poll([this, weight](std::uint64_t, const stacktrace& st) {
+                stacks_.add(st, weight);
+            });
+            return;
+        }
+
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            ring_t* const ring = state_.slots[i].ring.get();
+            if (!ring) {
+                continue;
+            }
+
+            std::size_t available = ring->available();
+            while (available >= header_words) {
+                const std::size_t size = static_cast<std::size_t>(ring->peek(0));
+                const std::uint64_t period_ns = ring->peek(1);
+                frames_.clear();
+                for (std::size_t j = 0; j < size; ++j) {
+                    frames_.push_back(frame(reinterpret_cast<boost::stacktrace::detail::native_frame_ptr_t>(
+                        static_cast<std::uintptr_t>(ring->peek(header_words + j))
+                    )));
+                }
+                stacks_.add(frames_.empty() ? static_cast<const frame*>(0) : &frames_[0], size, period_ns / 1000);
+                ++samples_;
+
+                ring->pop(header_words + size);
+                available -= header_words + size;
+            }
+        }
+#endif
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates a stopped profiler.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    /// @throws std::bad_alloc if not enough memory.
+    ///
+    /// @param frequency Wanted count of samples per second of the CPU time of each thread. Prime numbers, like the default 99,
+    /// avoid sampling in lockstep with periodic activities.
+    ///
+    /// @param max_overhead Share of the CPU time of the process that the profiler is allowed to spend on sampling and aggregation.
+    ///
+    /// @param max_threads Maximal count of the threads that are sampled at the same time, the rest are not sampled.
+    /// Each sampled thread takes 128KiB for its ring of samples.
+    ///
+    /// @param mode The way to collect the samples.
+    explicit cpu_profiler(unsigned frequency = 99, double max_overhead = 0.01, std::size_t max_threads = 1024,
+            cpu_profiler_mode mode = cpu_profiler_mode::signals)
+        : target_period_ns_(1000000000u / (frequency ? frequency : 1))
+        , max_overhead_(max_overhead)
+        , max_threads_(max_threads)
+        , mode_(mode)
+        , sampler_lost_(0)
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        , state_(table_capacity(max_threads))
+#endif
+        , samples_(0)
+        , stop_(false)
+        , running_(false)
+        , last_handler_ns_(0)
+        , last_own_ns_(0)
+        , last_process_ns_(0)
+    {
+        frames_.reserve(boost::stacktrace::detail::max_frames_dump);
+    }
+
+    /// @brief Stops the profiling, see stop().
+    ~cpu_profiler() {
+        stop();
+    }
+
+    /// @returns true if the platform supports the profiling.
+    static bool is_supported() noexcept {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief Starts sampling all the existing threads of the process and the ones that are created later.
+    /// Samples are added to the ones collected by the previous runs.
+    ///
+    /// @returns true if the profiler is running. false if the platform is not supported, SIGPROF has a handler
+    /// that is not of the profiler, another profiler is running or the system resources are exhausted.
+    /// In the cpu_profiler_mode::perf_events mode returns false if the events are not available.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool start() {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        if (running_) {
+            return true;
+        }
+
+        if (mode_ == cpu_profiler_mode::perf_events) {
+            sampler_.reset(new boost::stacktrace::perf_event_sampler(1, max_threads_));
+            sampler_->set_period(target_period_ns_);
+            if (!sampler_->update_threads()) {
+                sampler_.reset();
+                return false;
+            }
+        } else {
+            boost::stacktrace::detail::cpu_profiler_state* expected = 0;
+            if (!install_handler() || !boost::stacktrace::detail::cpu_profiler_active().compare_exchange_strong(expected, &state_)) {
+                return false;
+            }
+        }
+
+        state_.period_ns.store(target_period_ns_, std::memory_order_relaxed);
+        last_handler_ns_ = 0;
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            last_handler_ns_ += state_.slots[i].handler_ns.load(std::memory_order_relaxed);
+        }
+        last_process_ns_ = boost::stacktrace::detail::cpu_profiler_clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+        last_own_ns_ = 0;
+
+        try {
+            scan_threads();
+            stop_ = false;
+            thread_ = std::thread(&cpu_profiler::run, this);
+        } catch (...) {
+            running_ = true;
+            stop();
+            throw;
+        }
+        running_ = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief Stops the sampling and aggregates the samples that are still in the rings. Does nothing if not running.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void stop() noexcept {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        if (!running_) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            if (state_.slots[i].armed) {
+                ::timer_delete(state_.slots[i].timer);
+                state_.slots[i].armed = false;
+            }
+        }
+        if (!sampler_) {
+            boost::stacktrace::detail::cpu_profiler_active().store(0);
+            while (boost::stacktrace::detail::cpu_profiler_handlers_running().load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        try {
+            drain();
+        } catch (...) {}
+
+        if (sampler_) {
+            sampler_lost_ += sampler_->lost();
+            sampler_.reset();
+        }
+
+        for (std::size_t i = 0; i <= state_.mask; ++i) {
+            state_.slots[i].tid.store(0, std::memory_order_relaxed);
+        }
+        running_ = false;
+#endif
+    }
+
+    /// @returns true if the profiler was started and not stopped yet.
+    bool running() const noexcept { return running_; }
+
+    /// @returns Current sampling frequency per second of the CPU time of a thread, that could be lower than the requested
+    /// one because of the overhead budget. 0 if the profiler was never started.
+    unsigned frequency() const noexcept {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        const std::uint64_t period = state_.period_ns.load(std::memory_order_relaxed);
+        return period ? static_cast<unsigned>(1000000000u / period) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    /// @returns Count of the samples that were aggregated.
+    std::uint64_t samples() const {
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        return samples_;
+    }
+
+    /// @returns Count of the samples that were lost because the ring of the thread was full.
+    std::uint64_t dropped() const noexcept {
+#if defined(BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED)
+        return state_.dropped.load(std::memory_order_relaxed) + sampler_lost_ + (sampler_ ? sampler_->lost() : 0);
+#else
+        return 0;
+#endif
+    }
+
+    /// @returns Aggregated samples in the folded format of the flame graph tools, see boost::stacktrace::folded_stacks.
+    /// Weights are the CPU time in microseconds.
+    ///
+    /// Frames are symbolized under the lock that the background thread takes for aggregation, so the samples
+    /// could be dropped while the first output symbolizes lots of frames.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::string folded() {
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        return stacks_.str();
+    }
+
+    /// @brief Writes the aggregated samples to `os` in the folded format, see folded().
+    template <class CharT, class TraitsT>
+    void write_folded(std::basic_ostream<CharT, TraitsT>& os) {
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        stacks_.write(os);
+    }
+
+    /// @brief Writes the aggregated samples to the gzipped pprof profile `file` with a single "cpu" "nanoseconds"
+    /// value per sample, see boost::stacktrace::pprof_writer.
+    ///
+    /// @returns false on I/O errors.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool write_pprof(const char* file, symbolizer_backend backend = symbolizer_backend::default_backend) {
+        boost::stacktrace::pprof_writer writer(file, {pprof_value_type{"cpu", "nanoseconds"}}, backend);
+        writer.set_period(pprof_value_type{"cpu", "nanoseconds"}, static_cast<std::int64_t>(target_period_ns_));
+
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        stacks_.for_each_stack([&writer](const frame* frames, std::size_t size, std::uint64_t weight) {
+            if (size && weight) {
+                const std::int64_t value = static_cast<std::int64_t>(weight) * 1000;
+                writer.add(frames, size, &value);
+            }
+        });
+        return writer.close();
+    }
+
+    /// @brief Drops the aggregated samples. The profiler continues running if it was.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void clear() {
+        std::lock_guard<std::mutex> lock(stacks_mutex_);
+        stacks_.clear();
+        samples_ = 0;
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#undef BOOST_STACKTRACE_DETAIL_CPU_PROFILER_SUPPORTED
+
+#endif // BOOST_STACKTRACE_CPU_PROFILER_HPP
@@ -13,16 +13,22 @@
 #endif
 
 #include <boost/stacktrace/detail/addr_base.hpp>
+#include <boost/stacktrace/detail/location_from_symbol.hpp>
 #include <boost/stacktrace/detail/to_hex_array.hpp>
 #include <boost/stacktrace/detail/to_dec_array.hpp>
 #include <boost/stacktrace/detail/try_dec_convert.hpp>
-#include <boost/core/demangle.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <unistd.h>
 
 
 namespace boost { namespace stacktrace { namespace detail {
@@ -42,12 +48,43 @@ class addr2line_pipe {
     ::FILE* p;
     ::pid_t pid;
 
+    void run(char* prog_name, char* argp[]) noexcept {
+        int pdes[2];
+        if (::pipe(pdes) < 0) {
+            return;
+        }
+
+        pid = ::fork();
+        switch (pid) {
+        case -1:
+            // Failed...
+            ::close(pdes[0]);
+            ::close(pdes[1]);
+            return;
+
+        case 0:
+            // We are the child.
+            ::close(STDERR_FILENO);
+            ::close(pdes[0]);
+            if (pdes[1] != STDOUT_FILENO) {
+                ::dup2(pdes[1], STDOUT_FILENO);
+            }
+
+            // Do not use `execlp()`, `execvp()`, and `execvpe()` here!
+            // `exec*p*` functions are vulnerable to PATH variable evaluation attacks.
+            ::execv(prog_name, argp);
+            ::_exit(127);
+        }
+
+        p = ::fdopen(pdes[0], "r");
+        ::close(pdes[1]);
+    }
+
 public:
     explicit addr2line_pipe(const char *flag, const char* exec_path, const char* addr) noexcept
         : p(0)
         , pid(0)
     {
-        int pdes[2];
         #ifdef BOOST_STACKTRACE_ADDR2LINE_LOCATION
         char prog_name[] = BOOST_STRINGIZE( BOOST_STACKTRACE_ADDR2LINE_LOCATION );
         #if !defined(BOOST_NO_CXX11_CONSTEXPR) && !defined(BOOST_NO_CXX11_STATIC_ASSERT)
@@ -69,34 +106,44 @@ public:
             0
         };
 
-        if (::pipe(pdes) < 0) {
-            return;
-        }
+        run(prog_name, argp);
+    }
 
-        pid = ::fork();
-        switch (pid) {
-        case -1:
-            // Failed...
-            ::close(pdes[0]);
-            ::close(pdes[1]);
-            return;
+    // Resolves multiple addresses with a single addr2line process. Output contains
+    // the results for each of the `addrs` in the same order.
+    addr2line_pipe(const char *flag, const char* exec_path, const char* const* addrs, std::size_t addrs_count) noexcept
+        : p(0)
+        , pid(0)
+    {
+        #ifdef BOOST_STACKTRACE_ADDR2LINE_LOCATION
+        char prog_name[] = BOOST_STRINGIZE( BOOST_STACKTRACE_ADDR2LINE_LOCATION );
+        #if !defined(BOOST_NO_CXX11_CONSTEXPR) && !defined(BOOST_NO_CXX11_STATIC_ASSERT)
+        static_assert(
+            boost::stacktrace::detail::is_abs_path( BOOST_STRINGIZE( BOOST_STACKTRACE_ADDR2LINE_LOCATION ) ),
+            "BOOST_STACKTRACE_ADDR2LINE_LOCATION must be an absolute path"
+        );
+        #endif
 
-        case 0:
-            // We are the child.
-            ::close(STDERR_FILENO);
-            ::close(pdes[0]);
-            if (pdes[1] != STDOUT_FILENO) {
-                ::dup2(pdes[1], STDOUT_FILENO);
+        #else
+        char prog_name[] = "/usr/bin/addr2line";
+        #endif
+
+        try {
+            // Allocating before the fork, as the child must not allocate
+            std::vector<char*> argp;
+            argp.reserve(addrs_count + 4);
+            argp.push_back(prog_name);
+            argp.push_back(const_cast<char*>(flag));
+            argp.push_back(const_cast<char*>(exec_path));
+            for (std::size_t i = 0; i < addrs_count; ++i) {
+                argp.push_back(const_cast<char*>(addrs[i]));
             }
+            argp.push_back(0);
 
-            // Do not use `execlp()`, `execvp()`, and `execvpe()` here!
-            // `exec*p*` functions are vulnerable to PATH variable evaluation attacks.
-            ::execv(prog_name, argp);
-            ::_exit(127);
+            run(prog_name, &argp[0]);
+        } catch (...) {
+            // ignore, the pipe remains empty
         }
-
-        p = ::fdopen(pdes[0], "r");
-        ::close(pdes[1]);
     }
 
     operator ::FILE*() const noexcept {
@@ -113,108 +160,143 @@ public:
     }
 };
 
-inline std::string addr2line(const char* flag, const void* addr) {
-    std::string res;
+// Checks that the addr2line program could be executed
+inline bool addr2line_available() noexcept {
+#ifdef BOOST_STACKTRACE_ADDR2LINE_LOCATION
+    return ::access(BOOST_STRINGIZE( BOOST_STACKTRACE_ADDR2LINE_LOCATION ), X_OK) == 0;
+#else
+    return ::access("/usr/bin/addr2line", X_OK) == 0;
+#endif
+}
+
+// Executable path and load addresses of the modules, reused by all the addr2line invocations of a
+// single to_string() call or of a boost::stacktrace::symbolizer.
+class addr2line_context {
+    std::string exec_path_;
+    std::vector<mapping_entry_t> mappings_;
+    bool mappings_loaded_;
+
+    void load_mappings() {
+        mappings_.clear();
+        std::ifstream maps_file("/proc/self/maps");
+        for (std::string line; std::getline(maps_file, line); ) {
+            const mapping_entry_t mapping = boost::stacktrace::detail::parse_proc_maps_line(line);
+            if (mapping.end) {
+                mappings_.push_back(mapping);
+            }
+        }
+        mappings_loaded_ = true;
+    }
 
-    boost::stacktrace::detail::location_from_symbol loc(addr);
-    // For programs started through $PATH loc.name() is not absolute and
-    // addr2line will fail.
-    if (!loc.empty() && std::strchr(loc.name(), '/') != nullptr) {
-        res = loc.name();
-    } else {
-        res.resize(16);
+    bool find_addr_base(const void* addr, uintptr_t& base) const noexcept {
+        for (const mapping_entry_t& mapping: mappings_) {
+            if (mapping.contains_addr(addr)) {
+                base = mapping.start - mapping.offset_from_base;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::string& exec_path() {
+        if (!exec_path_.empty()) {
+            return exec_path_;
+        }
+
+        std::string res(16, '\0');
         ssize_t rlin_size = ::readlink("/proc/self/exe", &res[0], res.size() - 1);
         while (rlin_size == static_cast<ssize_t>(res.size() - 1)) {
             res.resize(res.size() * 4);
             rlin_size = ::readlink("/proc/self/exe", &res[0], res.size() - 1);
         }
-        if (rlin_size == -1) {
-            res.clear();
-            return res;
+        if (rlin_size != -1) {
+            res.resize(static_cast<std::size_t>(rlin_size));
+            exec_path_.swap(res);
         }
-        res.resize(static_cast<std::size_t>(rlin_size));
+        return exec_path_;
     }
 
-    addr2line_pipe p(flag, res.c_str(), to_hex_array(addr).data());
-    res.clear();
-
-    if (!p) {
-        return res;
-    }
+public:
+    addr2line_context() noexcept
+        : mappings_loaded_(false)
+    {}
+
+    uintptr_t addr_base(const void* addr) {
+        const bool reloaded = !mappings_loaded_;
+        if (reloaded) {
+            load_mappings();
+        }
 
-    char data[32];
-    while (!::feof(p)) {
-        if (::fgets(data, sizeof(data), p)) {
-            res += data;
-        } else {
-            break;
+        uintptr_t base = 0;
+        if (find_addr_base(addr, base)) {
+            return base;
+        }
+        if (!reloaded) {
+            // The module could be loaded after the mappings were read
+            load_mappings();
+            find_addr_base(addr, base);
         }
+        return base;
     }
 
-    // Trimming
-    while (!res.empty() && (res[res.size() - 1] == '\n' || res[res.size() - 1] == '\r')) {
-        res.erase(res.size() - 1);
+    const void* offset(const void* addr, bool position_independent) {
+        const uintptr_t addr_base = (position_independent ? this->addr_base(addr) : 0);
+        return reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(addr) - addr_base);
     }
 
-    return res;
-}
+    std::string addr2line(const char* flag, const void* addr) {
+        std::string res;
 
-inline std::string source_location(const void* addr, bool position_independent) {
-    uintptr_t addr_base = 0;
-    if (position_independent) {
-        addr_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
-    }
-    const void* offset = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) - addr_base);
-    std::string source_line = boost::stacktrace::detail::addr2line("-Cpe", reinterpret_cast<const void*>(offset));
-    if (source_line.empty() || source_line[0] == '?') {
-        return "";
-    }
+        boost::stacktrace::detail::location_from_symbol loc(addr);
+        // For programs started through $PATH loc.name() is not absolute and
+        // addr2line will fail.
+        if (!loc.empty() && std::strchr(loc.name(), '/') != nullptr) {
+            res = loc.name();
+        } else {
+            res = exec_path();
+            if (res.empty()) {
+                return res;
+            }
+        }
 
-    return source_line;
-}
+        addr2line_pipe p(flag, res.c_str(), to_hex_array(addr).data());
+        res.clear();
 
-struct to_string_using_addr2line {
-    std::string res;
-    void prepare_function_name(const void* addr) {
-        res = boost::stacktrace::frame(addr).name();
-    }
+        if (!p) {
+            return res;
+        }
 
-    bool prepare_source_location(const void* addr) {
-        // general idea in all addr2line uses:
-        // in each case:
-        //  - try to resolve whole address as if it was a non-pie binary
-        //  - if that didn't work, try to resolve just an offset from binary base address
-        // this is needed because:
-        //  - in pie binaries just passing an address to addr2line won't work (it needs an offset in this case)
-        //  - in non-pie binaries whole address is needed (offset won't work)
-        //  - there is no easy way to test if binary is position independent (that I know of)
-        std::string source_line = boost::stacktrace::detail::source_location(addr, false);
-        if(source_line.empty()) {
-            source_line = boost::stacktrace::detail::source_location(addr, true);
+        char data[32];
+        while (!::feof(p)) {
+            if (::fgets(data, sizeof(data), p)) {
+                res += data;
+            } else {
+                break;
+            }
         }
 
-        if (!source_line.empty()) {
-            res += " at ";
-            res += source_line;
-            return true;
+        // Trimming
+        while (!res.empty() && (res[res.size() - 1] == '\n' || res[res.size() - 1] == '\r')) {
+            res.erase(res.size() - 1);
         }
 
-        return false;
+        return res;
     }
 };
 
-template <class Base> class to_string_impl_base;
-typedef to_string_impl_base<to_string_using_addr2line> to_string_impl;
-
-inline std::string name(const void* addr, bool position_independent) {
-    uintptr_t addr_base = 0;
-    if(position_independent){
-        addr_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
+inline std::string source_location(addr2line_context& ctx, const void* addr, bool position_independent) {
+    std::string source_line = ctx.addr2line("-Cpe", ctx.offset(addr, position_independent));
+    if (source_line.empty() || source_line[0] == '?') {
+        return "";
     }
-    const void* offset = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) - addr_base);
-    std::string res = boost::stacktrace::detail::addr2line("-fe", offset);
+
+    return source_line;
+}
+
+inline std::string name(addr2line_context& ctx, const void* addr, bool position_independent) {
+    std::string res = ctx.addr2line("-fe", ctx.offset(addr, position_independent));
     res = res.substr(0, res.find_last_of('\n'));
-    res = boost::core::demangle(res.c_str());
+    res = boost::stacktrace::detail::demangle(res.c_str());
 
     if (res == "??") {
         res.clear();
@@ -223,23 +305,8 @@ inline std::string name(const void* addr, bool position_independent) {
     return res;
 }
 
-inline std::string name_impl(const void* addr) {
-    std::string res = boost::stacktrace::detail::name(addr, false);
-    if (res.empty()) {
-        res = boost::stacktrace::detail::name(addr, true);
-    }
-
-    return res;
-}
-
-inline std::string source_file(const void* addr, bool position_independent) {
-    std::string res;
-    uintptr_t addr_base = 0;
-    if(position_independent){
-        addr_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
-    }
-    const void* offset = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) - addr_base);
-    res = boost::stacktrace::detail::addr2line("-e", offset);
+inline std::string source_file(addr2line_context& ctx, const void* addr, bool position_independent) {
+    std::string res = ctx.addr2line("-e", ctx.offset(addr, position_independent));
     res = res.substr(0, res.find_last_of(':'));
     if (res == "??") {
         res.clear();
@@ -248,14 +315,9 @@ inline std::string source_file(const void* addr, bool position_independent) {
     return res;
 }
 
-inline std::size_t source_line(const void* addr, bool position_independent) {
+inline std::size_t source_line(addr2line_context& ctx, const void* addr, bool position_independent) {
     std::size_t line_num = 0;
-    uintptr_t addr_base = 0;
-    if(position_independent){
-        addr_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
-    }
-    const void* offset = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) - addr_base);
-    std::string res = boost::stacktrace::detail::addr2line("-e", offset);
+    std::string res = ctx.addr2line("-e", ctx.offset(addr, position_independent));
     const std::size_t last = res.find_last_of(':');
     if (last == std::string::npos) {
         return 0;
@@ -269,28 +331,86 @@ inline std::size_t source_line(const void* addr, bool position_independent) {
     return line_num;
 }
 
-} // namespace detail
+struct to_string_using_addr2line {
+    std::string res;
+    addr2line_context ctx;
+
+    void prepare_function_name(const void* addr) {
+        const char* exported = boost::stacktrace::detail::exported_symbol_name(addr);
+        if (exported) {
+            res = exported;
+        } else {
+            res = name(addr);
+        }
+    }
+
+    bool prepare_source_location(const void* addr) {
+        // general idea in all addr2line uses:
+        // in each case:
+        //  - try to resolve whole address as if it was a non-pie binary
+        //  - if that didn't work, try to resolve just an offset from binary base address
+        // this is needed because:
+        //  - in pie binaries just passing an address to addr2line won't work (it needs an offset in this case)
+        //  - in non-pie binaries whole address is needed (offset won't work)
+        //  - there is no easy way to test if binary is position independent (that I know of)
+        std::string source_line = boost::stacktrace::detail::source_location(ctx, addr, false);
+        if(source_line.empty()) {
+            source_line = boost::stacktrace::detail::source_location(ctx, addr, true);
+        }
+
+        if (!source_line.empty()) {
+            res += " at ";
+            res += source_line;
+            return true;
+        }
+
+        return false;
+    }
 
+    bool source_location(const void* addr, std::string& file, std::size_t& line) {
+        file = boost::stacktrace::detail::source_location(ctx, addr, false);
+        if (file.empty()) {
+            file = boost::stacktrace::detail::source_location(ctx, addr, true);
+        }
 
-std::string frame::source_file() const {
-    std::string res = boost::stacktrace::detail::source_file(addr_, false);
-    if (res.empty()) {
-        res = boost::stacktrace::detail::source_file(addr_, true);
+        // "file:line" or "file:line (discriminator N)"
+        const std::size_t colon = file.find_last_of(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        line = static_cast<std::size_t>(std::strtoul(file.c_str() + colon + 1, 0, 10));
+        file.resize(colon);
+        return line != 0;
     }
 
-    return res;
-}
+    std::string name(const void* addr) {
+        std::string result = boost::stacktrace::detail::name(ctx, addr, false);
+        if (result.empty()) {
+            result = boost::stacktrace::detail::name(ctx, addr, true);
+        }
 
-std::size_t frame::source_line() const {
-    std::size_t line_num = boost::stacktrace::detail::source_line(addr_, false);
-    if (line_num == 0) {
-        line_num = boost::stacktrace::detail::source_line(addr_, true);
+        return result;
     }
 
-    return line_num;
-}
+    std::string source_file(const void* addr) {
+        std::string result = boost::stacktrace::detail::source_file(ctx, addr, false);
+        if (result.empty()) {
+            result = boost::stacktrace::detail::source_file(ctx, addr, true);
+        }
 
+        return result;
+    }
+
+    std::size_t source_line(const void* addr) {
+        std::size_t line_num = boost::stacktrace::detail::source_line(ctx, addr, false);
+        if (line_num == 0) {
+            line_num = boost::stacktrace::detail::source_line(ctx, addr, true);
+        }
+
+        return line_num;
+    }
+};
 
-}} // namespace boost::stacktrace
+}}} // namespace boost::stacktrace::detail
 
 #endif // BOOST_STACKTRACE_DETAIL_ADDR2LINE_IMPLS_HPP
@@ -0,0 +1,1280 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_DEMANGLE_HPP
+#define BOOST_STACKTRACE_DETAIL_DEMANGLE_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/core/demangle.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifndef BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE
+#   define BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE 1024
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Demangler for the Itanium C++ ABI names that writes into a caller provided buffer. It does not allocate
+// memory and uses a fixed amount of stack, so it is async signal safe. It covers the names that are usually
+// seen in call stacks: nested and local names, templates, lambdas, operators, function and pointer types,
+// substitutions, ABI tags and clone suffixes. For anything else (expressions, arrays, pointers to members, ...)
+// it fails and the caller falls back to the full demangler. The output matches the one of `__cxa_demangle`, the
+// names that it writes in a special way (functions returning pointers to functions, generic lambdas, ...) fail too.
+class itanium_demangler {
+    struct range {
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    // The name is a template and has a return type, and the qualifiers of the function.
+    struct name_info {
+        bool ends_with_template;
+        bool is_ctor_dtor_conversion;
+        char qualifiers_buf[32];    // " const", " volatile", ... in the output order
+        std::size_t qualifiers_size;
+    };
+
+    static BOOST_CONSTEXPR_OR_CONST std::uint32_t invalid = ~static_cast<std::uint32_t>(0);
+    static BOOST_CONSTEXPR_OR_CONST std::size_t max_substitutions = 128;
+    static BOOST_CONSTEXPR_OR_CONST std::size_t max_template_args = 64;
+    static BOOST_CONSTEXPR_OR_CONST unsigned max_depth = 64;
+
+    const char* p_;
+    char* out_;
+    std::size_t size_;
+    std::size_t len_;
+    unsigned depth_;
+    unsigned type_depth_;
+
+    range subs_[max_substitutions];
+    std::size_t subs_count_;
+    range args_[max_template_args];     // stack of the template arguments
+    range arg_packs_[max_template_args];    // [begin, end) in pack_elements_ if the argument is a pack
+    std::size_t args_count_;
+    range pack_elements_[max_template_args];
+    std::size_t pack_elements_count_;
+    range last_pack_;                   // elements of the last parsed template argument
+    std::uint32_t pack_index_;          // element of the pack to write in the pack expansion
+    std::uint32_t pack_size_;           // size of the pack that is expanded
+    std::size_t targs_begin_;           // template arguments of the function, for T_
+    std::size_t targs_count_;
+    range last_name_;                   // last source name, for constructors and destructors
+
+    char peek(std::size_t i = 0) const noexcept {
+        for (std::size_t j = 0; j < i; ++j) {
+            if (!p_[j]) {
+                return '\0';
+            }
+        }
+        return p_[i];
+    }
+
+    bool consume(char c) noexcept {
+        if (*p_ != c) {
+            return false;
+        }
+        ++p_;
+        return true;
+    }
+
+    bool put(const char* s, std::size_t n) noexcept {
+        if (n > size_ - len_) {
+            return false;
+        }
+        std::memcpy(out_ + len_, s, n);
+        len_ += n;
+        return true;
+    }
+
+    bool put(const char* s) noexcept { return put(s, std::strlen(s)); }
+
+    bool put(char c) noexcept { return put(&c, 1); }
+
+    char last() const noexcept { return len_ ? out_[len_ - 1] : '\0'; }
+
+    bool copy(range r) noexcept {
+        if (r.begin == invalid || r.end > len_ || r.begin > r.end) {
+            return false;
+        }
+        // Source is always before the end of the output, so the ranges never overlap
+        if (r.end - r.begin > size_ - len_) {
+            return false;
+        }
+        std::memcpy(out_ + len_, out_ + r.begin, r.end - r.begin);
+        len_ += r.end - r.begin;
+        return true;
+    }
+
+    bool ends_with(const char* s) const noexcept {
+        const std::size_t n = std::strlen(s);
+        return len_ >= n && std::memcmp(out_ + len_ - n, s, n) == 0;
+    }
+
+    bool add_substitution(std::size_t begin) noexcept {
+        if (subs_count_ == max_substitutions) {
+            return false;
+        }
+        subs_[subs_count_].begin = static_cast<std::uint32_t>(begin);
+        subs_[subs_count_].end = static_cast<std::uint32_t>(len_);
+        ++subs_count_;
+        return true;
+    }
+
+    bool add_invalid_substitution() noexcept {
+        if (subs_count_ == max_substitutions) {
+            return false;
+        }
+        subs_[subs_count_].begin = invalid;
+        subs_[subs_count_].end = invalid;
+        ++subs_count_;
+        return true;
+    }
+
+    bool number(std::size_t& n) noexcept {
+        if (*p_ < '0' || *p_ > '9') {
+            return false;
+        }
+        n = 0;
+        while (*p_ >= '0' && *p_ <= '9') {
+            if (n > 100000) {
+                return false;
+            }
+            n = n * 10 + static_cast<std::size_t>(*p_++ - '0');
+        }
+        return true;
+    }
+
+    // <seq-id>_ or _, returns 0 for _ and seq-id + 1 otherwise
+    bool seq_id(std::size_t& n) noexcept {
+        if (consume('_')) {
+            n = 0;
+            return true;
+        }
+        n = 0;
+        for (;;) {
+            const char c = *p_;
+            if (c >= '0' && c <= '9') {
+                n = n * 36 + static_cast<std::size_t>(c - '0');
+            } else if (c >= 'A' && c <= 'Z') {
+                n = n * 36 + static_cast<std::size_t>(c - 'A' + 10);
+            } else {
+                break;
+            }
+            if (n > 100000) {
+                return false;
+            }
+            ++p_;
+        }
+        ++n;
+        return consume('_');
+    }
+
+    // Sets last_name_ to the last component of the text in `r` without the template arguments
+    void set_last_name(range r) noexcept {
+        std::uint32_t end = r.end;
+        if (end > r.begin && out_[end - 1] == '>') {
+            int depth = 0;
+            while (end > r.begin) {
+                --end;
+                if (out_[end] == '>') {
+                    ++depth;
+                } else if (out_[end] == '<' && --depth == 0) {
+                    break;
+                }
+            }
+        }
+        std::uint32_t begin = end;
+        while (begin > r.begin && !(out_[begin - 1] == ':' && begin - 1 > r.begin && out_[begin - 2] == ':')) {
+            --begin;
+        }
+        last_name_.begin = begin;
+        last_name_.end = end;
+    }
+
+    bool source_name() noexcept {
+        std::size_t n = 0;
+        if (!number(n)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!p_[i]) {
+                return false;
+            }
+        }
+
+        const std::size_t begin = len_;
+        static const char anonymous[] = "_GLOBAL__N";
+        if (n >= sizeof(anonymous) - 1 && std::memcmp(p_, anonymous, sizeof(anonymous) - 1) == 0) {
+            if (!put("(anonymous namespace)")) {
+                return false;
+            }
+        } else if (!put(p_, n)) {
+            return false;
+        }
+        p_ += n;
+        last_name_.begin = static_cast<std::uint32_t>(begin);
+        last_name_.end = static_cast<std::uint32_t>(len_);
+        return true;
+    }
+
+    bool abi_tags() noexcept {
+        while (consume('B')) {
+            const range saved = last_name_;
+            if (!put("[abi:") || !source_name() || !put(']')) {
+                return false;
+            }
+            last_name_ = saved;
+        }
+        return true;
+    }
+
+    bool operator_name(name_info& info) noexcept {
+        struct op {
+            char code[3];
+            const char* name;
+        };
+        static const op ops[] = {
+            {"nw", " new"}, {"na", " new[]"}, {"dl", " delete"}, {"da", " delete[]"},
+            {"ps", "+"}, {"ng", "-"}, {"ad", "&"}, {"de", "*"}, {"co", "~"},
+            {"pl", "+"}, {"mi", "-"}, {"ml", "*"}, {"dv", "/"}, {"rm", "%"}, {"an", "&"}, {"or", "|"}, {"eo", "^"},
+            {"aS", "="}, {"pL", "+="}, {"mI", "-="}, {"mL", "*="}, {"dV", "/="}, {"rM", "%="},
+            {"aN", "&="}, {"oR", "|="}, {"eO", "^="}, {"ls", "<<"}, {"rs", ">>"}, {"lS", "<<="}, {"rS", ">>="},
+            {"eq", "=="}, {"ne", "!="}, {"lt", "<"}, {"gt", ">"}, {"le", "<="}, {"ge", ">="}, {"ss", "<=>"},
+            {"nt", "!"}, {"aa", "&&"}, {"oo", "||"}, {"pp", "++"}, {"mm", "--"}, {"cm", ","},
+            {"pm", "->*"}, {"pt", "->"}, {"cl", "()"}, {"ix", "[]"}, {"qu", "?"},
+        };
+
+        const char a = peek(0);
+        const char b = peek(1);
+        if (a == 'c' && b == 'v') {
+            p_ += 2;
+            info.is_ctor_dtor_conversion = true;
+            ++type_depth_;
+            const bool ok = put("operator ") && type();
+            --type_depth_;
+            return ok && peek() != 'I';     // `__cxa_demangle` fails on some templated conversion operators
+        }
+        if (a == 'l' && b == 'i') {
+            p_ += 2;
+            return put("operator\"\" ") && source_name();
+        }
+        for (std::size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+            if (ops[i].code[0] == a && ops[i].code[1] == b) {
+                p_ += 2;
+                return put("operator") && put(ops[i].name);
+            }
+        }
+        return false;
+    }
+
+    // Ul <lambda-sig> E [ <number> ] _  or  Ut [ <number> ] _
+    bool unnamed_type_name() noexcept {
+        const char kind = peek(1);
+        p_ += 2;
+        if (kind == 'l') {
+            // Template parameters of a generic lambda are written as "auto:1", they are not supported
+            const std::size_t saved_targs_count = targs_count_;
+            targs_count_ = 0;
+            if (!put("{lambda(") || !parameters('E') || !consume('E')) {
+                return false;
+            }
+            targs_count_ = saved_targs_count;
+            if (!put(")#")) {
+                return false;
+            }
+        } else if (!put("{unnamed type#")) {
+            return false;
+        }
+
+        std::size_t n = 0;
+        if (*p_ >= '0' && *p_ <= '9') {
+            if (!number(n)) {
+                return false;
+            }
+            n += 1;
+        }
+        if (!consume('_')) {
+            return false;
+        }
+        char digits[24];
+        std::size_t i = sizeof(digits);
+        n += 1;
+        do {
+            digits[--i] = static_cast<char>('0' + n % 10);
+            n /= 10;
+        } while (n);
+        return put(digits + i, sizeof(digits) - i) && put('}');
+    }
+
+    bool unqualified_name(name_info& info) noexcept {
+        const char c = peek();
+        bool ok = false;
+        if (c >= '0' && c <= '9') {
+            ok = source_name();
+        } else if (c == 'L') {
+            // Internal linkage name, may have a discriminator
+            ++p_;
+            ok = source_name() && discriminator();
+        } else if (c == 'C' && peek(1) >= '1' && peek(1) <= '5') {
+            p_ += 2;
+            info.is_ctor_dtor_conversion = true;
+            ok = copy(last_name_);
+        } else if (c == 'D' && (peek(1) == '0' || peek(1) == '1' || peek(1) == '2' || peek(1) == '4' || peek(1) == '5')) {
+            p_ += 2;
+            info.is_ctor_dtor_conversion = true;
+            ok = put('~') && copy(last_name_);
+        } else if (c == 'U' && (peek(1) == 'l' || peek(1) == 't')) {
+            ok = unnamed_type_name();
+        } else if (c >= 'a' && c <= 'z') {
+            ok = operator_name(info);
+        }
+        if (!ok || !abi_tags()) {
+            return false;
+        }
+        info.ends_with_template = false;
+        return true;
+    }
+
+    // _ <digit> | __ <number> _
+    bool discriminator() noexcept {
+        if (peek() != '_') {
+            return true;
+        }
+        if (peek(1) >= '0' && peek(1) <= '9') {
+            p_ += 2;
+            return true;
+        }
+        if (peek(1) == '_') {
+            p_ += 2;
+            std::size_t n = 0;
+            return number(n) && consume('_');
+        }
+        return true;
+    }
+
+    // Standard abbreviations: St, Sa, Sb, Ss, Si, So, Sd. `prefix` is true if a constructor or
+    // a destructor follows, in that case the full names are used.
+    bool standard_substitution(char c, bool prefix) noexcept {
+        struct standard {
+            char code;
+            const char* simple;
+            const char* full;
+            const char* name;
+        };
+        static const standard names[] = {
+            {'a', "std::allocator", "std::allocator", "allocator"},
+            {'b', "std::basic_string", "std::basic_string", "basic_string"},
+            {'s', "std::string", "std::basic_string<char, std::char_traits<char>, std::allocator<char> >", "basic_string"},
+            {'i', "std::istream", "std::basic_istream<char, std::char_traits<char> >", "basic_istream"},
+            {'o', "std::ostream", "std::basic_ostream<char, std::char_traits<char> >", "basic_ostream"},
+            {'d', "std::iostream", "std::basic_iostream<char, std::char_traits<char> >", "basic_iostream"},
+        };
+        for (std::size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+            if (names[i].code != c) {
+                continue;
+            }
+            const char* const text = (prefix ? names[i].full : names[i].simple);
+            const std::size_t begin = len_;
+            if (!put(text)) {
+                return false;
+            }
+            // The name of the constructors is a part of the text
+            last_name_.begin = static_cast<std::uint32_t>(begin + (std::strstr(text, names[i].name) - text));
+            last_name_.end = static_cast<std::uint32_t>(last_name_.begin + std::strlen(names[i].name));
+            return true;
+        }
+        return false;
+    }
+
+    // S_, S<seq-id>_ and the standard abbreviations except St
+    bool substitution(bool prefix) noexcept {
+        if (!consume('S')) {
+            return false;
+        }
+        const char c = peek();
+        if (c >= 'a' && c <= 'z') {
+            ++p_;
+            return standard_substitution(c, prefix);
+        }
+        std::size_t n = 0;
+        if (!seq_id(n) || n >= subs_count_) {
+            return false;
+        }
+        const std::size_t begin = len_;
+        if (!copy(subs_[n])) {
+            return false;
+        }
+        range r;
+        r.begin = static_cast<std::uint32_t>(begin);
+        r.end = static_cast<std::uint32_t>(len_);
+        set_last_name(r);
+        return true;
+    }
+
+    // T_ or T<number>_
+    bool template_param() noexcept {
+        if (!consume('T')) {
+            return false;
+        }
+        std::size_t n = 0;
+        if (!consume('_')) {
+            if (!number(n) || !consume('_')) {
+                return false;
+            }
+            ++n;
+        }
+        if (n >= targs_count_) {
+            return false;
+        }
+        const std::size_t begin = len_;
+        const range pack = arg_packs_[targs_begin_ + n];
+        if (pack_index_ != invalid && pack.begin != invalid) {
+            // Inside of a pack expansion only a single element of the pack is written
+            const std::uint32_t size = pack.end - pack.begin;
+            if (pack_size_ != invalid && pack_size_ != size) {
+                return false;
+            }
+            pack_size_ = size;
+            if (pack_index_ < size && !copy(pack_elements_[pack.begin + pack_index_])) {
+                return false;
+            }
+        } else if (!copy(args_[targs_begin_ + n])) {
+            return false;
+        }
+        range r;
+        r.begin = static_cast<std::uint32_t>(begin);
+        r.end = static_cast<std::uint32_t>(len_);
+        set_last_name(r);
+        return true;
+    }
+
+    // L <type> <value number> E
+    bool literal() noexcept {
+        if (!consume('L')) {
+            return false;
+        }
+        const char kind = peek();
+        const char* suffix = "";
+        switch (kind) {
+        case 'i': ++p_; break;
+        case 'j': ++p_; suffix = "u"; break;
+        case 'l': ++p_; suffix = "l"; break;
+        case 'm': ++p_; suffix = "ul"; break;
+        case 'x': ++p_; suffix = "ll"; break;
+        case 'y': ++p_; suffix = "ull"; break;
+        case 'b':
+            if ((peek(1) == '0' || peek(1) == '1') && peek(2) == 'E') {
+                const bool value = (peek(1) == '1');
+                p_ += 3;
+                return put(value ? "true" : "false");
+            }
+            return false;
+        case 'c': case 'a': case 'h': case 's': case 't': case 'w':
+            if (!put('(') || !builtin_type() || !put(')')) {
+                return false;
+            }
+            break;
+        case 'N':
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+            // Enumeration
+            if (!put('(') || !type() || !put(')')) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+        if (consume('n') && !put('-')) {
+            return false;
+        }
+        const char* const begin = p_;
+        while (*p_ >= '0' && *p_ <= '9') {
+            ++p_;
+        }
+        if (p_ == begin || !put(begin, static_cast<std::size_t>(p_ - begin))) {
+            return false;
+        }
+        return put(suffix) && consume('E');
+    }
+
+    bool template_arg() noexcept {
+        const char c = peek();
+        if (c == 'L') {
+            return literal();
+        }
+        if (c == 'J') {
+            ++p_;
+            range pack;
+            pack.begin = static_cast<std::uint32_t>(pack_elements_count_);
+            bool first = true;
+            while (!consume('E')) {
+                if (!first && !put(", ")) {
+                    return false;
+                }
+                first = false;
+                if (peek() == 'J' || pack_elements_count_ == max_template_args) {
+                    return false;
+                }
+                const std::size_t element_begin = len_;
+                if (!template_arg()) {
+                    return false;
+                }
+                // Template arguments of the element are already dropped, so the elements stay contiguous
+                pack_elements_[pack_elements_count_].begin = static_cast<std::uint32_t>(element_begin);
+                pack_elements_[pack_elements_count_].end = static_cast<std::uint32_t>(len_);
+                ++pack_elements_count_;
+            }
+            pack.end = static_cast<std::uint32_t>(pack_elements_count_);
+            last_pack_ = pack;
+            return true;
+        }
+        ++type_depth_;
+        const bool ok = type();
+        --type_depth_;
+        return ok;
+    }
+
+    // I <template-arg>+ E
+    bool template_args(name_info* info) noexcept {
+        if (!consume('I')) {
+            return false;
+        }
+        if (last() == '<' && !put(' ')) {
+            return false;
+        }
+        if (!put('<')) {
+            return false;
+        }
+        const range saved_name = last_name_;
+        const std::size_t begin = args_count_;
+        const std::size_t packs_begin = pack_elements_count_;
+        std::size_t empty_tail = invalid;
+        while (!consume('E')) {
+            const std::size_t before = len_;
+            if (args_count_ != begin && !put(", ")) {
+                return false;
+            }
+            if (args_count_ == max_template_args) {
+                return false;
+            }
+            const std::size_t arg_begin = len_;
+            last_pack_.begin = invalid;
+            if (!template_arg()) {
+                return false;
+            }
+            if (len_ != arg_begin) {
+                empty_tail = invalid;
+            } else if (empty_tail == invalid) {
+                empty_tail = before;
+            }
+            args_[args_count_].begin = static_cast<std::uint32_t>(arg_begin);
+            args_[args_count_].end = static_cast<std::uint32_t>(len_);
+            arg_packs_[args_count_] = last_pack_;
+            ++args_count_;
+        }
+        // Like `__cxa_demangle`, only the ", " of the trailing empty packs is erased: "<, int>" and "<int>". It
+        // checks the last written character before the erasure.
+        bool erased_pack = false;
+        if (empty_tail != invalid && empty_tail != len_) {
+            len_ = empty_tail;
+            erased_pack = true;
+        }
+        if (last() == '>' && !erased_pack && !put(' ')) {
+            return false;
+        }
+        last_name_ = saved_name;
+        if (info && !type_depth_) {
+            // Arguments of the function or of its class are referenced by T_
+            targs_begin_ = begin;
+            targs_count_ = args_count_ - begin;
+            info->ends_with_template = true;
+        } else {
+            args_count_ = begin;
+            pack_elements_count_ = packs_begin;
+        }
+        return put('>');
+    }
+
+    void add_qualifier(name_info& info, const char* q) noexcept {
+        const std::size_t n = std::strlen(q);
+        if (info.qualifiers_size + n < sizeof(info.qualifiers_buf)) {
+            std::memcpy(info.qualifiers_buf + info.qualifiers_size, q, n);
+            info.qualifiers_size += n;
+        }
+    }
+
+    // N [<CV-qualifiers>] [<ref-qualifier>] <prefix> <unqualified-name> E
+    bool nested_name(name_info& info) noexcept {
+        if (!consume('N')) {
+            return false;
+        }
+        const bool r = consume('r');
+        const bool v = consume('V');
+        const bool k = consume('K');
+        if (k) add_qualifier(info, " const");
+        if (v) add_qualifier(info, " volatile");
+        if (r) add_qualifier(info, " restrict");
+        if (consume('R')) {
+            add_qualifier(info, " &");
+        } else if (consume('O')) {
+            add_qualifier(info, " &&");
+        }
+
+        const std::size_t begin = len_;
+        bool first = true;
+        while (!consume('E')) {
+            const char c = peek();
+            bool is_substitution = false;
+            bool ok = false;
+            if (c == 'I') {
+                if (first) {
+                    return false;
+                }
+                ok = template_args(&info);
+            } else {
+                if (!first && !put("::")) {
+                    return false;
+                }
+                info.ends_with_template = false;
+                if (c == 'S' && peek(1) == 't') {
+                    p_ += 2;
+                    ok = put("std");
+                    is_substitution = true;
+                } else if (c == 'S') {
+                    const char after = peek(2);
+                    ok = substitution(after == 'C' || after == 'D');
+                    is_substitution = true;
+                } else if (c == 'T') {
+                    ok = template_param();
+                } else if (c == 'D' && (peek(1) == 't' || peek(1) == 'T' || peek(1) == 'C')) {
+                    return false;   // decltype and structured bindings
+                } else {
+                    ok = unqualified_name(info);
+                }
+            }
+            if (!ok) {
+                return false;
+            }
+            first = false;
+            if (!is_substitution && peek() != 'E' && !add_substitution(begin)) {
+                return false;
+            }
+        }
+        return !first;
+    }
+
+    // Z <function encoding> E <entity name> [<discriminator>]  or  Z <function encoding> E s [<discriminator>]
+    bool local_name(name_info& info) noexcept {
+        // The enclosing function is parsed as a top level one, even if the local name is a template argument
+        // or a parameter. Its template arguments are referenced by T_ in the entity name only.
+        const unsigned saved_type_depth = type_depth_;
+        const std::size_t saved_subs_count = subs_count_;
+        const std::size_t saved_args_count = args_count_;
+        const std::size_t saved_pack_elements_count = pack_elements_count_;
+        const std::size_t saved_targs_begin = targs_begin_;
+        const std::size_t saved_targs_count = targs_count_;
+        type_depth_ = 0;
+
+        // Return type of the enclosing function is not written
+        if (!consume('Z') || !encoding(false) || !consume('E')) {
+            return false;
+        }
+        bool ok = false;
+        name_info entity = name_info();
+        if (consume('s')) {
+            ok = put("::string literal") && discriminator();
+        } else {
+            ok = put("::") && name(entity) && discriminator();
+        }
+        if (!ok) {
+            return false;
+        }
+
+        type_depth_ = saved_type_depth;
+        if (type_depth_) {
+            // `__cxa_demangle` resolves T_ in the substitutions made here with the arguments of the outer function
+            for (std::size_t i = saved_subs_count; i < subs_count_; ++i) {
+                subs_[i].begin = invalid;
+            }
+            args_count_ = saved_args_count;
+            pack_elements_count_ = saved_pack_elements_count;
+            targs_begin_ = saved_targs_begin;
+            targs_count_ = saved_targs_count;
+        } else {
+            info = entity;
+        }
+        return true;
+    }
+
+    bool name(name_info& info) noexcept {
+        if (++depth_ > max_depth) {
+            return false;
+        }
+        struct depth_guard {
+            unsigned& d;
+            ~depth_guard() { --d; }
+        } guard = {depth_};
+
+        const char c = peek();
+        if (c == 'N') {
+            return nested_name(info);
+        }
+        if (c == 'Z') {
+            return local_name(info);
+        }
+
+        const std::size_t begin = len_;
+        bool is_substitution = false;
+        if (c == 'S' && peek(1) == 't') {
+            p_ += 2;
+            if (!put("std::") || !unqualified_name(info)) {
+                return false;
+            }
+        } else if (c == 'S') {
+            if (!substitution(false) || peek() != 'I') {
+                return false;
+            }
+            is_substitution = true;
+        } else if (!unqualified_name(info)) {
+            return false;
+        }
+
+        if (peek() == 'I') {
+            if (!is_substitution && !add_substitution(begin)) {
+                return false;
+            }
+            return template_args(&info);
+        }
+        return true;
+    }
+
+    bool builtin_type() noexcept {
+        static const char* const names[26] = {
+            "signed char",          // a
+            "bool",                 // b
+            "char",                 // c
+            "double",               // d
+            "long double",          // e
+            "float",                // f
+            "__float128",           // g
+            "unsigned char",        // h
+            "int",                  // i
+            "unsigned int",         // j
+            nullptr,                // k
+            "long",                 // l
+            "unsigned long",        // m
+            "__int128",             // n
+            "unsigned __int128",    // o
+            nullptr,                // p
+            nullptr,                // q
+            nullptr,                // r
+            "short",                // s
+            "unsigned short",       // t
+            nullptr,                // u
+            "void",                 // v
+            "wchar_t",              // w
+            "long long",            // x
+            "unsigned long long",   // y
+            "...",                  // z
+        };
+        const char c = peek();
+        if (c >= 'a' && c <= 'z' && names[c - 'a']) {
+            ++p_;
+            return put(names[c - 'a']);
+        }
+        if (c == 'D') {
+            const char* name = nullptr;
+            switch (peek(1)) {
+            case 'n': name = "decltype(nullptr)"; break;
+            case 'a': name = "auto"; break;
+            case 'c': name = "decltype(auto)"; break;
+            case 'i': name = "char32_t"; break;
+            case 's': name = "char16_t"; break;
+            case 'u': name = "char8_t"; break;
+            default: return false;
+            }
+            p_ += 2;
+            return put(name);
+        }
+        return false;
+    }
+
+    static bool is_builtin(char c, char next) noexcept {
+        if (c == 'D') {
+            return next == 'n' || next == 'a' || next == 'c' || next == 'i' || next == 's' || next == 'u';
+        }
+        return c >= 'a' && c <= 'z' && c != 'k' && c != 'p' && c != 'q' && c != 'r' && c != 'u';
+    }
+
+    // Parameter types up to `terminator`, the end of the name or a clone suffix
+    bool parameters(char terminator) noexcept {
+        if (peek() == 'v' && (peek(1) == terminator || peek(1) == '\0' || peek(1) == '.')) {
+            ++p_;
+            return true;
+        }
+        bool first = true;
+        std::size_t empty_tail = invalid;
+        ++type_depth_;
+        while (peek() != terminator && peek() != '\0' && peek() != '.') {
+            const std::size_t before = len_;
+            if (!first && !put(", ")) {
+                return false;
+            }
+            first = false;
+            const std::size_t begin = len_;
+            if (!type()) {
+                return false;
+            }
+            if (len_ != begin) {
+                empty_tail = invalid;
+            } else if (empty_tail == invalid) {
+                empty_tail = before;
+            }
+        }
+        --type_depth_;
+        if (empty_tail != invalid) {
+            len_ = empty_tail;  // trailing empty pack expansions, the ones in the middle keep their ", "
+        }
+        return true;
+    }
+
+    // F [Y] <return type> <parameter types> E, written as "ret (params)" or as "ret (<decorator>)(params)"
+    bool function_type(const char* decorator) noexcept {
+        if (!consume('F')) {
+            return false;
+        }
+        consume('Y');
+        if (!type() || last() == ')' || !put(" (")) {
+            return false;   // functions returning pointers to functions are written inside out
+        }
+        if (decorator && (!put(decorator) || !put(")("))) {
+            return false;
+        }
+        if (!parameters('E') || !consume('E')) {
+            return false;
+        }
+        return put(')');
+    }
+
+    bool type() noexcept {
+        if (++depth_ > max_depth) {
+            return false;
+        }
+        struct depth_guard {
+            unsigned& d;
+            ~depth_guard() { --d; }
+        } guard = {depth_};
+
+        const std::size_t begin = len_;
+        const char c = peek();
+        if (is_builtin(c, peek(1))) {
+            return builtin_type();
+        }
+
+        switch (c) {
+        case 'r': case 'V': case 'K': {
+            const bool r = consume('r');
+            const bool v = consume('V');
+            const bool k = consume('K');
+            if (peek() == 'F' || ((peek() == 'P' || peek() == 'R' || peek() == 'O') && peek(1) == 'F')) {
+                return false;   // qualifiers are written inside of the function type
+            }
+            if (!type() || last() == ')') {
+                return false;
+            }
+            // Qualifiers of a substituted type are merged: "T const" with `T` being "X const" is "X const"
+            if (ends_with(" volatile") || ends_with(" restrict")) {
+                return false;
+            }
+            if ((k && !ends_with(" const") && !put(" const")) || (v && !put(" volatile")) || (r && !put(" restrict"))) {
+                return false;
+            }
+            return add_substitution(begin);
+        }
+        case 'P': case 'R': case 'O': {
+            ++p_;
+            const char* decorator = (c == 'P' ? "*" : (c == 'R' ? "&" : "&&"));
+            if (peek() == 'F') {
+                // The function type itself is not written as a whole, it could not be substituted
+                if (!function_type(decorator) || !add_invalid_substitution()) {
+                    return false;
+                }
+                return add_substitution(begin);
+            }
+            if (!type() || last() == ')') {
+                return false;   // the decorator goes inside of the function type
+            }
+            if (c != 'P' && last() == '&') {
+                // Reference collapsing: "T&" and "T&&" with `T` being "X&" are "X&", "T&&" with `T` being "X&&" is "X&&"
+                if (c == 'R' && len_ >= 2 && out_[len_ - 2] == '&') {
+                    --len_;
+                }
+                return add_substitution(begin);
+            }
+            return put(decorator) && add_substitution(begin);
+        }
+        case 'F':
+            return function_type(nullptr) && add_substitution(begin);
+        case 'T':
+            if (!template_param() || !add_substitution(begin)) {
+                return false;
+            }
+            if (peek() == 'I') {
+                return template_args(nullptr) && add_substitution(begin);
+            }
+            return true;
+        case 'S':
+            if (peek(1) == 't') {
+                name_info info = name_info();
+                return name(info) && add_substitution(begin);
+            }
+            if (!substitution(false)) {
+                return false;
+            }
+            if (peek() == 'I') {
+                return template_args(nullptr) && add_substitution(begin);
+            }
+            return true;
+        case 'D':
+            if (peek(1) == 'p') {
+                p_ += 2;
+                return pack_expansion() && add_invalid_substitution();
+            }
+            return false;
+        case 'N': case 'Z':
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': {
+            name_info info = name_info();
+            return name(info) && add_substitution(begin);
+        }
+        default:
+            return false;  // arrays, pointers to members, vendor extensions, decltype
+        }
+    }
+
+    // Dp <type>: the pattern is written once for each element of the pack it refers to, separated by ", "
+    bool pack_expansion() noexcept {
+        if (pack_index_ != invalid) {
+            return false;   // nested expansions
+        }
+        const std::size_t begin = len_;
+        const char* const pattern = p_;
+        const std::size_t subs_begin = subs_count_;
+        pack_index_ = 0;
+        pack_size_ = invalid;
+        bool ok = type();
+        const std::size_t subs_end = subs_count_;
+        for (std::uint32_t i = 1; ok && pack_size_ != invalid && i < pack_size_; ++i) {
+            p_ = pattern;
+            pack_index_ = i;
+            ok = put(", ") && type();
+            subs_count_ = subs_end;
+        }
+        if (ok && pack_size_ == 0) {
+            len_ = begin;
+        }
+        pack_index_ = invalid;
+        // Substitutions of the pattern refer to the unexpanded pack, they could not be written
+        for (std::size_t i = subs_begin; i < subs_count_; ++i) {
+            subs_[i].begin = invalid;
+        }
+        return ok;
+    }
+
+    // Drops the output after `size`, the substitutions that refer to it could not be written any more
+    void truncate(std::size_t size) noexcept {
+        for (std::size_t i = 0; i < subs_count_; ++i) {
+            if (subs_[i].begin != invalid && subs_[i].end > size) {
+                subs_[i].begin = invalid;
+            }
+        }
+        len_ = size;
+    }
+
+    // Rotates the output so that [b, m) and [m, e) swap places, and fixes the recorded ranges
+    void rotate(std::size_t b, std::size_t m, std::size_t e) noexcept {
+        std::rotate(out_ + b, out_ + m, out_ + e);
+        const auto fix = [b, m, e](range& r) {
+            if (r.begin == invalid || r.begin < b || r.end > e) {
+                return;
+            }
+            if (r.begin >= m) {
+                r.begin -= static_cast<std::uint32_t>(m - b);
+                r.end -= static_cast<std::uint32_t>(m - b);
+            } else {
+                r.begin += static_cast<std::uint32_t>(e - m);
+                r.end += static_cast<std::uint32_t>(e - m);
+            }
+        };
+        for (std::size_t i = 0; i < subs_count_; ++i) {
+            fix(subs_[i]);
+        }
+        for (std::size_t i = 0; i < args_count_; ++i) {
+            fix(args_[i]);
+        }
+        for (std::size_t i = 0; i < pack_elements_count_; ++i) {
+            fix(pack_elements_[i]);
+        }
+        fix(last_name_);
+    }
+
+    bool special_name() noexcept {
+        const char a = peek(0);
+        const char b = peek(1);
+        const char* prefix = nullptr;
+        bool is_type = true;
+        if (a == 'T') {
+            switch (b) {
+            case 'V': prefix = "vtable for "; break;
+            case 'T': prefix = "VTT for "; break;
+            case 'I': prefix = "typeinfo for "; break;
+            case 'S': prefix = "typeinfo name for "; break;
+            case 'H': prefix = "TLS init function for "; is_type = false; break;
+            case 'W': prefix = "TLS wrapper function for "; is_type = false; break;
+            case 'h': case 'v': {
+                p_ += 2;
+                std::size_t n = 0;
+                consume('n');
+                if (!number(n) || !consume('_')) {
+                    return false;
+                }
+                if (b == 'v') {
+                    consume('n');
+                    if (!number(n) || !consume('_')) {
+                        return false;
+                    }
+                }
+                return put(b == 'h' ? "non-virtual thunk to " : "virtual thunk to ") && encoding();
+            }
+            default: return false;
+            }
+        } else if (a == 'G' && b == 'V') {
+            prefix = "guard variable for ";
+            is_type = false;
+        } else if (a == 'G' && b == 'T' && (peek(2) == 't' || peek(2) == 'n')) {
+            const bool transaction_safe = (peek(2) == 't');
+            p_ += 3;
+            return put(transaction_safe ? "transaction clone for " : "non-transaction clone for ") && encoding();
+        } else {
+            return false;
+        }
+
+        p_ += 2;
+        if (!put(prefix)) {
+            return false;
+        }
+        if (is_type) {
+            ++type_depth_;
+            const bool ok = type();
+            --type_depth_;
+            return ok;
+        }
+        name_info info = name_info();
+        return name(info);
+    }
+
+    bool encoding(bool with_return_type = true) noexcept {
+        if (++depth_ > max_depth) {
+            return false;
+        }
+        struct depth_guard {
+            unsigned& d;
+            ~depth_guard() { --d; }
+        } guard = {depth_};
+
+        if (peek() == 'T' || peek() == 'G') {
+            return special_name();
+        }
+
+        const std::size_t begin = len_;
+        name_info info = name_info();
+        if (!name(info)) {
+            return false;
+        }
+        if (peek() == '\0' || peek() == 'E' || peek() == '.') {
+            return put(info.qualifiers_buf, info.qualifiers_size);    // variable
+        }
+
+        if (info.ends_with_template && !info.is_ctor_dtor_conversion) {
+            const std::size_t middle = len_;
+            ++type_depth_;
+            const bool ok = type();
+            --type_depth_;
+            if (!ok) {
+                return false;
+            }
+            if (with_return_type && last() == ')') {
+                return false;   // the name goes inside of a returned pointer to function: "int (*f<int>())()"
+            }
+            if (with_return_type) {
+                if (!put(' ')) {
+                    return false;
+                }
+                rotate(begin, middle, len_);
+            } else {
+                truncate(middle);
+            }
+        }
+
+        return put('(') && parameters('E') && put(')') && put(info.qualifiers_buf, info.qualifiers_size);
+    }
+
+    // .cold, .constprop.0, .isra.0, ...
+    bool clone_suffixes() noexcept {
+        while (peek() == '.') {
+            const char* const begin = p_;
+            const char c = peek(1);
+            if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) {
+                return false;
+            }
+            p_ += 2;
+            while ((*p_ >= 'a' && *p_ <= 'z') || (*p_ >= '0' && *p_ <= '9') || *p_ == '_') {
+                ++p_;
+            }
+            while (*p_ == '.' && p_[1] >= '0' && p_[1] <= '9') {
+                p_ += 2;
+                while (*p_ >= '0' && *p_ <= '9') {
+                    ++p_;
+                }
+            }
+            if (!put(" [clone ") || !put(begin, static_cast<std::size_t>(p_ - begin)) || !put(']')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    itanium_demangler(const char* mangled, char* out, std::size_t size) noexcept
+        : p_(mangled)
+        , out_(out)
+        , size_(size)
+        , len_(0)
+        , depth_(0)
+        , type_depth_(0)
+        , subs_count_(0)
+        , args_count_(0)
+        , pack_elements_count_(0)
+        , last_pack_()
+        , pack_index_(invalid)
+        , pack_size_(invalid)
+        , targs_begin_(0)
+        , targs_count_(0)
+        , last_name_()
+    {}
+
+    // Returns the length of the demangled name or 0 if the name could not be demangled. The output
+    // is not zero terminated.
+    std::size_t run() noexcept {
+        if (!p_ || p_[0] != '_' || p_[1] != 'Z' || !out_) {
+            return 0;
+        }
+        p_ += 2;
+        if (!encoding() || !clone_suffixes() || *p_ != '\0') {
+            return 0;
+        }
+        return len_;
+    }
+};
+
+// Demangles `mangled` into `out` without memory allocations. Returns the length of the result or 0 if
+// the name is not a supported mangled name or if the result does not fit. Async signal safe.
+inline std::size_t demangle_to(const char* mangled, char* out, std::size_t size) noexcept {
+    return itanium_demangler(mangled, out, size).run();
+}
+
+// Same as boost::core::demangle, but tries the allocation free demangler first.
+inline std::string demangle_uncached(const char* mangled) {
+    if (mangled[0] != '_' || mangled[1] != 'Z') {
+        return mangled;     // C functions and names that are already demangled
+    }
+    char buf[1024];
+    const std::size_t size = boost::stacktrace::detail::demangle_to(mangled, buf, sizeof(buf));
+    if (size) {
+        return std::string(buf, size);
+    }
+    return boost::core::demangle(mangled);
+}
+
+#if BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE
+// Bounded memo of the demangled names. Direct mapped: an entry is replaced by the next name with the same hash.
+class demangle_cache {
+    struct entry {
+        std::string mangled;
+        std::string demangled;
+    };
+
+    std::mutex mutex_;
+    entry entries_[BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE];
+
+public:
+    static demangle_cache& instance() {
+        static demangle_cache cache;
+        return cache;
+    }
+
+    std::string demangle(const char* mangled) {
+        const std::size_t length = std::strlen(mangled);
+        std::size_t h = 14695981039346656037ull & ~static_cast<std::size_t>(0);
+        for (std::size_t i = 0; i < length; ++i) {
+            h = (h ^ static_cast<unsigned char>(mangled[i])) * static_cast<std::size_t>(1099511628211ull);
+        }
+        entry& e = entries_[h % BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE];
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (e.mangled.size() == length && std::memcmp(e.mangled.data(), mangled, length) == 0) {
+                return e.demangled;
+            }
+        }
+
+        std::string res = boost::stacktrace::detail::demangle_uncached(mangled);
+        std::lock_guard<std::mutex> lock(mutex_);
+        e.mangled.assign(mangled, length);
+        e.demangled = res;
+        return res;
+    }
+};
+#endif
+
+// Demangled name, memoized in a process wide table of BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE entries.
+inline std::string demangle(const char* mangled) {
+#if BOOST_STACKTRACE_DEMANGLE_CACHE_SIZE
+    try {
+        return demangle_cache::instance().demangle(mangled);
+    } catch (...) {}
+#endif
+    return boost::stacktrace::detail::demangle_uncached(mangled);
+}
+
+// Replaces the mangled `name` with the demangled one. Reuses the storage of `name` if the allocation free
+// demangler succeeds.
+inline void demangle_in_place(std::string& name) {
+    if (name.size() < 2 || name[0] != '_' || name[1] != 'Z') {
+        return;
+    }
+
+    char buf[1024];
+    const std::size_t size = boost::stacktrace::detail::demangle_to(name.c_str(), buf, sizeof(buf));
+    if (size) {
+        name.assign(buf, size);
+    } else {
+        name = boost::stacktrace::detail::demangle(name.c_str());
+    }
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_DEMANGLE_HPP
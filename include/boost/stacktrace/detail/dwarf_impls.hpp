@@ -0,0 +1,71 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_DWARF_IMPLS_HPP
+#define BOOST_STACKTRACE_DETAIL_DWARF_IMPLS_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/dwarf_line_tables.hpp>
+#include <boost/stacktrace/detail/symbol_index.hpp>
+#include <boost/stacktrace/detail/unwind_base_impls.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+
+#include <string>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Sidecar index if there's one for the module, DWARF of the module otherwise
+inline bool dwarf_backend_location(const void* addr, std::string& file, std::size_t& line) noexcept {
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_INDEX
+    if (boost::stacktrace::detail::symbol_index_location(addr, file, line)) {
+        return true;
+    }
+#endif
+    return boost::stacktrace::detail::dwarf_source_location(addr, file, line);
+}
+
+// Names are looked up in the same way as in the basic implementation, DWARF is used for source locations
+struct to_string_using_dwarf: to_string_using_nothing {
+    bool prepare_source_location(const void* addr) {
+        std::string file;
+        std::size_t line = 0;
+        if (!boost::stacktrace::detail::dwarf_backend_location(addr, file, line)) {
+            return false;
+        }
+
+        res += " at ";
+        res += file;
+        res += ':';
+        res += boost::stacktrace::detail::to_dec_array(line).data();
+        return true;
+    }
+
+    bool source_location(const void* addr, std::string& file, std::size_t& line) const {
+        return boost::stacktrace::detail::dwarf_backend_location(addr, file, line);
+    }
+
+    std::string source_file(const void* addr) const {
+        std::string file;
+        std::size_t line = 0;
+        boost::stacktrace::detail::dwarf_backend_location(addr, file, line);
+        return file;
+    }
+
+    std::size_t source_line(const void* addr) const {
+        std::string file;
+        std::size_t line = 0;
+        boost::stacktrace::detail::dwarf_backend_location(addr, file, line);
+        return line;
+    }
+};
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_DWARF_IMPLS_HPP
@@ -0,0 +1,857 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_DWARF_LINE_TABLES_HPP
+#define BOOST_STACKTRACE_DETAIL_DWARF_LINE_TABLES_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/elf_file.hpp>
+#include <boost/stacktrace/detail/module_table.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef BOOST_STACKTRACE_DWARF_CACHED_UNITS
+/// Count of compilation units per module with decoded line tables that are kept in memory.
+#   define BOOST_STACKTRACE_DWARF_CACHED_UNITS 64
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Values from the DWARF 5 specification, section 7
+enum dwarf_constants : std::uint32_t {
+    dw_tag_compile_unit = 0x11, dw_tag_partial_unit = 0x3c, dw_tag_skeleton_unit = 0x4a,
+
+    dw_at_name = 0x03, dw_at_stmt_list = 0x10, dw_at_low_pc = 0x11, dw_at_high_pc = 0x12,
+    dw_at_comp_dir = 0x1b, dw_at_ranges = 0x55, dw_at_str_offsets_base = 0x72, dw_at_addr_base = 0x73,
+
+    dw_form_addr = 0x01, dw_form_block2 = 0x03, dw_form_block4 = 0x04, dw_form_data2 = 0x05,
+    dw_form_data4 = 0x06, dw_form_data8 = 0x07, dw_form_string = 0x08, dw_form_block = 0x09,
+    dw_form_block1 = 0x0a, dw_form_data1 = 0x0b, dw_form_flag = 0x0c, dw_form_sdata = 0x0d,
+    dw_form_strp = 0x0e, dw_form_udata = 0x0f, dw_form_ref_addr = 0x10, dw_form_ref1 = 0x11,
+    dw_form_ref2 = 0x12, dw_form_ref4 = 0x13, dw_form_ref8 = 0x14, dw_form_ref_udata = 0x15,
+    dw_form_indirect = 0x16, dw_form_sec_offset = 0x17, dw_form_exprloc = 0x18, dw_form_flag_present = 0x19,
+    dw_form_strx = 0x1a, dw_form_addrx = 0x1b, dw_form_ref_sup4 = 0x1c, dw_form_strp_sup = 0x1d,
+    dw_form_data16 = 0x1e, dw_form_line_strp = 0x1f, dw_form_ref_sig8 = 0x20, dw_form_implicit_const = 0x21,
+    dw_form_loclistx = 0x22, dw_form_rnglistx = 0x23, dw_form_ref_sup8 = 0x24, dw_form_strx1 = 0x25,
+    dw_form_strx2 = 0x26, dw_form_strx3 = 0x27, dw_form_strx4 = 0x28, dw_form_addrx1 = 0x29,
+    dw_form_addrx2 = 0x2a, dw_form_addrx3 = 0x2b, dw_form_addrx4 = 0x2c,
+    dw_form_gnu_addr_index = 0x1f01, dw_form_gnu_str_index = 0x1f02, dw_form_gnu_ref_alt = 0x1f20, dw_form_gnu_strp_alt = 0x1f21,
+
+    dw_ut_type = 0x02, dw_ut_skeleton = 0x04, dw_ut_split_compile = 0x05, dw_ut_split_type = 0x06,
+
+    dw_lns_copy = 1, dw_lns_advance_pc = 2, dw_lns_advance_line = 3, dw_lns_set_file = 4,
+    dw_lns_const_add_pc = 8, dw_lns_fixed_advance_pc = 9,
+    dw_lne_end_sequence = 1, dw_lne_set_address = 2, dw_lne_define_file = 3,
+    dw_lnct_path = 1, dw_lnct_directory_index = 2
+};
+
+// Bounds checked reader of the DWARF data. On any out of bounds read it becomes !ok()
+// and returns zeros from that point.
+class dwarf_reader {
+    const char* p_;
+    const char* end_;
+    bool ok_;
+
+    bool require(std::size_t n) noexcept {
+        if (ok_ && static_cast<std::size_t>(end_ - p_) >= n) {
+            return true;
+        }
+        ok_ = false;
+        p_ = end_;
+        return false;
+    }
+
+public:
+    dwarf_reader() noexcept : p_(nullptr), end_(nullptr), ok_(false) {}
+    dwarf_reader(const char* begin, const char* end) noexcept : p_(begin), end_(end), ok_(begin && begin <= end) {}
+
+    bool ok() const noexcept { return ok_; }
+    bool eof() const noexcept { return !ok_ || p_ == end_; }
+    const char* pos() const noexcept { return p_; }
+    std::size_t left() const noexcept { return static_cast<std::size_t>(end_ - p_); }
+
+    void skip(std::uint64_t n) noexcept {
+        if (require(static_cast<std::size_t>(n))) {
+            p_ += n;
+        }
+    }
+
+    std::uint64_t fixed(unsigned size) noexcept {
+        if (!require(size) || size > sizeof(std::uint64_t)) {
+            return 0;
+        }
+        std::uint64_t res = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        for (unsigned i = 0; i < size; ++i) {
+            res = (res << 8) | static_cast<unsigned char>(p_[i]);
+        }
+#else
+        for (unsigned i = size; i > 0; --i) {
+            res = (res << 8) | static_cast<unsigned char>(p_[i - 1]);
+        }
+#endif
+        p_ += size;
+        return res;
+    }
+
+    std::uint8_t u8() noexcept { return static_cast<std::uint8_t>(fixed(1)); }
+    std::uint16_t u16() noexcept { return static_cast<std::uint16_t>(fixed(2)); }
+    std::uint32_t u32() noexcept { return static_cast<std::uint32_t>(fixed(4)); }
+    std::uint64_t u64() noexcept { return fixed(8); }
+    std::uint64_t offset(bool is64) noexcept { return fixed(is64 ? 8 : 4); }
+
+    std::uint64_t uleb() noexcept {
+        std::uint64_t res = 0;
+        unsigned shift = 0;
+        while (require(1)) {
+            const unsigned char b = static_cast<unsigned char>(*p_++);
+            if (shift < 64) {
+                res |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            }
+            shift += 7;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        return res;
+    }
+
+    std::int64_t sleb() noexcept {
+        std::uint64_t res = 0;
+        unsigned shift = 0;
+        unsigned char b = 0;
+        while (require(1)) {
+            b = static_cast<unsigned char>(*p_++);
+            if (shift < 64) {
+                res |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            }
+            shift += 7;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        if (shift < 64 && (b & 0x40)) {
+            res |= ~static_cast<std::uint64_t>(0) << shift;
+        }
+        return static_cast<std::int64_t>(res);
+    }
+
+    const char* cstring() noexcept {
+        const char* const res = p_;
+        const void* const nul = (ok_ ? std::memchr(p_, 0, left()) : nullptr);
+        if (!nul) {
+            require(left() + 1);
+            return "";
+        }
+        p_ = static_cast<const char*>(nul) + 1;
+        return res;
+    }
+
+    // Reads the unit length, returns reader for the rest of the unit
+    dwarf_reader unit(bool& is64) noexcept {
+        std::uint64_t length = u32();
+        is64 = (length == 0xffffffffu);
+        if (is64) {
+            length = u64();
+        }
+        if (!require(static_cast<std::size_t>(length))) {
+            return dwarf_reader();
+        }
+        dwarf_reader res(p_, p_ + length);
+        p_ += length;
+        return res;
+    }
+};
+
+struct dwarf_sections {
+    elf_section info, abbrev, line, aranges, str, line_str, str_offsets, addr;
+};
+
+inline dwarf_sections find_dwarf_sections(const elf_file& file) noexcept {
+    dwarf_sections s;
+    s.info = file.find_section(".debug_info");
+    s.abbrev = file.find_section(".debug_abbrev");
+    s.line = file.find_section(".debug_line");
+    s.aranges = file.find_section(".debug_aranges");
+    s.str = file.find_section(".debug_str");
+    s.line_str = file.find_section(".debug_line_str");
+    s.str_offsets = file.find_section(".debug_str_offsets");
+    s.addr = file.find_section(".debug_addr");
+    return s;
+}
+
+struct dwarf_unit_format {
+    bool is64;
+    unsigned version;
+    unsigned address_size;
+};
+
+struct dwarf_form_value {
+    std::uint64_t u = 0;
+    const char* str = nullptr;
+};
+
+inline bool read_dwarf_form(dwarf_reader& r, std::uint64_t form, const dwarf_unit_format& f, std::int64_t implicit_const, dwarf_form_value& v) noexcept {
+    v = dwarf_form_value();
+    switch (form) {
+    case dw_form_addr:              v.u = r.fixed(f.address_size); break;
+    case dw_form_block2:            r.skip(r.u16()); break;
+    case dw_form_block4:            r.skip(r.u32()); break;
+    case dw_form_block:
+    case dw_form_exprloc:           r.skip(r.uleb()); break;
+    case dw_form_block1:            r.skip(r.u8()); break;
+    case dw_form_data1: case dw_form_ref1: case dw_form_flag: case dw_form_strx1: case dw_form_addrx1:
+                                    v.u = r.u8(); break;
+    case dw_form_data2: case dw_form_ref2: case dw_form_strx2: case dw_form_addrx2:
+                                    v.u = r.u16(); break;
+    case dw_form_strx3: case dw_form_addrx3:
+                                    v.u = r.fixed(3); break;
+    case dw_form_data4: case dw_form_ref4: case dw_form_ref_sup4: case dw_form_strx4: case dw_form_addrx4:
+                                    v.u = r.u32(); break;
+    case dw_form_data8: case dw_form_ref8: case dw_form_ref_sig8: case dw_form_ref_sup8:
+                                    v.u = r.u64(); break;
+    case dw_form_data16:            r.skip(16); break;
+    case dw_form_string:            v.str = r.cstring(); break;
+    case dw_form_sdata:             v.u = static_cast<std::uint64_t>(r.sleb()); break;
+    case dw_form_udata: case dw_form_ref_udata: case dw_form_strx: case dw_form_addrx: case dw_form_loclistx:
+    case dw_form_rnglistx: case dw_form_gnu_addr_index: case dw_form_gnu_str_index:
+                                    v.u = r.uleb(); break;
+    case dw_form_strp: case dw_form_line_strp: case dw_form_sec_offset: case dw_form_strp_sup:
+    case dw_form_gnu_ref_alt: case dw_form_gnu_strp_alt:
+                                    v.u = r.offset(f.is64); break;
+    case dw_form_ref_addr:          v.u = (f.version <= 2 ? r.fixed(f.address_size) : r.offset(f.is64)); break;
+    case dw_form_indirect:          return read_dwarf_form(r, r.uleb(), f, implicit_const, v);
+    case dw_form_flag_present:      v.u = 1; break;
+    case dw_form_implicit_const:    v.u = static_cast<std::uint64_t>(implicit_const); break;
+    default:                        return false;
+    }
+    return r.ok();
+}
+
+inline const char* dwarf_string_at(const elf_section& s, std::uint64_t offset) noexcept {
+    if (!s || offset >= s.size || !std::memchr(s.data + offset, 0, s.size - offset)) {
+        return nullptr;
+    }
+    return s.data + offset;
+}
+
+inline bool is_dwarf_strx_form(std::uint64_t form) noexcept {
+    return form == dw_form_strx || form == dw_form_strx1 || form == dw_form_strx2 || form == dw_form_strx3
+        || form == dw_form_strx4 || form == dw_form_gnu_str_index;
+}
+
+inline bool is_dwarf_addrx_form(std::uint64_t form) noexcept {
+    return form == dw_form_addrx || form == dw_form_addrx1 || form == dw_form_addrx2 || form == dw_form_addrx3
+        || form == dw_form_addrx4 || form == dw_form_gnu_addr_index;
+}
+
+// Attributes of the compilation unit DIE that are required for the line lookups.
+struct dwarf_compile_unit {
+    static constexpr std::uint64_t npos = ~static_cast<std::uint64_t>(0);
+
+    std::uint64_t line_offset = npos;
+    std::string comp_dir;
+    std::uintptr_t low_pc = 0;
+    std::uintptr_t high_pc = 0;     // 0 if the unit has no contiguous range
+    unsigned address_size = sizeof(void*);
+};
+
+// Parses the unit at `offset` in .debug_info. Sets `next` to the offset of the next unit.
+inline bool parse_dwarf_compile_unit(const dwarf_sections& s, std::uint64_t offset, dwarf_compile_unit& cu, std::uint64_t& next) noexcept {
+    next = dwarf_compile_unit::npos;
+    if (offset >= s.info.size) {
+        return false;
+    }
+
+    dwarf_reader outer(s.info.data + offset, s.info.data + s.info.size);
+    dwarf_unit_format f;
+    dwarf_reader r = outer.unit(f.is64);
+    if (!outer.ok()) {
+        return false;
+    }
+    next = static_cast<std::uint64_t>(outer.pos() - s.info.data);
+
+    f.version = r.u16();
+    std::uint64_t abbrev_offset = 0;
+    if (f.version >= 5) {
+        const unsigned unit_type = r.u8();
+        f.address_size = r.u8();
+        abbrev_offset = r.offset(f.is64);
+        if (unit_type == dw_ut_skeleton || unit_type == dw_ut_split_compile) {
+            r.skip(8);              // dwo_id
+        } else if (unit_type == dw_ut_type || unit_type == dw_ut_split_type) {
+            return false;           // type units have no code
+        }
+    } else {
+        abbrev_offset = r.offset(f.is64);
+        f.address_size = r.u8();
+    }
+    if (!r.ok() || f.version < 2 || f.version > 5 || abbrev_offset >= s.abbrev.size) {
+        return false;
+    }
+    cu.address_size = f.address_size;
+
+    // Searching for the abbreviation of the first DIE
+    const std::uint64_t code = r.uleb();
+    dwarf_reader abbrev(s.abbrev.data + abbrev_offset, s.abbrev.data + s.abbrev.size);
+    for (;;) {
+        const std::uint64_t c = abbrev.uleb();
+        if (!c || !abbrev.ok()) {
+            return false;
+        }
+        const std::uint64_t tag = abbrev.uleb();
+        abbrev.u8();    // children
+        if (c == code) {
+            if (tag != dw_tag_compile_unit && tag != dw_tag_partial_unit && tag != dw_tag_skeleton_unit) {
+                return false;
+            }
+            break;
+        }
+        for (;;) {
+            const std::uint64_t name = abbrev.uleb();
+            const std::uint64_t form = abbrev.uleb();
+            if (form == dw_form_implicit_const) {
+                abbrev.sleb();
+            }
+            if ((!name && !form) || !abbrev.ok()) {
+                break;
+            }
+        }
+    }
+
+    dwarf_form_value comp_dir, low_pc, high_pc;
+    std::uint64_t comp_dir_form = 0, low_pc_form = 0, high_pc_form = 0;
+    std::uint64_t str_offsets_base = (f.is64 ? 16 : 8);
+    std::uint64_t addr_base = 8;
+    bool has_ranges = false;
+    for (;;) {
+        const std::uint64_t name = abbrev.uleb();
+        const std::uint64_t form = abbrev.uleb();
+        const std::int64_t implicit_const = (form == dw_form_implicit_const ? abbrev.sleb() : 0);
+        if ((!name && !form) || !abbrev.ok()) {
+            break;
+        }
+
+        dwarf_form_value v;
+        if (!read_dwarf_form(r, form, f, implicit_const, v)) {
+            return false;
+        }
+        switch (name) {
+        case dw_at_stmt_list:           cu.line_offset = v.u; break;
+        case dw_at_comp_dir:            comp_dir = v; comp_dir_form = form; break;
+        case dw_at_low_pc:              low_pc = v; low_pc_form = form; break;
+        case dw_at_high_pc:             high_pc = v; high_pc_form = form; break;
+        case dw_at_ranges:              has_ranges = true; break;
+        case dw_at_str_offsets_base:    str_offsets_base = v.u; break;
+        case dw_at_addr_base:           addr_base = v.u; break;
+        default: break;
+        }
+    }
+
+    // Forms that reference other sections are resolved after all the attributes are read,
+    // because the bases may follow the attributes that use them.
+    const auto resolve_string = [&](const dwarf_form_value& v, std::uint64_t form) -> const char* {
+        if (v.str) {
+            return v.str;
+        } else if (form == dw_form_strp) {
+            return dwarf_string_at(s.str, v.u);
+        } else if (form == dw_form_line_strp) {
+            return dwarf_string_at(s.line_str, v.u);
+        } else if (is_dwarf_strx_form(form)) {
+            const std::uint64_t pos = str_offsets_base + v.u * (f.is64 ? 8 : 4);
+            if (pos >= s.str_offsets.size) {
+                return nullptr;
+            }
+            dwarf_reader str_offset(s.str_offsets.data + pos, s.str_offsets.data + s.str_offsets.size);
+            return dwarf_string_at(s.str, str_offset.offset(f.is64));
+        }
+        return nullptr;
+    };
+    const auto resolve_address = [&](const dwarf_form_value& v, std::uint64_t form) -> std::uint64_t {
+        if (!is_dwarf_addrx_form(form)) {
+            return v.u;
+        }
+        const std::uint64_t pos = addr_base + v.u * f.address_size;
+        if (pos >= s.addr.size) {
+            return 0;
+        }
+        dwarf_reader addr(s.addr.data + pos, s.addr.data + s.addr.size);
+        return addr.fixed(f.address_size);
+    };
+
+    const char* dir = resolve_string(comp_dir, comp_dir_form);
+    if (dir) {
+        cu.comp_dir = dir;
+    }
+    if (low_pc_form && high_pc_form && !has_ranges) {
+        cu.low_pc = static_cast<std::uintptr_t>(resolve_address(low_pc, low_pc_form));
+        const bool high_is_address = (high_pc_form == dw_form_addr || is_dwarf_addrx_form(high_pc_form));
+        cu.high_pc = static_cast<std::uintptr_t>(high_is_address ? resolve_address(high_pc, high_pc_form) : cu.low_pc + high_pc.u);
+        if (cu.high_pc <= cu.low_pc) {
+            cu.low_pc = cu.high_pc = 0;
+        }
+    }
+    return true;
+}
+
+struct dwarf_line_row {
+    static constexpr std::uint32_t end_sequence = ~static_cast<std::uint32_t>(0);
+
+    std::uintptr_t addr;
+    std::uint32_t file;     // end_sequence for the rows that mark the end of a sequence
+    std::uint32_t line;
+};
+
+// Decoded line number program of a single compilation unit, rows are sorted by address.
+struct dwarf_line_table {
+    std::vector<std::string> files;
+    std::vector<dwarf_line_row> rows;
+
+    bool find(std::uintptr_t addr, std::string& file, std::size_t& line) const {
+        auto it = std::upper_bound(rows.begin(), rows.end(), addr, [](std::uintptr_t a, const dwarf_line_row& row) {
+            return a < row.addr;
+        });
+        if (it == rows.begin()) {
+            return false;
+        }
+        --it;
+        if (it->file == dwarf_line_row::end_sequence || !it->line || it->file >= files.size() || files[it->file].empty()) {
+            return false;
+        }
+        file = files[it->file];
+        line = it->line;
+        return true;
+    }
+};
+
+inline std::string join_dwarf_path(const std::string& dir, const char* name) {
+    if (!*name) {
+        return dir;
+    }
+    if (name[0] == '/' || dir.empty()) {
+        return name;
+    }
+    std::string res = dir;
+    if (res[res.size() - 1] != '/') {
+        res += '/';
+    }
+    res += name;
+    return res;
+}
+
+// Reads the DWARF 5 directory or file name entries of the line program header.
+inline bool read_dwarf_line_entries(dwarf_reader& r, const dwarf_sections& s, const dwarf_unit_format& f,
+        const std::vector<std::string>& dirs, std::vector<std::string>& out)
+{
+    const unsigned formats_count = r.u8();
+    std::vector<std::pair<std::uint64_t, std::uint64_t> > formats;
+    for (unsigned i = 0; i < formats_count && r.ok(); ++i) {
+        const std::uint64_t content = r.uleb();
+        const std::uint64_t form = r.uleb();
+        formats.push_back(std::make_pair(content, form));
+    }
+
+    const std::uint64_t count = r.uleb();
+    for (std::uint64_t i = 0; i < count && r.ok(); ++i) {
+        const char* path = "";
+        std::uint64_t dir_index = 0;
+        for (std::size_t j = 0; j < formats.size(); ++j) {
+            dwarf_form_value v;
+            if (!read_dwarf_form(r, formats[j].second, f, 0, v)) {
+                return false;
+            }
+            if (formats[j].first == dw_lnct_path) {
+                const char* str = v.str;
+                if (formats[j].second == dw_form_line_strp) {
+                    str = dwarf_string_at(s.line_str, v.u);
+                } else if (formats[j].second == dw_form_strp) {
+                    str = dwarf_string_at(s.str, v.u);
+                }
+                path = (str ? str : "");
+            } else if (formats[j].first == dw_lnct_directory_index) {
+                dir_index = v.u;
+            }
+        }
+
+        if (&dirs == &out) {
+            // Directories other than the first one are relative to the first one
+            out.push_back(out.empty() ? std::string(path) : join_dwarf_path(out[0], path));
+        } else {
+            out.push_back(join_dwarf_path(dir_index < dirs.size() ? dirs[dir_index] : std::string(), path));
+        }
+    }
+    return r.ok();
+}
+
+inline bool decode_dwarf_line_table(const dwarf_sections& s, const dwarf_compile_unit& cu, dwarf_line_table& out) {
+    if (cu.line_offset >= s.line.size) {
+        return false;
+    }
+
+    dwarf_reader outer(s.line.data + cu.line_offset, s.line.data + s.line.size);
+    dwarf_unit_format f;
+    dwarf_reader r = outer.unit(f.is64);
+    f.version = r.u16();
+    f.address_size = cu.address_size;
+    if (!r.ok() || f.version < 2 || f.version > 5) {
+        return false;
+    }
+    if (f.version >= 5) {
+        f.address_size = r.u8();
+        r.u8();     // segment_selector_size
+    }
+
+    const std::uint64_t header_length = r.offset(f.is64);
+    if (header_length > r.left()) {
+        return false;
+    }
+    dwarf_reader program(r.pos() + header_length, r.pos() + r.left());
+
+    const unsigned min_inst_length = r.u8();
+    if (f.version >= 4) {
+        r.u8();     // maximum_operations_per_instruction, VLIW is not supported
+    }
+    const bool default_is_stmt = !!r.u8();
+    (void)default_is_stmt;
+    const int line_base = static_cast<std::int8_t>(r.u8());
+    const unsigned line_range = r.u8();
+    const unsigned opcode_base = r.u8();
+    if (!line_range || !opcode_base) {
+        return false;
+    }
+    std::vector<unsigned> opcode_lengths(opcode_base, 0);
+    for (unsigned i = 1; i < opcode_base; ++i) {
+        opcode_lengths[i] = r.u8();
+    }
+
+    std::vector<std::string> dirs;
+    if (f.version >= 5) {
+        if (!read_dwarf_line_entries(r, s, f, dirs, dirs) || !read_dwarf_line_entries(r, s, f, dirs, out.files)) {
+            return false;
+        }
+        if (!dirs.empty() && !dirs[0].empty() && dirs[0][0] != '/') {
+            dirs[0] = join_dwarf_path(cu.comp_dir, dirs[0].c_str());
+        }
+    } else {
+        dirs.push_back(cu.comp_dir);
+        for (;;) {
+            const char* dir = r.cstring();
+            if (!*dir || !r.ok()) {
+                break;
+            }
+            dirs.push_back(join_dwarf_path(cu.comp_dir, dir));
+        }
+
+        out.files.push_back(std::string());  // file indexes start from 1
+        for (;;) {
+            const char* name = r.cstring();
+            if (!*name || !r.ok()) {
+                break;
+            }
+            const std::uint64_t dir_index = r.uleb();
+            r.uleb();   // modification time
+            r.uleb();   // file length
+            out.files.push_back(join_dwarf_path(dir_index < dirs.size() ? dirs[dir_index] : std::string(), name));
+        }
+    }
+    if (!r.ok()) {
+        return false;
+    }
+
+    // Line number program state machine
+    std::uintptr_t address = 0;
+    std::uint32_t file = 1;
+    std::int64_t line = 1;
+    const auto emit = [&](bool end_of_sequence) {
+        dwarf_line_row row;
+        row.addr = address;
+        row.file = (end_of_sequence ? dwarf_line_row::end_sequence : file);
+        row.line = static_cast<std::uint32_t>(line);
+        out.rows.push_back(row);
+    };
+    const auto reset = [&]() {
+        address = 0;
+        file = 1;
+        line = 1;
+    };
+
+    while (!program.eof()) {
+        const unsigned opcode = program.u8();
+        if (opcode >= opcode_base) {
+            const unsigned adjusted = opcode - opcode_base;
+            address += (adjusted / line_range) * min_inst_length;
+            line += line_base + static_cast<int>(adjusted % line_range);
+            emit(false);
+            continue;
+        }
+
+        switch (opcode) {
+        case 0: {
+            const std::uint64_t len = program.uleb();
+            if (!len || len > program.left()) {
+                return false;
+            }
+            dwarf_reader ext(program.pos(), program.pos() + len);
+            program.skip(len);
+            switch (ext.u8()) {
+            case dw_lne_end_sequence:
+                emit(true);
+                reset();
+                break;
+            case dw_lne_set_address:
+                address = static_cast<std::uintptr_t>(ext.fixed(static_cast<unsigned>(len - 1)));
+                break;
+            case dw_lne_define_file: {
+                const char* name = ext.cstring();
+                const std::uint64_t dir_index = ext.uleb();
+                out.files.push_back(join_dwarf_path(dir_index < dirs.size() ? dirs[dir_index] : std::string(), name));
+                break;
+            }
+            default:
+                break;
+            }
+            break;
+        }
+        case dw_lns_copy:               emit(false); break;
+        case dw_lns_advance_pc:         address += static_cast<std::uintptr_t>(program.uleb() * min_inst_length); break;
+        case dw_lns_advance_line:       line += program.sleb(); break;
+        case dw_lns_set_file:           file = static_cast<std::uint32_t>(program.uleb()); break;
+        case dw_lns_const_add_pc:       address += ((255 - opcode_base) / line_range) * min_inst_length; break;
+        case dw_lns_fixed_advance_pc:   address += program.u16(); break;
+        default:
+            // Including the opcodes that only change the flags or column
+            for (unsigned i = 0; i < opcode_lengths[opcode]; ++i) {
+                program.uleb();
+            }
+            break;
+        }
+    }
+
+    // If several rows have the same address the last one wins, except the end of sequence marker
+    // that must not hide the start of the next sequence
+    std::stable_sort(out.rows.begin(), out.rows.end(), [](const dwarf_line_row& lhs, const dwarf_line_row& rhs) {
+        return lhs.addr < rhs.addr || (
+            lhs.addr == rhs.addr && lhs.file == dwarf_line_row::end_sequence && rhs.file != dwarf_line_row::end_sequence
+        );
+    });
+    return true;
+}
+
+// DWARF data of a single module. The index of compilation unit ranges is built on the first lookup,
+// line tables are decoded only for the compilation units that are actually hit and at most
+// BOOST_STACKTRACE_DWARF_CACHED_UNITS of them are kept in memory.
+class dwarf_module {
+    struct unit_range {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+        std::uint64_t unit_offset;
+    };
+
+    struct cached_unit {
+        std::uint64_t unit_offset;
+        std::unique_ptr<dwarf_line_table> table;
+    };
+
+    elf_file file_;
+    dwarf_sections s_;
+    std::vector<unit_range> ranges_;    // sorted by begin
+    bool indexed_ = false;
+    std::vector<cached_unit> cache_;    // most recently used at the back
+
+    void add_ranges_from_aranges(std::vector<std::uint64_t>& covered) {
+        dwarf_reader sets(s_.aranges.data, s_.aranges.data + s_.aranges.size);
+        while (!sets.eof()) {
+            const char* const set_begin = sets.pos();
+            bool is64 = false;
+            dwarf_reader r = sets.unit(is64);
+            if (!sets.ok()) {
+                break;
+            }
+            r.u16();    // version
+            const std::uint64_t unit_offset = r.offset(is64);
+            const unsigned address_size = r.u8();
+            const unsigned segment_size = r.u8();
+            if (!r.ok() || !address_size || address_size > 8 || segment_size) {
+                continue;
+            }
+
+            // Tuples are aligned to the size of a tuple
+            const std::size_t tuple_size = address_size * 2;
+            const std::size_t header_size = static_cast<std::size_t>(r.pos() - set_begin);
+            r.skip((tuple_size - header_size % tuple_size) % tuple_size);
+            while (r.left() >= tuple_size) {
+                const std::uint64_t begin = r.fixed(address_size);
+                const std::uint64_t length = r.fixed(address_size);
+                if (!begin && !length) {
+                    break;
+                }
+                if (length) {
+                    ranges_.push_back(unit_range{
+                        static_cast<std::uintptr_t>(begin), static_cast<std::uintptr_t>(begin + length), unit_offset
+                    });
+                }
+            }
+            covered.push_back(unit_offset);
+        }
+    }
+
+    void build_index() {
+        indexed_ = true;
+
+        std::vector<std::uint64_t> covered;
+        if (s_.aranges) {
+            add_ranges_from_aranges(covered);
+            std::sort(covered.begin(), covered.end());
+        }
+
+        // Units that are not in .debug_aranges (not all the compilers emit it): using the unit
+        // range if it is contiguous, otherwise the ranges of the line program sequences
+        std::uint64_t next = 0;
+        for (std::uint64_t offset = 0; offset < s_.info.size; offset = next) {
+            dwarf_compile_unit cu;
+            const bool ok = parse_dwarf_compile_unit(s_, offset, cu, next);
+            if (next == dwarf_compile_unit::npos) {
+                break;
+            }
+            if (!ok || std::binary_search(covered.begin(), covered.end(), offset)) {
+                continue;
+            }
+
+            if (cu.high_pc) {
+                ranges_.push_back(unit_range{cu.low_pc, cu.high_pc, offset});
+                continue;
+            }
+
+            dwarf_line_table table;
+            if (!decode_dwarf_line_table(s_, cu, table)) {
+                continue;
+            }
+            std::uintptr_t begin = 0;
+            bool in_sequence = false;
+            for (const dwarf_line_row& row: table.rows) {
+                if (row.file == dwarf_line_row::end_sequence) {
+                    if (in_sequence && begin < row.addr) {
+                        ranges_.push_back(unit_range{begin, row.addr, offset});
+                    }
+                    in_sequence = false;
+                } else if (!in_sequence) {
+                    begin = row.addr;
+                    in_sequence = true;
+                }
+            }
+        }
+
+        std::sort(ranges_.begin(), ranges_.end(), [](const unit_range& lhs, const unit_range& rhs) {
+            return lhs.begin < rhs.begin;
+        });
+    }
+
+    const dwarf_line_table* unit_table(std::uint64_t unit_offset) {
+        for (std::size_t i = cache_.size(); i > 0; --i) {
+            if (cache_[i - 1].unit_offset == unit_offset) {
+                std::rotate(cache_.begin() + static_cast<std::ptrdiff_t>(i - 1), cache_.begin() + static_cast<std::ptrdiff_t>(i), cache_.end());
+                return cache_.back().table.get();
+            }
+        }
+
+        dwarf_compile_unit cu;
+        std::uint64_t next;
+        std::unique_ptr<dwarf_line_table> table(new dwarf_line_table());
+        if (!parse_dwarf_compile_unit(s_, unit_offset, cu, next) || !decode_dwarf_line_table(s_, cu, *table)) {
+            table.reset(new dwarf_line_table());    // caching the failure too
+        }
+
+        if (cache_.size() >= BOOST_STACKTRACE_DWARF_CACHED_UNITS) {
+            cache_.erase(cache_.begin());
+        }
+        cache_.push_back(cached_unit{unit_offset, std::move(table)});
+        return cache_.back().table.get();
+    }
+
+public:
+    explicit dwarf_module(const std::string& path)
+        : file_(boost::stacktrace::detail::open_debug_file(path, ".debug_line"))
+        , s_(boost::stacktrace::detail::find_dwarf_sections(file_))
+    {}
+
+    // `addr` is the address in the module file, i.e. the runtime address minus the load bias.
+    bool find(std::uintptr_t addr, std::string& file, std::size_t& line) {
+        if (!s_.info || !s_.abbrev || !s_.line) {
+            return false;
+        }
+        if (!indexed_) {
+            build_index();
+        }
+
+        auto it = std::upper_bound(ranges_.begin(), ranges_.end(), addr, [](std::uintptr_t a, const unit_range& r) {
+            return a < r.begin;
+        });
+        while (it != ranges_.begin()) {
+            --it;
+            if (addr < it->end) {
+                const dwarf_line_table* table = unit_table(it->unit_offset);
+                if (table->find(addr, file, line)) {
+                    return true;
+                }
+            }
+            if (addr - it->begin > (static_cast<std::uintptr_t>(1) << 24)) {
+                break;  // there's no reason to look further than a few overlapping units
+            }
+        }
+        return false;
+    }
+};
+
+// Process wide cache of the opened modules.
+class dwarf_modules {
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<dwarf_module> > modules_;
+
+public:
+    static dwarf_modules& instance() {
+        static dwarf_modules modules;
+        return modules;
+    }
+
+    bool find(const void* addr, std::string& file, std::size_t& line) {
+        const std::shared_ptr<const module_table> table = module_table::current();
+        const module_info* m = table->find(addr);
+        if (!m || m->name.empty()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<dwarf_module>& dwarf = modules_[m->name];
+        if (!dwarf) {
+            dwarf.reset(new dwarf_module(m->name));
+        }
+        return dwarf->find(reinterpret_cast<std::uintptr_t>(addr) - m->load_bias, file, line);
+    }
+};
+
+inline bool dwarf_source_location(const void* addr, std::string& file, std::size_t& line) noexcept {
+    try {
+        return addr && dwarf_modules::instance().find(addr, file, line);
+    } catch (...) {
+        return false;
+    }
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_DWARF_LINE_TABLES_HPP
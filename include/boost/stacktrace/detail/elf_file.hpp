@@ -0,0 +1,325 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_ELF_FILE_HPP
+#define BOOST_STACKTRACE_DETAIL_ELF_FILE_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <elf.h>
+#include <link.h>           // ElfW
+#include <fcntl.h>          // ::open
+#include <sys/mman.h>       // ::mmap
+#include <sys/stat.h>       // ::fstat
+#include <unistd.h>         // ::close
+
+namespace boost { namespace stacktrace { namespace detail {
+
+struct elf_section {
+    const char* data = nullptr;
+    std::size_t size = 0;
+    std::uintptr_t addr = 0;    // address of the section in the module, 0 for non allocated sections
+    std::uint32_t link = 0;     // index of the associated section, for example string table for the .symtab
+
+    explicit operator bool() const noexcept { return !!data; }
+};
+
+// Read only memory mapping of an ELF file of the native class and byte order. Only the
+// pages that are actually touched are read by the kernel, so mapping a file with
+// big debug sections is cheap.
+class elf_file {
+    const char* data_;
+    std::size_t size_;
+
+    const ElfW(Ehdr)& header() const noexcept {
+        return *reinterpret_cast<const ElfW(Ehdr)*>(data_);
+    }
+
+    const ElfW(Shdr)* section_header(std::size_t i) const noexcept {
+        const ElfW(Ehdr)& h = header();
+        const std::size_t offset = static_cast<std::size_t>(h.e_shoff) + i * sizeof(ElfW(Shdr));
+        if (h.e_shentsize != sizeof(ElfW(Shdr)) || offset + sizeof(ElfW(Shdr)) > size_ || offset < h.e_shoff) {
+            return nullptr;
+        }
+        return reinterpret_cast<const ElfW(Shdr)*>(data_ + offset);
+    }
+
+    std::size_t sections_count() const noexcept {
+        const ElfW(Ehdr)& h = header();
+        if (h.e_shnum || !h.e_shoff) {
+            return h.e_shnum;
+        }
+
+        // More than SHN_LORESERVE sections, real count is in the first section header
+        const ElfW(Shdr)* first = section_header(0);
+        return first ? static_cast<std::size_t>(first->sh_size) : 0;
+    }
+
+    std::size_t names_section_index() const noexcept {
+        const ElfW(Ehdr)& h = header();
+        if (h.e_shstrndx != SHN_XINDEX) {
+            return h.e_shstrndx;
+        }
+        const ElfW(Shdr)* first = section_header(0);
+        return first ? static_cast<std::size_t>(first->sh_link) : 0;
+    }
+
+    bool valid() const noexcept {
+        if (size_ < sizeof(ElfW(Ehdr)) || std::memcmp(data_, ELFMAG, SELFMAG) != 0) {
+            return false;
+        }
+
+        const ElfW(Ehdr)& h = header();
+        const unsigned char native_class = (sizeof(ElfW(Addr)) == 8 ? ELFCLASS64 : ELFCLASS32);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        const unsigned char native_data = ELFDATA2MSB;
+#else
+        const unsigned char native_data = ELFDATA2LSB;
+#endif
+        return h.e_ident[EI_CLASS] == native_class && h.e_ident[EI_DATA] == native_data;
+    }
+
+    elf_file(const elf_file&) = delete;
+    elf_file& operator=(const elf_file&) = delete;
+
+public:
+    elf_file() noexcept
+        : data_(nullptr)
+        , size_(0)
+    {}
+
+    explicit elf_file(const char* path) noexcept
+        : data_(nullptr)
+        , size_(0)
+    {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const char*>(p);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+
+        if (data_ && !valid()) {
+            reset();
+        }
+    }
+
+    elf_file(elf_file&& other) noexcept
+        : data_(other.data_)
+        , size_(other.size_)
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    elf_file& operator=(elf_file&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~elf_file() noexcept {
+        reset();
+    }
+
+    void reset() noexcept {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    explicit operator bool() const noexcept { return !!data_; }
+
+    // Returns an empty section if there's no such section, or if it has no data in the file,
+    // or if it is compressed.
+    elf_section section(std::size_t index) const noexcept {
+        elf_section res;
+        const ElfW(Shdr)* sh = (data_ ? section_header(index) : nullptr);
+        if (!sh || sh->sh_type == SHT_NOBITS || (sh->sh_flags & SHF_COMPRESSED)) {
+            return res;
+        }
+
+        const std::size_t offset = static_cast<std::size_t>(sh->sh_offset);
+        const std::size_t size = static_cast<std::size_t>(sh->sh_size);
+        if (offset > size_ || size > size_ - offset) {
+            return res;
+        }
+
+        res.data = data_ + offset;
+        res.size = size;
+        res.addr = static_cast<std::uintptr_t>(sh->sh_addr);
+        res.link = sh->sh_link;
+        return res;
+    }
+
+    elf_section find_section(const char* name) const noexcept {
+        if (!data_) {
+            return elf_section();
+        }
+
+        const elf_section names = section(names_section_index());
+        if (!names) {
+            return elf_section();
+        }
+
+        const std::size_t name_len = std::strlen(name);
+        const std::size_t count = sections_count();
+        for (std::size_t i = 0; i < count; ++i) {
+            const ElfW(Shdr)* sh = section_header(i);
+            if (!sh) {
+                break;
+            }
+            if (sh->sh_name + name_len < names.size && std::memcmp(names.data + sh->sh_name, name, name_len + 1) == 0) {
+                return section(i);
+            }
+        }
+        return elf_section();
+    }
+
+    elf_section find_section_by_type(std::uint32_t type) const noexcept {
+        const std::size_t count = (data_ ? sections_count() : 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            const ElfW(Shdr)* sh = section_header(i);
+            if (!sh) {
+                break;
+            }
+            if (sh->sh_type == type) {
+                return section(i);
+            }
+        }
+        return elf_section();
+    }
+
+    // Address ranges of the sections with code. Works for the separate debug files too, where those
+    // sections have no data.
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t> > code_ranges() const {
+        std::vector<std::pair<std::uintptr_t, std::uintptr_t> > res;
+        const std::size_t count = (data_ ? sections_count() : 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            const ElfW(Shdr)* sh = section_header(i);
+            if (!sh) {
+                break;
+            }
+            if ((sh->sh_flags & SHF_ALLOC) && (sh->sh_flags & SHF_EXECINSTR) && sh->sh_size) {
+                const std::uintptr_t begin = static_cast<std::uintptr_t>(sh->sh_addr);
+                res.push_back(std::make_pair(begin, begin + static_cast<std::uintptr_t>(sh->sh_size)));
+            }
+        }
+        return res;
+    }
+
+    // Raw bytes of the NT_GNU_BUILD_ID note, empty if there's no such note.
+    std::string build_id() const {
+        const elf_section notes = find_section(".note.gnu.build-id");
+        const char* note = notes.data;
+        const char* const end = notes.data + notes.size;
+        while (note && note + sizeof(ElfW(Nhdr)) <= end) {
+            ElfW(Nhdr) hdr;
+            std::memcpy(&hdr, note, sizeof(hdr));
+            const char* const name = note + sizeof(hdr);
+            const char* const desc = name + ((hdr.n_namesz + 3) & ~3u);
+            const char* const next = desc + ((hdr.n_descsz + 3) & ~3u);
+            if (next > end) {
+                break;
+            }
+            if (hdr.n_type == NT_GNU_BUILD_ID && hdr.n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                return std::string(desc, hdr.n_descsz);
+            }
+            note = next;
+        }
+        return std::string();
+    }
+
+    // File name from the .gnu_debuglink section, empty if there's no such section.
+    std::string debuglink() const {
+        const elf_section link = find_section(".gnu_debuglink");
+        if (!link) {
+            return std::string();
+        }
+        return std::string(link.data, ::strnlen(link.data, link.size));
+    }
+};
+
+// Opens the file with the debug information for the module at `path`: the module itself if it has
+// `required_section`, otherwise the separate debug file found by build-id or by .gnu_debuglink
+// in the same places as GDB looks for them.
+inline elf_file open_debug_file(const std::string& path, const char* required_section) {
+    elf_file module(path.c_str());
+    if (!module || module.find_section(required_section)) {
+        return module;
+    }
+
+    static const char debug_dir[] = "/usr/lib/debug";
+    const std::string build_id = module.build_id();
+    if (build_id.size() > 1) {
+        static const char hex[] = "0123456789abcdef";
+        std::string name = debug_dir;
+        name += "/.build-id/";
+        for (std::size_t i = 0; i < build_id.size(); ++i) {
+            name += hex[static_cast<unsigned char>(build_id[i]) >> 4];
+            name += hex[static_cast<unsigned char>(build_id[i]) & 0xF];
+            if (i == 0) {
+                name += '/';
+            }
+        }
+        name += ".debug";
+
+        elf_file debug(name.c_str());
+        if (debug.find_section(required_section)) {
+            return debug;
+        }
+    }
+
+    const std::string link = module.debuglink();
+    if (!link.empty()) {
+        const std::string dir = path.substr(0, path.rfind('/') + 1);
+        const std::string candidates[] = {
+            dir + link,
+            dir + ".debug/" + link,
+            debug_dir + dir + link,
+        };
+        for (const std::string& name: candidates) {
+            if (name == path) {
+                continue;
+            }
+            elf_file debug(name.c_str());
+            if (debug.find_section(required_section)) {
+                return debug;
+            }
+        }
+    }
+
+    return module;
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_ELF_FILE_HPP
@@ -0,0 +1,211 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_ELF_SYMTAB_HPP
+#define BOOST_STACKTRACE_DETAIL_ELF_SYMTAB_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/module_table.hpp>
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_ELF_SYMTAB)
+#   define BOOST_STACKTRACE_DETAIL_HAS_ELF_SYMTAB
+
+#include <boost/stacktrace/detail/elf_file.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Function symbols of a single module sorted by address. Built once from the .symtab of the
+// module or of its separate debug file, or from the .dynsym if the module is stripped.
+// Names are not copied, they point into the memory mapped string table.
+class elf_symbol_index {
+    struct entry {
+        std::uintptr_t addr;
+        std::uint32_t size;
+        std::uint32_t name;     // offset in the string table
+    };
+
+    static constexpr unsigned stt_gnu_ifunc = 10;   // not defined in some of the <elf.h>
+
+    elf_file file_;
+    elf_section names_;
+    std::vector<entry> entries_;
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t> > code_;
+
+    static int binding_rank(unsigned char info) noexcept {
+        // ST_BIND is the same for both ELF classes
+        switch (ELF32_ST_BIND(info)) {
+        case STB_GLOBAL: return 0;
+        case STB_WEAK:   return 1;
+        default:         return 2;
+        }
+    }
+
+    bool load(const elf_section& symbols) {
+        if (!symbols || symbols.size % sizeof(ElfW(Sym)) != 0) {
+            return false;
+        }
+        names_ = file_.section(symbols.link);
+        if (!names_) {
+            return false;
+        }
+
+        const std::size_t count = symbols.size / sizeof(ElfW(Sym));
+        std::vector<std::pair<entry, int> > found;
+        for (std::size_t i = 0; i < count; ++i) {
+            ElfW(Sym) sym;
+            std::memcpy(&sym, symbols.data + i * sizeof(sym), sizeof(sym));
+
+            const unsigned type = ELF32_ST_TYPE(sym.st_info);
+            if ((type != STT_FUNC && type != stt_gnu_ifunc) || sym.st_shndx == SHN_UNDEF
+                || !sym.st_value || !sym.st_name || sym.st_name >= names_.size || sym.st_size > 0xffffffffu)
+            {
+                continue;
+            }
+
+            entry e;
+            e.addr = static_cast<std::uintptr_t>(sym.st_value);
+            e.size = static_cast<std::uint32_t>(sym.st_size);
+            e.name = static_cast<std::uint32_t>(sym.st_name);
+            found.push_back(std::make_pair(e, binding_rank(sym.st_info)));
+        }
+
+        // For aliases prefer global names over the local ones
+        std::sort(found.begin(), found.end(), [](const std::pair<entry, int>& lhs, const std::pair<entry, int>& rhs) {
+            return lhs.first.addr < rhs.first.addr || (lhs.first.addr == rhs.first.addr && lhs.second < rhs.second);
+        });
+        entries_.reserve(found.size());
+        for (std::size_t i = 0; i < found.size(); ++i) {
+            if (entries_.empty() || entries_.back().addr != found[i].first.addr) {
+                entries_.push_back(found[i].first);
+            }
+        }
+        return !entries_.empty();
+    }
+
+public:
+    explicit elf_symbol_index(const std::string& path)
+        : file_(boost::stacktrace::detail::open_debug_file(path, ".symtab"))
+    {
+        if (!load(file_.find_section_by_type(SHT_SYMTAB))) {
+            entries_.clear();
+            load(file_.find_section_by_type(SHT_DYNSYM));
+        }
+        code_ = file_.code_ranges();
+    }
+
+    const std::vector<std::pair<std::uintptr_t, std::uintptr_t> >& code_ranges() const noexcept {
+        return code_;
+    }
+
+    // Calls `visitor(begin, end, mangled_name)` for each function in the order of addresses. Symbols
+    // without size end at the next symbol or at the end of their section with code.
+    template <class Visitor>
+    void visit(Visitor visitor) const {
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const entry& e = entries_[i];
+            std::uintptr_t end = e.addr + e.size;
+            if (!e.size) {
+                for (std::size_t j = 0; j < code_.size(); ++j) {
+                    if (code_[j].first <= e.addr && e.addr < code_[j].second) {
+                        end = code_[j].second;
+                    }
+                }
+                if (i + 1 < entries_.size()) {
+                    end = (std::min)(end, entries_[i + 1].addr);
+                }
+            }
+            if (end > e.addr) {
+                visitor(e.addr, end, names_.data + e.name);
+            }
+        }
+    }
+
+    // Returns the mangled name of the function containing `addr`, or nullptr. `addr` is the address in the
+    // module file, i.e. the runtime address minus the load bias.
+    const char* find(std::uintptr_t addr) const noexcept {
+        auto it = std::upper_bound(entries_.begin(), entries_.end(), addr, [](std::uintptr_t a, const entry& e) {
+            return a < e.addr;
+        });
+        if (it == entries_.begin()) {
+            return nullptr;
+        }
+        --it;
+
+        if (it->size) {
+            return (addr - it->addr < it->size ? names_.data + it->name : nullptr);
+        }
+
+        // Symbols without size (hand written assembly, _init, _fini) match up to the next
+        // symbol within the same section with code
+        for (std::size_t i = 0; i < code_.size(); ++i) {
+            if (code_[i].first <= it->addr && it->addr < code_[i].second) {
+                return (addr < code_[i].second ? names_.data + it->name : nullptr);
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Process wide cache of the symbol indexes, one per loaded module.
+class elf_symbol_indexes {
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<elf_symbol_index> > indexes_;
+
+public:
+    static elf_symbol_indexes& instance() {
+        static elf_symbol_indexes indexes;
+        return indexes;
+    }
+
+    std::string find(const void* addr) {
+        const std::shared_ptr<const module_table> table = module_table::current();
+        const module_info* m = table->find(addr);
+        if (!m || m->name.empty()) {
+            return std::string();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<elf_symbol_index>& index = indexes_[m->name];
+        if (!index) {
+            index.reset(new elf_symbol_index(m->name));
+        }
+        const char* name = index->find(reinterpret_cast<std::uintptr_t>(addr) - m->load_bias);
+        return name ? std::string(name) : std::string();
+    }
+};
+
+// Demangled name of the function containing `addr` from the ELF symbol tables, works for the
+// functions that are not exported.
+inline std::string elf_symtab_name(const void* addr) {
+    try {
+        if (!addr) {
+            return std::string();
+        }
+        const std::string name = elf_symbol_indexes::instance().find(addr);
+        return name.empty() ? name : boost::stacktrace::detail::demangle(name.c_str());
+    } catch (...) {
+        return std::string();
+    }
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_ELF_SYMTAB)
+
+#endif // BOOST_STACKTRACE_DETAIL_ELF_SYMTAB_HPP
@@ -143,6 +143,73 @@ public:
 
 namespace detail {
     BOOST_STACKTRACE_FUNCTION std::string to_string(const frame* frames, std::size_t size);
+
+    // Receiver of the formatted text. Plain function pointer, as it crosses the shared library boundary.
+    struct text_sink {
+        void (*write)(void* context, const char* data, std::size_t size);
+        void* context;
+    };
+
+    // Same output as of to_string(frames, size), each line is passed to the `sink` as soon as it is formatted
+    BOOST_STACKTRACE_FUNCTION void to_string(const frame* frames, std::size_t size, text_sink sink);
+
+    // Same output as of boost::stacktrace::to_string(f)
+    BOOST_STACKTRACE_FUNCTION void to_string(const frame& f, text_sink sink);
+
+    // JSON array of the frames, see <boost/stacktrace/json.hpp>. Each frame is passed to the `sink` as soon as it is formatted
+    BOOST_STACKTRACE_FUNCTION void to_json(const frame* frames, std::size_t size, text_sink sink);
+
+    // JSON object of the frame, see <boost/stacktrace/json.hpp>
+    BOOST_STACKTRACE_FUNCTION void to_json(const frame& f, text_sink sink);
+
+    inline void append_to_string_sink(void* context, const char* data, std::size_t size) {
+        static_cast<std::string*>(context)->append(data, size);
+    }
+
+    inline text_sink make_text_sink(std::string& out) noexcept {
+        const text_sink sink = {&boost::stacktrace::detail::append_to_string_sink, &out};
+        return sink;
+    }
+
+    // Fixed size buffer that keeps the count of all the written characters, even of those that did not fit
+    struct chars_buffer {
+        char* data;
+        std::size_t capacity;
+        std::size_t size;
+    };
+
+    inline void append_to_chars_sink(void* context, const char* data, std::size_t size) noexcept {
+        chars_buffer& buf = *static_cast<chars_buffer*>(context);
+        if (buf.size < buf.capacity) {
+            const std::size_t available = buf.capacity - buf.size;
+            std::char_traits<char>::copy(buf.data + buf.size, data, size < available ? size : available);
+        }
+        buf.size += size;
+    }
+
+    // Writes at most `capacity - 1` characters of the output and a terminating zero. Returns the length
+    // of the whole output, as std::snprintf does.
+    template <class Formatter>
+    std::size_t format_to_chars(char* out, std::size_t capacity, Formatter formatter) {
+        chars_buffer buf = {out, capacity ? capacity - 1 : 0, 0};
+        const text_sink sink = {&boost::stacktrace::detail::append_to_chars_sink, &buf};
+        formatter(sink);
+        if (capacity) {
+            out[buf.size < buf.capacity ? buf.size : buf.capacity] = '\0';
+        }
+        return buf.size;
+    }
+
+    template <class CharT, class TraitsT>
+    void append_to_ostream_sink(void* context, const char* data, std::size_t size) {
+        static_cast<std::basic_ostream<CharT, TraitsT>*>(context)->write(data, static_cast<std::streamsize>(size));
+    }
+
+    template <class CharT, class TraitsT>
+    text_sink make_text_sink(std::basic_ostream<CharT, TraitsT>& os) noexcept {
+        const text_sink sink = {&boost::stacktrace::detail::append_to_ostream_sink<CharT, TraitsT>, &os};
+        return sink;
+    }
 } // namespace detail
 
 }} // namespace boost::stacktrace
@@ -13,8 +13,10 @@
 #endif
 
 #include <boost/stacktrace/frame.hpp>
+#include <boost/stacktrace/detail/symbolizer_decl.hpp>
 
-#include <boost/core/demangle.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
+#include <boost/stacktrace/detail/json_writer.hpp>
 #include <boost/core/noncopyable.hpp>
 #include <boost/stacktrace/detail/to_dec_array.hpp>
 #include <boost/stacktrace/detail/to_hex_array.hpp>
@@ -36,6 +38,7 @@
 #include "dbgeng.h"
 
 #include <mutex>
+#include <unordered_map>
 
 #if defined(__clang__) || defined(BOOST_MSVC)
 #   pragma comment(lib, "ole32.lib")
@@ -100,10 +103,10 @@ inline std::string mingw_demangling_workaround(const std::string& s) {
     }
 
     if (s[0] != '_') {
-        return boost::core::demangle(('_' + s).c_str());
+        return boost::stacktrace::detail::demangle(('_' + s).c_str());
     }
 
-    return boost::core::demangle(s.c_str());
+    return boost::stacktrace::detail::demangle(s.c_str());
 #else
     return s;
 #endif
@@ -439,6 +442,83 @@ std::string to_string(const frame* frames, std::size_t size) {
     return res;
 }
 
+void to_string(const frame* frames, std::size_t size, text_sink sink) {
+    boost::stacktrace::detail::debugging_symbols idebug;
+    if (!idebug.is_inited()) {
+        return;
+    }
+
+    std::string line;
+    for (std::size_t i = 0; i < size; ++i) {
+        line.clear();
+        if (i < 10) {
+            line += ' ';
+        }
+        line += boost::stacktrace::detail::to_dec_array(i).data();
+        line += '#';
+        line += ' ';
+        idebug.to_string_impl(frames[i].address(), line);
+        line += '\n';
+        sink.write(sink.context, line.data(), line.size());
+    }
+}
+
+void to_string(const frame& f, text_sink sink) {
+    std::string res;
+
+    boost::stacktrace::detail::debugging_symbols idebug;
+    idebug.to_string_impl(f.address(), res);
+    sink.write(sink.context, res.data(), res.size());
+}
+
+// Appends the JSON object of the frame
+inline void append_json(const debugging_symbols& idebug, std::string& out, bool with_index, std::size_t index, const void* addr) {
+    std::string module_name;
+    const std::string function = idebug.get_name_impl(addr, &module_name);
+    const std::pair<std::string, std::size_t> source_line = idebug.get_source_file_line_impl(addr);
+#ifdef BOOST_STACKTRACE_DISABLE_OFFSET_ADDR_BASE
+    const std::uintptr_t module_base = 0;
+#else
+    const std::uintptr_t module_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
+#endif
+    const boost::stacktrace::detail::json_frame f = {
+        addr,
+        module_name.empty() ? 0 : module_name.c_str(),
+        module_base,
+        &function,
+        &source_line.first,
+        source_line.second
+    };
+    boost::stacktrace::detail::append_json_frame(out, with_index, index, f);
+}
+
+void to_json(const frame* frames, std::size_t size, text_sink sink) {
+    boost::stacktrace::detail::debugging_symbols idebug;
+    std::string out;
+    out += '[';
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i) {
+            out += ',';
+        }
+        boost::stacktrace::detail::append_json(idebug, out, true, i, frames[i].address());
+        sink.write(sink.context, out.data(), out.size());
+        out.clear();
+    }
+    out += ']';
+    sink.write(sink.context, out.data(), out.size());
+}
+
+void to_json(const frame& f, text_sink sink) {
+    std::string out;
+    if (!f) {
+        out = "null";
+    } else {
+        boost::stacktrace::detail::debugging_symbols idebug;
+        boost::stacktrace::detail::append_json(idebug, out, false, 0, f.address());
+    }
+    sink.write(sink.context, out.data(), out.size());
+}
+
 } // namespace detail
 
 std::string frame::name() const {
@@ -465,6 +545,90 @@ std::string to_string(const frame& f) {
     return res;
 }
 
+bool symbolizer_backend_available(symbolizer_backend backend) noexcept {
+    return backend == symbolizer_backend::default_backend || backend == symbolizer_backend::noop;
+}
+
+// The debug engine is shared and protected by a mutex that is held by the debugging_symbols, so it is not kept
+// between the calls. Only the produced descriptions are remembered.
+class symbolizer::impl {
+public:
+    const symbolizer_backend kind;
+    std::unordered_map<frame::native_frame_ptr_t, std::string> lines;
+
+    explicit impl(symbolizer_backend backend)
+        : kind(boost::stacktrace::symbolizer_backend_available(backend) ? backend : symbolizer_backend::default_backend)
+    {}
+};
+
+symbolizer::symbolizer()
+    : impl_(new impl(symbolizer_backend::default_backend))
+{}
+
+symbolizer::symbolizer(symbolizer_backend backend)
+    : impl_(new impl(backend))
+{}
+
+symbolizer::~symbolizer() {
+    delete impl_;
+}
+
+std::string symbolizer::to_string(const frame& f) {
+    if (impl_->kind == symbolizer_backend::noop) {
+        return std::string();
+    }
+
+    const auto it = impl_->lines.find(f.address());
+    if (it != impl_->lines.end()) {
+        return it->second;
+    }
+
+    std::string res = boost::stacktrace::to_string(f);
+    impl_->lines.emplace(f.address(), res);
+    return res;
+}
+
+std::string symbolizer::to_string(const frame* frames, std::size_t size) {
+    std::string res;
+    if (impl_->kind == symbolizer_backend::noop) {
+        return res;
+    }
+
+    res.reserve(64 * size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i < 10) {
+            res += ' ';
+        }
+        res += boost::stacktrace::detail::to_dec_array(i).data();
+        res += '#';
+        res += ' ';
+        res += this->to_string(frames[i]);
+        res += '\n';
+    }
+
+    return res;
+}
+
+std::string symbolizer::name(const frame& f) {
+    return impl_->kind == symbolizer_backend::noop ? std::string() : f.name();
+}
+
+std::string symbolizer::source_file(const frame& f) {
+    return impl_->kind == symbolizer_backend::noop ? std::string() : f.source_file();
+}
+
+std::size_t symbolizer::source_line(const frame& f) {
+    return impl_->kind == symbolizer_backend::noop ? 0 : f.source_line();
+}
+
+void symbolizer::clear() {
+    impl_->lines.clear();
+}
+
+symbolizer_backend symbolizer::backend() const noexcept {
+    return impl_->kind;
+}
+
 }} // namespace boost::stacktrace
 
 #endif // BOOST_STACKTRACE_DETAIL_FRAME_MSVC_IPP
@@ -13,6 +13,8 @@
 #endif
 
 #include <boost/stacktrace/frame.hpp>
+#include <boost/stacktrace/detail/symbolizer_decl.hpp>
+#include <boost/stacktrace/detail/json_writer.hpp>
 
 namespace boost { namespace stacktrace { namespace detail {
 
@@ -20,6 +22,37 @@ std::string to_string(const frame* /*frames*/, std::size_t /*count*/) {
     return std::string();
 }
 
+void to_string(const frame* /*frames*/, std::size_t /*count*/, text_sink /*sink*/) {}
+
+void to_string(const frame& /*f*/, text_sink /*sink*/) {}
+
+void to_json(const frame* frames, std::size_t size, text_sink sink) {
+    static const std::string no_information;
+    std::string out;
+    out += '[';
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i) {
+            out += ',';
+        }
+        const boost::stacktrace::detail::json_frame f = {frames[i].address(), 0, 0, &no_information, &no_information, 0};
+        boost::stacktrace::detail::append_json_frame(out, true, i, f);
+    }
+    out += ']';
+    sink.write(sink.context, out.data(), out.size());
+}
+
+void to_json(const frame& f, text_sink sink) {
+    static const std::string no_information;
+    std::string out;
+    if (!f) {
+        out = "null";
+    } else {
+        const boost::stacktrace::detail::json_frame info = {f.address(), 0, 0, &no_information, &no_information, 0};
+        boost::stacktrace::detail::append_json_frame(out, false, 0, info);
+    }
+    sink.write(sink.context, out.data(), out.size());
+}
+
 } // namespace detail
 
 std::string frame::name() const {
@@ -38,6 +71,46 @@ std::string to_string(const frame& /*f*/) {
     return std::string();
 }
 
+bool symbolizer_backend_available(symbolizer_backend backend) noexcept {
+    return backend == symbolizer_backend::default_backend || backend == symbolizer_backend::noop;
+}
+
+symbolizer::symbolizer()
+    : impl_(nullptr)
+{}
+
+symbolizer::symbolizer(symbolizer_backend /*backend*/)
+    : impl_(nullptr)
+{}
+
+symbolizer::~symbolizer() {}
+
+std::string symbolizer::to_string(const frame& /*f*/) {
+    return std::string();
+}
+
+std::string symbolizer::to_string(const frame* /*frames*/, std::size_t /*size*/) {
+    return std::string();
+}
+
+std::string symbolizer::name(const frame& /*f*/) {
+    return std::string();
+}
+
+std::string symbolizer::source_file(const frame& /*f*/) {
+    return std::string();
+}
+
+std::size_t symbolizer::source_line(const frame& /*f*/) {
+    return 0;
+}
+
+void symbolizer::clear() {}
+
+symbolizer_backend symbolizer::backend() const noexcept {
+    return symbolizer_backend::default_backend;
+}
+
 
 }} // namespace boost::stacktrace
 
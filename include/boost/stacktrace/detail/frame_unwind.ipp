@@ -13,56 +13,193 @@
 #endif
 
 #include <boost/stacktrace/frame.hpp>
+#include <boost/stacktrace/detail/symbolizer_decl.hpp>
 
 #include <boost/stacktrace/detail/to_hex_array.hpp>
 #include <boost/stacktrace/detail/location_from_symbol.hpp>
 #include <boost/stacktrace/detail/to_dec_array.hpp>
 #include <boost/stacktrace/detail/addr_base.hpp>
-#include <boost/core/demangle.hpp>
+#if defined(BOOST_STACKTRACE_ENABLE_SYMBOL_CACHE) || defined(BOOST_STACKTRACE_INTERNAL_BUILD_LIBS)
+#   include <boost/stacktrace/detail/symbol_cache.hpp>
+#endif
+#include <boost/stacktrace/detail/demangle.hpp>
+#include <boost/stacktrace/detail/json_writer.hpp>
 
 #include <cstdio>
+#include <memory>
+#include <unordered_map>
+
+// The libraries have all the implementations that work on the platform available at runtime, the
+// BOOST_STACKTRACE_USE_* macro chooses the default one. Header only translation units get only the default
+// implementation and `basic`, unless BOOST_STACKTRACE_ENABLE_RUNTIME_BACKENDS is defined, as the other
+// implementations take a lot of compilation time.
+#include <boost/stacktrace/detail/unwind_base_impls.hpp>
+
+#if defined(BOOST_STACKTRACE_INTERNAL_BUILD_LIBS) || defined(BOOST_STACKTRACE_ENABLE_RUNTIME_BACKENDS)
+#   define BOOST_STACKTRACE_DETAIL_ALL_BACKENDS
+#endif
+
+#if defined(BOOST_STACKTRACE_USE_DWARF) || (defined(BOOST_STACKTRACE_DETAIL_ALL_BACKENDS) && defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR))
+#   include <boost/stacktrace/detail/dwarf_impls.hpp>
+#   define BOOST_STACKTRACE_DETAIL_HAS_DWARF_BACKEND
+#endif
+
+#if defined(BOOST_STACKTRACE_USE_ADDR2LINE) || (defined(BOOST_STACKTRACE_DETAIL_ALL_BACKENDS) && !defined(BOOST_WINDOWS) && !defined(__CYGWIN__))
+#   include <boost/stacktrace/detail/addr2line_impls.hpp>
+#   define BOOST_STACKTRACE_DETAIL_HAS_ADDR2LINE_BACKEND
+#endif
+
+#undef BOOST_STACKTRACE_DETAIL_ALL_BACKENDS
 
 #ifdef BOOST_STACKTRACE_USE_BACKTRACE
 #   include <boost/stacktrace/detail/libbacktrace_impls.hpp>
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+#ifdef BOOST_STACKTRACE_USE_BACKTRACE
+typedef to_string_using_backtrace default_backend;
 #elif defined(BOOST_STACKTRACE_USE_ADDR2LINE)
-#   include <boost/stacktrace/detail/addr2line_impls.hpp>
+typedef to_string_using_addr2line default_backend;
+#elif defined(BOOST_STACKTRACE_USE_DWARF)
+typedef to_string_using_dwarf default_backend;
 #else
-#   include <boost/stacktrace/detail/unwind_base_impls.hpp>
+typedef to_string_using_nothing default_backend;
 #endif
 
-namespace boost { namespace stacktrace { namespace detail {
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_CACHE
+// Implementation that resolves the frames for the key in the symbol cache
+template <class Base> struct symbol_cache_backend;
+
+template <> struct symbol_cache_backend<to_string_using_nothing> {
+    static constexpr symbolizer_backend value = symbolizer_backend::basic;
+};
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_DWARF_BACKEND
+template <> struct symbol_cache_backend<to_string_using_dwarf> {
+    static constexpr symbolizer_backend value = symbolizer_backend::dwarf;
+};
+#endif
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ADDR2LINE_BACKEND
+template <> struct symbol_cache_backend<to_string_using_addr2line> {
+    static constexpr symbolizer_backend value = symbolizer_backend::addr2line;
+};
+#endif
+#ifdef BOOST_STACKTRACE_USE_BACKTRACE
+template <> struct symbol_cache_backend<to_string_using_backtrace> {
+    static constexpr symbolizer_backend value = symbolizer_backend::backtrace;
+};
+#endif
+
+BOOST_CONSTEXPR_OR_CONST std::uint16_t symbol_cache_has_location = 1;
+#endif // BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_CACHE
 
 template <class Base>
 class to_string_impl_base: private Base {
-public:
-    std::string operator()(boost::stacktrace::detail::native_frame_ptr_t addr) {
+    // Writes the function name and the source location into the Base::res. If the name is unknown, writes the
+    // offset of the frame in its module. Returns false if the location is unknown.
+    bool resolve(boost::stacktrace::detail::native_frame_ptr_t addr) {
         Base::res.clear();
         Base::prepare_function_name(addr);
         if (!Base::res.empty()) {
-            Base::res = boost::core::demangle(Base::res.c_str());
+            boost::stacktrace::detail::demangle_in_place(Base::res);
         } else {
 #ifdef BOOST_STACKTRACE_DISABLE_OFFSET_ADDR_BASE
             Base::res = to_hex_array(addr).data();
 #else
-            const auto addr_base = boost::stacktrace::detail::get_own_proc_addr_base(addr);
+            // Asking the loader first, as reading /proc/self/maps is much slower
+            const void* const module_base = boost::stacktrace::detail::module_base_address(addr);
+            const auto addr_base = module_base
+                ? reinterpret_cast<uintptr_t>(module_base)
+                : boost::stacktrace::detail::get_own_proc_addr_base(addr);
             Base::res = to_hex_array(reinterpret_cast<uintptr_t>(addr) - addr_base).data();
 #endif
         }
 
-        if (Base::prepare_source_location(addr)) {
-            return Base::res;
-        }
+        return Base::prepare_source_location(addr);
+    }
 
+    void append_module_name(boost::stacktrace::detail::native_frame_ptr_t addr) {
         boost::stacktrace::detail::location_from_symbol loc(addr);
         if (!loc.empty()) {
             Base::res += " in ";
             Base::res += loc.name();
         }
+    }
+
+public:
+    // Returns a reference to the internal buffer, that is valid till the next call
+    const std::string& operator()(boost::stacktrace::detail::native_frame_ptr_t addr) {
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_CACHE
+        // The module path is not cached, it is appended on each lookup
+        symbol_cache_file* cache = boost::stacktrace::detail::symbol_cache();
+        symbol_cache_key key;
+        if (cache && boost::stacktrace::detail::make_symbol_cache_key(
+                addr, static_cast<std::uint16_t>(symbol_cache_backend<Base>::value), key))
+        {
+            std::uint16_t flags = 0;
+            if (!cache->find(key, Base::res, flags)) {
+                flags = (resolve(addr) ? symbol_cache_has_location : 0);
+                cache->insert(key, Base::res, flags);
+            }
+            if (!(flags & symbol_cache_has_location)) {
+                append_module_name(addr);
+            }
+            return Base::res;
+        }
+#endif
+        if (!resolve(addr)) {
+            append_module_name(addr);
+        }
+        return Base::res;
+    }
+
+    // Fields for the structured output. Returns the function name, that is valid till the next call.
+    const std::string& describe(boost::stacktrace::detail::native_frame_ptr_t addr, std::string& file, std::size_t& line) {
+        Base::res.clear();
+        Base::prepare_function_name(addr);
+        boost::stacktrace::detail::demangle_in_place(Base::res);
 
+        line = 0;
+        if (!Base::source_location(addr, file, line)) {
+            file.clear();
+            line = 0;
+        }
         return Base::res;
     }
+
+    std::string name(boost::stacktrace::detail::native_frame_ptr_t addr) {
+        return Base::name(addr);
+    }
+
+    std::string source_file(boost::stacktrace::detail::native_frame_ptr_t addr) {
+        return Base::source_file(addr);
+    }
+
+    std::size_t source_line(boost::stacktrace::detail::native_frame_ptr_t addr) {
+        return Base::source_line(addr);
+    }
 };
 
+typedef to_string_impl_base<default_backend> to_string_impl;
+
+// Appends the numbered descriptions of frames to `out`. `flush(out)` is called after each line.
+template <class Impl, class Flush>
+void to_string(Impl& impl, const frame* frames, std::size_t size, std::string& out, Flush flush) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i < 10) {
+            out += ' ';
+        }
+        out += boost::stacktrace::detail::to_dec_array(i).data();
+        out += '#';
+        out += ' ';
+        out += impl(frames[i]);
+        out += '\n';
+        flush(out);
+    }
+}
+
+inline void keep_accumulating(std::string& /*out*/) noexcept {}
+
 std::string to_string(const frame* frames, std::size_t size) {
     std::string res;
     if (size == 0) {
@@ -71,21 +208,164 @@ std::string to_string(const frame* frames, std::size_t size) {
     res.reserve(64 * size);
 
     to_string_impl impl;
+    const auto frame_to_string = [&impl](const frame& f) -> const std::string& {
+        return impl(f.address());
+    };
+    boost::stacktrace::detail::to_string(frame_to_string, frames, size, res, &keep_accumulating);
+    return res;
+}
 
+void to_string(const frame* frames, std::size_t size, text_sink sink) {
+    if (size == 0) {
+        return;
+    }
+
+    to_string_impl impl;
+    const auto frame_to_string = [&impl](const frame& f) -> const std::string& {
+        return impl(f.address());
+    };
+    std::string line;
+    const auto write_line = [&sink](std::string& l) {
+        sink.write(sink.context, l.data(), l.size());
+        l.clear();
+    };
+    boost::stacktrace::detail::to_string(frame_to_string, frames, size, line, write_line);
+}
+
+void to_string(const frame& f, text_sink sink) {
+    if (!f) {
+        return;
+    }
+
+    to_string_impl impl;
+    const std::string& res = impl(f.address());
+    sink.write(sink.context, res.data(), res.size());
+}
+
+// Appends the JSON object of the frame, `file` is a reusable buffer
+inline void append_json(to_string_impl& impl, std::string& out, bool with_index, std::size_t index,
+        native_frame_ptr_t addr, std::string& file)
+{
+    std::size_t line = 0;
+    const std::string& function = impl.describe(addr, file, line);
+    const boost::stacktrace::detail::location_from_symbol loc(addr);
+    const boost::stacktrace::detail::json_frame f = {
+        addr,
+        loc.empty() ? 0 : loc.name(),
+        reinterpret_cast<std::uintptr_t>(boost::stacktrace::detail::module_base_address(addr)),
+        &function,
+        &file,
+        line
+    };
+    boost::stacktrace::detail::append_json_frame(out, with_index, index, f);
+}
+
+void to_json(const frame* frames, std::size_t size, text_sink sink) {
+    to_string_impl impl;
+    std::string out;
+    std::string file;
+
+    out += '[';
     for (std::size_t i = 0; i < size; ++i) {
-        if (i < 10) {
-            res += ' ';
+        if (i) {
+            out += ',';
         }
-        res += boost::stacktrace::detail::to_dec_array(i).data();
-        res += '#';
-        res += ' ';
-        res += impl(frames[i].address());
-        res += '\n';
+        boost::stacktrace::detail::append_json(impl, out, true, i, frames[i].address(), file);
+        sink.write(sink.context, out.data(), out.size());
+        out.clear();
     }
+    out += ']';
+    sink.write(sink.context, out.data(), out.size());
+}
 
-    return res;
+void to_json(const frame& f, text_sink sink) {
+    std::string out;
+    if (!f) {
+        out = "null";
+    } else {
+        to_string_impl impl;
+        std::string file;
+        boost::stacktrace::detail::append_json(impl, out, false, 0, f.address(), file);
+    }
+    sink.write(sink.context, out.data(), out.size());
 }
 
+// Implementation chosen at runtime by boost::stacktrace::symbolizer
+class frame_resolver {
+public:
+    virtual std::string to_string(native_frame_ptr_t addr) = 0;
+    virtual std::string name(native_frame_ptr_t addr) = 0;
+    virtual std::string source_file(native_frame_ptr_t addr) = 0;
+    virtual std::size_t source_line(native_frame_ptr_t addr) = 0;
+    virtual ~frame_resolver() = default;
+};
+
+template <class Base>
+class frame_resolver_using final: public frame_resolver {
+    to_string_impl_base<Base> impl_;
+
+public:
+    std::string to_string(native_frame_ptr_t addr) override {
+        return impl_(addr);
+    }
+
+    std::string name(native_frame_ptr_t addr) override {
+        return impl_.name(addr);
+    }
+
+    std::string source_file(native_frame_ptr_t addr) override {
+        return impl_.source_file(addr);
+    }
+
+    std::size_t source_line(native_frame_ptr_t addr) override {
+        return impl_.source_line(addr);
+    }
+};
+
+class frame_resolver_noop final: public frame_resolver {
+public:
+    std::string to_string(native_frame_ptr_t /*addr*/) override {
+        return std::string();
+    }
+
+    std::string name(native_frame_ptr_t /*addr*/) override {
+        return std::string();
+    }
+
+    std::string source_file(native_frame_ptr_t /*addr*/) override {
+        return std::string();
+    }
+
+    std::size_t source_line(native_frame_ptr_t /*addr*/) override {
+        return 0;
+    }
+};
+
+// Expects an available `backend`
+inline std::unique_ptr<frame_resolver> make_frame_resolver(symbolizer_backend backend) {
+    switch (backend) {
+    case symbolizer_backend::noop:
+        return std::unique_ptr<frame_resolver>(new frame_resolver_noop());
+    case symbolizer_backend::basic:
+        return std::unique_ptr<frame_resolver>(new frame_resolver_using<to_string_using_nothing>());
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_DWARF_BACKEND
+    case symbolizer_backend::dwarf:
+        return std::unique_ptr<frame_resolver>(new frame_resolver_using<to_string_using_dwarf>());
+#endif
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ADDR2LINE_BACKEND
+    case symbolizer_backend::addr2line:
+        return std::unique_ptr<frame_resolver>(new frame_resolver_using<to_string_using_addr2line>());
+#endif
+#ifdef BOOST_STACKTRACE_USE_BACKTRACE
+    case symbolizer_backend::backtrace:
+        return std::unique_ptr<frame_resolver>(new frame_resolver_using<to_string_using_backtrace>());
+#endif
+    default:
+        break;
+    }
+
+    return std::unique_ptr<frame_resolver>(new frame_resolver_using<default_backend>());
+}
 
 } // namespace detail
 
@@ -95,14 +375,20 @@ std::string frame::name() const {
         return std::string();
     }
 
-#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
-    boost::stacktrace::detail::Dl_info dli;
-    const bool dl_ok = !!boost::stacktrace::detail::dladdr(addr_, dli);
-    if (dl_ok && dli.dli_sname) {
-        return boost::core::demangle(dli.dli_sname);
+    const char* exported = boost::stacktrace::detail::exported_symbol_name(addr_);
+    if (exported) {
+        return boost::stacktrace::detail::demangle(exported);
     }
-#endif
-    return boost::stacktrace::detail::name_impl(addr_);
+
+    return boost::stacktrace::detail::default_backend().name(addr_);
+}
+
+std::string frame::source_file() const {
+    return boost::stacktrace::detail::default_backend().source_file(addr_);
+}
+
+std::size_t frame::source_line() const {
+    return boost::stacktrace::detail::default_backend().source_line(addr_);
 }
 
 std::string to_string(const frame& f) {
@@ -114,6 +400,119 @@ std::string to_string(const frame& f) {
     return impl(f.address());
 }
 
+bool symbolizer_backend_available(symbolizer_backend backend) noexcept {
+    switch (backend) {
+    case symbolizer_backend::default_backend:
+    case symbolizer_backend::noop:
+    case symbolizer_backend::basic:
+        return true;
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_DWARF_BACKEND
+    case symbolizer_backend::dwarf:
+        return true;
+#endif
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ADDR2LINE_BACKEND
+    case symbolizer_backend::addr2line:
+        return boost::stacktrace::detail::addr2line_available();
+#endif
+#ifdef BOOST_STACKTRACE_USE_BACKTRACE
+    case symbolizer_backend::backtrace:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+class symbolizer::impl {
+public:
+    const symbolizer_backend kind;
+    const std::unique_ptr<boost::stacktrace::detail::frame_resolver> resolver;
+    std::unordered_map<frame::native_frame_ptr_t, std::string> lines;
+    const std::string no_line;
+
+    explicit impl(symbolizer_backend backend)
+        : kind(boost::stacktrace::symbolizer_backend_available(backend) ? backend : symbolizer_backend::default_backend)
+        , resolver(boost::stacktrace::detail::make_frame_resolver(kind))
+    {}
+
+    const std::string& line(const frame& f) {
+        if (!f) {
+            return no_line;
+        }
+
+        const auto it = lines.find(f.address());
+        if (it != lines.end()) {
+            return it->second;
+        }
+
+        return lines.emplace(f.address(), resolver->to_string(f.address())).first->second;
+    }
+};
+
+symbolizer::symbolizer()
+    : impl_(new impl(symbolizer_backend::default_backend))
+{}
+
+symbolizer::symbolizer(symbolizer_backend backend)
+    : impl_(new impl(backend))
+{}
+
+symbolizer::~symbolizer() {
+    delete impl_;
+}
+
+std::string symbolizer::to_string(const frame& f) {
+    if (!f) {
+        return std::string();
+    }
+
+    return impl_->line(f);
+}
+
+std::string symbolizer::to_string(const frame* frames, std::size_t size) {
+    std::string res;
+    if (impl_->kind == symbolizer_backend::noop || size == 0) {
+        return res;
+    }
+    res.reserve(64 * size);
+
+    const auto frame_to_string = [this](const frame& f) -> const std::string& {
+        return impl_->line(f);
+    };
+    boost::stacktrace::detail::to_string(frame_to_string, frames, size, res, &boost::stacktrace::detail::keep_accumulating);
+    return res;
+}
+
+std::string symbolizer::name(const frame& f) {
+    if (!f || impl_->kind == symbolizer_backend::noop) {
+        return std::string();
+    }
+
+    const char* exported = boost::stacktrace::detail::exported_symbol_name(f.address());
+    if (exported) {
+        return boost::stacktrace::detail::demangle(exported);
+    }
+
+    return impl_->resolver->name(f.address());
+}
+
+std::string symbolizer::source_file(const frame& f) {
+    return impl_->resolver->source_file(f.address());
+}
+
+std::size_t symbolizer::source_line(const frame& f) {
+    return impl_->resolver->source_line(f.address());
+}
+
+void symbolizer::clear() {
+    impl* fresh = new impl(impl_->kind);
+    delete impl_;
+    impl_ = fresh;
+}
+
+symbolizer_backend symbolizer::backend() const noexcept {
+    return impl_->kind;
+}
 
 }} // namespace boost::stacktrace
 
@@ -0,0 +1,323 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_GZIP_WRITER_HPP
+#define BOOST_STACKTRACE_DETAIL_GZIP_WRITER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+inline const std::uint32_t* crc32_table() noexcept {
+    struct table {
+        std::uint32_t values[256];
+
+        table() noexcept {
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                values[i] = c;
+            }
+        }
+    };
+    static const table t;
+    return t.values;
+}
+
+// Streaming gzip (RFC 1951, RFC 1952) compressor into a FILE. Data is encoded as a single deflate block
+// with the fixed Huffman codes, matches are searched in the 32KiB window through the hash chains of
+// 3 byte sequences, as in zlib. Compresses worse than zlib but needs no dependencies, memory usage
+// is constant: about 400KiB.
+class gzip_writer {
+    static constexpr std::size_t window_size = 32 * 1024;
+    static constexpr std::size_t buffer_size = window_size * 3;
+    static constexpr std::size_t min_match = 3;
+    static constexpr std::size_t max_match = 258;
+    static constexpr unsigned hash_bits = 15;
+    static constexpr unsigned max_chain = 64;
+
+    std::FILE* file_;
+    bool ok_;
+    std::uint32_t crc_;
+    std::uint32_t size_;                // size of the input modulo 2^32
+
+    std::vector<unsigned char> input_;  // up to window_size of already encoded data followed by the pending data
+    std::size_t pos_;                   // first not encoded byte in input_
+    std::vector<std::int32_t> head_;    // hash of 3 bytes -> last position in input_, -1 if none
+    std::vector<std::int32_t> prev_;    // position % window_size -> previous position with the same hash, -1 if none
+
+    std::uint64_t bits_;
+    unsigned bits_count_;
+    std::vector<unsigned char> output_;
+
+    gzip_writer(const gzip_writer&) = delete;
+    gzip_writer& operator=(const gzip_writer&) = delete;
+
+    void flush_output() {
+        if (!output_.empty()) {
+            ok_ = ok_ && std::fwrite(&output_[0], 1, output_.size(), file_) == output_.size();
+            output_.clear();
+        }
+    }
+
+    void put_bits(std::uint32_t value, unsigned count) {
+        bits_ |= static_cast<std::uint64_t>(value) << bits_count_;
+        bits_count_ += count;
+        while (bits_count_ >= 8) {
+            output_.push_back(static_cast<unsigned char>(bits_));
+            bits_ >>= 8;
+            bits_count_ -= 8;
+        }
+    }
+
+    // Huffman codes are stored starting from the most significant bit
+    void put_code(std::uint32_t code, unsigned length) {
+        std::uint32_t reversed = 0;
+        for (unsigned i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put_bits(reversed, length);
+    }
+
+    void put_literal(unsigned value) {
+        if (value < 144) {
+            put_code(0x30 + value, 8);
+        } else if (value < 256) {
+            put_code(0x190 + value - 144, 9);
+        } else if (value < 280) {
+            put_code(value - 256, 7);
+        } else {
+            put_code(0xC0 + value - 280, 8);
+        }
+    }
+
+    void put_match(std::size_t length, std::size_t distance) {
+        static const unsigned short length_base[] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        static const unsigned char length_extra[] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        static const unsigned short distance_base[] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+            4097, 6145, 8193, 12289, 16385, 24577
+        };
+        static const unsigned char distance_extra[] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+
+        unsigned l = 28;
+        while (length_base[l] > length) {
+            --l;
+        }
+        put_literal(257 + l);
+        put_bits(static_cast<std::uint32_t>(length - length_base[l]), length_extra[l]);
+
+        unsigned d = 29;
+        while (distance_base[d] > distance) {
+            --d;
+        }
+        put_code(d, 5);
+        put_bits(static_cast<std::uint32_t>(distance - distance_base[d]), distance_extra[d]);
+    }
+
+    std::size_t hash_at(std::size_t pos) const noexcept {
+        const std::uint32_t v = input_[pos] | (input_[pos + 1] << 8) | (static_cast<std::uint32_t>(input_[pos + 2]) << 16);
+        return (v * 2654435761u) >> (32 - hash_bits);
+    }
+
+    // Returns the previous position with the same hash
+    std::int32_t insert(std::size_t pos) noexcept {
+        if (pos + min_match > input_.size()) {
+            return -1;
+        }
+
+        std::int32_t& head = head_[hash_at(pos)];
+        const std::int32_t prev = head;
+        prev_[pos % window_size] = prev;
+        head = static_cast<std::int32_t>(pos);
+        return prev;
+    }
+
+    // Returns the length of the longest match for the data at pos_, sets the `distance` to it
+    std::size_t longest_match(std::int32_t candidate, std::size_t& distance) const noexcept {
+        const std::size_t max_length = (input_.size() - pos_ < max_match ? input_.size() - pos_ : max_match);
+        const unsigned char* const current = &input_[pos_];
+
+        std::size_t best = 0;
+        for (unsigned chain = 0; chain < max_chain && candidate >= 0; ++chain) {
+            const std::size_t c = static_cast<std::size_t>(candidate);
+            if (pos_ - c > window_size) {
+                break;
+            }
+
+            const unsigned char* const data = &input_[c];
+            if (data[best] == current[best]) {
+                std::size_t length = 0;
+                while (length < max_length && data[length] == current[length]) {
+                    ++length;
+                }
+                if (length > best) {
+                    best = length;
+                    distance = pos_ - c;
+                    if (best == max_length) {
+                        break;
+                    }
+                }
+            }
+
+            const std::int32_t next = prev_[c % window_size];
+            if (next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+        return best;
+    }
+
+    // Encodes the pending data, keeping the last max_match bytes for the next call if `final` is false
+    void encode(bool final) {
+        const std::size_t end = input_.size();
+        const std::size_t limit = final ? end : (end > max_match ? end - max_match : 0);
+        while (pos_ < limit) {
+            std::size_t distance = 0;
+            const std::size_t length = longest_match(insert(pos_), distance);
+
+            if (length >= min_match) {
+                put_match(length, distance);
+                for (std::size_t i = 1; i < length; ++i) {
+                    insert(pos_ + i);
+                }
+                pos_ += length;
+            } else {
+                put_literal(input_[pos_]);
+                ++pos_;
+            }
+        }
+
+        if (output_.size() >= window_size) {
+            flush_output();
+        }
+    }
+
+    // Drops the data that is too far to be referenced by matches
+    void slide() {
+        if (pos_ <= window_size) {
+            return;
+        }
+
+        const std::size_t shift = pos_ - window_size;
+        std::memmove(&input_[0], &input_[shift], input_.size() - shift);
+        input_.resize(input_.size() - shift);
+        pos_ -= shift;
+        const std::int32_t s = static_cast<std::int32_t>(shift);
+        for (std::size_t i = 0; i < head_.size(); ++i) {
+            head_[i] = (head_[i] >= s ? head_[i] - s : -1);
+        }
+
+        // Chains are indexed by the position modulo window_size, shifting them along with the positions
+        std::vector<std::int32_t> prev(window_size, -1);
+        for (std::size_t i = 0; i < window_size; ++i) {
+            if (prev_[i] >= s) {
+                prev[(i + window_size - shift % window_size) % window_size] = prev_[i] - s;
+            }
+        }
+        prev_.swap(prev);
+    }
+
+public:
+    // Takes ownership of the `file`, that must be opened for writing in binary mode. `file` may be nullptr.
+    explicit gzip_writer(std::FILE* file)
+        : file_(file)
+        , ok_(file != 0)
+        , crc_(0xFFFFFFFFu)
+        , size_(0)
+        , pos_(0)
+        , head_(std::size_t(1) << hash_bits, -1)
+        , prev_(window_size, -1)
+        , bits_(0)
+        , bits_count_(0)
+    {
+        if (!file_) {
+            return;
+        }
+
+        static const unsigned char header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+        output_.assign(header, header + sizeof(header));
+        put_bits(1, 1); // last block
+        put_bits(1, 2); // fixed Huffman codes
+        input_.reserve(buffer_size);
+    }
+
+    ~gzip_writer() {
+        finish();
+    }
+
+    bool is_open() const noexcept { return file_ != 0; }
+
+    void write(const void* data, std::size_t size) {
+        if (!file_) {
+            return;
+        }
+
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        const std::uint32_t* const table = boost::stacktrace::detail::crc32_table();
+        for (std::size_t i = 0; i < size; ++i) {
+            crc_ = table[(crc_ ^ p[i]) & 0xFF] ^ (crc_ >> 8);
+        }
+        size_ += static_cast<std::uint32_t>(size);
+
+        while (size) {
+            const std::size_t chunk = (buffer_size - input_.size() < size ? buffer_size - input_.size() : size);
+            input_.insert(input_.end(), p, p + chunk);
+            p += chunk;
+            size -= chunk;
+            if (input_.size() == buffer_size) {
+                encode(false);
+                slide();
+            }
+        }
+    }
+
+    // Writes the rest of the data and the gzip trailer, closes the file. Returns false on I/O errors.
+    bool finish() {
+        if (!file_) {
+            return ok_;
+        }
+
+        encode(true);
+        put_literal(256); // end of block
+        if (bits_count_) {
+            put_bits(0, 8 - bits_count_);
+        }
+
+        const std::uint32_t trailer[2] = {crc_ ^ 0xFFFFFFFFu, size_};
+        for (std::size_t i = 0; i < 2; ++i) {
+            for (unsigned shift = 0; shift < 32; shift += 8) {
+                output_.push_back(static_cast<unsigned char>(trailer[i] >> shift));
+            }
+        }
+        flush_output();
+        ok_ = (std::fclose(file_) == 0) && ok_;
+        file_ = 0;
+        return ok_;
+    }
+};
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_GZIP_WRITER_HPP
@@ -0,0 +1,119 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_JSON_WRITER_HPP
+#define BOOST_STACKTRACE_DETAIL_JSON_WRITER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Appends `value` as a JSON string. Bytes above 0x7F are copied as is, names and paths are expected to be UTF-8.
+inline void append_json_string(std::string& out, const char* value, std::size_t size) {
+    static const char hex_digits[] = "0123456789abcdef";
+
+    out += '"';
+    const char* chunk = value;
+    for (const char* it = value; it != value + size; ++it) {
+        const unsigned char c = static_cast<unsigned char>(*it);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(chunk, it);
+        chunk = it + 1;
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex_digits[c >> 4];
+            out += hex_digits[c & 0xF];
+        }
+    }
+    out.append(chunk, value + size);
+    out += '"';
+}
+
+// Appends a JSON string, or null if the `value` is empty
+inline void append_json_string_or_null(std::string& out, const char* value, std::size_t size) {
+    if (size) {
+        boost::stacktrace::detail::append_json_string(out, value, size);
+    } else {
+        out += "null";
+    }
+}
+
+// Information about a frame for the structured output. Pointers are not owning, unknown values are empty or zero.
+struct json_frame {
+    const void* address;
+    const char* module;             // nullptr if unknown
+    std::uintptr_t module_base;     // 0 if unknown
+    const std::string* function;
+    const std::string* file;
+    std::size_t line;
+};
+
+// Appends {"index":N,"address":"0x..","module":..,"offset":"0x..","function":..,"file":..,"line":N}.
+// `index` is omitted if `with_index` is false, unknown values are null.
+inline void append_json_frame(std::string& out, bool with_index, std::size_t index, const json_frame& f) {
+    out += '{';
+    if (with_index) {
+        out += "\"index\":";
+        out += boost::stacktrace::detail::to_dec_array(index).data();
+        out += ',';
+    }
+
+    out += "\"address\":\"";
+    out += boost::stacktrace::detail::to_hex_array(f.address).data();
+
+    out += "\",\"module\":";
+    if (f.module) {
+        boost::stacktrace::detail::append_json_string_or_null(out, f.module, std::strlen(f.module));
+    } else {
+        out += "null";
+    }
+
+    out += ",\"offset\":";
+    if (f.module_base) {
+        out += '"';
+        out += boost::stacktrace::detail::to_hex_array(reinterpret_cast<std::uintptr_t>(f.address) - f.module_base).data();
+        out += '"';
+    } else {
+        out += "null";
+    }
+
+    out += ",\"function\":";
+    boost::stacktrace::detail::append_json_string_or_null(out, f.function->data(), f.function->size());
+    out += ",\"file\":";
+    boost::stacktrace::detail::append_json_string_or_null(out, f.file->data(), f.file->size());
+
+    out += ",\"line\":";
+    if (f.line) {
+        out += boost::stacktrace::detail::to_dec_array(f.line).data();
+    } else {
+        out += "null";
+    }
+    out += '}';
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_JSON_WRITER_HPP
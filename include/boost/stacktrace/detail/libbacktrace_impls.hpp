@@ -15,7 +15,7 @@
 #include <boost/stacktrace/detail/to_hex_array.hpp>
 #include <boost/stacktrace/detail/to_dec_array.hpp>
 #include <boost/stacktrace/detail/location_from_symbol.hpp>
-#include <boost/core/demangle.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
 
 #ifdef BOOST_STACKTRACE_BACKTRACE_INCLUDE_FILE
 #   include BOOST_STACKTRACE_BACKTRACE_INCLUDE_FILE
@@ -121,8 +121,8 @@ struct to_string_using_backtrace {
     std::string filename;
     std::size_t line;
 
-    void prepare_function_name(const void* addr) {
-        boost::stacktrace::detail::pc_data data = {&res, &filename, 0};
+    void query(const void* addr, std::string* function, std::string* file, std::size_t& line_num) const {
+        boost::stacktrace::detail::pc_data data = {function, file, 0};
         if (state) {
             ::backtrace_pcinfo(
                 state,
@@ -132,15 +132,19 @@ struct to_string_using_backtrace {
                 &data
             ) 
             ||
-            ::backtrace_syminfo(
+            (function && ::backtrace_syminfo(
                 state,
                 reinterpret_cast<uintptr_t>(addr),
                 boost::stacktrace::detail::libbacktrace_syminfo_callback,
                 boost::stacktrace::detail::libbacktrace_error_callback,
                 &data
-            );
+            ));
         }
-        line = data.line;
+        line_num = data.line;
+    }
+
+    void prepare_function_name(const void* addr) {
+        query(addr, &res, &filename, line);
     }
 
     bool prepare_source_location(const void* /*addr*/) {
@@ -155,94 +159,52 @@ struct to_string_using_backtrace {
         return true;
     }
 
-    to_string_using_backtrace() noexcept {
-        state = boost::stacktrace::detail::construct_state(prog_location);
-    }
-};
-
-template <class Base> class to_string_impl_base;
-typedef to_string_impl_base<to_string_using_backtrace> to_string_impl;
-
-inline std::string name_impl(const void* addr) {
-    std::string res;
+    // Called after prepare_function_name(addr)
+    bool source_location(const void* /*addr*/, std::string& file, std::size_t& line_num) const {
+        if (filename.empty() || !line) {
+            return false;
+        }
 
-    boost::stacktrace::detail::program_location prog_location;
-    ::backtrace_state* state = boost::stacktrace::detail::construct_state(prog_location);
-
-    boost::stacktrace::detail::pc_data data = {&res, 0, 0};
-    if (state) {
-        ::backtrace_pcinfo(
-            state,
-            reinterpret_cast<uintptr_t>(addr),
-            boost::stacktrace::detail::libbacktrace_full_callback,
-            boost::stacktrace::detail::libbacktrace_error_callback,
-            &data
-        )
-        ||
-        ::backtrace_syminfo(
-            state,
-            reinterpret_cast<uintptr_t>(addr),
-            boost::stacktrace::detail::libbacktrace_syminfo_callback,
-            boost::stacktrace::detail::libbacktrace_error_callback,
-            &data
-        );
-    }
-    if (!res.empty()) {
-        res = boost::core::demangle(res.c_str());
+        file = filename;
+        line_num = line;
+        return true;
     }
 
-    return res;
-}
-
-} // namespace detail
-
-std::string frame::source_file() const {
-    std::string res;
+    std::string name(const void* addr) const {
+        std::string result;
+        std::size_t line_num = 0;
+        query(addr, &result, 0, line_num);
+        if (!result.empty()) {
+            result = boost::stacktrace::detail::demangle(result.c_str());
+        }
 
-    if (!addr_) {
-        return res;
+        return result;
     }
 
-    boost::stacktrace::detail::program_location prog_location;
-    ::backtrace_state* state = boost::stacktrace::detail::construct_state(prog_location);
-
-    boost::stacktrace::detail::pc_data data = {0, &res, 0};
-    if (state) {
-        ::backtrace_pcinfo(
-            state,
-            reinterpret_cast<uintptr_t>(addr_),
-            boost::stacktrace::detail::libbacktrace_full_callback,
-            boost::stacktrace::detail::libbacktrace_error_callback,
-            &data
-        );
+    std::string source_file(const void* addr) const {
+        std::string result;
+        std::size_t line_num = 0;
+        if (addr) {
+            query(addr, 0, &result, line_num);
+        }
+
+        return result;
     }
 
-    return res;
-}
+    std::size_t source_line(const void* addr) const {
+        std::size_t line_num = 0;
+        if (addr) {
+            query(addr, 0, 0, line_num);
+        }
 
-std::size_t frame::source_line() const {
-    if (!addr_) {
-        return 0;
+        return line_num;
     }
 
-    boost::stacktrace::detail::program_location prog_location;
-    ::backtrace_state* state = boost::stacktrace::detail::construct_state(prog_location);
-
-    boost::stacktrace::detail::pc_data data = {0, 0, 0};
-    if (state) {
-        ::backtrace_pcinfo(
-            state,
-            reinterpret_cast<uintptr_t>(addr_),
-            boost::stacktrace::detail::libbacktrace_full_callback,
-            boost::stacktrace::detail::libbacktrace_error_callback,
-            &data
-        );
+    to_string_using_backtrace() noexcept {
+        state = boost::stacktrace::detail::construct_state(prog_location);
     }
+};
 
-    return data.line;
-}
-
-
-}} // namespace boost::stacktrace
+}}} // namespace boost::stacktrace::detail
 
 #endif // BOOST_STACKTRACE_DETAIL_LIBBACKTRACE_IMPLS_HPP
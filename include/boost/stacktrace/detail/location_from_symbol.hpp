@@ -193,6 +193,30 @@ public:
 };
 #endif
 
+// Not demangled name of the exported symbol that contains `addr`, nullptr if there's none.
+inline const char* exported_symbol_name(const void* addr) noexcept {
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    boost::stacktrace::detail::Dl_info dli;
+    if (boost::stacktrace::detail::dladdr(addr, dli)) {
+        return dli.dli_sname;
+    }
+#endif
+    (void)addr;
+    return 0;
+}
+
+// Address at which the module that contains `addr` is loaded, nullptr if the loader does not know.
+inline const void* module_base_address(const void* addr) noexcept {
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__) && !defined(_AIX)
+    boost::stacktrace::detail::Dl_info dli;
+    if (boost::stacktrace::detail::dladdr(addr, dli)) {
+        return dli.dli_fbase;
+    }
+#endif
+    (void)addr;
+    return 0;
+}
+
 }}} // namespace boost::stacktrace::detail
 
 #endif // BOOST_STACKTRACE_DETAIL_LOCATION_FROM_SYMBOL_HPP
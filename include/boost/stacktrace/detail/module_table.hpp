@@ -0,0 +1,239 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_MODULE_TABLE_HPP
+#define BOOST_STACKTRACE_DETAIL_MODULE_TABLE_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+#   define BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR
+#   include <link.h>       // ::dl_iterate_phdr
+#   include <unistd.h>     // ::readlink
+#elif !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+#   include <dlfcn.h>      // ::dladdr
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// 64 bit FNV-1a
+inline std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t h = 14695981039346656037ull) noexcept {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+inline const char* module_base_name(const char* path) noexcept {
+    const char* res = path;
+    for (; *path; ++path) {
+        if (*path == '/' || *path == '\\') {
+            res = path + 1;
+        }
+    }
+    return res;
+}
+
+// Identifier of a module that does not depend on the load address: hash of the GNU build-id
+// if the module has one, hash of the module file name otherwise.
+inline std::uint64_t make_module_id(const std::string& build_id, const char* path) noexcept {
+    if (!build_id.empty()) {
+        return fnv1a(build_id.data(), build_id.size());
+    }
+    const char* name = module_base_name(path);
+    return fnv1a(name, std::strlen(name));
+}
+
+struct module_info {
+    std::uintptr_t begin;       // lowest address of the loaded segments
+    std::uintptr_t end;         // past the highest address of the loaded segments
+    std::uintptr_t load_bias;   // difference between the runtime addresses and the addresses in the file
+    std::uint64_t id;
+    std::string name;
+    std::string build_id;       // raw bytes of NT_GNU_BUILD_ID note, empty if there's no such note
+};
+
+// Snapshot of the modules loaded into the process. Snapshot is immutable and is shared between
+// users; a new snapshot is made by current() only after the dynamic loader loads or unloads something.
+class module_table {
+    std::vector<module_info> modules_;  // sorted by begin
+    std::uint64_t generation_;
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+    static bool has_generation(std::size_t size) noexcept {
+        return size >= offsetof(dl_phdr_info, dlpi_subs) + sizeof(dl_phdr_info::dlpi_subs);
+    }
+
+    static int generation_callback(dl_phdr_info* info, std::size_t size, void* data) noexcept {
+        *static_cast<std::uint64_t*>(data) = has_generation(size)
+            ? static_cast<std::uint64_t>(info->dlpi_adds + info->dlpi_subs)
+            : ~static_cast<std::uint64_t>(0);
+        return 1;
+    }
+
+    static std::string build_id_of(const dl_phdr_info& info) {
+        for (std::size_t i = 0; i < info.dlpi_phnum; ++i) {
+            const ElfW(Phdr)& ph = info.dlpi_phdr[i];
+            if (ph.p_type != PT_NOTE) {
+                continue;
+            }
+
+            const char* note = reinterpret_cast<const char*>(info.dlpi_addr + ph.p_vaddr);
+            const char* const note_end = note + ph.p_memsz;
+            while (note + sizeof(ElfW(Nhdr)) <= note_end) {
+                ElfW(Nhdr) hdr;
+                std::memcpy(&hdr, note, sizeof(hdr));
+                const char* const name = note + sizeof(hdr);
+                const char* const desc = name + ((hdr.n_namesz + 3) & ~3u);
+                const char* const next = desc + ((hdr.n_descsz + 3) & ~3u);
+                if (next > note_end) {
+                    break;
+                }
+                if (hdr.n_type == NT_GNU_BUILD_ID && hdr.n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                    return std::string(desc, hdr.n_descsz);
+                }
+                note = next;
+            }
+        }
+        return std::string();
+    }
+
+    static int collect_callback(dl_phdr_info* info, std::size_t /*size*/, void* data) {
+        module_table& self = *static_cast<module_table*>(data);
+
+        module_info m;
+        m.begin = ~static_cast<std::uintptr_t>(0);
+        m.end = 0;
+        for (std::size_t i = 0; i < info->dlpi_phnum; ++i) {
+            const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+            if (ph.p_type == PT_LOAD) {
+                m.begin = (std::min)(m.begin, static_cast<std::uintptr_t>(info->dlpi_addr + ph.p_vaddr));
+                m.end = (std::max)(m.end, static_cast<std::uintptr_t>(info->dlpi_addr + ph.p_vaddr + ph.p_memsz));
+            }
+        }
+        if (m.begin >= m.end) {
+            return 0;
+        }
+
+        m.load_bias = static_cast<std::uintptr_t>(info->dlpi_addr);
+        if (info->dlpi_name && *info->dlpi_name) {
+            m.name = info->dlpi_name;
+        } else if (self.modules_.empty()) {
+            // The first entry is the executable itself and it has no name
+            char buf[4096];
+            const ssize_t len = ::readlink("/proc/self/exe", buf, sizeof(buf));
+            if (len > 0 && static_cast<std::size_t>(len) < sizeof(buf)) {
+                m.name.assign(buf, static_cast<std::size_t>(len));
+            }
+        }
+        m.build_id = build_id_of(*info);
+        m.id = make_module_id(m.build_id, m.name.c_str());
+        self.modules_.push_back(std::move(m));
+        return 0;
+    }
+#endif
+
+    static std::uint64_t loader_generation() noexcept {
+        std::uint64_t res = 0;
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+        ::dl_iterate_phdr(&module_table::generation_callback, &res);
+#endif
+        return res;
+    }
+
+    explicit module_table(std::uint64_t generation)
+        : generation_(generation)
+    {
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+        ::dl_iterate_phdr(&module_table::collect_callback, this);
+        std::sort(modules_.begin(), modules_.end(), [](const module_info& lhs, const module_info& rhs) {
+            return lhs.begin < rhs.begin;
+        });
+#endif
+    }
+
+public:
+    // Returns the cached snapshot, or makes a new one if the set of loaded modules changed.
+    static std::shared_ptr<const module_table> current() {
+        static std::mutex m;
+        static std::shared_ptr<const module_table> cached;
+
+        const std::uint64_t generation = loader_generation();
+        std::lock_guard<std::mutex> lock(m);
+        if (!cached || cached->generation_ != generation || generation == ~static_cast<std::uint64_t>(0)) {
+            cached.reset(new module_table(generation));
+        }
+        return cached;
+    }
+
+    const std::vector<module_info>& modules() const noexcept {
+        return modules_;
+    }
+
+    // Returns nullptr if `addr` does not belong to any of the modules.
+    const module_info* find(const void* addr) const noexcept {
+        const std::uintptr_t a = reinterpret_cast<std::uintptr_t>(addr);
+        auto it = std::upper_bound(modules_.begin(), modules_.end(), a, [](std::uintptr_t v, const module_info& m) {
+            return v < m.begin;
+        });
+        if (it == modules_.begin()) {
+            return nullptr;
+        }
+        --it;
+        return a < it->end ? &*it : nullptr;
+    }
+
+    // Returns nullptr if there's no loaded module with such id.
+    const module_info* find_by_id(std::uint64_t id) const noexcept {
+        for (const module_info& m: modules_) {
+            if (m.id == id) {
+                return &m;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Converts an absolute address into {module id, offset}. Returns {0, addr} if module
+// could not be found.
+inline void to_module_offset(const module_table& table, const void* addr, std::uint64_t& id, std::uintptr_t& offset) {
+    const module_info* m = table.find(addr);
+    if (m) {
+        id = m->id;
+        offset = reinterpret_cast<std::uintptr_t>(addr) - m->load_bias;
+        return;
+    }
+
+#if !defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    // No way to enumerate the modules, asking the loader for each address
+    Dl_info info;
+    if (addr && ::dladdr(addr, &info) && info.dli_fname && info.dli_fbase) {
+        id = make_module_id(std::string(), info.dli_fname);
+        offset = reinterpret_cast<std::uintptr_t>(addr) - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+        return;
+    }
+#endif
+
+    id = 0;
+    offset = reinterpret_cast<std::uintptr_t>(addr);
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_MODULE_TABLE_HPP
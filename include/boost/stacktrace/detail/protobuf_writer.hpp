@@ -0,0 +1,75 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_PROTOBUF_WRITER_HPP
+#define BOOST_STACKTRACE_DETAIL_PROTOBUF_WRITER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Minimal encoder of the protocol buffers wire format, enough for writing the pprof profiles.
+// Negative int64 values are encoded as 10 byte varints, as the protocol requires.
+
+enum protobuf_wire_type {
+    protobuf_varint = 0,
+    protobuf_length_delimited = 2
+};
+
+inline void append_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void append_tag(std::string& out, unsigned field, protobuf_wire_type type) {
+    boost::stacktrace::detail::append_varint(out, (static_cast<std::uint64_t>(field) << 3) | type);
+}
+
+// Default values are not written, as in the proto3 encoding
+inline void append_varint_field(std::string& out, unsigned field, std::uint64_t value) {
+    if (value) {
+        boost::stacktrace::detail::append_tag(out, field, protobuf_varint);
+        boost::stacktrace::detail::append_varint(out, value);
+    }
+}
+
+inline void append_bytes_field(std::string& out, unsigned field, const char* data, std::size_t size) {
+    boost::stacktrace::detail::append_tag(out, field, protobuf_length_delimited);
+    boost::stacktrace::detail::append_varint(out, size);
+    out.append(data, size);
+}
+
+inline void append_bytes_field(std::string& out, unsigned field, const std::string& data) {
+    boost::stacktrace::detail::append_bytes_field(out, field, data.data(), data.size());
+}
+
+// Packed repeated field of varints, `scratch` is a reusable buffer
+template <class T>
+void append_packed_field(std::string& out, unsigned field, const T* values, std::size_t size, std::string& scratch) {
+    if (!size) {
+        return;
+    }
+
+    scratch.clear();
+    for (std::size_t i = 0; i < size; ++i) {
+        boost::stacktrace::detail::append_varint(scratch, static_cast<std::uint64_t>(values[i]));
+    }
+    boost::stacktrace::detail::append_bytes_field(out, field, scratch);
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_PROTOBUF_WRITER_HPP
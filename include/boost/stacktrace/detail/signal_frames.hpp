@@ -0,0 +1,64 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SIGNAL_FRAMES_HPP
+#define BOOST_STACKTRACE_DETAIL_SIGNAL_FRAMES_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/safe_dump_to.hpp> // boost::stacktrace::detail::native_frame_ptr_t
+
+#include <cstddef>
+
+#if defined(__linux__)
+#   include <ucontext.h>
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+#if defined(__linux__)
+
+// Address of the instruction that was interrupted by the signal, nullptr if unknown for the platform.
+// `context` is the third parameter of the SA_SIGINFO signal handler. Async signal safe.
+inline native_frame_ptr_t interrupted_pc(const void* context) noexcept {
+    const ::ucontext_t* const uc = static_cast<const ::ucontext_t*>(context);
+#if defined(__x86_64__) && defined(REG_RIP)
+    return reinterpret_cast<native_frame_ptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__i386__) && defined(REG_EIP)
+    return reinterpret_cast<native_frame_ptr_t>(uc->uc_mcontext.gregs[REG_EIP]);
+#elif defined(__aarch64__)
+    return reinterpret_cast<native_frame_ptr_t>(uc->uc_mcontext.pc);
+#elif defined(__arm__)
+    return reinterpret_cast<native_frame_ptr_t>(uc->uc_mcontext.arm_pc);
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+// Index of the interrupted frame in the `frames` that were collected in a signal handler, so the frames of the
+// handler and of the signal trampoline could be dropped. Unwinder reports the interrupted instruction as is for
+// the signal frames, so it is found exactly. If it is not found, `handler_frames` is returned. Async signal safe.
+inline std::size_t first_interrupted_frame(const native_frame_ptr_t* frames, std::size_t size,
+                                           const void* context, std::size_t handler_frames) noexcept
+{
+    const native_frame_ptr_t pc = boost::stacktrace::detail::interrupted_pc(context);
+    for (std::size_t i = 0; pc && i < size && i < handler_frames + 2; ++i) {
+        if (frames[i] == pc) {
+            return i;
+        }
+    }
+    return (size > handler_frames ? handler_frames : size);
+}
+
+#endif // defined(__linux__)
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_SIGNAL_FRAMES_HPP
@@ -0,0 +1,109 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SPSC_RING_HPP
+#define BOOST_STACKTRACE_DETAIL_SPSC_RING_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Wait-free single producer single consumer ring of 64 bit words.
+//
+// Producer side (try_push) does not allocate, does not lock and is async signal safe
+// as long as std::atomic<std::size_t> is lock free. A try_push from a signal handler that
+// interrupted another try_push of the same producer fails. Records are variable length
+// sequences of words, the ring does not know about the records layout.
+class spsc_ring {
+    enum { cache_line = 64 };
+
+    std::unique_ptr<std::uint64_t[]> data_;
+    std::size_t mask_;
+
+    // Indexes grow monotonically and are masked on access
+    std::atomic<std::size_t> head_;     // written by producer
+    std::atomic<bool> pushing_;         // producer only, set while a try_push is running
+    char pad0_[cache_line - sizeof(std::atomic<std::size_t>) - sizeof(std::atomic<bool>)];
+    std::atomic<std::size_t> tail_;     // written by consumer
+    char pad1_[cache_line - sizeof(std::atomic<std::size_t>)];
+
+    static std::size_t round_up_to_power_of_2(std::size_t v) noexcept {
+        std::size_t res = 1;
+        while (res < v) {
+            res <<= 1;
+        }
+        return res;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+public:
+    explicit spsc_ring(std::size_t capacity_words)
+        : data_(new std::uint64_t[round_up_to_power_of_2(capacity_words)])
+        , mask_(round_up_to_power_of_2(capacity_words) - 1)
+        , head_(0)
+        , pushing_(false)
+        , tail_(0)
+    {}
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // Producer. Writes `size` words, obtaining them from `f(i)`. Either all the words
+    // are written or nothing is written and `false` is returned.
+    template <class F>
+    bool try_push(std::size_t size, F f) noexcept {
+        // Only the producer thread and its signal handlers touch the flag, the signal fences are enough
+        if (pushing_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        pushing_.store(true, std::memory_order_relaxed);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        const bool fits = (capacity() - (head - tail) >= size);
+        if (fits) {
+            for (std::size_t i = 0; i < size; ++i) {
+                data_[(head + i) & mask_] = f(i);
+            }
+            head_.store(head + size, std::memory_order_release);
+        }
+
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        pushing_.store(false, std::memory_order_relaxed);
+        return fits;
+    }
+
+    // Consumer. Count of words that could be read with peek().
+    std::size_t available() const noexcept {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    // Consumer. Word at position `i` from the read position, `i` must be less than available().
+    std::uint64_t peek(std::size_t i) const noexcept {
+        return data_[(tail_.load(std::memory_order_relaxed) + i) & mask_];
+    }
+
+    // Consumer. Releases `size` words to the producer.
+    void pop(std::size_t size) noexcept {
+        tail_.store(tail_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+};
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_SPSC_RING_HPP
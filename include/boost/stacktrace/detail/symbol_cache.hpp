@@ -0,0 +1,301 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SYMBOL_CACHE_HPP
+#define BOOST_STACKTRACE_DETAIL_SYMBOL_CACHE_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/module_table.hpp>
+
+// The cache is compiled into the libraries. Header only users opt in with BOOST_STACKTRACE_ENABLE_SYMBOL_CACHE,
+// so that the other translation units do not pay for it.
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_SYMBOL_CACHE) \
+    && (defined(BOOST_STACKTRACE_ENABLE_SYMBOL_CACHE) || defined(BOOST_STACKTRACE_INTERNAL_BUILD_LIBS))
+#   define BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_CACHE
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>          // ::open
+#include <sys/mman.h>       // ::mmap
+#include <sys/stat.h>       // ::fstat
+#include <unistd.h>         // ::ftruncate
+
+#if defined(__linux__)
+#   include <sys/auxv.h>    // ::getauxval
+#endif
+
+#ifndef BOOST_STACKTRACE_SYMBOL_CACHE_SIZE
+#   define BOOST_STACKTRACE_SYMBOL_CACHE_SIZE (64u << 20)
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Layout of the persistent cache of the resolved frames. The file is mapped with MAP_SHARED by all
+// the processes that use it, and all the fields that are modified after the file creation are atomics.
+// An all-zero file is a valid empty cache, so the file needs no initialization other than ftruncate.
+//
+//  symbol_cache_header
+//  std::atomic<std::uint64_t>[slots_count]  file offsets of the entries, 0 for an empty slot
+//  entries                                  symbol_cache_entry followed by the text, 8 byte aligned
+//
+// Inserts are append only: an entry is written into space reserved by fetch_add on `data_used` and
+// only then published by a compare-and-swap of an empty slot. Readers never see a partially written
+// entry and a process that dies in the middle of an insert only leaks the reserved space.
+//
+// Entries are keyed by the module, the offset and the implementation that resolved the frame, as the
+// implementations produce different texts. The text does not contain the module path, which differs
+// between the hosts for the same build-id.
+BOOST_CONSTEXPR_OR_CONST std::uint64_t symbol_cache_magic = 0x3243595354534231ull; // "1BSTSYC2"
+
+struct symbol_cache_header {
+    std::atomic<std::uint64_t> magic;
+    std::atomic<std::uint64_t> data_used;
+};
+
+struct symbol_cache_key {
+    std::uint64_t module_id;    // hash of the build-id
+    std::uint64_t offset;       // address in the module file
+    std::uint16_t backend;      // boost::stacktrace::symbolizer_backend that resolved the frame
+};
+
+struct symbol_cache_entry {
+    std::uint64_t module_id;
+    std::uint64_t offset;
+    std::uint32_t size;         // of the text that follows the entry
+    std::uint16_t backend;
+    std::uint16_t flags;        // user defined
+
+    bool matches(const symbol_cache_key& key) const noexcept {
+        return module_id == key.module_id && offset == key.offset && backend == key.backend;
+    }
+};
+
+class symbol_cache_file {
+    char* data_;
+    std::size_t size_;
+    std::size_t slots_count_;
+    std::size_t data_begin_;
+
+    static BOOST_CONSTEXPR_OR_CONST std::size_t max_probes = 64;
+    static BOOST_CONSTEXPR_OR_CONST std::size_t max_text_size = 4096;
+
+    symbol_cache_header& header() const noexcept {
+        return *reinterpret_cast<symbol_cache_header*>(data_);
+    }
+
+    std::atomic<std::uint64_t>* slots() const noexcept {
+        return reinterpret_cast<std::atomic<std::uint64_t>*>(data_ + sizeof(symbol_cache_header));
+    }
+
+    static std::uint64_t hash(const symbol_cache_key& key) noexcept {
+        const std::uint64_t h = boost::stacktrace::detail::fnv1a(&key.offset, sizeof(key.offset), key.module_id);
+        return boost::stacktrace::detail::fnv1a(&key.backend, sizeof(key.backend), h);
+    }
+
+    // Entry published at `value` or nullptr if the value does not point to a complete entry inside of the file
+    const symbol_cache_entry* entry(std::uint64_t value) const noexcept {
+        if (value < data_begin_ || value % 8 || value > size_ - sizeof(symbol_cache_entry)) {
+            return nullptr;
+        }
+        const symbol_cache_entry* e = reinterpret_cast<const symbol_cache_entry*>(data_ + value);
+        if (e->size > size_ - value - sizeof(symbol_cache_entry)) {
+            return nullptr;
+        }
+        return e;
+    }
+
+    void reset() noexcept {
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    symbol_cache_file(const symbol_cache_file&) = delete;
+    symbol_cache_file& operator=(const symbol_cache_file&) = delete;
+
+public:
+    // Opens or creates the cache at `path`. A new file is made `size` bytes long; an existing
+    // file keeps its size, so that all the processes agree on the layout.
+    symbol_cache_file(const char* path, std::size_t size) noexcept
+        : data_(nullptr)
+        , size_(0)
+        , slots_count_(0)
+        , data_begin_(0)
+    {
+        if (!std::atomic<std::uint64_t>().is_lock_free()) {
+            return; // locks inside of the atomics are not shared between processes
+        }
+
+        // Symbolic links are not followed, so that a link planted at the path could not redirect the writes
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0644);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return;
+        }
+        if (st.st_size == 0 && ::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            ::fstat(fd, &st);
+        }
+        if (static_cast<std::size_t>(st.st_size) >= (1u << 16)) {
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<char*>(p);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+        if (!data_) {
+            return;
+        }
+
+        std::uint64_t magic = 0;
+        if (!header().magic.compare_exchange_strong(magic, symbol_cache_magic) && magic != symbol_cache_magic) {
+            reset();
+            return;
+        }
+
+        // A quarter of the file for the slots, power of two of them
+        slots_count_ = 1;
+        while (slots_count_ * 2 * sizeof(std::uint64_t) <= size_ / 4) {
+            slots_count_ *= 2;
+        }
+        data_begin_ = sizeof(symbol_cache_header) + slots_count_ * sizeof(std::uint64_t);
+    }
+
+    ~symbol_cache_file() noexcept {
+        reset();
+    }
+
+    explicit operator bool() const noexcept { return !!data_; }
+
+    bool find(const symbol_cache_key& key, std::string& text, std::uint16_t& flags) const {
+        if (!data_) {
+            return false;
+        }
+        const std::uint64_t h = hash(key);
+        for (std::size_t i = 0; i < max_probes; ++i) {
+            const std::uint64_t value = slots()[(h + i) & (slots_count_ - 1)].load(std::memory_order_acquire);
+            if (!value) {
+                return false;
+            }
+            const symbol_cache_entry* e = entry(value);
+            if (e && e->matches(key)) {
+                text.assign(reinterpret_cast<const char*>(e + 1), e->size);
+                flags = e->flags;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns false if the cache is full or the key is already there.
+    bool insert(const symbol_cache_key& key, const std::string& text, std::uint16_t flags) noexcept {
+        if (!data_ || text.size() > max_text_size) {
+            return false;
+        }
+
+        const std::uint64_t h = hash(key);
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < max_probes; ++i) {
+            std::atomic<std::uint64_t>& slot = slots()[(h + i) & (slots_count_ - 1)];
+            std::uint64_t current = slot.load(std::memory_order_acquire);
+            if (!current) {
+                if (!value) {
+                    const std::uint64_t size = (sizeof(symbol_cache_entry) + text.size() + 7) & ~static_cast<std::uint64_t>(7);
+                    const std::uint64_t used = header().data_used.fetch_add(size, std::memory_order_relaxed);
+                    if (used > size_ - data_begin_ || size > size_ - data_begin_ - used) {
+                        return false;
+                    }
+                    value = data_begin_ + used;
+
+                    symbol_cache_entry* e = reinterpret_cast<symbol_cache_entry*>(data_ + value);
+                    e->module_id = key.module_id;
+                    e->offset = key.offset;
+                    e->size = static_cast<std::uint32_t>(text.size());
+                    e->backend = key.backend;
+                    e->flags = flags;
+                    std::memcpy(e + 1, text.data(), text.size());
+                }
+                if (slot.compare_exchange_strong(current, value, std::memory_order_release, std::memory_order_acquire)) {
+                    return true;
+                }
+                // Other process took the slot, `current` now holds its entry
+            }
+
+            const symbol_cache_entry* e = entry(current);
+            if (e && e->matches(key)) {
+                return false;
+            }
+        }
+        return false;
+    }
+};
+
+// True for the set-user-ID and set-group-ID programs and for the ones with file capabilities. They must not
+// write to the files named by the environment of the less privileged caller.
+inline bool symbol_cache_secure_execution() noexcept {
+#if defined(__linux__) && defined(AT_SECURE)
+    return ::getauxval(AT_SECURE) != 0;
+#else
+    return ::getuid() != ::geteuid() || ::getgid() != ::getegid();
+#endif
+}
+
+// Process wide cache file, enabled by setting the BOOST_STACKTRACE_SYMBOL_CACHE environment
+// variable to the path of the file. The variable is read once, on the first symbolization, and
+// is ignored in the secure execution mode.
+inline symbol_cache_file* symbol_cache() noexcept {
+    static const std::unique_ptr<symbol_cache_file> cache = []() -> std::unique_ptr<symbol_cache_file> {
+        if (boost::stacktrace::detail::symbol_cache_secure_execution()) {
+            return nullptr;
+        }
+        const char* path = std::getenv("BOOST_STACKTRACE_SYMBOL_CACHE");
+        if (!path || !*path) {
+            return nullptr;
+        }
+        std::unique_ptr<symbol_cache_file> res(new (std::nothrow) symbol_cache_file(path, BOOST_STACKTRACE_SYMBOL_CACHE_SIZE));
+        if (res && !*res) {
+            res.reset();
+        }
+        return res;
+    }();
+    return cache.get();
+}
+
+// Key of the frame in the cache. Frames of the modules without a build-id are not cached, because
+// a rebuilt module with the same name would get the stale results.
+inline bool make_symbol_cache_key(const void* addr, std::uint16_t backend, symbol_cache_key& key) {
+    const std::shared_ptr<const module_table> table = module_table::current();
+    const module_info* m = table->find(addr);
+    if (!m || m->build_id.empty()) {
+        return false;
+    }
+    key.module_id = m->id;
+    key.offset = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(addr) - m->load_bias);
+    key.backend = backend;
+    return true;
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_SYMBOL_CACHE)
+
+#endif // BOOST_STACKTRACE_DETAIL_SYMBOL_CACHE_HPP
@@ -0,0 +1,295 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_HPP
+#define BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/module_table.hpp>
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_SYMBOL_INDEX)
+#   define BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_INDEX
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <fcntl.h>          // ::open
+#include <sys/mman.h>       // ::mmap
+#include <sys/stat.h>       // ::fstat
+#include <unistd.h>         // ::close
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Layout of the sidecar symbol index file produced by the boost_stacktrace_make_index tool.
+// All the arrays are 8 byte aligned and use the byte order of the machine that made the index.
+// Addresses are the addresses in the module file, i.e. without the load bias. Size and modification
+// time of the module file identify the modules without a build-id.
+//
+//  symbol_index_header
+//  symbol_index_function[functions_count]   sorted by begin
+//  symbol_index_line[lines_count]           sorted by addr
+//  std::uint32_t[files_count]               offsets of file names in the strings
+//  char[strings_size]                       zero terminated strings
+BOOST_CONSTEXPR_OR_CONST char symbol_index_magic[8] = {'B', 'S', 'T', 'S', 'I', 'D', 'X', '2'};
+
+struct symbol_index_header {
+    char magic[8];
+    std::uint32_t build_id_size;
+    std::uint32_t reserved;
+    unsigned char build_id[64];
+    std::uint64_t module_size;
+    std::int64_t module_mtime;
+    std::uint64_t functions_offset, functions_count;
+    std::uint64_t lines_offset, lines_count;
+    std::uint64_t files_offset, files_count;
+    std::uint64_t strings_offset, strings_size;
+};
+
+struct symbol_index_function {
+    std::uint64_t begin;
+    std::uint64_t end;
+    std::uint64_t name;     // offset in the strings
+};
+
+struct symbol_index_line {
+    static BOOST_CONSTEXPR_OR_CONST std::uint32_t end_sequence = ~static_cast<std::uint32_t>(0);
+
+    std::uint64_t addr;
+    std::uint32_t file;     // index in the files or end_sequence
+    std::uint32_t line;
+};
+
+// Read only memory mapping of a sidecar index. Lookups are binary searches over the mapped
+// arrays, nothing is parsed or copied on load except the header validation.
+class symbol_index_file {
+    const char* data_;
+    std::size_t size_;
+    symbol_index_header header_;
+
+    template <class T>
+    const T* array(std::uint64_t offset) const noexcept {
+        return reinterpret_cast<const T*>(data_ + offset);
+    }
+
+    bool valid_array(std::uint64_t offset, std::uint64_t count, std::size_t element_size) const noexcept {
+        return offset % 8 == 0 && offset <= size_ && count <= (size_ - offset) / element_size;
+    }
+
+    bool valid() const noexcept {
+        const symbol_index_header& h = header_;
+        return std::memcmp(h.magic, symbol_index_magic, sizeof(h.magic)) == 0
+            && h.build_id_size <= sizeof(h.build_id)
+            && valid_array(h.functions_offset, h.functions_count, sizeof(symbol_index_function))
+            && valid_array(h.lines_offset, h.lines_count, sizeof(symbol_index_line))
+            && valid_array(h.files_offset, h.files_count, sizeof(std::uint32_t))
+            && h.strings_offset <= size_ && h.strings_size <= size_ - h.strings_offset
+            && h.strings_size && data_[h.strings_offset + h.strings_size - 1] == '\0';
+    }
+
+    const char* string(std::uint64_t offset) const noexcept {
+        return offset < header_.strings_size ? data_ + header_.strings_offset + offset : nullptr;
+    }
+
+    symbol_index_file(const symbol_index_file&) = delete;
+    symbol_index_file& operator=(const symbol_index_file&) = delete;
+
+public:
+    explicit symbol_index_file(const char* path) noexcept
+        : data_(nullptr)
+        , size_(0)
+        , header_()
+    {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(symbol_index_header)) {
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const char*>(p);
+                size_ = static_cast<std::size_t>(st.st_size);
+                std::memcpy(&header_, data_, sizeof(header_));
+            }
+        }
+        ::close(fd);
+
+        if (data_ && !valid()) {
+            ::munmap(const_cast<char*>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    ~symbol_index_file() noexcept {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    explicit operator bool() const noexcept { return !!data_; }
+
+    std::string build_id() const {
+        return std::string(reinterpret_cast<const char*>(header_.build_id), data_ ? header_.build_id_size : 0);
+    }
+
+    // True if the index was made for the module: both have the same non empty build-id, or both have
+    // no build-id and the module file has the same size and modification time as when the index was made.
+    bool matches(const std::string& module_build_id, const char* module_path) const noexcept {
+        if (!data_) {
+            return false;
+        }
+        if (!module_build_id.empty() || header_.build_id_size) {
+            return module_build_id.size() == header_.build_id_size
+                && std::memcmp(module_build_id.data(), header_.build_id, header_.build_id_size) == 0;
+        }
+
+        struct stat st;
+        return header_.module_size && ::stat(module_path, &st) == 0
+            && static_cast<std::uint64_t>(st.st_size) == header_.module_size
+            && static_cast<std::int64_t>(st.st_mtime) == header_.module_mtime;
+    }
+
+    // Demangled name of the function containing `addr` or nullptr.
+    const char* function(std::uint64_t addr) const noexcept {
+        if (!data_) {
+            return nullptr;
+        }
+        const symbol_index_function* begin = array<symbol_index_function>(header_.functions_offset);
+        const symbol_index_function* end = begin + header_.functions_count;
+        const symbol_index_function* it = std::upper_bound(begin, end, addr, [](std::uint64_t a, const symbol_index_function& f) {
+            return a < f.begin;
+        });
+        if (it == begin || addr >= (it - 1)->end) {
+            return nullptr;
+        }
+        return string((it - 1)->name);
+    }
+
+    bool location(std::uint64_t addr, std::string& file, std::size_t& line) const {
+        if (!data_) {
+            return false;
+        }
+        const symbol_index_line* begin = array<symbol_index_line>(header_.lines_offset);
+        const symbol_index_line* end = begin + header_.lines_count;
+        const symbol_index_line* it = std::upper_bound(begin, end, addr, [](std::uint64_t a, const symbol_index_line& l) {
+            return a < l.addr;
+        });
+        if (it == begin) {
+            return false;
+        }
+        --it;
+        if (it->file == symbol_index_line::end_sequence || it->file >= header_.files_count || !it->line) {
+            return false;
+        }
+
+        const char* name = string(array<std::uint32_t>(header_.files_offset)[it->file]);
+        if (!name || !*name) {
+            return false;
+        }
+        file = name;
+        line = it->line;
+        return true;
+    }
+};
+
+inline std::string symbol_index_file_name(const std::string& build_id) {
+    static const char hex[] = "0123456789abcdef";
+    std::string res;
+    for (std::size_t i = 0; i < build_id.size(); ++i) {
+        res += hex[static_cast<unsigned char>(build_id[i]) >> 4];
+        res += hex[static_cast<unsigned char>(build_id[i]) & 0xF];
+    }
+    res += ".symidx";
+    return res;
+}
+
+// Process wide cache of the sidecar indexes. The index of a module is searched next to the module
+// as "<module>.symidx" and, if BOOST_STACKTRACE_SYMBOL_INDEX_DIR is defined, as
+// "BOOST_STACKTRACE_SYMBOL_INDEX_DIR/<hex build-id>.symidx". The index must match the loaded module,
+// see symbol_index_file::matches(). Modules without an index are remembered and cost only a hash
+// table lookup afterwards.
+class symbol_indexes {
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<symbol_index_file> > indexes_;
+
+    static std::unique_ptr<symbol_index_file> open_for(const module_info& m) {
+        std::unique_ptr<symbol_index_file> index(new symbol_index_file((m.name + ".symidx").c_str()));
+#ifdef BOOST_STACKTRACE_SYMBOL_INDEX_DIR
+        if (!*index && !m.build_id.empty()) {
+            index.reset(new symbol_index_file(
+                (std::string(BOOST_STACKTRACE_SYMBOL_INDEX_DIR) + '/' + symbol_index_file_name(m.build_id)).c_str()
+            ));
+        }
+#endif
+        if (*index && !index->matches(m.build_id, m.name.c_str())) {
+            index.reset(new symbol_index_file(""));
+        }
+        return index;
+    }
+
+public:
+    static symbol_indexes& instance() {
+        static symbol_indexes indexes;
+        return indexes;
+    }
+
+    template <class Func>
+    bool visit(const void* addr, Func f) {
+        const std::shared_ptr<const module_table> table = module_table::current();
+        const module_info* m = table->find(addr);
+        if (!m || m->name.empty()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<symbol_index_file>& index = indexes_[m->name];
+        if (!index) {
+            index = open_for(*m);
+        }
+        return *index && f(*index, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(addr) - m->load_bias));
+    }
+};
+
+inline std::string symbol_index_name(const void* addr) {
+    std::string res;
+    try {
+        symbol_indexes::instance().visit(addr, [&res](const symbol_index_file& index, std::uint64_t offset) {
+            const char* name = index.function(offset);
+            if (name) {
+                res = name;
+            }
+            return !!name;
+        });
+    } catch (...) {}
+    return res;
+}
+
+inline bool symbol_index_location(const void* addr, std::string& file, std::size_t& line) noexcept {
+    try {
+        return addr && symbol_indexes::instance().visit(addr, [&](const symbol_index_file& index, std::uint64_t offset) {
+            return index.location(offset, file, line);
+        });
+    } catch (...) {
+        return false;
+    }
+}
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR) && !defined(BOOST_STACKTRACE_DISABLE_SYMBOL_INDEX)
+
+#endif // BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_HPP
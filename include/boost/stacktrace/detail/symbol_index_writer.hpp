@@ -0,0 +1,194 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_WRITER_HPP
+#define BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_WRITER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/detail/symbol_index.hpp>
+#include <boost/stacktrace/detail/dwarf_line_tables.hpp>
+#include <boost/stacktrace/detail/elf_symtab.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost { namespace stacktrace { namespace detail {
+
+class symbol_index_builder {
+    std::vector<symbol_index_function> functions_;
+    std::vector<symbol_index_line> lines_;
+    std::vector<std::uint32_t> files_;
+    std::string strings_;
+    std::unordered_map<std::string, std::uint64_t> string_offsets_;
+    std::string build_id_;
+    std::uint64_t module_size_;
+    std::int64_t module_mtime_;
+
+    std::uint64_t add_string(const std::string& s) {
+        auto it = string_offsets_.find(s);
+        if (it != string_offsets_.end()) {
+            return it->second;
+        }
+        const std::uint64_t offset = strings_.size();
+        strings_.append(s.c_str(), s.size() + 1);
+        string_offsets_.emplace(s, offset);
+        return offset;
+    }
+
+    void add_functions(const std::string& module_path) {
+        const elf_symbol_index symbols(module_path);
+        symbols.visit([&](std::uintptr_t begin, std::uintptr_t end, const char* name) {
+            symbol_index_function f;
+            f.begin = begin;
+            f.end = end;
+            f.name = add_string(boost::stacktrace::detail::demangle_uncached(name));
+            functions_.push_back(f);
+        });
+    }
+
+    void add_lines(const std::string& module_path) {
+        const elf_file file = boost::stacktrace::detail::open_debug_file(module_path, ".debug_line");
+        const dwarf_sections s = boost::stacktrace::detail::find_dwarf_sections(file);
+        if (!s.info || !s.abbrev || !s.line) {
+            return;
+        }
+
+        std::unordered_map<std::string, std::uint32_t> file_indexes;
+        std::uint64_t next = 0;
+        for (std::uint64_t offset = 0; offset < s.info.size; offset = next) {
+            dwarf_compile_unit cu;
+            const bool ok = boost::stacktrace::detail::parse_dwarf_compile_unit(s, offset, cu, next);
+            if (next == dwarf_compile_unit::npos) {
+                break;
+            }
+            dwarf_line_table table;
+            if (!ok || !boost::stacktrace::detail::decode_dwarf_line_table(s, cu, table)) {
+                continue;
+            }
+
+            std::vector<std::uint32_t> remap(table.files.size(), static_cast<std::uint32_t>(symbol_index_line::end_sequence));
+            for (const dwarf_line_row& row: table.rows) {
+                symbol_index_line l;
+                l.addr = row.addr;
+                l.line = row.line;
+                l.file = symbol_index_line::end_sequence;
+                if (row.file != dwarf_line_row::end_sequence && row.file < remap.size()) {
+                    if (remap[row.file] == symbol_index_line::end_sequence) {
+                        auto it = file_indexes.emplace(table.files[row.file], static_cast<std::uint32_t>(files_.size()));
+                        if (it.second) {
+                            files_.push_back(static_cast<std::uint32_t>(add_string(table.files[row.file])));
+                        }
+                        remap[row.file] = it.first->second;
+                    }
+                    l.file = remap[row.file];
+                }
+                lines_.push_back(l);
+            }
+        }
+
+        std::stable_sort(lines_.begin(), lines_.end(), [](const symbol_index_line& lhs, const symbol_index_line& rhs) {
+            return lhs.addr < rhs.addr || (
+                lhs.addr == rhs.addr && lhs.file == symbol_index_line::end_sequence && rhs.file != symbol_index_line::end_sequence
+            );
+        });
+
+        // Rows that repeat the location of the previous row do not change the lookup results
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < lines_.size(); ++i) {
+            if (out && lines_[i].file != symbol_index_line::end_sequence
+                && lines_[out - 1].file == lines_[i].file && lines_[out - 1].line == lines_[i].line)
+            {
+                continue;
+            }
+            lines_[out++] = lines_[i];
+        }
+        lines_.resize(out);
+    }
+
+public:
+    explicit symbol_index_builder(const std::string& module_path)
+        : module_size_(0)
+        , module_mtime_(0)
+    {
+        build_id_ = elf_file(module_path.c_str()).build_id();
+        struct stat st;
+        if (::stat(module_path.c_str(), &st) == 0) {
+            module_size_ = static_cast<std::uint64_t>(st.st_size);
+            module_mtime_ = static_cast<std::int64_t>(st.st_mtime);
+        }
+        add_string(std::string());
+        add_functions(module_path);
+        add_lines(module_path);
+    }
+
+    std::size_t functions_count() const noexcept { return functions_.size(); }
+    std::size_t lines_count() const noexcept { return lines_.size(); }
+
+    bool write(const std::string& out_path) const {
+        symbol_index_header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, symbol_index_magic, sizeof(h.magic));
+        h.build_id_size = static_cast<std::uint32_t>((std::min)(build_id_.size(), sizeof(h.build_id)));
+        std::memcpy(h.build_id, build_id_.data(), h.build_id_size);
+        h.module_size = module_size_;
+        h.module_mtime = module_mtime_;
+
+        const auto align = [](std::uint64_t v) { return (v + 7) & ~static_cast<std::uint64_t>(7); };
+        h.functions_offset = align(sizeof(h));
+        h.functions_count = functions_.size();
+        h.lines_offset = align(h.functions_offset + functions_.size() * sizeof(symbol_index_function));
+        h.lines_count = lines_.size();
+        h.files_offset = align(h.lines_offset + lines_.size() * sizeof(symbol_index_line));
+        h.files_count = files_.size();
+        h.strings_offset = align(h.files_offset + files_.size() * sizeof(std::uint32_t));
+        h.strings_size = strings_.size();
+
+        // Writing to a temporary file and renaming it, so that readers never see a partial index
+        const std::string tmp_path = out_path + ".tmp";
+        std::FILE* f = std::fopen(tmp_path.c_str(), "wb");
+        if (!f) {
+            return false;
+        }
+
+        std::uint64_t written = 0;
+        const auto put = [&](std::uint64_t offset, const void* data, std::size_t size) {
+            static const char zeros[8] = {};
+            bool ok = true;
+            if (written < offset) {
+                ok = (std::fwrite(zeros, 1, static_cast<std::size_t>(offset - written), f) == offset - written);
+                written = offset;
+            }
+            ok = ok && (!size || std::fwrite(data, 1, size, f) == size);
+            written += size;
+            return ok;
+        };
+        bool ok = put(0, &h, sizeof(h))
+            && put(h.functions_offset, functions_.data(), functions_.size() * sizeof(symbol_index_function))
+            && put(h.lines_offset, lines_.data(), lines_.size() * sizeof(symbol_index_line))
+            && put(h.files_offset, files_.data(), files_.size() * sizeof(std::uint32_t))
+            && put(h.strings_offset, strings_.data(), strings_.size());
+        ok = (std::fclose(f) == 0) && ok;
+
+        if (!ok || std::rename(tmp_path.c_str(), out_path.c_str()) != 0) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_SYMBOL_INDEX_WRITER_HPP
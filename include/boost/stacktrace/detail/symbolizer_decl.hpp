@@ -0,0 +1,171 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_SYMBOLIZER_DECL_HPP
+#define BOOST_STACKTRACE_DETAIL_SYMBOLIZER_DECL_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <cstddef>
+#include <string>
+
+#include <boost/stacktrace/stacktrace_fwd.hpp>
+#include <boost/stacktrace/detail/frame_decl.hpp>
+#include <boost/stacktrace/detail/push_options.h>
+
+/// @file boost/stacktrace/detail/symbolizer_decl.hpp
+/// Use <boost/stacktrace/symbolizer.hpp> header instead of this one!
+
+namespace boost { namespace stacktrace {
+
+/// @brief Implementations of getting information about frames that could be chosen at runtime,
+/// see boost::stacktrace::symbolizer::symbolizer(symbolizer_backend).
+enum class symbolizer_backend {
+    /// The implementation that the library uses by default: chosen by the BOOST_STACKTRACE_USE_* macro
+    /// in header only mode or by the linked library.
+    default_backend,
+
+    /// No information at all, as with BOOST_STACKTRACE_USE_NOOP. Frames are described by empty strings.
+    noop,
+
+    /// Names from the dynamic symbol tables and from the `.symtab` of the modules, source locations only
+    /// from the sidecar symbol indexes. Cheap, no debug information is parsed.
+    basic,
+
+    /// Names as in `basic`, source locations from the DWARF line tables, as with BOOST_STACKTRACE_USE_DWARF.
+    dwarf,
+
+    /// Runs the addr2line program, as with BOOST_STACKTRACE_USE_ADDR2LINE. Slow.
+    addr2line,
+
+    /// Uses libbacktrace, as with BOOST_STACKTRACE_USE_BACKTRACE. Available only if the
+    /// library (or the translation unit in header only mode) is built with libbacktrace.
+    backtrace
+};
+
+/// @returns true if the `backend` could be used in this build on this platform. For
+/// symbolizer_backend::addr2line also checks that the addr2line program is there.
+///
+/// @b Async-Handler-Safety: Unsafe.
+BOOST_STACKTRACE_FUNCTION bool symbolizer_backend_available(symbolizer_backend backend) noexcept;
+
+/// @class boost::stacktrace::symbolizer boost/stacktrace/detail/symbolizer_decl.hpp <boost/stacktrace/symbolizer.hpp>
+/// @brief Reusable context for getting information about frames.
+///
+/// boost::stacktrace::to_string() and the boost::stacktrace::frame member functions set up the implementation
+/// on each call. Depending on the implementation that is looking up the program location and the debug info state,
+/// reading `/proc/self/exe` or `/proc/self/maps`, or attaching to the debug engine. The symbolizer does that once
+/// and keeps the state along with the already produced descriptions of frames, so processing of many stacktraces
+/// is cheaper. Output is the same as of boost::stacktrace::to_string() and of the boost::stacktrace::frame member functions.
+///
+/// The object is not thread safe, use one per thread. Call clear() after unloading shared libraries, as their
+/// addresses could be reused by other libraries.
+class symbolizer {
+    /// @cond
+    class impl;
+    impl* impl_;
+    /// @endcond
+
+public:
+    /// @brief Prepares the implementation specific state.
+    ///
+    /// @b Complexity: unknown (platform specific work).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    /// @throws std::bad_alloc if not enough memory.
+    BOOST_STACKTRACE_FUNCTION symbolizer();
+
+    /// @brief Prepares the state of the chosen implementation. Allows to trade the quality of the output for the
+    /// speed within a single binary: symbolizer_backend::basic gives only names, while
+    /// symbolizer_backend::backtrace or symbolizer_backend::dwarf also parse the debug information for source locations.
+    ///
+    /// Falls back to symbolizer_backend::default_backend if the `backend` is not available,
+    /// see boost::stacktrace::symbolizer_backend_available().
+    ///
+    /// @b Complexity: unknown (platform specific work).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    /// @throws std::bad_alloc if not enough memory.
+    BOOST_STACKTRACE_FUNCTION explicit symbolizer(symbolizer_backend backend);
+
+    BOOST_STACKTRACE_FUNCTION ~symbolizer();
+
+    symbolizer(const symbolizer&) = delete;
+    symbolizer& operator=(const symbolizer&) = delete;
+
+    /// @returns Same as boost::stacktrace::to_string(f).
+    ///
+    /// @b Complexity: O(1) for the already seen frames, unknown (lots of platform specific work) otherwise.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION std::string to_string(const frame& f);
+
+    /// @returns Same as boost::stacktrace::to_string(bt).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class Allocator>
+    std::string to_string(const basic_stacktrace<Allocator>& bt) {
+        if (!bt) {
+            return std::string();
+        }
+
+        return to_string(&bt.as_vector()[0], bt.size());
+    }
+
+    /// @returns Frames in the format of boost::stacktrace::to_string(const basic_stacktrace<Allocator>&).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION std::string to_string(const frame* frames, std::size_t size);
+
+    /// @returns Same as f.name().
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION std::string name(const frame& f);
+
+    /// @returns Same as f.source_file().
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION std::string source_file(const frame& f);
+
+    /// @returns Same as f.source_line().
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION std::size_t source_line(const frame& f);
+
+    /// @brief Drops the remembered descriptions of frames and the cached state of the loaded modules.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    BOOST_STACKTRACE_FUNCTION void clear();
+
+    /// @returns The implementation in use.
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    BOOST_STACKTRACE_FUNCTION symbolizer_backend backend() const noexcept;
+};
+
+/// @returns Description of the frame, produced by the chosen implementation.
+///
+/// @b Async-Handler-Safety: Unsafe.
+inline std::string to_string(const frame& f, symbolizer_backend backend) {
+    return boost::stacktrace::symbolizer(backend).to_string(f);
+}
+
+/// @returns Description of the stacktrace, produced by the chosen implementation.
+///
+/// @b Async-Handler-Safety: Unsafe.
+template <class Allocator>
+std::string to_string(const basic_stacktrace<Allocator>& bt, symbolizer_backend backend) {
+    return boost::stacktrace::symbolizer(backend).to_string(bt);
+}
+
+}} // namespace boost::stacktrace
+
+#include <boost/stacktrace/detail/pop_options.h>
+
+#endif // BOOST_STACKTRACE_DETAIL_SYMBOLIZER_DECL_HPP
@@ -0,0 +1,154 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_DETAIL_THREAD_ID_HPP
+#define BOOST_STACKTRACE_DETAIL_THREAD_ID_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <cstdint>
+
+#if defined(BOOST_WINDOWS)
+#   include <boost/winapi/get_current_process_id.hpp>
+#   include <boost/winapi/get_current_thread_id.hpp>
+#   include <chrono>
+#else
+#   include <time.h>       // ::clock_gettime
+#   include <unistd.h>     // ::getpid
+#   if defined(__linux__)
+#       include <cstdlib>      // std::strtol
+#       include <cstring>      // std::memchr
+#       include <dirent.h>     // ::opendir
+#       include <fcntl.h>      // ::open
+#       include <sys/syscall.h>
+#   elif defined(__APPLE__)
+#       include <pthread.h>
+#   endif
+#endif
+
+namespace boost { namespace stacktrace { namespace detail {
+
+// Wall clock time in nanoseconds since the UNIX epoch. Async signal safe on POSIX.
+inline std::uint64_t now_ns() noexcept {
+#if defined(BOOST_WINDOWS)
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count());
+#else
+    ::timespec ts;
+    if (::clock_gettime(CLOCK_REALTIME, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec);
+#endif
+}
+
+// Platform specific id of the current thread as shown by debuggers and OS tools, 0 if unknown.
+// Async signal safe on Linux.
+inline std::uint64_t current_thread_id() noexcept {
+#if defined(BOOST_WINDOWS)
+    return boost::winapi::GetCurrentThreadId();
+#elif defined(__linux__) && defined(SYS_gettid)
+    return static_cast<std::uint64_t>(::syscall(SYS_gettid));
+#elif defined(__APPLE__)
+    std::uint64_t tid = 0;
+    ::pthread_threadid_np(0, &tid);
+    return tid;
+#else
+    return 0;
+#endif
+}
+
+// Id of the current process. Async signal safe on POSIX.
+inline std::uint64_t current_process_id() noexcept {
+#if defined(BOOST_WINDOWS)
+    return boost::winapi::GetCurrentProcessId();
+#else
+    return static_cast<std::uint64_t>(::getpid());
+#endif
+}
+
+#if defined(__linux__)
+// Calls `f(tid)` for each thread of the current process. Threads that are created or exit
+// during the call may be missed. Returns false if the threads could not be listed.
+template <class F>
+bool for_each_thread_id(F f) {
+    struct dir_closer {
+        ::DIR* const dir;
+        ~dir_closer() { ::closedir(dir); }
+    };
+
+    ::DIR* const dir = ::opendir("/proc/self/task");
+    if (!dir) {
+        return false;
+    }
+
+    const dir_closer closer = {dir};
+    while (const ::dirent* entry = ::readdir(closer.dir)) {
+        const long tid = std::strtol(entry->d_name, 0, 10);
+        if (tid > 0) {
+            f(static_cast<std::uint64_t>(tid));
+        }
+    }
+    return true;
+}
+
+// Start time of the thread in clock ticks since the boot, field 22 of `/proc/self/task/<tid>/stat`. Together
+// with the tid it identifies the thread, as the ids of the exited threads are reused. Returns 0 on error.
+inline std::uint64_t thread_start_time(std::uint64_t tid) noexcept {
+    char path[64] = "/proc/self/task/";
+    std::size_t len = std::strlen(path);
+    char digits[24];
+    std::size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + tid % 10);
+        tid /= 10;
+    } while (tid);
+    while (n) {
+        path[len++] = digits[--n];
+    }
+    std::memcpy(path + len, "/stat", sizeof("/stat"));
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    char buf[1024];
+    ssize_t size = 0;
+    for (ssize_t r; size < static_cast<ssize_t>(sizeof(buf)) - 1; size += r) {
+        r = ::read(fd, buf + size, sizeof(buf) - 1 - static_cast<std::size_t>(size));
+        if (r <= 0) {
+            break;
+        }
+    }
+    ::close(fd);
+    buf[size > 0 ? size : 0] = '\0';
+
+    // The name of the thread in the second field may contain spaces and parentheses
+    const char* p = buf + size;
+    while (p != buf && *(p - 1) != ')') {
+        --p;
+    }
+    if (p == buf) {
+        return 0;
+    }
+    for (int field = 2; field < 22; ++field) {
+        p = static_cast<const char*>(std::memchr(p, ' ', static_cast<std::size_t>(buf + size - p)));
+        if (!p) {
+            return 0;
+        }
+        ++p;
+    }
+    return std::strtoull(p, 0, 10);
+}
+#endif
+
+}}} // namespace boost::stacktrace::detail
+
+#endif // BOOST_STACKTRACE_DETAIL_THREAD_ID_HPP
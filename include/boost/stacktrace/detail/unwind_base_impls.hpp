@@ -12,7 +12,12 @@
 #   pragma once
 #endif
 
-#include <boost/stacktrace/frame.hpp>
+#include <boost/stacktrace/detail/elf_symtab.hpp>
+#include <boost/stacktrace/detail/location_from_symbol.hpp>
+#include <boost/stacktrace/detail/symbol_index.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+
+#include <string>
 
 namespace boost { namespace stacktrace { namespace detail {
 
@@ -20,31 +25,70 @@ struct to_string_using_nothing {
     std::string res;
 
     void prepare_function_name(const void* addr) {
-        res = boost::stacktrace::frame(addr).name();
+        const char* exported = boost::stacktrace::detail::exported_symbol_name(addr);
+        if (exported) {
+            res = exported;
+        } else {
+            res = name(addr);
+        }
     }
 
-    bool prepare_source_location(const void* /*addr*/) const noexcept {
-        return false;
-    }
-};
+    bool prepare_source_location(const void* addr) {
+        std::string file;
+        std::size_t line = 0;
+        if (!source_location(addr, file, line)) {
+            return false;
+        }
 
-template <class Base> class to_string_impl_base;
-typedef to_string_impl_base<to_string_using_nothing> to_string_impl;
+        res += " at ";
+        res += file;
+        res += ':';
+        res += boost::stacktrace::detail::to_dec_array(line).data();
+        return true;
+    }
 
-inline std::string name_impl(const void* /*addr*/) {
-    return std::string();
-}
+    // Name of a symbol that is not exported
+    std::string name(const void* addr) const {
+        std::string result;
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_INDEX
+        result = boost::stacktrace::detail::symbol_index_name(addr);
+#endif
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ELF_SYMTAB
+        if (result.empty()) {
+            result = boost::stacktrace::detail::elf_symtab_name(addr);
+        }
+#endif
+        (void)addr;
+        return result;
+    }
 
-} // namespace detail
+    std::string source_file(const void* addr) const {
+        std::string file;
+        std::size_t line = 0;
+        source_location(addr, file, line);
+        return file;
+    }
 
-std::string frame::source_file() const {
-    return std::string();
-}
+    std::size_t source_line(const void* addr) const {
+        std::string file;
+        std::size_t line = 0;
+        source_location(addr, file, line);
+        return line;
+    }
 
-std::size_t frame::source_line() const {
-    return 0;
-}
+    // Called after prepare_function_name(addr)
+    bool source_location(const void* addr, std::string& file, std::size_t& line) const {
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_INDEX
+        return boost::stacktrace::detail::symbol_index_location(addr, file, line);
+#else
+        (void)addr;
+        (void)file;
+        (void)line;
+        return false;
+#endif
+    }
+};
 
-}} // namespace boost::stacktrace
+}}} // namespace boost::stacktrace::detail
 
 #endif // BOOST_STACKTRACE_DETAIL_UNWIND_BASE_IMPLS_HPP
@@ -0,0 +1,416 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_FLIGHT_RECORDER_HPP
+#define BOOST_STACKTRACE_FLIGHT_RECORDER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if !defined(BOOST_WINDOWS)
+#   include <unistd.h>     // ::ftruncate, ::close
+#   include <fcntl.h>      // ::open
+#   include <sys/mman.h>   // ::mmap
+#   include <sys/stat.h>   // ::fstat
+#endif
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file flight_recorder.hpp Crash flight recorder: a preallocated, memory mapped,
+/// file backed ring of call sequences that survives the death of the process.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+    static_assert(
+        sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+        "Flight recorder requires std::atomic<std::uint64_t> to be layout compatible with std::uint64_t"
+    );
+
+    // Layout of the file:
+    //  flight_recorder_header, then `slots_count` slots of `slot_size` bytes each.
+    //  Each slot is a flight_recorder_slot immediately followed by `max_depth` of native_frame_ptr_t.
+    struct flight_recorder_header {
+        char magic[8];
+        std::uint64_t version;
+        std::uint64_t slots_count;
+        std::uint64_t max_depth;
+        std::uint64_t slot_size;
+        std::atomic<std::uint64_t> next;    // next record number to reserve
+    };
+
+    struct flight_recorder_slot {
+        // 0 - slot is empty, flight_recorder_writing bit set - slot is being written, otherwise record number + 1
+        std::atomic<std::uint64_t> sequence;
+        std::uint64_t timestamp_ns;
+        std::uint64_t thread_id;
+        std::uint64_t frames_count;
+    };
+
+    BOOST_STATIC_CONSTEXPR char flight_recorder_magic[8] = {'B', 'S', 'T', 'F', 'R', 'E', 'C', '\0'};
+    BOOST_STATIC_CONSTEXPR std::uint64_t flight_recorder_version = 2;
+    BOOST_STATIC_CONSTEXPR std::uint64_t flight_recorder_writing = static_cast<std::uint64_t>(1) << 63;
+
+    inline std::uint64_t flight_recorder_slot_size(std::uint64_t max_depth) noexcept {
+        return sizeof(flight_recorder_slot) + max_depth * sizeof(native_frame_ptr_t);
+    }
+
+    inline bool flight_recorder_header_valid(const flight_recorder_header& h, std::size_t file_size) noexcept {
+        if (std::memcmp(h.magic, flight_recorder_magic, sizeof(flight_recorder_magic)) != 0
+            || h.version != flight_recorder_version
+            || !h.slots_count
+            || h.slot_size != flight_recorder_slot_size(h.max_depth))
+        {
+            return false;
+        }
+
+        return (file_size - sizeof(flight_recorder_header)) / h.slot_size >= h.slots_count;
+    }
+
+} // namespace detail
+/// @endcond
+
+/// @brief Single record, read from the flight recorder file.
+struct flight_recorder_entry {
+    /// Number of the record since the file creation. Records with bigger numbers were written later.
+    std::uint64_t sequence;
+
+    /// Wall clock time of the record in nanoseconds since the UNIX epoch.
+    std::uint64_t timestamp_ns;
+
+    /// Platform specific identifier of the thread that made the record, 0 if unknown.
+    std::uint64_t thread_id;
+
+    /// Call sequence of the record.
+    boost::stacktrace::stacktrace trace;
+};
+
+/// @brief Crash flight recorder: a preallocated memory mapped file that keeps a ring
+/// of the last recorded call sequences along with their timestamps and thread ids.
+///
+/// Writing into the recorder does not allocate memory, does not take locks and does not
+/// call `::open`/`::write`: a slot is reserved with a single atomic increment and
+/// filled in place. Because the memory is a shared mapping of a file, the records
+/// survive the death of the process and could be later read with flight_recorder::read().
+///
+/// Records are made by flight_recorder::record() that could be used from exception hooks,
+/// assertion handlers and signal handlers alike.
+///
+/// @b Platforms: POSIX. On other platforms the recorder always fails to open.
+class flight_recorder {
+    /// @cond
+    unsigned char* memory_;
+    std::size_t memory_size_;
+
+    boost::stacktrace::detail::flight_recorder_header* header() const noexcept {
+        return reinterpret_cast<boost::stacktrace::detail::flight_recorder_header*>(memory_);
+    }
+
+    boost::stacktrace::detail::flight_recorder_slot* slot(std::uint64_t index) const noexcept {
+        return reinterpret_cast<boost::stacktrace::detail::flight_recorder_slot*>(
+            memory_ + sizeof(boost::stacktrace::detail::flight_recorder_header) + index * header()->slot_size
+        );
+    }
+
+    void close() noexcept {
+#if !defined(BOOST_WINDOWS)
+        if (memory_) {
+            ::munmap(memory_, memory_size_);
+        }
+#endif
+        memory_ = 0;
+        memory_size_ = 0;
+    }
+
+    flight_recorder(const flight_recorder&) = delete;
+    flight_recorder& operator=(const flight_recorder&) = delete;
+    /// @endcond
+
+public:
+    /// @brief Constructs a recorder that is not bound to any file. Calls to record() do nothing.
+    ///
+    /// @b Complexity: O(1).
+    flight_recorder() noexcept
+        : memory_(0)
+        , memory_size_(0)
+    {}
+
+    /// @brief Opens or creates the file and maps it into memory.
+    ///
+    /// If the file already contains a recorder with the same `slots_count` and `max_depth`, then its
+    /// records are preserved and new records continue the old sequence. Otherwise the file is truncated
+    /// and initialized from scratch.
+    ///
+    /// @b Complexity: O(slots_count * max_depth) in worst case.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @param file Path to the recorder file.
+    ///
+    /// @param slots_count How many last records to keep.
+    ///
+    /// @param max_depth Max call sequence depth of each record.
+    flight_recorder(const char* file, std::size_t slots_count, std::size_t max_depth = boost::stacktrace::detail::max_frames_dump) noexcept
+        : memory_(0)
+        , memory_size_(0)
+    {
+#if !defined(BOOST_WINDOWS)
+        namespace bsd = boost::stacktrace::detail;
+        if (!slots_count || !max_depth) {
+            return;
+        }
+
+        const std::uint64_t slot_size = bsd::flight_recorder_slot_size(max_depth);
+        const std::size_t size = sizeof(bsd::flight_recorder_header) + static_cast<std::size_t>(slot_size * slots_count);
+
+        const int fd = ::open(file, O_CREAT | O_RDWR, S_IWUSR | S_IRUSR);
+        if (fd == -1) {
+            return;
+        }
+
+        struct ::stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return;
+        }
+
+        bool reuse = (static_cast<std::size_t>(st.st_size) == size);
+        if (!reuse && ::ftruncate(fd, static_cast< ::off_t>(size)) != 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return;
+        }
+        memory_ = static_cast<unsigned char*>(p);
+        memory_size_ = size;
+
+        bsd::flight_recorder_header* h = header();
+        reuse = reuse && bsd::flight_recorder_header_valid(*h, size)
+            && h->slots_count == slots_count && h->max_depth == max_depth;
+        if (!reuse) {
+            std::memset(memory_, 0, size);
+            h->version = bsd::flight_recorder_version;
+            h->slots_count = slots_count;
+            h->max_depth = max_depth;
+            h->slot_size = slot_size;
+            h->next.store(0, std::memory_order_relaxed);
+            // Magic is written last, so that a partially initialized file is never treated as valid
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(h->magic, bsd::flight_recorder_magic, sizeof(bsd::flight_recorder_magic));
+        } else {
+            // Records that were being written when the previous owner of the file died are never completed
+            for (std::uint64_t i = 0; i < h->slots_count; ++i) {
+                if (slot(i)->sequence.load(std::memory_order_relaxed) & bsd::flight_recorder_writing) {
+                    slot(i)->sequence.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+#else
+        (void)file;
+        (void)slots_count;
+        (void)max_depth;
+#endif
+    }
+
+    /// @b Complexity: O(1).
+    ~flight_recorder() noexcept {
+        close();
+    }
+
+    /// @returns `true` if the recorder file was successfully opened and mapped.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: \asyncsafe.
+    constexpr explicit operator bool () const noexcept { return memory_ != 0; }
+
+    /// @brief Stores the current function call sequence along with the timestamp and
+    /// thread id into the next slot of the ring, overwriting the oldest record.
+    ///
+    /// If the slot is still being written by another thread that reserved it a whole ring ago, or it already
+    /// holds a newer record, the record is dropped rather than mixed with the other one.
+    ///
+    /// @b Complexity: O(N) where N is call sequence length.
+    ///
+    /// @b Async-Handler-Safety: \asyncsafe.
+    ///
+    /// @returns Stored call sequence depth, 0 if the recorder is not opened or the record was dropped.
+    ///
+    /// @param skip How many top calls to skip and do not store.
+    BOOST_NOINLINE std::size_t record(std::size_t skip = 0) noexcept {
+#if !defined(BOOST_WINDOWS)
+        namespace bsd = boost::stacktrace::detail;
+        if (!memory_) {
+            return 0;
+        }
+
+        bsd::flight_recorder_header* h = header();
+        const std::uint64_t number = h->next.fetch_add(1, std::memory_order_relaxed);
+        bsd::flight_recorder_slot* s = slot(number % h->slots_count);
+
+        // Claiming the slot and marking it as incomplete, so that a crash in the middle of writing is detectable.
+        // Writers whose numbers differ by a multiple of slots_count could come to the same slot at the same time.
+        std::uint64_t previous = s->sequence.load(std::memory_order_relaxed);
+        do {
+            if ((previous & bsd::flight_recorder_writing) || previous > number) {
+                return 0;
+            }
+        } while (!s->sequence.compare_exchange_weak(previous, (number + 1) | bsd::flight_recorder_writing, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        s->timestamp_ns = bsd::now_ns();
+        s->thread_id = bsd::current_thread_id();
+        bsd::native_frame_ptr_t* frames = reinterpret_cast<bsd::native_frame_ptr_t*>(s + 1);
+        const std::size_t frames_count = bsd::this_thread_frames::collect(
+            frames, static_cast<std::size_t>(h->max_depth), skip + 1
+        );
+        s->frames_count = frames_count;
+
+        s->sequence.store(number + 1, std::memory_order_release);
+        return frames_count;
+#else
+        (void)skip;
+        return 0;
+#endif
+    }
+
+    /// @brief Reads the flight recorder file.
+    ///
+    /// Records that were being written at the moment of the crash, or that were overwritten
+    /// concurrently with the reading, are skipped.
+    ///
+    /// @b Complexity: O(slots_count * log(slots_count) + last_n * max_depth).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @returns Up to `last_n` most recent records in the order they were written.
+    /// Returns an empty vector if the file does not exist or is not a flight recorder file.
+    ///
+    /// @param file Path to the recorder file.
+    ///
+    /// @param last_n Max count of records to return.
+    static std::vector<flight_recorder_entry> read(const char* file, std::size_t last_n = static_cast<std::size_t>(-1)) {
+        std::vector<flight_recorder_entry> result;
+#if !defined(BOOST_WINDOWS)
+        namespace bsd = boost::stacktrace::detail;
+
+        const int fd = ::open(file, O_RDONLY);
+        if (fd == -1) {
+            return result;
+        }
+
+        struct ::stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(bsd::flight_recorder_header)) {
+            ::close(fd);
+            return result;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return result;
+        }
+
+        const unsigned char* memory = static_cast<const unsigned char*>(p);
+        const bsd::flight_recorder_header& h = *reinterpret_cast<const bsd::flight_recorder_header*>(memory);
+        if (!bsd::flight_recorder_header_valid(h, size)) {
+            ::munmap(p, size);
+            return result;
+        }
+
+        struct slot_ref {
+            std::uint64_t sequence;
+            const bsd::flight_recorder_slot* slot;
+
+            bool operator<(const slot_ref& other) const noexcept {
+                return sequence > other.sequence;
+            }
+        };
+
+        std::vector<slot_ref> slots;
+        slots.reserve(static_cast<std::size_t>(h.slots_count));
+        for (std::uint64_t i = 0; i < h.slots_count; ++i) {
+            const bsd::flight_recorder_slot* s = reinterpret_cast<const bsd::flight_recorder_slot*>(
+                memory + sizeof(bsd::flight_recorder_header) + i * h.slot_size
+            );
+            const std::uint64_t sequence = s->sequence.load(std::memory_order_acquire);
+            if (sequence && !(sequence & bsd::flight_recorder_writing)) {
+                slot_ref ref = {sequence, s};
+                slots.push_back(ref);
+            }
+        }
+
+        std::sort(slots.begin(), slots.end());
+        if (slots.size() > last_n) {
+            slots.resize(last_n);
+        }
+
+        result.reserve(slots.size());
+        std::vector<bsd::native_frame_ptr_t> frames;
+        for (std::size_t i = slots.size(); i > 0; --i) {
+            const slot_ref& ref = slots[i - 1];
+            flight_recorder_entry entry;
+            entry.sequence = ref.sequence - 1;
+            entry.timestamp_ns = ref.slot->timestamp_ns;
+            entry.thread_id = ref.slot->thread_id;
+
+            const std::size_t frames_count = static_cast<std::size_t>(
+                (std::min)(ref.slot->frames_count, h.max_depth)
+            );
+
+            // Adding the terminating zero frame, as from_dump expects it
+            frames.assign(frames_count + 1, 0);
+            std::memcpy(frames.data(), ref.slot + 1, frames_count * sizeof(bsd::native_frame_ptr_t));
+
+            // The slot was overwritten while we were reading it. The fence keeps the reads above before the re-check.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ref.slot->sequence.load(std::memory_order_relaxed) != ref.sequence) {
+                continue;
+            }
+            entry.trace = boost::stacktrace::stacktrace::from_dump(
+                frames.data(), frames.size() * sizeof(bsd::native_frame_ptr_t)
+            );
+            result.push_back(std::move(entry));
+        }
+
+        ::munmap(p, size);
+#else
+        (void)file;
+        (void)last_n;
+#endif
+        return result;
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_FLIGHT_RECORDER_HPP
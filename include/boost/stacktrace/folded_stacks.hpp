@@ -0,0 +1,325 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_FOLDED_STACKS_HPP
+#define BOOST_STACKTRACE_FOLDED_STACKS_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/symbolizer.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/container_hash/hash.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @file folded_stacks.hpp Aggregation of sampled stacktraces into the collapsed `root;caller;callee count` format
+/// of the flame graph tools.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Counts the identical stacktraces and writes them in the folded (collapsed) format, one line per stack:
+/// `main;handle(request const&);parse(char const*) 42`. Frames go from the outermost one to the innermost one,
+/// the line ends with the accumulated weight.
+///
+/// Stacks are merged by their hash_value() and kept as indexes of unique frames, so memory grows with the count
+/// of the distinct stacks rather than with the count of samples. Each unique frame is symbolized exactly once,
+/// on the first output that needs it. Stacks that differ only by the call sites inside the same functions produce
+/// the same text and are written as a single line.
+///
+/// Frames without a known name are written as hexadecimal addresses. `;` in the names is replaced with `:`,
+/// line breaks with spaces.
+///
+/// The object is not thread safe. Call clear() after unloading shared libraries, as their addresses could be
+/// reused by other libraries.
+class folded_stacks {
+    /// @cond
+    struct stack_info {
+        std::size_t first;      // position in frames_
+        std::size_t size;
+        std::uint64_t weight;
+    };
+
+    boost::stacktrace::symbolizer symbolizer_;
+
+    std::vector<std::uint32_t> frames_;                             // stacks one after another, innermost frame first
+    std::vector<stack_info> stacks_;
+    std::unordered_multimap<std::size_t, std::size_t> stack_ids_;   // hash_value of the stack -> index in stacks_
+
+    std::unordered_map<const void*, std::uint32_t> frame_ids_;      // address -> index in addresses_
+    std::vector<const void*> addresses_;
+    std::vector<std::uint32_t> frame_names_;                        // index in addresses_ -> index in names_
+    std::unordered_map<std::string, std::uint32_t> name_ids_;
+    std::vector<const std::string*> names_;                         // keys of name_ids_
+
+    std::uint64_t total_weight_;
+
+    folded_stacks(const folded_stacks&) = delete;
+    folded_stacks& operator=(const folded_stacks&) = delete;
+
+    std::uint32_t frame_id(const void* address) {
+        const std::pair<std::unordered_map<const void*, std::uint32_t>::iterator, bool> res = frame_ids_.emplace(
+            address, static_cast<std::uint32_t>(addresses_.size())
+        );
+        if (res.second) {
+            addresses_.push_back(address);
+        }
+        return res.first->second;
+    }
+
+    bool same_stack(const stack_info& s, const frame* frames, std::size_t size) const noexcept {
+        if (s.size != size) {
+            return false;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            if (addresses_[frames_[s.first + i]] != frames[i].address()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool same_text(const stack_info& lhs, const stack_info& rhs) const noexcept {
+        if (lhs.size != rhs.size) {
+            return false;
+        }
+        for (std::size_t i = 0; i < lhs.size; ++i) {
+            if (frame_names_[frames_[lhs.first + i]] != frame_names_[frames_[rhs.first + i]]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Symbolizes the frames that were not seen by the previous outputs
+    void resolve_new_frames() {
+        std::string name;
+        for (std::size_t i = frame_names_.size(); i < addresses_.size(); ++i) {
+            name = symbolizer_.name(frame(addresses_[i]));
+            if (name.empty()) {
+                name = boost::stacktrace::detail::to_hex_array(addresses_[i]).data();
+            }
+            for (std::size_t j = 0; j < name.size(); ++j) {
+                if (name[j] == ';') {
+                    name[j] = ':';
+                } else if (name[j] == '\n' || name[j] == '\r') {
+                    name[j] = ' ';
+                }
+            }
+
+            const std::pair<std::unordered_map<std::string, std::uint32_t>::iterator, bool> res = name_ids_.emplace(
+                name, static_cast<std::uint32_t>(names_.size())
+            );
+            if (res.second) {
+                names_.push_back(&res.first->first);
+            }
+            frame_names_.push_back(res.first->second);
+        }
+    }
+
+    // Calls `f(line)` for each line of the output, `line` includes the trailing '\n'
+    template <class F>
+    void for_each_line(F f) {
+        resolve_new_frames();
+
+        // Merging the stacks that differ only in addresses inside the same functions
+        std::vector<std::uint64_t> weights(stacks_.size());
+        std::unordered_multimap<std::size_t, std::size_t> texts;
+        for (std::size_t i = 0; i < stacks_.size(); ++i) {
+            const stack_info& s = stacks_[i];
+            if (!s.size || !s.weight) {
+                continue;
+            }
+
+            std::size_t seed = 0;
+            for (std::size_t j = 0; j < s.size; ++j) {
+                boost::hash_combine(seed, frame_names_[frames_[s.first + j]]);
+            }
+
+            std::size_t line = i;
+            const std::pair<std::unordered_multimap<std::size_t, std::size_t>::iterator,
+                std::unordered_multimap<std::size_t, std::size_t>::iterator> range = texts.equal_range(seed);
+            for (std::unordered_multimap<std::size_t, std::size_t>::iterator it = range.first; it != range.second; ++it) {
+                if (same_text(stacks_[it->second], s)) {
+                    line = it->second;
+                    break;
+                }
+            }
+            if (line == i) {
+                texts.emplace(seed, i);
+            }
+            weights[line] += s.weight;
+        }
+
+        std::string line;
+        for (std::size_t i = 0; i < stacks_.size(); ++i) {
+            if (!weights[i]) {
+                continue;
+            }
+
+            const stack_info& s = stacks_[i];
+            line.clear();
+            for (std::size_t j = s.size; j > 0; --j) {
+                line += *names_[frame_names_[frames_[s.first + j - 1]]];
+                line += ';';
+            }
+            line.back() = ' ';
+            line += std::to_string(weights[i]);
+            line += '\n';
+            f(line);
+        }
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates an empty aggregator that symbolizes the frames with the chosen implementation,
+    /// see boost::stacktrace::symbolizer::symbolizer(symbolizer_backend).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    /// @throws std::bad_alloc if not enough memory.
+    explicit folded_stacks(symbolizer_backend backend = symbolizer_backend::default_backend)
+        : symbolizer_(backend)
+        , total_weight_(0)
+    {}
+
+    /// @brief Adds `weight` samples of the stack, innermost frame first as in boost::stacktrace::stacktrace.
+    ///
+    /// @returns Identifier of the stack, same for the identical stacks. Could be passed to add_weight()
+    /// to count the stack again without hashing and comparing the frames.
+    ///
+    /// @b Complexity: O(size) amortized, no symbolization is done.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::size_t add(const frame* frames, std::size_t size, std::uint64_t weight = 1) {
+        total_weight_ += weight;
+
+        const std::size_t hash = boost::hash_range(frames, frames + size);
+        const std::pair<std::unordered_multimap<std::size_t, std::size_t>::iterator,
+            std::unordered_multimap<std::size_t, std::size_t>::iterator> range = stack_ids_.equal_range(hash);
+        for (std::unordered_multimap<std::size_t, std::size_t>::iterator it = range.first; it != range.second; ++it) {
+            if (same_stack(stacks_[it->second], frames, size)) {
+                stacks_[it->second].weight += weight;
+                return it->second;
+            }
+        }
+
+        const stack_info s = {frames_.size(), size, weight};
+        for (std::size_t i = 0; i < size; ++i) {
+            frames_.push_back(frame_id(frames[i].address()));
+        }
+        stacks_.push_back(s);
+        stack_ids_.emplace(hash, stacks_.size() - 1);
+        return stacks_.size() - 1;
+    }
+
+    /// @brief Adds `weight` samples of the stacktrace.
+    ///
+    /// @returns Identifier of the stack, same for the identical stacks.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class Allocator>
+    std::size_t add(const basic_stacktrace<Allocator>& bt, std::uint64_t weight = 1) {
+        return add(bt ? &bt.as_vector()[0] : static_cast<const frame*>(0), bt.size(), weight);
+    }
+
+    /// @brief Adds `weight` samples of the stack that was previously added and returned the `stack_id`.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void add_weight(std::size_t stack_id, std::uint64_t weight = 1) noexcept {
+        BOOST_ASSERT(stack_id < stacks_.size());
+        total_weight_ += weight;
+        stacks_[stack_id].weight += weight;
+    }
+
+    /// @returns Count of the distinct stacks.
+    std::size_t size() const noexcept { return stacks_.size(); }
+
+    /// @returns true if no stacks were added.
+    bool empty() const noexcept { return stacks_.empty(); }
+
+    /// @returns Sum of the weights of all the added samples.
+    std::uint64_t total_weight() const noexcept { return total_weight_; }
+
+    /// @brief Calls `f(frames, size, weight)` for each distinct stack in the order of addition, frames are passed
+    /// as `const frame*`, innermost frame first. Stacks are not merged by their text and are not symbolized.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class F>
+    void for_each_stack(F f) const {
+        std::vector<frame> buffer;
+        for (std::size_t i = 0; i < stacks_.size(); ++i) {
+            const stack_info& s = stacks_[i];
+            buffer.clear();
+            for (std::size_t j = 0; j < s.size; ++j) {
+                buffer.push_back(frame(addresses_[frames_[s.first + j]]));
+            }
+            f(buffer.empty() ? static_cast<const frame*>(0) : &buffer[0], s.size, s.weight);
+        }
+    }
+
+    /// @brief Appends the folded stacks to `out`, one line per stack. Empty stacks and stacks without weight are skipped.
+    ///
+    /// @b Complexity: O(N) where N is the total count of frames in the distinct stacks, plus the symbolization of the frames
+    /// that were not written before.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void append_to(std::string& out) {
+        for_each_line([&out](const std::string& line) { out += line; });
+    }
+
+    /// @returns The folded stacks, see append_to().
+    std::string str() {
+        std::string res;
+        append_to(res);
+        return res;
+    }
+
+    /// @brief Writes the folded stacks to `os` line by line, see append_to().
+    template <class CharT, class TraitsT>
+    void write(std::basic_ostream<CharT, TraitsT>& os) {
+        for_each_line([&os](const std::string& line) { os << line.c_str(); });
+    }
+
+    /// @brief Drops all the stacks, resets the weights and forgets the names of the frames. Stack identifiers
+    /// returned by add() become invalid.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void clear() {
+        frames_.clear();
+        stacks_.clear();
+        stack_ids_.clear();
+        frame_ids_.clear();
+        addresses_.clear();
+        frame_names_.clear();
+        names_.clear();
+        name_ids_.clear();
+        total_weight_ = 0;
+        symbolizer_.clear();
+    }
+};
+
+/// Writes the folded stacks to the output stream `os`, see boost::stacktrace::folded_stacks::write().
+template <class CharT, class TraitsT>
+std::basic_ostream<CharT, TraitsT>& operator<<(std::basic_ostream<CharT, TraitsT>& os, folded_stacks& stacks) {
+    stacks.write(os);
+    return os;
+}
+
+}} // namespace boost::stacktrace
+
+#endif // BOOST_STACKTRACE_FOLDED_STACKS_HPP
@@ -0,0 +1,278 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_FORKED_DUMP_HPP
+#define BOOST_STACKTRACE_FORKED_DUMP_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if !defined(BOOST_WINDOWS)
+#   include <cerrno>
+#   include <csignal>
+#   include <fcntl.h>      // ::open
+#   include <sys/wait.h>   // ::waitpid
+#   include <time.h>       // ::clock_gettime, ::nanosleep
+#   include <unistd.h>     // ::write, ::_exit
+#   if defined(__linux__)
+#       include <sys/syscall.h>    // SYS_clone
+#   endif
+#endif
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file forked_dump.hpp \asyncsafe functions that write a fully symbolized call sequence from a
+/// fatal signal handler by symbolizing it in a forked child process.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+#if !defined(BOOST_WINDOWS)
+
+struct forked_dump {
+    static bool write_all(int fd, const char* data, std::size_t size) noexcept {
+        while (size) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    // Fork that does not run the pthread_atfork handlers, which are not async signal safe
+    static pid_t fork_process() noexcept {
+#if defined(__GLIBC__) && defined(__USE_GNU) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+        return ::_Fork();
+#elif defined(__linux__) && defined(SYS_clone)
+        return static_cast<pid_t>(::syscall(SYS_clone, SIGCHLD, 0, 0, 0, 0));
+#else
+        return ::fork();
+#endif
+    }
+
+    static std::int64_t now_ms() noexcept {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    // Runs in the child: the address space is a frozen copy of the crashed process, so any code
+    // could be used. Only the thread that called fork exists in the child.
+    BOOST_NORETURN static void symbolize(int fd, const native_frame_ptr_t* frames, std::size_t frames_count) noexcept {
+        // Crash of the child must not get into the handlers of the parent
+        const int fatal_signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP};
+        for (std::size_t i = 0; i < sizeof(fatal_signals) / sizeof(fatal_signals[0]); ++i) {
+            ::signal(fatal_signals[i], SIG_DFL);
+        }
+
+        try {
+            const std::string report = boost::stacktrace::to_string(boost::stacktrace::stacktrace::from_dump(
+                frames, (frames_count + 1) * sizeof(native_frame_ptr_t)
+            ));
+            ::_exit(write_all(fd, report.data(), report.size()) ? 0 : 1);
+        } catch (...) {}
+        ::_exit(1);
+    }
+
+    // Fallback if the child failed, timed out or was reaped by someone else
+    static void write_addresses(int fd, const native_frame_ptr_t* frames, std::size_t frames_count) noexcept {
+        static const char header[] = "Symbolization failed, raw frames:\n";
+        write_all(fd, header, sizeof(header) - 1);
+        for (std::size_t i = 0; i < frames_count; ++i) {
+            char line[64];
+            std::size_t size = 0;
+            if (i < 10) {
+                line[size++] = ' ';
+            }
+            const auto index = boost::stacktrace::detail::to_dec_array(i);
+            const std::size_t index_size = std::strlen(index.data());
+            std::memcpy(line + size, index.data(), index_size);
+            size += index_size;
+            line[size++] = '#';
+            line[size++] = ' ';
+            const auto addr = boost::stacktrace::detail::to_hex_array(frames[i]);
+            const std::size_t addr_size = std::strlen(addr.data());
+            std::memcpy(line + size, addr.data(), addr_size);
+            size += addr_size;
+            line[size++] = '\n';
+            write_all(fd, line, size);
+        }
+    }
+
+    static bool run(int fd, const native_frame_ptr_t* frames, std::size_t frames_count, std::int64_t timeout_ms) noexcept {
+        const pid_t pid = fork_process();
+        if (pid == 0) {
+            symbolize(fd, frames, frames_count);
+        }
+        if (pid < 0) {
+            write_addresses(fd, frames, frames_count);
+            return false;
+        }
+
+        const std::int64_t deadline = now_ms() + timeout_ms;
+        int status = 0;
+        for (;;) {
+            const pid_t res = ::waitpid(pid, &status, WNOHANG);
+            if (res == pid) {
+                break;
+            }
+            if (res < 0 && errno != EINTR) {
+                // SIGCHLD is ignored and the child was reaped automatically, its result is unknown
+                status = -1;
+                break;
+            }
+            if (now_ms() >= deadline) {
+                // The child is probably stuck on a lock that was held by the crashed code
+                ::kill(pid, SIGKILL);
+                while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+                status = -1;
+                break;
+            }
+            timespec delay = {0, 1000000};
+            ::nanosleep(&delay, nullptr);
+        }
+
+        if (status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            return true;
+        }
+        write_addresses(fd, frames, frames_count);
+        return false;
+    }
+
+    BOOST_NOINLINE static bool dump_to(int fd, std::size_t skip, std::size_t max_depth, std::chrono::milliseconds timeout) noexcept {
+        native_frame_ptr_t buffer[boost::stacktrace::detail::max_frames_dump + 1];
+        if (max_depth > boost::stacktrace::detail::max_frames_dump) {
+            max_depth = boost::stacktrace::detail::max_frames_dump;
+        }
+
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(buffer, max_depth, skip + 1);
+        buffer[frames_count] = 0;
+        return run(fd, buffer, frames_count, static_cast<std::int64_t>(timeout.count()));
+    }
+
+    BOOST_NOINLINE static bool dump_to(const char* file, std::size_t skip, std::size_t max_depth, std::chrono::milliseconds timeout) noexcept {
+        native_frame_ptr_t buffer[boost::stacktrace::detail::max_frames_dump + 1];
+        if (max_depth > boost::stacktrace::detail::max_frames_dump) {
+            max_depth = boost::stacktrace::detail::max_frames_dump;
+        }
+
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(buffer, max_depth, skip + 1);
+        buffer[frames_count] = 0;
+
+        const int fd = ::open(file, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, S_IFREG | S_IWUSR | S_IRUSR);
+        if (fd < 0) {
+            return false;
+        }
+        const bool res = run(fd, buffer, frames_count, static_cast<std::int64_t>(timeout.count()));
+        ::close(fd);
+        return res;
+    }
+};
+
+#else
+
+struct forked_dump {
+    template <class T>
+    static bool dump_to(T, std::size_t, std::size_t, std::chrono::milliseconds) noexcept {
+        return false;
+    }
+};
+
+#endif
+
+} // namespace detail
+/// @endcond
+
+/// Default time to wait for the child process in boost::stacktrace::forked_dump_to.
+BOOST_CONSTEXPR_OR_CONST std::chrono::milliseconds forked_dump_default_timeout = std::chrono::milliseconds(5000);
+
+/// @brief Writes the current function call sequence with function names and source locations into the
+/// file descriptor, symbolizing it in a forked child process.
+///
+/// The frames are collected in an async signal safe way, then the process forks without running the
+/// `pthread_atfork` handlers. The child inherits a frozen copy of the address space and runs the
+/// full boost::stacktrace::to_string() with the implementation the program is built with, while the parent
+/// waits for it. If the child fails or does not finish in `timeout`, for example because the crashed code held
+/// a lock that the symbolization needs, the child is killed and the raw addresses are written instead.
+///
+/// @b Complexity: O(N) in the calling process where N is call sequence length.
+///
+/// @b Async-Handler-Safety: \asyncsafe.
+///
+/// @returns true if the symbolized call sequence was written.
+///
+/// @b Platforms: POSIX. On other platforms nothing is written and false is returned.
+BOOST_FORCEINLINE bool forked_dump_to(int fd, std::chrono::milliseconds timeout = forked_dump_default_timeout) noexcept {
+    return boost::stacktrace::detail::forked_dump::dump_to(fd, 0, boost::stacktrace::detail::max_frames_dump, timeout);
+}
+
+/// @brief Writes the current function call sequence with function names and source locations into the
+/// file descriptor, symbolizing it in a forked child process. See forked_dump_to(int, std::chrono::milliseconds).
+///
+/// @b Async-Handler-Safety: \asyncsafe.
+///
+/// @param skip How many top calls to skip and do not write.
+///
+/// @param max_depth Max call sequence depth to write.
+BOOST_FORCEINLINE bool forked_dump_to(std::size_t skip, std::size_t max_depth, int fd,
+    std::chrono::milliseconds timeout = forked_dump_default_timeout) noexcept
+{
+    return boost::stacktrace::detail::forked_dump::dump_to(fd, skip, max_depth, timeout);
+}
+
+/// @brief Opens a file and rewrites its content with the current function call sequence with function names and
+/// source locations, symbolizing it in a forked child process. See forked_dump_to(int, std::chrono::milliseconds).
+///
+/// @b Async-Handler-Safety: \asyncsafe.
+BOOST_FORCEINLINE bool forked_dump_to(const char* file, std::chrono::milliseconds timeout = forked_dump_default_timeout) noexcept {
+    return boost::stacktrace::detail::forked_dump::dump_to(file, 0, boost::stacktrace::detail::max_frames_dump, timeout);
+}
+
+/// @brief Opens a file and rewrites its content with the current function call sequence with function names and
+/// source locations, symbolizing it in a forked child process. See forked_dump_to(int, std::chrono::milliseconds).
+///
+/// @b Async-Handler-Safety: \asyncsafe.
+///
+/// @param skip How many top calls to skip and do not write.
+///
+/// @param max_depth Max call sequence depth to write.
+BOOST_FORCEINLINE bool forked_dump_to(std::size_t skip, std::size_t max_depth, const char* file,
+    std::chrono::milliseconds timeout = forked_dump_default_timeout) noexcept
+{
+    return boost::stacktrace::detail::forked_dump::dump_to(file, skip, max_depth, timeout);
+}
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_FORKED_DUMP_HPP
@@ -52,10 +52,25 @@ inline std::size_t hash_value(const frame& f) noexcept {
 /// Outputs stacktrace::frame in a human readable format to string; unsafe to use in async handlers.
 BOOST_STACKTRACE_FUNCTION std::string to_string(const frame& f);
 
+/// Appends stacktrace::frame in a human readable format to `out`, no temporary strings are created; unsafe to use in async handlers.
+inline void append_to_string(std::string& out, const frame& f) {
+    boost::stacktrace::detail::to_string(f, boost::stacktrace::detail::make_text_sink(out));
+}
+
+/// Writes stacktrace::frame in a human readable format to `out`. At most `size - 1` characters are written, followed
+/// by a terminating zero; unsafe to use in async handlers.
+/// @returns Length of the whole description, the output was truncated if it is not less than `size`.
+inline std::size_t to_string(const frame& f, char* out, std::size_t size) {
+    return boost::stacktrace::detail::format_to_chars(out, size, [&f](boost::stacktrace::detail::text_sink sink) {
+        boost::stacktrace::detail::to_string(f, sink);
+    });
+}
+
 /// Outputs stacktrace::frame in a human readable format to output stream; unsafe to use in async handlers.
 template <class CharT, class TraitsT>
 std::basic_ostream<CharT, TraitsT>& operator<<(std::basic_ostream<CharT, TraitsT>& os, const frame& f) {
-    return os << boost::stacktrace::to_string(f);
+    boost::stacktrace::detail::to_string(f, boost::stacktrace::detail::make_text_sink(os));
+    return os;
 }
 
 }} // namespace boost::stacktrace
@@ -0,0 +1,532 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_HEAP_PROFILER_HPP
+#define BOOST_STACKTRACE_HEAP_PROFILER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/pprof_writer.hpp>
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file heap_profiler.hpp Sampling heap profiler that attributes the allocated and the in-use memory to the allocation stacks.
+
+namespace boost { namespace stacktrace {
+
+class heap_profiler;
+
+/// @cond
+namespace detail {
+
+    // State of the sampling in the current thread. Trivial, so it is constant initialized and usable
+    // from the allocation functions at any time of the thread life.
+    struct heap_profiler_thread {
+        std::int64_t bytes_until_sample;
+        std::uint64_t random;
+        bool initialized;
+        bool busy;      // inside the profiler, allocations of the profiler itself are not sampled
+    };
+
+    inline heap_profiler_thread& heap_profiler_this_thread() noexcept {
+        static thread_local heap_profiler_thread state;
+        return state;
+    }
+
+    class heap_profiler_busy_scope {
+        heap_profiler_thread& state_;
+        const bool was_busy_;
+
+        heap_profiler_busy_scope(const heap_profiler_busy_scope&) = delete;
+        heap_profiler_busy_scope& operator=(const heap_profiler_busy_scope&) = delete;
+
+    public:
+        heap_profiler_busy_scope() noexcept
+            : state_(boost::stacktrace::detail::heap_profiler_this_thread())
+            , was_busy_(state_.busy)
+        {
+            state_.busy = true;
+        }
+
+        ~heap_profiler_busy_scope() {
+            state_.busy = was_busy_;
+        }
+    };
+
+    // All of them are constant initialized, so they could be used by the allocations before main()
+    inline std::atomic<heap_profiler*>& heap_profiler_active() noexcept {
+        static std::atomic<heap_profiler*> profiler(nullptr);
+        return profiler;
+    }
+
+    inline std::atomic<std::size_t>& heap_profiler_in_flight() noexcept {
+        static std::atomic<std::size_t> count(0);
+        return count;
+    }
+
+    inline std::atomic<std::uint64_t>& heap_profiler_interval() noexcept {
+        static std::atomic<std::uint64_t> interval(0);
+        return interval;
+    }
+
+    // Counting filter of the addresses of the sampled live allocations. Zero counter means that the address
+    // was not sampled, so most of the deallocations are filtered out without locking.
+    enum { heap_profiler_filter_size = 1 << 14 };
+
+    inline std::atomic<std::uint32_t>& heap_profiler_filter(const void* ptr) noexcept {
+        static std::atomic<std::uint32_t> counters[heap_profiler_filter_size];
+        const std::uintptr_t v = reinterpret_cast<std::uintptr_t>(ptr);
+        return counters[((v >> 4) ^ (v >> 18)) & (heap_profiler_filter_size - 1)];
+    }
+
+    // Exponentially distributed count of bytes with the mean `interval`, so the sampled allocations form a Poisson process
+    inline std::int64_t heap_profiler_next_interval(heap_profiler_thread& t, std::uint64_t interval) noexcept {
+        if (!t.random) {
+            t.random = (reinterpret_cast<std::uintptr_t>(&t) ^ boost::stacktrace::detail::now_ns()) | 1;
+        }
+        t.random ^= t.random >> 12;
+        t.random ^= t.random << 25;
+        t.random ^= t.random >> 27;
+        const double uniform = static_cast<double>(((t.random * 2685821657736338717u) >> 11) + 1) / 9007199254740992.0;
+        return static_cast<std::int64_t>(-std::log(uniform) * static_cast<double>(interval)) + 1;
+    }
+
+} // namespace detail
+/// @endcond
+
+/// @brief Estimated allocations of a single stack, see boost::stacktrace::heap_profiler::snapshot().
+struct heap_profile_entry {
+    stacktrace stack;                   ///< Stack of the allocation, innermost frame first.
+    std::uint64_t inuse_objects;        ///< Count of the allocations that are not freed yet.
+    std::uint64_t inuse_bytes;          ///< Bytes in the allocations that are not freed yet.
+    std::uint64_t alloc_objects;        ///< Count of all the allocations since start().
+    std::uint64_t alloc_bytes;          ///< Bytes in all the allocations since start().
+};
+
+/// @brief Sampling heap profiler: samples the allocations, captures their stacks and tracks the memory per stack.
+///
+/// Allocations are reported to the running profiler through record_allocation() and record_deallocation().
+/// Define the `BOOST_STACKTRACE_HEAP_PROFILER_REPLACE_OPERATOR_NEW` macro in exactly one translation unit of the program
+/// before including this header to replace the global `operator new` and `operator delete` with the ones that
+/// report to the profiler. `malloc` could be reported by the wrappers of the allocator, for example with `-Wl,--wrap=malloc`.
+///
+/// On average one allocation per `sample_interval` allocated bytes is sampled: each thread counts down the exponentially
+/// distributed count of bytes, the allocation that reaches zero is sampled. Allocations that are not sampled cost a load of
+/// an atomic and a decrement of a thread local counter, deallocations of the not sampled memory cost a lookup in a small
+/// table of atomic counters. Sampled allocations capture their stacks with boost::stacktrace::safe_dump_to() machinery into
+/// a buffer on the stack and take a lock. Reported values are estimations that are scaled by the probability of sampling,
+/// as in the tcmalloc and the Go runtime heap profiles.
+///
+/// Only one profiler could be running at a time. Allocations made by the profiler itself are not sampled.
+class heap_profiler {
+    /// @cond
+    typedef boost::stacktrace::detail::native_frame_ptr_t native_frame_ptr_t;
+
+    struct stack_info {
+        std::size_t first;          // position in frames_
+        std::size_t size;
+        double inuse_objects;
+        double inuse_bytes;
+        double alloc_objects;
+        double alloc_bytes;
+    };
+
+    struct live_allocation {
+        std::size_t stack;
+        std::size_t size;
+    };
+
+    const std::uint64_t interval_;
+
+    mutable std::mutex mutex_;
+    std::vector<native_frame_ptr_t> frames_;                        // stacks one after another, innermost frame first
+    std::vector<stack_info> stacks_;
+    std::unordered_multimap<std::size_t, std::size_t> stack_ids_;   // hash of the frames -> index in stacks_
+    std::unordered_map<const void*, live_allocation> live_;
+    std::uint64_t samples_;
+
+    heap_profiler(const heap_profiler&) = delete;
+    heap_profiler& operator=(const heap_profiler&) = delete;
+
+    // Expected count of the allocations that are represented by a sampled allocation of `size` bytes
+    double weight(std::size_t size) const noexcept {
+        return 1.0 / (1.0 - std::exp(-static_cast<double>(size ? size : 1) / static_cast<double>(interval_)));
+    }
+
+    std::size_t intern(const native_frame_ptr_t* frames, std::size_t size) {
+        const std::size_t hash = boost::hash_range(frames, frames + size);
+        const std::pair<std::unordered_multimap<std::size_t, std::size_t>::iterator,
+            std::unordered_multimap<std::size_t, std::size_t>::iterator> range = stack_ids_.equal_range(hash);
+        for (std::unordered_multimap<std::size_t, std::size_t>::iterator it = range.first; it != range.second; ++it) {
+            const stack_info& s = stacks_[it->second];
+            if (s.size == size && std::equal(frames, frames + size, frames_.begin() + static_cast<std::ptrdiff_t>(s.first))) {
+                return it->second;
+            }
+        }
+
+        const stack_info s = {frames_.size(), size, 0.0, 0.0, 0.0, 0.0};
+        frames_.insert(frames_.end(), frames, frames + size);
+        stacks_.push_back(s);
+        stack_ids_.emplace(hash, stacks_.size() - 1);
+        return stacks_.size() - 1;
+    }
+
+    void forget_locked(std::unordered_map<const void*, live_allocation>::iterator it) noexcept {
+        stack_info& s = stacks_[it->second.stack];
+        const double w = weight(it->second.size);
+        s.inuse_objects -= w;
+        s.inuse_bytes -= w * static_cast<double>(it->second.size);
+        boost::stacktrace::detail::heap_profiler_filter(it->first).fetch_sub(1, std::memory_order_relaxed);
+        live_.erase(it);
+    }
+
+    BOOST_NOINLINE void sample(const void* ptr, std::size_t size) noexcept {
+        native_frame_ptr_t frames[boost::stacktrace::detail::max_frames_dump];
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(
+            frames, boost::stacktrace::detail::max_frames_dump, 1
+        );
+
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const std::unordered_map<const void*, live_allocation>::iterator old = live_.find(ptr);
+            if (old != live_.end()) {
+                forget_locked(old); // deallocation was not reported
+            }
+
+            const std::size_t id = intern(frames, frames_count);
+            const live_allocation a = {id, size};
+            live_.emplace(ptr, a);
+            boost::stacktrace::detail::heap_profiler_filter(ptr).fetch_add(1, std::memory_order_relaxed);
+
+            stack_info& s = stacks_[id];
+            const double w = weight(size);
+            s.inuse_objects += w;
+            s.inuse_bytes += w * static_cast<double>(size);
+            s.alloc_objects += w;
+            s.alloc_bytes += w * static_cast<double>(size);
+            ++samples_;
+        } catch (...) {
+            // Not enough memory for the sample, skipping it
+        }
+    }
+
+    void forget(const void* ptr) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::unordered_map<const void*, live_allocation>::iterator it = live_.find(ptr);
+        if (it != live_.end()) {
+            forget_locked(it);
+        }
+    }
+
+    static std::uint64_t to_count(double v) noexcept {
+        return v > 0.5 ? static_cast<std::uint64_t>(v + 0.5) : 0;
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates a stopped profiler.
+    ///
+    /// @param sample_interval Mean count of the allocated bytes between the sampled allocations. Smaller values give
+    /// more precise profiles at a higher cost. 512KiB, the default of tcmalloc, costs well below 1% of the CPU time even
+    /// with millions of allocations per second.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    explicit heap_profiler(std::size_t sample_interval = 512 * 1024)
+        : interval_(sample_interval ? sample_interval : 1)
+        , samples_(0)
+    {}
+
+    /// @brief Stops the profiling, see stop().
+    ~heap_profiler() {
+        stop();
+    }
+
+    /// @brief Starts sampling the allocations of all the threads. Allocated memory counters are kept from the previous
+    /// runs, in-use memory counters are reset because the deallocations were not tracked while the profiler was stopped.
+    ///
+    /// @returns false if another profiler is running.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool start() {
+        heap_profiler* expected = 0;
+        if (boost::stacktrace::detail::heap_profiler_active().load() == this) {
+            return true;
+        }
+
+        {
+            boost::stacktrace::detail::heap_profiler_busy_scope busy;
+            std::lock_guard<std::mutex> lock(mutex_);
+            live_.clear();
+            for (std::size_t i = 0; i < stacks_.size(); ++i) {
+                stacks_[i].inuse_objects = 0;
+                stacks_[i].inuse_bytes = 0;
+            }
+        }
+
+        if (!boost::stacktrace::detail::heap_profiler_active().compare_exchange_strong(expected, this)) {
+            return false;
+        }
+        boost::stacktrace::detail::heap_profiler_interval().store(interval_);
+        return true;
+    }
+
+    /// @brief Stops sampling. In-use memory counters keep the values at the moment of the stop. Does nothing if not running.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void stop() noexcept {
+        heap_profiler* expected = this;
+        if (!boost::stacktrace::detail::heap_profiler_active().compare_exchange_strong(expected, 0)) {
+            return;
+        }
+        while (boost::stacktrace::detail::heap_profiler_in_flight().load() != 0) {
+            std::this_thread::yield();
+        }
+
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::unordered_map<const void*, live_allocation>::const_iterator it = live_.begin(); it != live_.end(); ++it) {
+            boost::stacktrace::detail::heap_profiler_filter(it->first).fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @returns true if the profiler was started and not stopped yet.
+    bool running() const noexcept {
+        return boost::stacktrace::detail::heap_profiler_active().load() == this;
+    }
+
+    /// @returns Mean count of bytes between the sampled allocations.
+    std::size_t sample_interval() const noexcept {
+        return static_cast<std::size_t>(interval_);
+    }
+
+    /// @returns Count of the sampled allocations.
+    std::uint64_t samples() const {
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return samples_;
+    }
+
+    /// @brief Reports the allocation of `size` bytes at `ptr` to the running profiler. Does nothing if no profiler is running.
+    ///
+    /// @b Complexity: O(1), the stack is captured for the sampled allocations only.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    static void record_allocation(const void* ptr, std::size_t size) noexcept {
+        if (!ptr || !boost::stacktrace::detail::heap_profiler_active().load(std::memory_order_acquire)) {
+            return;
+        }
+
+        boost::stacktrace::detail::heap_profiler_thread& t = boost::stacktrace::detail::heap_profiler_this_thread();
+        t.bytes_until_sample -= static_cast<std::int64_t>(size);
+        if (t.bytes_until_sample > 0 || t.busy) {
+            return;
+        }
+
+        const bool sample = t.initialized;
+        t.initialized = true;
+        t.bytes_until_sample = boost::stacktrace::detail::heap_profiler_next_interval(
+            t, boost::stacktrace::detail::heap_profiler_interval().load(std::memory_order_relaxed)
+        );
+        if (!sample) {
+            return; // first allocation of the thread only starts the countdown
+        }
+
+        // stop() waits for the counter to become 0 after resetting the active profiler
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        boost::stacktrace::detail::heap_profiler_in_flight().fetch_add(1);
+        if (heap_profiler* const profiler = boost::stacktrace::detail::heap_profiler_active().load()) {
+            profiler->sample(ptr, size);
+        }
+        boost::stacktrace::detail::heap_profiler_in_flight().fetch_sub(1);
+    }
+
+    /// @brief Reports the deallocation of the memory at `ptr` to the running profiler. Must be called before the memory
+    /// is returned to the allocator. Does nothing if no profiler is running.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    static void record_deallocation(const void* ptr) noexcept {
+        if (!ptr || !boost::stacktrace::detail::heap_profiler_active().load(std::memory_order_acquire)
+            || !boost::stacktrace::detail::heap_profiler_filter(ptr).load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        boost::stacktrace::detail::heap_profiler_thread& t = boost::stacktrace::detail::heap_profiler_this_thread();
+        if (t.busy) {
+            return;
+        }
+
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        boost::stacktrace::detail::heap_profiler_in_flight().fetch_add(1);
+        if (heap_profiler* const profiler = boost::stacktrace::detail::heap_profiler_active().load()) {
+            profiler->forget(ptr);
+        }
+        boost::stacktrace::detail::heap_profiler_in_flight().fetch_sub(1);
+    }
+
+    /// @returns Estimated allocations per stack, sorted by the in-use bytes in descending order. Stacks without
+    /// allocations since start() are not included.
+    ///
+    /// @b Complexity: O(N) where N is the total count of frames in the distinct stacks, no symbolization is done.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::vector<heap_profile_entry> snapshot() const {
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        std::vector<heap_profile_entry> res;
+        std::vector<native_frame_ptr_t> buffer;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        res.reserve(stacks_.size());
+        for (std::size_t i = 0; i < stacks_.size(); ++i) {
+            const stack_info& s = stacks_[i];
+            const heap_profile_entry e = {
+                stacktrace(0, 0), to_count(s.inuse_objects), to_count(s.inuse_bytes), to_count(s.alloc_objects), to_count(s.alloc_bytes)
+            };
+            if (!e.alloc_objects) {
+                continue;
+            }
+
+            buffer.assign(frames_.begin() + static_cast<std::ptrdiff_t>(s.first), frames_.begin() + static_cast<std::ptrdiff_t>(s.first + s.size));
+            buffer.push_back(0); // terminating frame, as in the buffers of boost::stacktrace::safe_dump_to()
+            res.push_back(e);
+            res.back().stack = stacktrace::from_dump(&buffer[0], buffer.size() * sizeof(buffer[0]));
+        }
+        lock.unlock();
+
+        std::sort(res.begin(), res.end(), [](const heap_profile_entry& lhs, const heap_profile_entry& rhs) {
+            return lhs.inuse_bytes > rhs.inuse_bytes;
+        });
+        return res;
+    }
+
+    /// @brief Writes the snapshot() to the gzipped pprof profile `file` with the "alloc_objects", "alloc_space",
+    /// "inuse_objects" and "inuse_space" values per sample, as in the heap profiles of Go.
+    ///
+    /// @returns false on I/O errors.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool write_pprof(const char* file, symbolizer_backend backend = symbolizer_backend::default_backend) const {
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        const std::vector<heap_profile_entry> entries = snapshot();
+
+        boost::stacktrace::pprof_writer writer(file, {
+            pprof_value_type{"alloc_objects", "count"}, pprof_value_type{"alloc_space", "bytes"},
+            pprof_value_type{"inuse_objects", "count"}, pprof_value_type{"inuse_space", "bytes"}
+        }, backend);
+        writer.set_period(pprof_value_type{"space", "bytes"}, static_cast<std::int64_t>(interval_));
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            writer.add(entries[i].stack, {
+                static_cast<std::int64_t>(entries[i].alloc_objects), static_cast<std::int64_t>(entries[i].alloc_bytes),
+                static_cast<std::int64_t>(entries[i].inuse_objects), static_cast<std::int64_t>(entries[i].inuse_bytes)
+            });
+        }
+        return writer.close();
+    }
+
+    /// @brief Drops all the stacks and counters. Allocations that are alive are no longer tracked.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void clear() {
+        boost::stacktrace::detail::heap_profiler_busy_scope busy;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running()) {
+            for (std::unordered_map<const void*, live_allocation>::const_iterator it = live_.begin(); it != live_.end(); ++it) {
+                boost::stacktrace::detail::heap_profiler_filter(it->first).fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        live_.clear();
+        frames_.clear();
+        stacks_.clear();
+        stack_ids_.clear();
+        samples_ = 0;
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#if defined(BOOST_STACKTRACE_HEAP_PROFILER_REPLACE_OPERATOR_NEW)
+
+#include <cstdlib>
+#include <new>
+
+// Replacing the array forms is required, sanitizers replace them with ones that do not call the operators below.
+// Other forms of the operators call these ones by default.
+void* operator new(std::size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    while (!ptr) {
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+        ptr = std::malloc(size ? size : 1);
+    }
+    boost::stacktrace::heap_profiler::record_allocation(ptr, size);
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept {
+    boost::stacktrace::heap_profiler::record_deallocation(ptr);
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void* ptr) noexcept {
+    ::operator delete(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* ptr, std::size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    ::operator delete(ptr);
+}
+#endif
+
+#endif // defined(BOOST_STACKTRACE_HEAP_PROFILER_REPLACE_OPERATOR_NEW)
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_HEAP_PROFILER_HPP
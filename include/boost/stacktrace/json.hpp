@@ -0,0 +1,70 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_JSON_HPP
+#define BOOST_STACKTRACE_JSON_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/frame.hpp>
+#include <boost/stacktrace/stacktrace.hpp>
+
+#include <cstddef>
+#include <string>
+
+/// @file json.hpp Structured output of stacktraces for log pipelines. A stacktrace is written as a JSON array of objects:
+/// `{"index":0,"address":"0x7f..","module":"/usr/lib/libfoo.so","offset":"0x1a2b","function":"foo(int)","file":"foo.cpp","line":42}`.
+/// `offset` is the address relative to the load address of the `module`. Unknown values are `null`. Addresses and offsets are
+/// hexadecimal strings, as JSON numbers may not hold 64 bit values. The output is a single line without spaces.
+
+namespace boost { namespace stacktrace {
+
+/// Appends the JSON object of the frame to `out`, `null` for an empty frame; unsafe to use in async handlers.
+inline void append_to_json(std::string& out, const frame& f) {
+    boost::stacktrace::detail::to_json(f, boost::stacktrace::detail::make_text_sink(out));
+}
+
+/// Appends the JSON array of the stacktrace frames to `out`, fields are produced directly by the symbolization
+/// implementation without parsing the to_string() output; unsafe to use in async handlers.
+template <class Allocator>
+void append_to_json(std::string& out, const basic_stacktrace<Allocator>& bt) {
+    boost::stacktrace::detail::to_json(
+        bt ? &bt.as_vector()[0] : static_cast<const frame*>(0), bt.size(), boost::stacktrace::detail::make_text_sink(out)
+    );
+}
+
+/// @returns JSON object of the frame, `null` for an empty frame; unsafe to use in async handlers.
+inline std::string to_json(const frame& f) {
+    std::string res;
+    boost::stacktrace::append_to_json(res, f);
+    return res;
+}
+
+/// @returns JSON array of the stacktrace frames; unsafe to use in async handlers.
+template <class Allocator>
+std::string to_json(const basic_stacktrace<Allocator>& bt) {
+    std::string res;
+    res.reserve(128 * bt.size() + 2);
+    boost::stacktrace::append_to_json(res, bt);
+    return res;
+}
+
+/// Writes the JSON array of the stacktrace frames to `out`. At most `size - 1` characters are written, followed
+/// by a terminating zero; unsafe to use in async handlers.
+/// @returns Length of the whole output, the output was truncated if it is not less than `size`.
+template <class Allocator>
+std::size_t to_json(const basic_stacktrace<Allocator>& bt, char* out, std::size_t size) {
+    return boost::stacktrace::detail::format_to_chars(out, size, [&bt](boost::stacktrace::detail::text_sink sink) {
+        boost::stacktrace::detail::to_json(bt ? &bt.as_vector()[0] : static_cast<const frame*>(0), bt.size(), sink);
+    });
+}
+
+}} // namespace boost::stacktrace
+
+#endif // BOOST_STACKTRACE_JSON_HPP
@@ -0,0 +1,356 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_PERF_EVENT_SAMPLER_HPP
+#define BOOST_STACKTRACE_PERF_EVENT_SAMPLER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#   if defined(SYS_perf_event_open)
+#       include <linux/perf_event.h>
+#       include <sys/ioctl.h>  // ::ioctl
+#       include <sys/mman.h>   // ::mmap
+#       include <unistd.h>     // ::syscall, ::close
+#       define BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED
+#   endif
+#endif
+
+/// @file perf_event_sampler.hpp Sampling of the user space callchains of the threads by the Linux kernel.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Samples the threads of the process with the `perf_event_open` software CPU clock events.
+///
+/// The kernel interrupts each sampled thread after each period of its CPU time, collects the user space callchain
+/// and writes it into the ring buffer that is shared with the process. No signals are delivered and nothing runs in
+/// the sampled threads, so the sampling is not biased to the signal delivery points and costs the threads much less
+/// than unwinding in a signal handler. poll() reads the samples from the buffers and converts the callchains into
+/// boost::stacktrace::stacktrace.
+///
+/// The kernel walks the user stacks through the frame pointers, so the code has to be compiled with
+/// `-fno-omit-frame-pointer` to get complete callchains. Only the time spent in user space is sampled.
+/// Depending on `/proc/sys/kernel/perf_event_paranoid` and the container settings the events may be unavailable,
+/// in that case add_thread() fails.
+///
+/// Works on Linux only. The object is not thread safe.
+class perf_event_sampler {
+    /// @cond
+    struct thread_event {
+        std::uint64_t tid;
+        std::uint64_t start_time;   // tells apart the threads that got the tid of an exited one
+        int fd;
+        void* buffer;
+        bool seen;
+        bool exited;
+    };
+
+    std::vector<thread_event> events_;
+    std::uint64_t period_ns_;
+    const std::size_t max_threads_;
+    const std::size_t data_pages_;
+    std::size_t page_size_;
+    std::atomic<std::uint64_t> lost_;
+    std::vector<unsigned char> record_;
+    std::vector<boost::stacktrace::detail::native_frame_ptr_t> frames_;
+
+    perf_event_sampler(const perf_event_sampler&) = delete;
+    perf_event_sampler& operator=(const perf_event_sampler&) = delete;
+
+    static std::size_t round_up_to_power_of_2(std::size_t v) noexcept {
+        std::size_t res = 1;
+        while (res < v) {
+            res <<= 1;
+        }
+        return res;
+    }
+
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+    void close_event(thread_event& e) noexcept {
+        ::munmap(e.buffer, (data_pages_ + 1) * page_size_);
+        ::close(e.fd);
+    }
+
+    // Copies `size` bytes at the position `pos` of the data area, that is a ring
+    void copy_out(const thread_event& e, std::uint64_t pos, std::size_t size, void* out) const noexcept {
+        const unsigned char* const data = static_cast<const unsigned char*>(e.buffer) + page_size_;
+        const std::size_t data_size = data_pages_ * page_size_;
+        const std::size_t offset = static_cast<std::size_t>(pos % data_size);
+        const std::size_t first = (size < data_size - offset ? size : data_size - offset);
+        std::memcpy(out, data + offset, first);
+        std::memcpy(static_cast<unsigned char*>(out) + first, data, size - first);
+    }
+
+    template <class F>
+    std::size_t poll_event(thread_event& e, F& f) {
+        ::perf_event_mmap_page* const meta = static_cast<::perf_event_mmap_page*>(e.buffer);
+        // Head and tail are shared with the kernel as plain integers, accessing them the same way as the perf tools do
+        const std::uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+
+        std::size_t res = 0;
+        std::uint64_t tail = meta->data_tail;
+        while (head - tail >= sizeof(::perf_event_header)) {
+            ::perf_event_header header;
+            copy_out(e, tail, sizeof(header), &header);
+            if (header.size < sizeof(header) || header.size > head - tail) {
+                break;
+            }
+            record_.resize(header.size);
+            copy_out(e, tail, header.size, &record_[0]);
+
+            // Releasing the space before the processing, so the record is not read twice if `f` throws
+            tail += header.size;
+            __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+
+            if (header.type == PERF_RECORD_LOST && header.size >= sizeof(header) + 2 * sizeof(std::uint64_t)) {
+                std::uint64_t lost;
+                std::memcpy(&lost, &record_[sizeof(header) + sizeof(std::uint64_t)], sizeof(lost));
+                lost_.fetch_add(lost, std::memory_order_relaxed);
+            } else if (header.type == PERF_RECORD_SAMPLE) {
+                res += process_sample(f);
+            }
+        }
+        return res;
+    }
+
+    // Sample layout for PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN: header, u32 pid, u32 tid, u64 nr, u64 ips[nr]
+    template <class F>
+    std::size_t process_sample(F& f) {
+        const std::size_t ips_offset = sizeof(::perf_event_header) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+        if (record_.size() < ips_offset) {
+            return 0;
+        }
+
+        std::uint32_t tid;
+        std::uint64_t nr;
+        std::memcpy(&tid, &record_[sizeof(::perf_event_header) + sizeof(std::uint32_t)], sizeof(tid));
+        std::memcpy(&nr, &record_[ips_offset - sizeof(nr)], sizeof(nr));
+        if (nr > (record_.size() - ips_offset) / sizeof(std::uint64_t)) {
+            return 0;
+        }
+
+        frames_.clear();
+        for (std::size_t i = 0; i < nr; ++i) {
+            std::uint64_t ip;
+            std::memcpy(&ip, &record_[ips_offset + i * sizeof(ip)], sizeof(ip));
+            if (ip >= static_cast<std::uint64_t>(PERF_CONTEXT_MAX)) {
+                continue; // PERF_CONTEXT_USER and other markers of the callchain parts
+            }
+            frames_.push_back(reinterpret_cast<boost::stacktrace::detail::native_frame_ptr_t>(static_cast<std::uintptr_t>(ip)));
+        }
+
+        frames_.push_back(0); // terminating frame, as in the buffers of boost::stacktrace::safe_dump_to()
+        const stacktrace st = stacktrace::from_dump(&frames_[0], frames_.size() * sizeof(frames_[0]));
+        f(static_cast<std::uint64_t>(tid), st);
+        return 1;
+    }
+#endif // defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+    /// @endcond
+
+public:
+    /// @brief Creates a sampler without threads.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @param frequency Count of samples per second of the CPU time of each thread.
+    ///
+    /// @param max_threads Maximal count of the sampled threads, each one takes a file descriptor and a buffer.
+    ///
+    /// @param buffer_pages Size of the buffer of each thread in memory pages, rounded up to a power of 2. The buffer
+    /// should fit the samples between the poll() calls, otherwise the samples are lost and counted in lost().
+    explicit perf_event_sampler(unsigned frequency = 99, std::size_t max_threads = 1024, std::size_t buffer_pages = 16)
+        : period_ns_(1000000000u / (frequency ? frequency : 1))
+        , max_threads_(max_threads)
+        , data_pages_(round_up_to_power_of_2(buffer_pages))
+        , page_size_(4096)
+        , lost_(0)
+    {
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        const long page_size = ::sysconf(_SC_PAGESIZE);
+        if (page_size > 0) {
+            page_size_ = static_cast<std::size_t>(page_size);
+        }
+#endif
+    }
+
+    /// @brief Stops sampling all the threads. Samples that were not polled are lost.
+    ~perf_event_sampler() {
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        for (std::size_t i = 0; i < events_.size(); ++i) {
+            close_event(events_[i]);
+        }
+#endif
+    }
+
+    /// @returns true if the platform has the `perf_event_open` system call. Events still may be unavailable
+    /// because of the system settings.
+    static bool is_supported() noexcept {
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief Starts sampling the thread with the id `tid`, as returned by `gettid()`.
+    ///
+    /// @returns true if the thread is sampled. false if the events are not available, the thread does not exist
+    /// or max_threads are already sampled.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    bool add_thread(std::uint64_t tid) {
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        const std::uint64_t start_time = boost::stacktrace::detail::thread_start_time(tid);
+        for (std::size_t i = 0; i < events_.size(); ++i) {
+            if (events_[i].tid == tid && !events_[i].exited) {
+                if (events_[i].start_time == start_time) {
+                    return true;
+                }
+                events_[i].exited = true;   // the event is bound to the exited thread
+            }
+        }
+        if (events_.size() >= max_threads_) {
+            return false;
+        }
+        events_.reserve(events_.size() + 1);
+
+        ::perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+        attr.sample_period = period_ns_;
+        attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.exclude_callchain_kernel = 1;
+
+        unsigned long flags = 0;
+#if defined(PERF_FLAG_FD_CLOEXEC)
+        flags |= PERF_FLAG_FD_CLOEXEC;
+#endif
+        const long fd = ::syscall(SYS_perf_event_open, &attr, static_cast<::pid_t>(tid), -1, -1, flags);
+        if (fd < 0) {
+            return false;
+        }
+
+        void* const buffer = ::mmap(0, (data_pages_ + 1) * page_size_, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(fd), 0);
+        if (buffer == MAP_FAILED) {
+            ::close(static_cast<int>(fd));
+            return false;
+        }
+
+        const thread_event e = {tid, start_time, static_cast<int>(fd), buffer, true, false};
+        events_.push_back(e);
+        return true;
+#else
+        (void)tid;
+        return false;
+#endif
+    }
+
+    /// @brief Starts sampling the new threads of the process, listed in `/proc/self/task`. Threads that have exited
+    /// are closed by the next poll(), after their last samples are read.
+    ///
+    /// @returns Count of the sampled threads.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::size_t update_threads() {
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        for (std::size_t i = 0; i < events_.size(); ++i) {
+            events_[i].seen = false;
+        }
+        const bool listed = boost::stacktrace::detail::for_each_thread_id([this](std::uint64_t tid) {
+            const std::uint64_t start_time = boost::stacktrace::detail::thread_start_time(tid);
+            for (std::size_t i = 0; i < events_.size(); ++i) {
+                if (events_[i].tid == tid && events_[i].start_time == start_time && !events_[i].exited) {
+                    events_[i].seen = true;
+                    return;
+                }
+            }
+            add_thread(tid);
+        });
+        for (std::size_t i = 0; listed && i < events_.size(); ++i) {
+            events_[i].exited = events_[i].exited || !events_[i].seen;
+        }
+#endif
+        return threads();
+    }
+
+    /// @returns Count of the sampled threads.
+    std::size_t threads() const noexcept {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < events_.size(); ++i) {
+            res += !events_[i].exited;
+        }
+        return res;
+    }
+
+    /// @returns Current sampling period in nanoseconds of the CPU time.
+    std::uint64_t period() const noexcept { return period_ns_; }
+
+    /// @brief Changes the sampling period of all the threads.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void set_period(std::uint64_t period_ns) noexcept {
+        period_ns_ = (period_ns ? period_ns : 1);
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        for (std::size_t i = 0; i < events_.size(); ++i) {
+            ::ioctl(events_[i].fd, PERF_EVENT_IOC_PERIOD, &period_ns_);
+        }
+#endif
+    }
+
+    /// @brief Reads the samples of all the threads and calls `f(tid, st)` for each of them, where `tid` is
+    /// `std::uint64_t` and `st` is `const boost::stacktrace::stacktrace&` with the innermost frame first.
+    ///
+    /// @returns Count of the read samples.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class F>
+    std::size_t poll(F f) {
+        std::size_t res = 0;
+#if defined(BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED)
+        for (std::size_t i = 0; i < events_.size(); ) {
+            res += poll_event(events_[i], f);
+            if (events_[i].exited) {
+                close_event(events_[i]);
+                events_[i] = events_.back();
+                events_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+#else
+        (void)f;
+#endif
+        return res;
+    }
+
+    /// @returns Count of the samples that the kernel dropped because the buffers were full.
+    std::uint64_t lost() const noexcept {
+        return lost_.load(std::memory_order_relaxed);
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#undef BOOST_STACKTRACE_DETAIL_PERF_EVENTS_SUPPORTED
+
+#endif // BOOST_STACKTRACE_PERF_EVENT_SAMPLER_HPP
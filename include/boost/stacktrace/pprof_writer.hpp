@@ -0,0 +1,363 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_PPROF_WRITER_HPP
+#define BOOST_STACKTRACE_PPROF_WRITER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/symbolizer.hpp>
+#include <boost/stacktrace/detail/gzip_writer.hpp>
+#include <boost/stacktrace/detail/module_table.hpp>
+#include <boost/stacktrace/detail/protobuf_writer.hpp>
+
+#include <boost/assert.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @file pprof_writer.hpp Writing of the captured stacktraces into gzipped pprof profiles, that are
+/// understood by `go tool pprof`, speedscope, Perfetto and many other profile viewers.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Kind of a value in the samples of a pprof profile, for example `{"samples", "count"}`,
+/// `{"cpu", "nanoseconds"}` or `{"alloc_space", "bytes"}`.
+struct pprof_value_type {
+    const char* type;
+    const char* unit;
+};
+
+/// @brief Writes weighted stacktraces into a gzipped file in the pprof `profile.proto` format.
+///
+/// Samples are encoded and compressed as they are added, so the memory usage does not depend on the count of
+/// the samples. Only the tables of the unique locations, functions, modules and strings are kept in memory and
+/// are written by close(). Each unique address is symbolized exactly once, with a reusable boost::stacktrace::symbolizer.
+///
+/// Locations reference the mappings of the loaded modules with their file names and GNU build-ids, so the profile
+/// could be symbolized again by the viewer if the debug information is not available in process.
+///
+/// The object is not thread safe.
+class pprof_writer {
+    /// @cond
+    struct location_info {
+        const void* address;
+        std::uint64_t mapping_id;   // 0 if unknown
+    };
+
+    struct mapping_info {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+        std::string name;
+        std::string build_id;       // raw bytes
+        bool has_lines;
+    };
+
+    boost::stacktrace::detail::gzip_writer out_;
+    boost::stacktrace::symbolizer symbolizer_;
+    const std::size_t values_count_;
+    const std::int64_t time_nanos_;
+    const std::chrono::steady_clock::time_point start_;
+
+    std::unordered_map<const void*, std::uint64_t> location_ids_;   // address -> index in locations_ + 1
+    std::vector<location_info> locations_;
+    std::unordered_map<std::uintptr_t, std::uint64_t> mapping_ids_; // begin of a module -> index in mappings_ + 1
+    std::vector<mapping_info> mappings_;
+    std::shared_ptr<const boost::stacktrace::detail::module_table> modules_;
+
+    std::unordered_map<std::string, std::uint64_t> string_ids_;
+    std::vector<const std::string*> strings_;                       // keys of string_ids_
+
+    std::string sample_types_;                                      // encoded `sample_type` fields
+    std::string period_;                                            // encoded `period_type` and `period` fields
+
+    std::string message_;
+    std::string scratch_;
+    std::vector<std::uint64_t> sample_locations_;
+
+    pprof_writer(const pprof_writer&) = delete;
+    pprof_writer& operator=(const pprof_writer&) = delete;
+
+    enum profile_field {
+        profile_sample_type = 1,
+        profile_sample = 2,
+        profile_mapping = 3,
+        profile_location = 4,
+        profile_function = 5,
+        profile_string_table = 6,
+        profile_time_nanos = 9,
+        profile_duration_nanos = 10,
+        profile_period_type = 11,
+        profile_period = 12
+    };
+
+    std::uint64_t string_id(const std::string& s) {
+        const std::pair<std::unordered_map<std::string, std::uint64_t>::iterator, bool> res = string_ids_.emplace(
+            s, static_cast<std::uint64_t>(strings_.size())
+        );
+        if (res.second) {
+            strings_.push_back(&res.first->first);
+        }
+        return res.first->second;
+    }
+
+    std::string encode_value_type(const pprof_value_type& v) {
+        std::string res;
+        boost::stacktrace::detail::append_varint_field(res, 1, string_id(v.type));
+        boost::stacktrace::detail::append_varint_field(res, 2, string_id(v.unit));
+        return res;
+    }
+
+    std::uint64_t mapping_id(const void* address) {
+        if (!modules_ || !modules_->find(address)) {
+            modules_ = boost::stacktrace::detail::module_table::current();
+        }
+        const boost::stacktrace::detail::module_info* m = modules_->find(address);
+        if (!m) {
+            return 0;
+        }
+
+        const std::pair<std::unordered_map<std::uintptr_t, std::uint64_t>::iterator, bool> res = mapping_ids_.emplace(
+            m->begin, static_cast<std::uint64_t>(mappings_.size() + 1)
+        );
+        if (res.second) {
+            const mapping_info info = {m->begin, m->end, m->name, m->build_id, false};
+            mappings_.push_back(info);
+        }
+        return res.first->second;
+    }
+
+    std::uint64_t location_id(const void* address) {
+        const std::pair<std::unordered_map<const void*, std::uint64_t>::iterator, bool> res = location_ids_.emplace(
+            address, static_cast<std::uint64_t>(locations_.size() + 1)
+        );
+        if (res.second) {
+            const location_info info = {address, mapping_id(address)};
+            locations_.push_back(info);
+        }
+        return res.first->second;
+    }
+
+    void write_message(unsigned field, const std::string& message) {
+        std::string& tag = scratch_;
+        tag.clear();
+        boost::stacktrace::detail::append_tag(tag, field, boost::stacktrace::detail::protobuf_length_delimited);
+        boost::stacktrace::detail::append_varint(tag, message.size());
+        out_.write(tag.data(), tag.size());
+        out_.write(message.data(), message.size());
+    }
+
+    // Symbolizes the locations and writes them along with the functions
+    void write_locations() {
+        std::unordered_map<std::uint64_t, std::uint64_t> function_ids; // name and file string ids -> function id
+        std::string line;
+        std::string function;
+        for (std::size_t i = 0; i < locations_.size(); ++i) {
+            const frame f(locations_[i].address);
+            const std::string name = symbolizer_.name(f);
+            const std::string file = (name.empty() ? std::string() : symbolizer_.source_file(f));
+            const std::size_t line_number = (name.empty() ? 0 : symbolizer_.source_line(f));
+
+            line.clear();
+            if (!name.empty()) {
+                const std::uint64_t name_id = string_id(name);
+                const std::uint64_t file_id = string_id(file);
+                const std::pair<std::unordered_map<std::uint64_t, std::uint64_t>::iterator, bool> res = function_ids.emplace(
+                    (name_id << 32) | file_id, static_cast<std::uint64_t>(function_ids.size() + 1)
+                );
+                if (res.second) {
+                    function.clear();
+                    boost::stacktrace::detail::append_varint_field(function, 1, res.first->second);
+                    boost::stacktrace::detail::append_varint_field(function, 2, name_id);
+                    boost::stacktrace::detail::append_varint_field(function, 3, name_id);
+                    boost::stacktrace::detail::append_varint_field(function, 4, file_id);
+                    write_message(profile_function, function);
+                }
+
+                boost::stacktrace::detail::append_varint_field(line, 1, res.first->second);
+                boost::stacktrace::detail::append_varint_field(line, 2, line_number);
+                if (line_number && locations_[i].mapping_id) {
+                    mappings_[locations_[i].mapping_id - 1].has_lines = true;
+                }
+            }
+
+            message_.clear();
+            boost::stacktrace::detail::append_varint_field(message_, 1, i + 1);
+            boost::stacktrace::detail::append_varint_field(message_, 2, locations_[i].mapping_id);
+            boost::stacktrace::detail::append_varint_field(message_, 3, reinterpret_cast<std::uintptr_t>(locations_[i].address));
+            if (!line.empty()) {
+                boost::stacktrace::detail::append_bytes_field(message_, 4, line);
+            }
+            write_message(profile_location, message_);
+        }
+    }
+
+    void write_mappings() {
+        static const char hex_digits[] = "0123456789abcdef"; // pprof compares build-ids in lower case
+
+        std::string build_id;
+        for (std::size_t i = 0; i < mappings_.size(); ++i) {
+            const mapping_info& m = mappings_[i];
+            build_id.clear();
+            for (std::size_t j = 0; j < m.build_id.size(); ++j) {
+                build_id += hex_digits[static_cast<unsigned char>(m.build_id[j]) >> 4];
+                build_id += hex_digits[static_cast<unsigned char>(m.build_id[j]) & 0xF];
+            }
+
+            // File offset is left zero: the first loadable segment of ELF files starts at the beginning of the file
+            message_.clear();
+            boost::stacktrace::detail::append_varint_field(message_, 1, i + 1);
+            boost::stacktrace::detail::append_varint_field(message_, 2, m.begin);
+            boost::stacktrace::detail::append_varint_field(message_, 3, m.end);
+            boost::stacktrace::detail::append_varint_field(message_, 5, string_id(m.name));
+            boost::stacktrace::detail::append_varint_field(message_, 6, string_id(build_id));
+            boost::stacktrace::detail::append_varint_field(message_, 7, 1);              // has_functions
+            boost::stacktrace::detail::append_varint_field(message_, 8, m.has_lines);    // has_filenames
+            boost::stacktrace::detail::append_varint_field(message_, 9, m.has_lines);    // has_line_numbers
+            write_message(profile_mapping, message_);
+        }
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates the file and starts the profile.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    /// @throws std::bad_alloc if not enough memory.
+    ///
+    /// @param file Path to the profile. Existing file is overwritten.
+    ///
+    /// @param sample_types Meaning of the values of each sample, at least one. Samples have as many values as there are types.
+    ///
+    /// @param backend Implementation that symbolizes the frames, see boost::stacktrace::symbolizer::symbolizer(symbolizer_backend).
+    explicit pprof_writer(const char* file,
+            std::initializer_list<pprof_value_type> sample_types = {pprof_value_type{"samples", "count"}},
+            symbolizer_backend backend = symbolizer_backend::default_backend)
+        : out_(std::fopen(file, "wb"))
+        , symbolizer_(backend)
+        , values_count_(sample_types.size())
+        , time_nanos_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count())
+        , start_(std::chrono::steady_clock::now())
+    {
+        BOOST_ASSERT_MSG(values_count_, "At least one sample type is required");
+        string_id(std::string()); // string table starts with an empty string
+
+        for (std::initializer_list<pprof_value_type>::const_iterator it = sample_types.begin(); it != sample_types.end(); ++it) {
+            boost::stacktrace::detail::append_bytes_field(sample_types_, profile_sample_type, encode_value_type(*it));
+        }
+    }
+
+    /// @brief Writes the rest of the profile, see close().
+    ~pprof_writer() {
+        close();
+    }
+
+    /// @returns `true` if the file was successfully opened.
+    explicit operator bool () const noexcept { return out_.is_open(); }
+
+    /// @brief Sets the sampling period, for example `{"cpu", "nanoseconds"}` and 10000000 for sampling each 10 milliseconds.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void set_period(pprof_value_type type, std::int64_t period) {
+        period_.clear();
+        boost::stacktrace::detail::append_bytes_field(period_, profile_period_type, encode_value_type(type));
+        boost::stacktrace::detail::append_varint_field(period_, profile_period, static_cast<std::uint64_t>(period));
+    }
+
+    /// @brief Writes a sample of the stack, innermost frame first as in boost::stacktrace::stacktrace.
+    ///
+    /// @b Complexity: O(size) amortized, no symbolization is done.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @param values As many values as there are sample types.
+    void add(const frame* frames, std::size_t size, const std::int64_t* values) {
+        if (!out_.is_open()) {
+            return;
+        }
+
+        sample_locations_.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            if (!frames[i].empty()) {
+                sample_locations_.push_back(location_id(frames[i].address()));
+            }
+        }
+
+        message_.clear();
+        boost::stacktrace::detail::append_packed_field(message_, 1, sample_locations_.data(), sample_locations_.size(), scratch_);
+        boost::stacktrace::detail::append_packed_field(message_, 2, values, values_count_, scratch_);
+        write_message(profile_sample, message_);
+    }
+
+    /// @brief Writes a sample of the stacktrace with the values for all the sample types.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class Allocator>
+    void add(const basic_stacktrace<Allocator>& bt, std::initializer_list<std::int64_t> values) {
+        BOOST_ASSERT_MSG(values.size() == values_count_, "Count of values must be equal to the count of sample types");
+        add(bt ? &bt.as_vector()[0] : static_cast<const frame*>(0), bt.size(), values.begin());
+    }
+
+    /// @brief Writes a sample of the stacktrace with a `value` for the only sample type.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    template <class Allocator>
+    void add(const basic_stacktrace<Allocator>& bt, std::int64_t value = 1) {
+        BOOST_ASSERT_MSG(values_count_ == 1, "Count of values must be equal to the count of sample types");
+        add(bt ? &bt.as_vector()[0] : static_cast<const frame*>(0), bt.size(), &value);
+    }
+
+    /// @brief Symbolizes the unique addresses, writes the tables of the profile and closes the file.
+    /// Does nothing if the file was already closed.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @returns `false` if the profile could not be written.
+    bool close() {
+        if (!out_.is_open()) {
+            return out_.finish();
+        }
+
+        out_.write(sample_types_.data(), sample_types_.size());
+        out_.write(period_.data(), period_.size());
+
+        message_.clear();
+        boost::stacktrace::detail::append_varint_field(message_, profile_time_nanos, static_cast<std::uint64_t>(time_nanos_));
+        boost::stacktrace::detail::append_varint_field(message_, profile_duration_nanos, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()
+        ));
+        out_.write(message_.data(), message_.size());
+
+        write_locations();
+        write_mappings();
+
+        // Strings go last, after all of them were collected
+        for (std::size_t i = 0; i < strings_.size(); ++i) {
+            message_.clear();
+            boost::stacktrace::detail::append_bytes_field(message_, profile_string_table, *strings_[i]);
+            out_.write(message_.data(), message_.size());
+        }
+
+        return out_.finish();
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#endif // BOOST_STACKTRACE_PPROF_WRITER_HPP
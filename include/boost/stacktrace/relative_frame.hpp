@@ -0,0 +1,180 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_RELATIVE_FRAME_HPP
+#define BOOST_STACKTRACE_RELATIVE_FRAME_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/module_table.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// @file relative_frame.hpp Frames that are identified by module and offset in it, rather than by
+/// the absolute address. Such frames stay the same across processes and restarts of the same binary.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Frame that is stored as a module identifier and an offset inside that module.
+///
+/// Module identifier is a hash of the GNU build-id of the module, or of the module file name if
+/// the module has no build-id. Offset is the address of the frame in the module file, so it could be passed
+/// directly to `addr2line -e <module>`. Unlike boost::stacktrace::frame, relative frames
+/// of the same code are equal and have the same hash in all the processes that run the same binaries,
+/// even with address space layout randomization.
+///
+/// On platforms where loaded modules could not be queried (Windows) module_id() is 0 and offset() is the absolute address.
+class relative_frame {
+    std::uint64_t module_id_;
+    std::uintptr_t offset_;
+
+public:
+    /// @brief Constructs empty relative_frame.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr relative_frame() noexcept
+        : module_id_(0)
+        , offset_(0)
+    {}
+
+    /// @brief Constructs relative_frame from a module identifier and an offset, for example obtained in another process.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr relative_frame(std::uint64_t module_id, std::uintptr_t offset) noexcept
+        : module_id_(module_id)
+        , offset_(offset)
+    {}
+
+    /// @brief Converts frame to relative_frame.
+    ///
+    /// @b Complexity: O(log(modules count)) if the cached table of modules is up to date; O(modules count) otherwise.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    explicit relative_frame(const frame& f) {
+        detail::to_module_offset(*detail::module_table::current(), f.address(), module_id_, offset_);
+    }
+
+    /// @returns Hash of the build-id or of the file name of the module; 0 if the module is unknown.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr std::uint64_t module_id() const noexcept { return module_id_; }
+
+    /// @returns Offset of the frame from the module load address.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr std::uintptr_t offset() const noexcept { return offset_; }
+
+    /// @returns Path to the module with module_id() if that module is loaded into the current process, empty string otherwise.
+    ///
+    /// @b Complexity: O(modules count).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    std::string module_name() const {
+        const std::shared_ptr<const detail::module_table> table = detail::module_table::current();
+        const detail::module_info* m = table->find_by_id(module_id_);
+        return m ? m->name : std::string();
+    }
+
+    /// @brief Checks that relative_frame is not empty.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr explicit operator bool () const noexcept { return !empty(); }
+
+    /// @brief Checks that relative_frame references no code.
+    ///
+    /// @b Complexity: O(1).
+    ///
+    /// @b Async-Handler-Safety: Safe.
+    constexpr bool empty() const noexcept { return !module_id_ && !offset_; }
+};
+
+/// Comparison operators that provide platform independent ordering and have O(1) complexity; are Async-Handler-Safe.
+constexpr inline bool operator< (const relative_frame& lhs, const relative_frame& rhs) noexcept {
+    return lhs.module_id() < rhs.module_id() || (lhs.module_id() == rhs.module_id() && lhs.offset() < rhs.offset());
+}
+constexpr inline bool operator> (const relative_frame& lhs, const relative_frame& rhs) noexcept { return rhs < lhs; }
+constexpr inline bool operator<=(const relative_frame& lhs, const relative_frame& rhs) noexcept { return !(lhs > rhs); }
+constexpr inline bool operator>=(const relative_frame& lhs, const relative_frame& rhs) noexcept { return !(lhs < rhs); }
+constexpr inline bool operator==(const relative_frame& lhs, const relative_frame& rhs) noexcept {
+    return lhs.module_id() == rhs.module_id() && lhs.offset() == rhs.offset();
+}
+constexpr inline bool operator!=(const relative_frame& lhs, const relative_frame& rhs) noexcept { return !(lhs == rhs); }
+
+/// Fast hashing support, O(1) complexity; Async-Handler-Safe. The result is the same in all the processes.
+inline std::size_t hash_value(const relative_frame& f) noexcept {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, f.module_id());
+    boost::hash_combine(seed, f.offset());
+    return seed;
+}
+
+/// @brief Converts each frame of the stacktrace to relative_frame.
+///
+/// Modules are looked up in a table that is cached between calls and is rebuilt only
+/// after the dynamic loader loads or unloads a module. Use boost::hash_range on the result
+/// to get a hash of the stacktrace that is the same in all the processes that run the same binaries.
+///
+/// @b Complexity: O(N * log(modules count)) if the cached table of modules is up to date.
+///
+/// @b Async-Handler-Safety: Unsafe.
+template <class Allocator>
+std::vector<relative_frame> to_relative(const basic_stacktrace<Allocator>& st) {
+    std::vector<relative_frame> res;
+    res.reserve(st.size());
+
+    const std::shared_ptr<const detail::module_table> table = detail::module_table::current();
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        std::uint64_t id;
+        std::uintptr_t offset;
+        detail::to_module_offset(*table, st[i].address(), id, offset);
+        res.emplace_back(id, offset);
+    }
+    return res;
+}
+
+/// Outputs relative_frame as `<module id in hex>+<offset in hex>`; unsafe to use in async handlers.
+inline std::string to_string(const relative_frame& f) {
+    std::string res;
+    if (sizeof(std::uintptr_t) < sizeof(std::uint64_t)) {
+        res = detail::to_hex_array(static_cast<std::uintptr_t>(f.module_id() >> 32)).data();
+        res += detail::to_hex_array(static_cast<std::uintptr_t>(f.module_id())).data() + 2;
+    } else {
+        res = detail::to_hex_array(static_cast<std::uintptr_t>(f.module_id())).data();
+    }
+    res += '+';
+    res += detail::to_hex_array(f.offset()).data();
+    return res;
+}
+
+/// Outputs relative_frame as `<module id in hex>+<offset in hex>`; unsafe to use in async handlers.
+template <class CharT, class TraitsT>
+std::basic_ostream<CharT, TraitsT>& operator<<(std::basic_ostream<CharT, TraitsT>& os, const relative_frame& f) {
+    return os << boost::stacktrace::to_string(f);
+}
+
+}} // namespace boost::stacktrace
+
+#endif // BOOST_STACKTRACE_RELATIVE_FRAME_HPP
@@ -0,0 +1,318 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_SAFE_SYMBOLIZER_HPP
+#define BOOST_STACKTRACE_SAFE_SYMBOLIZER_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/detail/demangle.hpp>
+#include <boost/stacktrace/detail/elf_symtab.hpp>
+#include <boost/stacktrace/detail/module_table.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if !defined(BOOST_WINDOWS)
+#   include <unistd.h>     // ::write
+#   include <cerrno>
+#endif
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file safe_symbolizer.hpp \asyncsafe symbolization of call sequences from a table of functions
+/// that is prepared in advance.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Writes human readable call sequences from signal handlers and other places where memory
+/// allocations, locks and stdio are forbidden.
+///
+/// The constructor and refresh() take a snapshot of the loaded modules and of their function symbols
+/// (taken from the `.symtab` of each module or of its separate debug file, or from the `.dynsym`) and
+/// demangle all the names. After that formatting and writing of the frames does not allocate memory,
+/// does not take locks and uses only `::write`; lookups are binary searches over the prepared tables.
+///
+/// Each frame is written as `<index># <function>+0x<offset in function> in <module>`, or as
+/// `<index># 0x<offset in module> in <module>` if the function is unknown.
+/// Source locations are not reported.
+///
+/// @b Platforms: POSIX with ELF binaries. On other platforms function and module names are not known
+/// and the frames are written as addresses.
+class safe_symbolizer {
+    /// @cond
+    struct module_entry {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+        std::uintptr_t load_bias;
+        std::size_t name;           // offset in strings_
+        std::size_t first_symbol;   // [first_symbol, last_symbol) in symbols_
+        std::size_t last_symbol;
+    };
+
+    struct symbol_entry {
+        std::uintptr_t begin;       // addresses in the module file
+        std::uintptr_t end;
+        std::size_t name;           // offset in strings_
+    };
+
+    std::vector<module_entry> modules_;
+    std::vector<symbol_entry> symbols_;
+    std::vector<char> strings_;
+
+    static std::size_t add_string(std::vector<char>& strings, const char* s, std::size_t size) {
+        const std::size_t offset = strings.size();
+        strings.insert(strings.end(), s, s + size);
+        strings.push_back('\0');
+        return offset;
+    }
+
+    // Appends to a fixed size buffer, silently truncating. Async signal safe.
+    class line_writer {
+        char* out_;
+        std::size_t size_;
+        std::size_t used_;
+
+    public:
+        line_writer(char* out, std::size_t size) noexcept
+            : out_(out)
+            , size_(size)
+            , used_(0)
+        {}
+
+        void put(const char* s, std::size_t len) noexcept {
+            len = (std::min)(len, size_ - used_);
+            std::memcpy(out_ + used_, s, len);
+            used_ += len;
+        }
+
+        void put(const char* s) noexcept { put(s, std::strlen(s)); }
+
+        void put_hex(std::uintptr_t value) noexcept {
+            char buf[2 + sizeof(value) * 2];
+            char* p = buf + sizeof(buf);
+            do {
+                *--p = "0123456789abcdef"[value & 0xF];
+                value >>= 4;
+            } while (value);
+            *--p = 'x';
+            *--p = '0';
+            put(p, static_cast<std::size_t>(buf + sizeof(buf) - p));
+        }
+
+        std::size_t size() const noexcept { return used_; }
+    };
+
+    const module_entry* find_module(std::uintptr_t addr) const noexcept {
+        auto it = std::upper_bound(modules_.begin(), modules_.end(), addr, [](std::uintptr_t a, const module_entry& m) {
+            return a < m.begin;
+        });
+        if (it == modules_.begin()) {
+            return nullptr;
+        }
+        --it;
+        return addr < it->end ? &*it : nullptr;
+    }
+
+    const symbol_entry* find_symbol(const module_entry& m, std::uintptr_t offset) const noexcept {
+        const symbol_entry* const begin = symbols_.data() + m.first_symbol;
+        const symbol_entry* const end = symbols_.data() + m.last_symbol;
+        const symbol_entry* it = std::upper_bound(begin, end, offset, [](std::uintptr_t a, const symbol_entry& s) {
+            return a < s.begin;
+        });
+        if (it == begin || offset >= (it - 1)->end) {
+            return nullptr;
+        }
+        return it - 1;
+    }
+
+    static bool write_all(int fd, const char* data, std::size_t size) noexcept {
+#if !defined(BOOST_WINDOWS)
+        while (size) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+#else
+        (void)fd;
+        (void)data;
+        (void)size;
+        return false;
+#endif
+    }
+    /// @endcond
+
+public:
+    /// Maximal length of a single written line, longer function names are truncated.
+    static constexpr std::size_t max_line_size = 1024;
+
+    /// @brief Prepares the tables of the currently loaded modules.
+    ///
+    /// @b Complexity: O(total count of the function symbols in the modules).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    safe_symbolizer() {
+        refresh();
+    }
+
+    /// @brief Rebuilds the tables, for example after loading modules with `dlopen`. Frames from the modules that
+    /// were loaded after the last refresh() are written without names.
+    ///
+    /// Must not run concurrently with any other use of the object.
+    ///
+    /// @b Complexity: O(total count of the function symbols in the modules).
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void refresh() {
+        // The tables are replaced all at once, an exception leaves the old ones intact
+        std::vector<module_entry> modules;
+        std::vector<symbol_entry> symbols;
+        std::vector<char> strings(1, '\0');
+
+        const std::shared_ptr<const boost::stacktrace::detail::module_table> table = boost::stacktrace::detail::module_table::current();
+        for (const boost::stacktrace::detail::module_info& info: table->modules()) {
+            module_entry m;
+            m.begin = info.begin;
+            m.end = info.end;
+            m.load_bias = info.load_bias;
+            m.name = add_string(strings, info.name.c_str(), info.name.size());
+            m.first_symbol = symbols.size();
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ELF_SYMTAB
+            if (!info.name.empty()) {
+                const boost::stacktrace::detail::elf_symbol_index index(info.name);
+                index.visit([&](std::uintptr_t begin, std::uintptr_t end, const char* name) {
+                    const std::string demangled = boost::stacktrace::detail::demangle_uncached(name);
+                    symbol_entry s;
+                    s.begin = begin;
+                    s.end = end;
+                    s.name = add_string(strings, demangled.c_str(), demangled.size());
+                    symbols.push_back(s);
+                });
+            }
+#endif
+            m.last_symbol = symbols.size();
+            modules.push_back(m);
+        }
+
+        modules_.swap(modules);
+        symbols_.swap(symbols);
+        strings_.swap(strings);
+    }
+
+    /// @brief Formats a single frame without the index and the trailing newline.
+    ///
+    /// @b Complexity: O(log(modules count) + log(symbols count in module)).
+    ///
+    /// @b Async-Handler-Safety: \asyncsafe.
+    ///
+    /// @returns Count of characters written to `out`, the output is not zero terminated and is truncated to `size`.
+    std::size_t format(const void* addr, char* out, std::size_t size) const noexcept {
+        line_writer w(out, size);
+        const std::uintptr_t a = reinterpret_cast<std::uintptr_t>(addr);
+        const module_entry* m = find_module(a);
+        if (!m) {
+            w.put_hex(a);
+            return w.size();
+        }
+
+        const std::uintptr_t offset = a - m->load_bias;
+        const symbol_entry* s = find_symbol(*m, offset);
+        if (s) {
+            w.put(strings_.data() + s->name);
+            w.put("+", 1);
+            w.put_hex(offset - s->begin);
+        } else {
+            w.put_hex(offset);
+        }
+        if (strings_[m->name]) {
+            w.put(" in ", 4);
+            w.put(strings_.data() + m->name);
+        }
+        return w.size();
+    }
+
+    /// @brief Writes the frames into the file descriptor, one line per frame.
+    ///
+    /// @b Complexity: O(N * (log(modules count) + log(symbols count in module))).
+    ///
+    /// @b Async-Handler-Safety: \asyncsafe.
+    ///
+    /// @returns Count of the written frames.
+    ///
+    /// @param frames Addresses of the frames, for example filled by boost::stacktrace::safe_dump_to(void*, std::size_t).
+    /// Zero address terminates the sequence.
+    std::size_t write_to(int fd, const void* const* frames, std::size_t frames_count) const noexcept {
+        char line[max_line_size];
+        for (std::size_t i = 0; i < frames_count; ++i) {
+            if (!frames[i]) {
+                return i;
+            }
+
+            line_writer w(line, sizeof(line) - 1);
+            if (i < 10) {
+                w.put(" ", 1);
+            }
+            w.put(boost::stacktrace::detail::to_dec_array(i).data());
+            w.put("# ", 2);
+            const std::size_t used = w.size();
+            std::size_t size = used + format(frames[i], line + used, sizeof(line) - 1 - used);
+            line[size++] = '\n';
+            if (!write_all(fd, line, size)) {
+                return i;
+            }
+        }
+        return frames_count;
+    }
+
+    /// @brief Collects the current function call sequence and writes it into the file descriptor.
+    ///
+    /// @b Complexity: O(N * (log(modules count) + log(symbols count in module))) where N is call sequence length.
+    ///
+    /// @b Async-Handler-Safety: \asyncsafe.
+    ///
+    /// @returns Count of the written frames.
+    ///
+    /// @param skip How many top calls to skip and do not write.
+    ///
+    /// @param max_depth Max call sequence depth to write.
+    BOOST_NOINLINE std::size_t write_current(int fd, std::size_t skip = 0,
+        std::size_t max_depth = boost::stacktrace::detail::max_frames_dump) const noexcept
+    {
+        boost::stacktrace::detail::native_frame_ptr_t buffer[boost::stacktrace::detail::max_frames_dump];
+        if (max_depth > boost::stacktrace::detail::max_frames_dump) {
+            max_depth = boost::stacktrace::detail::max_frames_dump;
+        }
+
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(buffer, max_depth, skip + 1);
+        return write_to(fd, buffer, frames_count);
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_SAFE_SYMBOLIZER_HPP
@@ -473,10 +473,34 @@ std::string to_string(const basic_stacktrace<Allocator>& bt) {
     return boost::stacktrace::detail::to_string(&bt.as_vector()[0], bt.size());
 }
 
-/// Outputs stacktrace in a human readable format to the output stream `os`; unsafe to use in async handlers.
+/// Appends stacktrace in a human readable format to `out`, frame by frame without temporary strings. Reusing the
+/// same `out` for many stacktraces avoids memory allocations; unsafe to use in async handlers.
+template <class Allocator>
+void append_to_string(std::string& out, const basic_stacktrace<Allocator>& bt) {
+    if (bt) {
+        boost::stacktrace::detail::to_string(&bt.as_vector()[0], bt.size(), boost::stacktrace::detail::make_text_sink(out));
+    }
+}
+
+/// Writes stacktrace in a human readable format to `out`. At most `size - 1` characters are written, followed
+/// by a terminating zero; unsafe to use in async handlers.
+/// @returns Length of the whole description, the output was truncated if it is not less than `size`.
+template <class Allocator>
+std::size_t to_string(const basic_stacktrace<Allocator>& bt, char* out, std::size_t size) {
+    return boost::stacktrace::detail::format_to_chars(out, size, [&bt](boost::stacktrace::detail::text_sink sink) {
+        if (bt) {
+            boost::stacktrace::detail::to_string(&bt.as_vector()[0], bt.size(), sink);
+        }
+    });
+}
+
+/// Outputs stacktrace in a human readable format to the output stream `os` frame by frame; unsafe to use in async handlers.
 template <class CharT, class TraitsT, class Allocator>
 std::basic_ostream<CharT, TraitsT>& operator<<(std::basic_ostream<CharT, TraitsT>& os, const basic_stacktrace<Allocator>& bt) {
-    return os << boost::stacktrace::to_string(bt);
+    if (bt) {
+        boost::stacktrace::detail::to_string(&bt.as_vector()[0], bt.size(), boost::stacktrace::detail::make_text_sink(os));
+    }
+    return os;
 }
 
 /// This is the typedef to use unless you'd like to provide a specific allocator to boost::stacktrace::basic_stacktrace.
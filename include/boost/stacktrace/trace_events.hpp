@@ -0,0 +1,396 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_TRACE_EVENTS_HPP
+#define BOOST_STACKTRACE_TRACE_EVENTS_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/symbolizer.hpp>
+#include <boost/stacktrace/trace_log.hpp>
+#include <boost/stacktrace/detail/json_writer.hpp>
+#include <boost/stacktrace/detail/module_table.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file trace_events.hpp Recording of stack snapshots on a timeline and exporting them in the Chrome
+/// trace event format, that is understood by chrome://tracing, Perfetto UI, speedscope and other trace viewers.
+
+namespace boost { namespace stacktrace {
+
+/// @brief Records named stack snapshots with a timestamp and a thread id, exports them as Chrome trace event JSON.
+///
+/// Each recording thread gets its own wait-free queue, record() copies the raw frames into it and never blocks or
+/// allocates, except for the first call from each thread. If the queue is full the snapshot is dropped and counted in dropped().
+/// So is the snapshot recorded by a signal handler that interrupted another record() of the same thread.
+/// collect() moves the queued snapshots into the recorder storage and is called by the export functions; call it periodically
+/// if the threads record more snapshots between the exports than fit into their queues.
+///
+/// Export writes each snapshot as an instant event of the thread, with the stack in the `stackFrames` table. Identical
+/// stack prefixes share the table entries and each unique address is symbolized exactly once.
+///
+/// Timestamps are taken from the wall clock, in microseconds since the UNIX epoch, as are the timestamps of many tracing libraries.
+class trace_event_recorder {
+    /// @cond
+    typedef boost::stacktrace::detail::trace_log_queue queue_t;
+
+    // Record: frames count, timestamp in ns, thread id, pointer to the name, frames.
+    enum { record_header_words = 4 };
+
+    const std::uint64_t id_;
+    const std::size_t queue_capacity_words_;
+
+    std::mutex queues_mutex_;
+    std::vector<std::shared_ptr<queue_t> > queues_;
+
+    std::mutex events_mutex_;
+    std::vector<std::uint64_t> events_;     // records taken from the queues
+    std::size_t events_count_;
+
+    std::atomic<std::uint64_t> dropped_;
+
+    trace_event_recorder(const trace_event_recorder&) = delete;
+    trace_event_recorder& operator=(const trace_event_recorder&) = delete;
+
+    queue_t* this_thread_queue() noexcept {
+        boost::stacktrace::detail::trace_log_thread_queues& tq = boost::stacktrace::detail::trace_log_this_thread_queues();
+        if (queue_t* q = tq.find(id_)) {
+            return q;
+        }
+
+        try {
+            std::shared_ptr<queue_t> q = std::make_shared<queue_t>(
+                queue_capacity_words_, boost::stacktrace::detail::current_thread_id()
+            );
+            {
+                std::lock_guard<std::mutex> lock(queues_mutex_);
+                queues_.push_back(q);
+            }
+            queue_t* const res = q.get();
+            tq.add(id_, std::move(q));
+            return res;
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    template <class T>
+    bool record_impl(const char* name, const T* frames, std::size_t size) noexcept {
+        queue_t* q = this_thread_queue();
+        if (!q) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const std::uint64_t header[record_header_words] = {
+            size,
+            boost::stacktrace::detail::now_ns(),
+            q->thread_id,
+            reinterpret_cast<std::uintptr_t>(name ? name : "")
+        };
+        const bool pushed = q->ring.try_push(record_header_words + size, [&header, frames](std::size_t i) -> std::uint64_t {
+            return i < record_header_words ? header[i] : trace_event_recorder::to_word(frames[i - record_header_words]);
+        });
+        if (!pushed) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return pushed;
+    }
+
+    static std::uint64_t to_word(boost::stacktrace::detail::native_frame_ptr_t p) noexcept {
+        return reinterpret_cast<std::uintptr_t>(p);
+    }
+
+    static std::uint64_t to_word(const boost::stacktrace::frame& f) noexcept {
+        return reinterpret_cast<std::uintptr_t>(f.address());
+    }
+
+    // Must be called with the events_mutex_ locked
+    void collect_impl() {
+        std::vector<std::shared_ptr<queue_t> > snapshot;
+        {
+            std::lock_guard<std::mutex> lock(queues_mutex_);
+            snapshot = queues_;
+        }
+
+        bool has_exited = false;
+        for (std::size_t i = 0; i < snapshot.size(); ++i) {
+            boost::stacktrace::detail::spsc_ring& ring = snapshot[i]->ring;
+            const bool exited = snapshot[i]->thread_exited.load(std::memory_order_acquire);
+            const std::size_t available = ring.available();
+            for (std::size_t pos = 0; pos < available; ) {
+                const std::size_t record_words = record_header_words + static_cast<std::size_t>(ring.peek(pos));
+                for (std::size_t j = 0; j < record_words; ++j) {
+                    events_.push_back(ring.peek(pos + j));
+                }
+                pos += record_words;
+                ++events_count_;
+            }
+            ring.pop(available);
+            has_exited = has_exited || exited;
+        }
+
+        if (has_exited) {
+            std::lock_guard<std::mutex> lock(queues_mutex_);
+            for (std::size_t i = 0; i < queues_.size(); ) {
+                if (queues_[i]->thread_exited.load(std::memory_order_acquire) && !queues_[i]->ring.available()) {
+                    queues_[i] = std::move(queues_.back());
+                    queues_.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    struct stack_node {
+        std::uint64_t parent;   // 0 for the outermost frames
+        const void* address;
+    };
+
+    struct node_key_hash {
+        std::size_t operator()(const std::pair<std::uint64_t, const void*>& v) const noexcept {
+            std::size_t seed = static_cast<std::size_t>(v.first);
+            boost::hash_combine(seed, v.second);
+            return seed;
+        }
+    };
+
+    // Calls `out(chunk)` with the parts of the JSON document
+    template <class F>
+    void export_impl(F out, symbolizer_backend backend) {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        collect_impl();
+
+        std::unordered_map<std::pair<std::uint64_t, const void*>, std::uint64_t, node_key_hash> node_ids;
+        std::vector<stack_node> nodes;
+
+        std::string buf = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        const std::string pid = boost::stacktrace::detail::to_dec_array(
+            static_cast<std::size_t>(boost::stacktrace::detail::current_process_id())
+        ).data();
+        for (std::size_t pos = 0, i = 0; pos < events_.size(); ++i) {
+            const std::size_t size = static_cast<std::size_t>(events_[pos]);
+            const std::uint64_t ts = events_[pos + 1];
+            const char* const name = reinterpret_cast<const char*>(static_cast<std::uintptr_t>(events_[pos + 3]));
+
+            // Frames go from the outermost one, each node is identified by its parent and address
+            std::uint64_t node = 0;
+            for (std::size_t j = size; j > 0; --j) {
+                const void* const address = reinterpret_cast<const void*>(
+                    static_cast<std::uintptr_t>(events_[pos + record_header_words + j - 1])
+                );
+                const std::pair<std::unordered_map<std::pair<std::uint64_t, const void*>, std::uint64_t, node_key_hash>::iterator, bool> res
+                    = node_ids.emplace(std::make_pair(node, address), static_cast<std::uint64_t>(nodes.size() + 1));
+                if (res.second) {
+                    const stack_node n = {node, address};
+                    nodes.push_back(n);
+                }
+                node = res.first->second;
+            }
+
+            buf += (i ? ",\n" : "\n");
+            buf += "{\"name\":";
+            boost::stacktrace::detail::append_json_string(buf, name, std::strlen(name));
+            buf += ",\"cat\":\"stacktrace\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+            buf += std::to_string(ts / 1000);
+            buf += '.';
+            const char fraction[3] = {
+                static_cast<char>('0' + ts % 1000 / 100),
+                static_cast<char>('0' + ts % 100 / 10),
+                static_cast<char>('0' + ts % 10)
+            };
+            buf.append(fraction, 3);
+            buf += ",\"pid\":";
+            buf += pid;
+            buf += ",\"tid\":";
+            buf += boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(events_[pos + 2])).data();
+            if (node) {
+                buf += ",\"sf\":\"";
+                buf += boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(node)).data();
+                buf += '"';
+            }
+            buf += '}';
+
+            pos += record_header_words + size;
+            if (buf.size() >= 64 * 1024) {
+                out(buf);
+                buf.clear();
+            }
+        }
+
+        buf += "\n],\"stackFrames\":{";
+        boost::stacktrace::symbolizer sym(backend);
+        std::unordered_map<const void*, std::string> names;
+        std::shared_ptr<const boost::stacktrace::detail::module_table> modules;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const void* const address = nodes[i].address;
+            const std::pair<std::unordered_map<const void*, std::string>::iterator, bool> res = names.emplace(address, std::string());
+            if (res.second) {
+                res.first->second = sym.name(frame(address));
+                if (res.first->second.empty()) {
+                    res.first->second = boost::stacktrace::detail::to_hex_array(address).data();
+                }
+            }
+
+            buf += (i ? ",\n\"" : "\n\"");
+            buf += boost::stacktrace::detail::to_dec_array(i + 1).data();
+            buf += "\":{\"name\":";
+            boost::stacktrace::detail::append_json_string(buf, res.first->second.data(), res.first->second.size());
+
+            if (!modules || !modules->find(address)) {
+                modules = boost::stacktrace::detail::module_table::current();
+            }
+            const boost::stacktrace::detail::module_info* m = modules->find(address);
+            if (m && !m->name.empty()) {
+                const char* const module = boost::stacktrace::detail::module_base_name(m->name.c_str());
+                buf += ",\"category\":";
+                boost::stacktrace::detail::append_json_string(buf, module, std::strlen(module));
+            }
+            if (nodes[i].parent) {
+                buf += ",\"parent\":\"";
+                buf += boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(nodes[i].parent)).data();
+                buf += '"';
+            }
+            buf += '}';
+
+            if (buf.size() >= 64 * 1024) {
+                out(buf);
+                buf.clear();
+            }
+        }
+        buf += "\n}}\n";
+        out(buf);
+    }
+    /// @endcond
+
+public:
+    /// @brief Creates an empty recorder.
+    ///
+    /// @param thread_queue_size Size in bytes of the queue of each recording thread. Snapshots that do not fit into the queue are dropped.
+    explicit trace_event_recorder(std::size_t thread_queue_size = 256 * 1024)
+        : id_(boost::stacktrace::detail::trace_log_next_writer_id())
+        , queue_capacity_words_(thread_queue_size / sizeof(std::uint64_t))
+        , events_count_(0)
+        , dropped_(0)
+    {}
+
+    /// @brief Stops the recording. Must not be called while other threads are calling record().
+    ~trace_event_recorder() {
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        for (std::size_t i = 0; i < queues_.size(); ++i) {
+            queues_[i]->writer_closed.store(true, std::memory_order_release);
+        }
+    }
+
+    /// @brief Records the current function call sequence with the current time and thread id.
+    ///
+    /// @b Complexity: O(N) where N is call sequence length.
+    ///
+    /// @b Async-Handler-Safety: Unsafe for the first call from each thread, \asyncsafe otherwise. The snapshot is
+    /// dropped if the call interrupted another record() of the same thread.
+    ///
+    /// @param name Name of the event, must be valid till the end of the export. Usually a string literal.
+    /// Null is recorded as an empty name.
+    ///
+    /// @param skip How many top calls to skip and do not store.
+    ///
+    /// @returns `false` if the snapshot was dropped.
+    BOOST_NOINLINE bool record(const char* name, std::size_t skip = 0) noexcept {
+        boost::stacktrace::detail::native_frame_ptr_t buffer[boost::stacktrace::detail::max_frames_dump];
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(
+            buffer, boost::stacktrace::detail::max_frames_dump, skip + 1
+        );
+        return record_impl(name, buffer, frames_count);
+    }
+
+    /// @brief Records the frames of the already captured stacktrace with the current time and thread id.
+    ///
+    /// @b Complexity: O(st.size()).
+    ///
+    /// @returns `false` if the snapshot was dropped.
+    template <class Allocator>
+    bool record(const char* name, const basic_stacktrace<Allocator>& st) noexcept {
+        return record_impl(name, st.as_vector().data(), st.size());
+    }
+
+    /// @brief Moves the snapshots from the queues of the threads into the recorder, freeing the queues.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void collect() {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        collect_impl();
+    }
+
+    /// @returns Count of the collected snapshots.
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        collect_impl();
+        return events_count_;
+    }
+
+    /// @returns Count of the snapshots that were dropped because of a full queue or of a nested record().
+    std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Drops all the recorded snapshots.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void clear() {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        collect_impl();
+        events_.clear();
+        events_count_ = 0;
+    }
+
+    /// @brief Writes all the recorded snapshots to `os` in the Chrome trace event JSON format.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @param backend Implementation that symbolizes the frames, see boost::stacktrace::symbolizer::symbolizer(symbolizer_backend).
+    void write(std::ostream& os, symbolizer_backend backend = symbolizer_backend::default_backend) {
+        export_impl([&os](const std::string& chunk) { os.write(chunk.data(), static_cast<std::streamsize>(chunk.size())); }, backend);
+    }
+
+    /// @returns All the recorded snapshots in the Chrome trace event JSON format, see write().
+    std::string to_json(symbolizer_backend backend = symbolizer_backend::default_backend) {
+        std::string res;
+        export_impl([&res](const std::string& chunk) { res += chunk; }, backend);
+        return res;
+    }
+};
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_TRACE_EVENTS_HPP
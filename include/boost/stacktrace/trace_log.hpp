@@ -0,0 +1,598 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_STACKTRACE_TRACE_LOG_HPP
+#define BOOST_STACKTRACE_TRACE_LOG_HPP
+
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_PRAGMA_ONCE
+#   pragma once
+#endif
+
+#include <boost/stacktrace/stacktrace.hpp>
+#include <boost/stacktrace/detail/spsc_ring.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(BOOST_WINDOWS)
+#   include <unistd.h>     // ::close
+#   include <fcntl.h>      // ::open
+#   include <sys/mman.h>   // ::mmap
+#   include <sys/stat.h>   // ::fstat
+#else
+#   include <fstream>
+#endif
+
+#ifdef BOOST_INTEL
+#   pragma warning(push)
+#   pragma warning(disable:2196) // warning #2196: routine is both "inline" and "noinline"
+#endif
+
+/// @file trace_log.hpp Append-only log of call sequences for high rate capturing:
+/// producers never block on I/O, a background thread writes the traces in big batches.
+
+namespace boost { namespace stacktrace {
+
+/// @cond
+namespace detail {
+
+    // File layout: trace_log_magic (8 bytes), trace_log_version (8 bytes), then records.
+    // Record: frames count, timestamp in ns, thread id, frames. All the values are 64 bit words.
+    BOOST_STATIC_CONSTEXPR char trace_log_magic[8] = {'B', 'S', 'T', 'T', 'L', 'O', 'G', '\0'};
+    BOOST_STATIC_CONSTEXPR std::uint64_t trace_log_version = 1;
+    enum trace_log_layout { trace_log_record_header_words = 3, trace_log_file_header_words = 2 };
+
+    struct trace_log_queue {
+        trace_log_queue(std::size_t capacity_words, std::uint64_t owner_thread_id)
+            : ring(capacity_words)
+            , thread_id(owner_thread_id)
+            , thread_exited(false)
+            , writer_closed(false)
+        {}
+
+        boost::stacktrace::detail::spsc_ring ring;
+        const std::uint64_t thread_id;  // of the only thread that pushes into the queue, cached to avoid a syscall per push
+        std::atomic<bool> thread_exited;
+        std::atomic<bool> writer_closed;
+    };
+
+    // Queues of the current thread, one per trace_log_writer that the thread pushed into.
+    class trace_log_thread_queues {
+        std::vector<std::pair<std::uint64_t, std::shared_ptr<trace_log_queue> > > queues_;
+
+    public:
+        trace_log_queue* find(std::uint64_t writer_id) noexcept {
+            for (std::size_t i = 0; i < queues_.size(); ++i) {
+                if (queues_[i].first == writer_id) {
+                    return queues_[i].second.get();
+                }
+            }
+            return 0;
+        }
+
+        void add(std::uint64_t writer_id, std::shared_ptr<trace_log_queue> q) {
+            for (std::size_t i = 0; i < queues_.size(); ) {
+                if (queues_[i].second->writer_closed.load(std::memory_order_acquire)) {
+                    queues_[i] = std::move(queues_.back());
+                    queues_.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            queues_.emplace_back(writer_id, std::move(q));
+        }
+
+        ~trace_log_thread_queues() {
+            for (std::size_t i = 0; i < queues_.size(); ++i) {
+                queues_[i].second->thread_exited.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    inline trace_log_thread_queues& trace_log_this_thread_queues() {
+        static thread_local trace_log_thread_queues queues;
+        return queues;
+    }
+
+    inline std::uint64_t trace_log_next_writer_id() noexcept {
+        static std::atomic<std::uint64_t> id(0);
+        return ++id;
+    }
+
+} // namespace detail
+/// @endcond
+
+/// @brief Asynchronous append-only writer of call sequences into a file.
+///
+/// Each producer thread gets its own wait-free queue. push() copies the raw frames into that queue
+/// and never blocks: if the queue is full the trace is dropped and counted in dropped(). So is the trace pushed
+/// by a signal handler that interrupted another push() of the same thread.
+/// A background thread drains all the queues and writes them into the file with big sequential writes.
+///
+/// The resulting file could be read with boost::stacktrace::trace_log_reader.
+class trace_log_writer {
+    /// @cond
+    typedef boost::stacktrace::detail::trace_log_queue queue_t;
+
+    std::FILE* file_;
+    const std::uint64_t id_;
+    const std::size_t queue_capacity_words_;
+    const std::chrono::milliseconds flush_interval_;
+
+    std::mutex queues_mutex_;
+    std::vector<std::shared_ptr<queue_t> > queues_;
+
+    std::mutex drain_mutex_;
+    std::vector<std::shared_ptr<queue_t> > drain_snapshot_;
+    std::vector<std::uint64_t> batch_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+
+    std::atomic<std::uint64_t> dropped_;
+    std::thread thread_;
+
+    enum { batch_words = 64 * 1024 };
+
+    trace_log_writer(const trace_log_writer&) = delete;
+    trace_log_writer& operator=(const trace_log_writer&) = delete;
+
+    queue_t* this_thread_queue() noexcept {
+        boost::stacktrace::detail::trace_log_thread_queues& tq = boost::stacktrace::detail::trace_log_this_thread_queues();
+        if (queue_t* q = tq.find(id_)) {
+            return q;
+        }
+
+        try {
+            std::shared_ptr<queue_t> q = std::make_shared<queue_t>(
+                queue_capacity_words_, boost::stacktrace::detail::current_thread_id()
+            );
+            {
+                std::lock_guard<std::mutex> lock(queues_mutex_);
+                queues_.push_back(q);
+            }
+            queue_t* const res = q.get();
+            tq.add(id_, std::move(q));
+            return res;
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    template <class T>
+    bool push_impl(const T* frames, std::size_t size) noexcept {
+        if (!file_) {
+            return false;
+        }
+
+        queue_t* q = this_thread_queue();
+        if (!q) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const std::uint64_t header[boost::stacktrace::detail::trace_log_record_header_words] = {
+            size,
+            boost::stacktrace::detail::now_ns(),
+            q->thread_id
+        };
+        const bool pushed = q->ring.try_push(
+            boost::stacktrace::detail::trace_log_record_header_words + size,
+            [&header, frames](std::size_t i) -> std::uint64_t {
+                return i < boost::stacktrace::detail::trace_log_record_header_words
+                    ? header[i]
+                    : trace_log_writer::to_word(frames[i - boost::stacktrace::detail::trace_log_record_header_words]);
+            }
+        );
+        if (!pushed) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return pushed;
+    }
+
+    static std::uint64_t to_word(boost::stacktrace::detail::native_frame_ptr_t p) noexcept {
+        return reinterpret_cast<std::uintptr_t>(p);
+    }
+
+    static std::uint64_t to_word(const boost::stacktrace::frame& f) noexcept {
+        return reinterpret_cast<std::uintptr_t>(f.address());
+    }
+
+    void write_batch() noexcept {
+        if (!batch_.empty()) {
+            std::fwrite(batch_.data(), sizeof(std::uint64_t), batch_.size(), file_);
+            batch_.clear();
+        }
+    }
+
+    // Returns true if something was written
+    bool drain() {
+        std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(queues_mutex_);
+            drain_snapshot_ = queues_;
+        }
+
+        bool written = false;
+        for (std::size_t i = 0; i < drain_snapshot_.size(); ++i) {
+            spsc_ring_drain(drain_snapshot_[i]->ring, written);
+        }
+        write_batch();
+
+        // Releasing queues of exited threads
+        bool has_exited = false;
+        for (std::size_t i = 0; i < drain_snapshot_.size(); ++i) {
+            queue_t& q = *drain_snapshot_[i];
+            has_exited = has_exited || (q.thread_exited.load(std::memory_order_acquire) && !q.ring.available());
+        }
+        drain_snapshot_.clear();
+        if (has_exited) {
+            std::lock_guard<std::mutex> lock(queues_mutex_);
+            for (std::size_t i = 0; i < queues_.size(); ) {
+                if (queues_[i]->thread_exited.load(std::memory_order_acquire) && !queues_[i]->ring.available()) {
+                    queues_[i] = std::move(queues_.back());
+                    queues_.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+
+        return written;
+    }
+
+    void spsc_ring_drain(boost::stacktrace::detail::spsc_ring& ring, bool& written) {
+        std::size_t available = ring.available();
+        while (available) {
+            for (std::size_t i = 0; i < available; ++i) {
+                batch_.push_back(ring.peek(i));
+            }
+            ring.pop(available);
+            written = true;
+
+            if (batch_.size() >= batch_words) {
+                write_batch();
+            }
+            available = ring.available();
+        }
+    }
+
+    void run() {
+        for (;;) {
+            const bool written = drain();
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            if (stop_) {
+                break;
+            }
+            if (!written) {
+                wake_.wait_for(lock, flush_interval_);
+            }
+        }
+        drain();
+    }
+    /// @endcond
+
+public:
+    /// @brief Opens the file for appending and starts the background writing thread.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    ///
+    /// @throws std::bad_alloc or std::system_error if failed to allocate memory or start the thread.
+    ///
+    /// @param file Path to the log file. New records are appended to the existing file.
+    ///
+    /// @param thread_queue_size Size in bytes of the queue of each producer thread. Traces that do not fit into the queue are dropped.
+    ///
+    /// @param flush_interval How often the background thread checks the queues when there is nothing to write.
+    explicit trace_log_writer(const char* file, std::size_t thread_queue_size = 256 * 1024,
+            std::chrono::milliseconds flush_interval = std::chrono::milliseconds(10))
+        : file_(0)
+        , id_(boost::stacktrace::detail::trace_log_next_writer_id())
+        , queue_capacity_words_(thread_queue_size / sizeof(std::uint64_t))
+        , flush_interval_(flush_interval)
+        , stop_(false)
+        , dropped_(0)
+    {
+        file_ = std::fopen(file, "ab");
+        if (!file_) {
+            return;
+        }
+
+        // Batches are written at once, no need in additional buffering
+        std::setvbuf(file_, 0, _IONBF, 0);
+        std::fseek(file_, 0, SEEK_END);
+        if (std::ftell(file_) == 0) {
+            std::uint64_t header[boost::stacktrace::detail::trace_log_file_header_words];
+            std::memcpy(&header[0], boost::stacktrace::detail::trace_log_magic, sizeof(header[0]));
+            header[1] = boost::stacktrace::detail::trace_log_version;
+            std::fwrite(header, sizeof(header), 1, file_);
+        }
+
+        batch_.reserve(batch_words + queue_capacity_words_);
+        try {
+            thread_ = std::thread(&trace_log_writer::run, this);
+        } catch (...) {
+            std::fclose(file_);
+            throw;
+        }
+    }
+
+    /// @brief Writes all the pushed traces, stops the background thread and closes the file.
+    ~trace_log_writer() {
+        if (!file_) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        for (std::size_t i = 0; i < queues_.size(); ++i) {
+            queues_[i]->writer_closed.store(true, std::memory_order_release);
+        }
+        std::fclose(file_);
+    }
+
+    /// @returns `true` if the file was successfully opened.
+    explicit operator bool () const noexcept { return file_ != 0; }
+
+    /// @brief Stores the current function call sequence into the queue of the current thread.
+    ///
+    /// @b Complexity: O(N) where N is call sequence length.
+    ///
+    /// @b Async-Handler-Safety: Unsafe for the first call from each thread, \asyncsafe otherwise. The trace is
+    /// dropped if the call interrupted another push() of the same thread.
+    ///
+    /// @returns `false` if the trace was dropped.
+    ///
+    /// @param skip How many top calls to skip and do not store.
+    BOOST_NOINLINE bool push(std::size_t skip = 0) noexcept {
+        boost::stacktrace::detail::native_frame_ptr_t buffer[boost::stacktrace::detail::max_frames_dump];
+        const std::size_t frames_count = boost::stacktrace::detail::this_thread_frames::collect(
+            buffer, boost::stacktrace::detail::max_frames_dump, skip + 1
+        );
+        return push_impl(buffer, frames_count);
+    }
+
+    /// @brief Stores the raw frames into the queue of the current thread.
+    ///
+    /// @b Complexity: O(size).
+    ///
+    /// @b Async-Handler-Safety: Unsafe for the first call from each thread, \asyncsafe otherwise. The trace is
+    /// dropped if the call interrupted another push() of the same thread.
+    ///
+    /// @returns `false` if the trace was dropped.
+    bool push(const frame::native_frame_ptr_t* frames, std::size_t size) noexcept {
+        return push_impl(frames, size);
+    }
+
+    /// @brief Stores the frames of the stacktrace into the queue of the current thread.
+    ///
+    /// @b Complexity: O(st.size()).
+    ///
+    /// @returns `false` if the trace was dropped.
+    template <class Allocator>
+    bool push(const basic_stacktrace<Allocator>& st) noexcept {
+        return push_impl(st.as_vector().data(), st.size());
+    }
+
+    /// @brief Blocks until all the traces pushed before the call are written to the file.
+    ///
+    /// @b Async-Handler-Safety: Unsafe.
+    void flush() {
+        if (file_) {
+            drain();
+        }
+    }
+
+    /// @returns Count of traces that were dropped because of a full queue or of a nested push().
+    std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+};
+
+/// @brief View of a single record from the trace log file, valid while the boost::stacktrace::trace_log_reader is alive.
+class trace_log_record {
+    /// @cond
+    const std::uint64_t* data_;
+    friend class trace_log_reader;
+    /// @endcond
+
+public:
+    /// @cond
+    explicit trace_log_record(const std::uint64_t* data) noexcept
+        : data_(data)
+    {}
+    /// @endcond
+
+    /// @returns Wall clock time of the record in nanoseconds since the UNIX epoch.
+    std::uint64_t timestamp_ns() const noexcept { return data_[1]; }
+
+    /// @returns Platform specific identifier of the thread that made the record, 0 if unknown.
+    std::uint64_t thread_id() const noexcept { return data_[2]; }
+
+    /// @returns Count of frames in the record.
+    std::size_t size() const noexcept { return static_cast<std::size_t>(data_[0]); }
+
+    /// @returns Frame with index `i`, `i` must be less than size().
+    boost::stacktrace::frame operator[](std::size_t i) const noexcept {
+        return boost::stacktrace::frame(reinterpret_cast<frame::native_frame_ptr_t>(
+            static_cast<std::uintptr_t>(data_[boost::stacktrace::detail::trace_log_record_header_words + i])
+        ));
+    }
+
+    /// @returns Stacktrace made of the frames of the record.
+    boost::stacktrace::stacktrace to_stacktrace() const {
+        std::vector<frame::native_frame_ptr_t> frames(size() + 1, 0);
+        for (std::size_t i = 0; i < size(); ++i) {
+            frames[i] = (*this)[i].address();
+        }
+        return boost::stacktrace::stacktrace::from_dump(frames.data(), frames.size() * sizeof(frame::native_frame_ptr_t));
+    }
+};
+
+/// @brief Reader of the files written by boost::stacktrace::trace_log_writer. Maps the whole file into memory
+/// and iterates over its records without copying them.
+class trace_log_reader {
+    /// @cond
+    const std::uint64_t* begin_;
+    const std::uint64_t* end_;
+    void* mapping_;
+    std::size_t mapping_size_;
+    std::vector<std::uint64_t> storage_;
+
+    trace_log_reader(const trace_log_reader&) = delete;
+    trace_log_reader& operator=(const trace_log_reader&) = delete;
+
+    void init(const std::uint64_t* data, std::size_t words) noexcept {
+        const std::size_t header_words = boost::stacktrace::detail::trace_log_file_header_words;
+        if (words < header_words
+            || std::memcmp(data, boost::stacktrace::detail::trace_log_magic, sizeof(data[0])) != 0
+            || data[1] != boost::stacktrace::detail::trace_log_version)
+        {
+            return;
+        }
+
+        begin_ = data + header_words;
+        end_ = data + words;
+    }
+    /// @endcond
+
+public:
+    /// Forward iterator over the records of the file.
+    class const_iterator {
+        /// @cond
+        const std::uint64_t* pos_;
+        const std::uint64_t* end_;
+
+        void validate() noexcept {
+            // Truncated record at the end of the file, for example because of a crash during writing
+            if (pos_ != end_ && (static_cast<std::size_t>(end_ - pos_) < boost::stacktrace::detail::trace_log_record_header_words
+                || pos_[0] > static_cast<std::size_t>(end_ - pos_) - boost::stacktrace::detail::trace_log_record_header_words))
+            {
+                pos_ = end_;
+            }
+        }
+        /// @endcond
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef trace_log_record value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const trace_log_record* pointer;
+        typedef trace_log_record reference;
+
+        /// @cond
+        const_iterator(const std::uint64_t* pos, const std::uint64_t* end) noexcept
+            : pos_(pos)
+            , end_(end)
+        {
+            validate();
+        }
+        /// @endcond
+
+        trace_log_record operator*() const noexcept {
+            return trace_log_record(pos_);
+        }
+
+        const_iterator& operator++() noexcept {
+            pos_ += boost::stacktrace::detail::trace_log_record_header_words + static_cast<std::size_t>(pos_[0]);
+            validate();
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const noexcept { return pos_ == other.pos_; }
+        bool operator!=(const const_iterator& other) const noexcept { return pos_ != other.pos_; }
+    };
+
+    /// @brief Maps the file into memory. If the file does not exist or is not a trace log, the reader is empty.
+    ///
+    /// @throws std::bad_alloc on platforms without memory mapping support.
+    explicit trace_log_reader(const char* file)
+        : begin_(0)
+        , end_(0)
+        , mapping_(0)
+        , mapping_size_(0)
+    {
+#if !defined(BOOST_WINDOWS)
+        const int fd = ::open(file, O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+
+        struct ::stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return;
+        }
+        mapping_ = p;
+        mapping_size_ = size;
+        init(static_cast<const std::uint64_t*>(p), size / sizeof(std::uint64_t));
+#else
+        std::ifstream in(file, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return;
+        }
+        const std::size_t size = static_cast<std::size_t>(in.tellg());
+        storage_.resize(size / sizeof(std::uint64_t));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(storage_.data()), static_cast<std::streamsize>(storage_.size() * sizeof(std::uint64_t)));
+        init(storage_.data(), storage_.size());
+#endif
+    }
+
+    ~trace_log_reader() {
+#if !defined(BOOST_WINDOWS)
+        if (mapping_) {
+            ::munmap(mapping_, mapping_size_);
+        }
+#endif
+    }
+
+    /// @returns `true` if the file is a valid trace log.
+    explicit operator bool () const noexcept { return begin_ != 0; }
+
+    const_iterator begin() const noexcept { return const_iterator(begin_, end_); }
+    const_iterator end() const noexcept { return const_iterator(end_, end_); }
+};
+
+}} // namespace boost::stacktrace
+
+#ifdef BOOST_INTEL
+#   pragma warning(pop)
+#endif
+
+#endif // BOOST_STACKTRACE_TRACE_LOG_HPP
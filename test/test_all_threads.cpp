@@ -0,0 +1,174 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/all_threads.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#   include <signal.h>
+#endif
+
+using boost::stacktrace::all_threads_stacktraces;
+using boost::stacktrace::stacktrace;
+
+std::mutex mutex;
+std::condition_variable cv;
+bool done = false;
+std::atomic<int> started(0);
+
+BOOST_NOINLINE void function_with_known_name() {
+    started.fetch_add(1);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!done) {
+        cv.wait(lock);
+    }
+    not_a_tail_call(1);
+}
+
+BOOST_NOINLINE void spinning_function_with_known_name() {
+    started.fetch_add(1);
+    std::uint64_t value = 1;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done) {
+                break;
+            }
+        }
+        value = burn_cpu(value);
+    }
+    not_a_tail_call(value);
+}
+
+void test_all_threads() {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back(function_with_known_name);
+    }
+    threads.emplace_back(spinning_function_with_known_name);
+    while (started.load() != 4) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10)); // let the threads block
+
+    const std::uint64_t self = boost::stacktrace::detail::current_thread_id();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<std::pair<std::uint64_t, stacktrace> > stacks = all_threads_stacktraces();
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Captured " << stacks.size() << " threads in "
+        << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << "us\n";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_all();
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    BOOST_TEST(!stacks.empty());
+    std::size_t self_count = 0;
+    std::size_t blocked = 0;
+    std::size_t spinning = 0;
+    for (std::size_t i = 0; i < stacks.size(); ++i) {
+        BOOST_TEST(i == 0 || stacks[i - 1].first < stacks[i].first);
+        self_count += (stacks[i].first == self);
+        blocked += has_name(stacks[i].second, "function_with_known_name")
+            && !has_name(stacks[i].second, "spinning_function_with_known_name");
+        spinning += has_name(stacks[i].second, "spinning_function_with_known_name");
+        std::cout << "Thread " << stacks[i].first << ":\n" << stacks[i].second << '\n';
+    }
+    BOOST_TEST_EQ(self_count, 1u);
+
+#if defined(__linux__)
+    BOOST_TEST_GE(stacks.size(), 5u);
+    if (stacktrace()) { // not the noop implementation
+        BOOST_TEST_EQ(blocked, 3u);
+        BOOST_TEST_EQ(spinning, 1u);
+        for (std::size_t i = 0; i < stacks.size(); ++i) {
+            BOOST_TEST(!has_name(stacks[i].second, "on_signal"));
+        }
+    }
+#else
+    (void)blocked;
+    (void)spinning;
+#endif
+}
+
+#if defined(__linux__)
+void test_blocked_signal() {
+    std::atomic<std::uint64_t> blocked(0);
+    std::atomic<bool> stop(false);
+    std::thread worker([&]() {
+        ::sigset_t set;
+        ::sigemptyset(&set);
+        ::sigaddset(&set, BOOST_STACKTRACE_ALL_THREADS_SIGNAL);
+        ::pthread_sigmask(SIG_BLOCK, &set, 0);
+        blocked = boost::stacktrace::detail::current_thread_id();
+        while (!stop.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (!blocked.load()) {
+        std::this_thread::yield();
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<std::pair<std::uint64_t, stacktrace> > stacks = all_threads_stacktraces(std::chrono::milliseconds(50));
+    BOOST_TEST(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+    stop = true;
+    worker.join();
+
+    // Sanitizers may have threads of their own that block the signals
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < stacks.size(); ++i) {
+        if (stacks[i].first == blocked.load()) {
+            ++found;
+            BOOST_TEST(stacks[i].second.empty());
+        } else if (stacks[i].first == boost::stacktrace::detail::current_thread_id()) {
+            BOOST_TEST_EQ(!stacks[i].second.empty(), !!stacktrace());
+        }
+    }
+    BOOST_TEST_EQ(found, 1u);
+}
+
+void test_handler_past_deadline() {
+    // As if the signal handler of some thread is stuck
+    std::atomic<std::size_t>& running = boost::stacktrace::detail::all_threads_handlers_running();
+    ++running;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<std::pair<std::uint64_t, stacktrace> > stacks = all_threads_stacktraces(std::chrono::milliseconds(50));
+    BOOST_TEST(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    --running;
+    BOOST_TEST(!stacks.empty());
+
+    // Frees the request of the previous call
+    BOOST_TEST(!all_threads_stacktraces(std::chrono::milliseconds(50)).empty());
+}
+#endif
+
+int main() {
+    test_all_threads();
+#if defined(__linux__)
+    test_blocked_signal();
+    test_handler_past_deadline();
+#endif
+
+    return boost::report_errors();
+}
@@ -0,0 +1,114 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/async_symbolizer.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::async_symbolizer;
+using boost::stacktrace::stacktrace;
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    depth = res.size(); // not a tail call
+    return res;
+}
+
+void test_future() {
+    const stacktrace st = function_with_known_name();
+    async_symbolizer service;
+
+    std::future<std::string> f = service.submit(st);
+    BOOST_TEST(f.valid());
+    const std::string text = f.get();
+    std::cout << text;
+    BOOST_TEST_EQ(text, boost::stacktrace::to_string(st));
+
+    if (st) { // not the noop implementation
+        BOOST_TEST(text.find("function_with_known_name") != std::string::npos);
+    }
+
+    BOOST_TEST_EQ(service.submit(stacktrace(0, 0)).get(), std::string());
+    BOOST_TEST_EQ(service.dropped(), 0u);
+}
+
+void test_callback() {
+    const stacktrace st = function_with_known_name();
+    const std::string expected = boost::stacktrace::to_string(st);
+
+    std::atomic<int> done(0);
+    std::atomic<int> mismatched(0);
+    {
+        async_symbolizer service(2, boost::stacktrace::symbolizer_backend::default_backend, 1000);
+        for (int i = 0; i < 100; ++i) {
+            const bool queued = service.submit(st, [&](std::string s) {
+                if (s != expected) {
+                    ++mismatched;
+                }
+                ++done;
+            });
+            BOOST_TEST(queued);
+        }
+        service.clear();
+    } // completes the pending requests
+
+    BOOST_TEST_EQ(done.load(), 100);
+    BOOST_TEST_EQ(mismatched.load(), 0);
+}
+
+void test_many_submitters() {
+    const stacktrace st = function_with_known_name();
+    const std::string expected = boost::stacktrace::to_string(st);
+    async_symbolizer service(3);
+
+    std::atomic<int> mismatched(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            std::vector<std::future<std::string> > results;
+            for (int i = 0; i < 50; ++i) {
+                results.push_back(service.submit(st));
+            }
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                if (results[i].get() != expected) {
+                    ++mismatched;
+                }
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    BOOST_TEST_EQ(mismatched.load(), 0);
+    BOOST_TEST_EQ(service.pending(), 0u);
+}
+
+void test_full_queue() {
+    const stacktrace st = function_with_known_name();
+    async_symbolizer service(1, boost::stacktrace::symbolizer_backend::default_backend, 0);
+
+    BOOST_TEST(!service.submit(st).valid());
+    BOOST_TEST(!service.submit(st, [](std::string) {}));
+    BOOST_TEST_EQ(service.dropped(), 2u);
+}
+
+int main() {
+    test_future();
+    test_callback();
+    test_many_submitters();
+    test_full_queue();
+
+    return boost::report_errors();
+}
@@ -0,0 +1,136 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/compact_stacktrace.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::compact_stacktrace;
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE stacktrace make_trace(int depth) {
+    if (depth) {
+        return make_trace(depth - 1);
+    }
+    return stacktrace();
+}
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE compact_stacktrace make_compact(int depth) {
+    if (depth) {
+        return make_compact(depth - 1);
+    }
+    return compact_stacktrace();
+}
+
+void test_empty() {
+    const compact_stacktrace st(0, 0);
+    BOOST_TEST(!st);
+    BOOST_TEST(st.empty());
+    BOOST_TEST_EQ(st.size(), 0u);
+    BOOST_TEST(st.begin() == st.end());
+    BOOST_TEST(to_string(st).empty());
+    BOOST_TEST(!st.to_stacktrace());
+    BOOST_TEST(st == compact_stacktrace(stacktrace(0, 0)));
+    BOOST_TEST_EQ(hash_value(st), hash_value(stacktrace(0, 0)));
+}
+
+void test_roundtrip() {
+    const stacktrace st = make_trace(5);
+    const compact_stacktrace cst(st);
+
+    BOOST_TEST_EQ(cst.size(), st.size());
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        BOOST_TEST(cst[i] == st[i]);
+    }
+    BOOST_TEST(cst.to_stacktrace() == st);
+    BOOST_TEST_EQ(hash_value(cst), hash_value(st));
+    BOOST_TEST_EQ(to_string(cst), to_string(st));
+
+    std::size_t count = 0;
+    for (frame f: cst) {
+        BOOST_TEST(f == st[count]);
+        ++count;
+    }
+    BOOST_TEST_EQ(count, st.size());
+
+    compact_stacktrace copy(cst);
+    BOOST_TEST(copy == cst);
+    BOOST_TEST(!(copy < cst));
+    compact_stacktrace moved(std::move(copy));
+    BOOST_TEST(moved == cst);
+    copy = moved;
+    BOOST_TEST(copy == moved);
+}
+
+void test_capture() {
+    const bool is_noop = !stacktrace();
+    const compact_stacktrace cst = make_compact(3);
+    BOOST_TEST(is_noop || cst.size() > 4);
+
+    const compact_stacktrace limited(1, 2);
+    BOOST_TEST(limited.size() <= 2);
+    BOOST_TEST(is_noop || limited.size() == 2);
+
+    const compact_stacktrace other = make_compact(4);
+    BOOST_TEST(is_noop || cst != other);
+    BOOST_TEST(is_noop || cst < other);
+    BOOST_TEST(is_noop || (cst < other) == (cst.to_stacktrace() < other.to_stacktrace()));
+}
+
+void test_arbitrary_addresses() {
+    // Addresses spread over the address space must survive the conversion, even when they do not fit
+    // into the table of regions.
+    std::vector<frame::native_frame_ptr_t> frames;
+    for (std::uintptr_t i = 1; i <= 5000; ++i) {
+        frames.push_back(reinterpret_cast<frame::native_frame_ptr_t>(i * static_cast<std::uintptr_t>(0x100123)));
+    }
+
+    const compact_stacktrace cst = compact_stacktrace::from_dump(frames.data(), frames.size() * sizeof(frames[0]));
+    BOOST_TEST_EQ(cst.size(), frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        BOOST_TEST_EQ(cst[i].address(), frames[i]);
+    }
+
+    // Terminating zero frame
+    const frame::native_frame_ptr_t terminated[] = {frames[0], frames[1], nullptr, frames[2]};
+    BOOST_TEST_EQ(compact_stacktrace::from_dump(terminated, sizeof(terminated)).size(), 2u);
+}
+
+void test_threads() {
+    const stacktrace expected = make_trace(2);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&expected, t]() {
+            for (int i = 0; i < 100; ++i) {
+                const compact_stacktrace cst(expected);
+                BOOST_TEST(cst.to_stacktrace() == expected);
+
+                const frame::native_frame_ptr_t f[] = {
+                    reinterpret_cast<frame::native_frame_ptr_t>(static_cast<std::uintptr_t>((t * 100 + i + 1) << 20) + 7)
+                };
+                BOOST_TEST_EQ(compact_stacktrace::from_dump(f, sizeof(f))[0].address(), f[0]);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+int main() {
+    test_empty();
+    test_roundtrip();
+    test_capture();
+    test_threads();
+    test_arbitrary_addresses();
+
+    return boost::report_errors();
+}
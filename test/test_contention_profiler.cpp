@@ -0,0 +1,171 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/contention_profiler.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX)
+#   include <cerrno>
+#   include <pthread.h>
+#endif
+
+using boost::stacktrace::contention_profile_entry;
+using boost::stacktrace::contention_profiler;
+using boost::stacktrace::profiled_mutex;
+using boost::stacktrace::stacktrace;
+
+const char* const kFile = "./contention_profiler_test.pb.gz";
+
+profiled_mutex<> shared_mutex;
+volatile int shared_value = 0;
+
+BOOST_NOINLINE void function_with_known_name(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+        std::lock_guard<profiled_mutex<> > lock(shared_mutex);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        shared_value = shared_value + 1;
+    }
+    not_a_tail_call(static_cast<std::uint64_t>(shared_value));
+}
+
+namespace {
+
+void run_threads(int iterations) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back(function_with_known_name, iterations);
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+} // anonymous namespace
+
+void test_contention() {
+    contention_profiler profiler(std::chrono::microseconds(10));
+    BOOST_TEST(!profiler.running());
+    BOOST_TEST(profiler.threshold() == std::chrono::microseconds(10));
+    BOOST_TEST_EQ(profiler.sample_rate(), 1u);
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.running());
+
+    contention_profiler another;
+    BOOST_TEST(!another.start());
+
+    run_threads(50);
+    profiler.stop();
+    BOOST_TEST(!profiler.running());
+    run_threads(10); // not recorded
+
+    const std::uint64_t samples = profiler.samples();
+    BOOST_TEST_GT(samples, 50u);
+
+    const std::vector<contention_profile_entry> entries = profiler.snapshot();
+    BOOST_TEST(!entries.empty());
+    std::uint64_t contentions = 0;
+    std::uint64_t wait_ns = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        contentions += entries[i].contentions;
+        wait_ns += entries[i].wait_ns;
+        BOOST_TEST_GE(entries[i].wait_ns, entries[i].contentions * 10000u);
+        BOOST_TEST(i == 0 || entries[i - 1].wait_ns >= entries[i].wait_ns);
+    }
+    BOOST_TEST_EQ(contentions, samples);
+    BOOST_TEST_GT(wait_ns, samples * 10000u);
+
+    const std::vector<contention_profile_entry> top = profiler.top(1);
+    BOOST_TEST_EQ(top.size(), 1u);
+    BOOST_TEST_EQ(top[0].wait_ns, entries[0].wait_ns);
+    if (stacktrace()) { // not the noop implementation
+        BOOST_TEST(has_known_name(top[0].stack));
+    }
+
+    BOOST_TEST(profiler.write_pprof(kFile));
+    std::ifstream in(kFile, std::ios::binary);
+    const std::string profile((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    BOOST_TEST(profile.compare(0, 2, "\x1F\x8B") == 0);
+    in.close();
+    std::remove(kFile);
+
+    profiler.clear();
+    BOOST_TEST(profiler.snapshot().empty());
+    BOOST_TEST_EQ(profiler.samples(), 0u);
+}
+
+void test_threshold_and_rate() {
+    {
+        contention_profiler profiler(std::chrono::seconds(10));
+        BOOST_TEST(profiler.start());
+        run_threads(10);
+        profiler.stop();
+        BOOST_TEST_EQ(profiler.samples(), 0u);
+    }
+
+    contention_profiler profiler(std::chrono::nanoseconds(0), 4);
+    BOOST_TEST(profiler.start());
+    for (int i = 0; i < 8; ++i) {
+        contention_profiler::record_wait(std::chrono::microseconds(1));
+    }
+    profiler.stop();
+
+    const std::vector<contention_profile_entry> entries = profiler.snapshot();
+    BOOST_TEST_EQ(profiler.samples(), 2u);
+    BOOST_TEST_EQ(entries.size(), 1u);
+    BOOST_TEST_EQ(entries[0].contentions, 8u);
+    BOOST_TEST_EQ(entries[0].wait_ns, 8000u);
+}
+
+#if defined(BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX)
+// Linked with -Wl,--wrap=pthread_mutex_lock
+void test_robust_mutex() {
+    ::pthread_mutexattr_t attr;
+    ::pthread_mutexattr_init(&attr);
+    ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    ::pthread_mutex_t m;
+    ::pthread_mutex_init(&m, &attr);
+    ::pthread_mutexattr_destroy(&attr);
+
+    std::thread([&m]() { ::pthread_mutex_lock(&m); }).join(); // owner dies with the mutex locked
+
+    contention_profiler profiler(std::chrono::nanoseconds(0));
+    BOOST_TEST(profiler.start());
+    BOOST_TEST_EQ(::pthread_mutex_lock(&m), EOWNERDEAD);
+    profiler.stop();
+
+    BOOST_TEST_EQ(::pthread_mutex_consistent(&m), 0);
+    BOOST_TEST_EQ(::pthread_mutex_unlock(&m), 0);
+    BOOST_TEST_EQ(::pthread_mutex_lock(&m), 0);
+    BOOST_TEST_EQ(::pthread_mutex_unlock(&m), 0);
+    ::pthread_mutex_destroy(&m);
+}
+#endif
+
+int main() {
+    // Works without a running profiler
+    contention_profiler::record_wait(std::chrono::seconds(1));
+    contention_profiler::lock(shared_mutex.get());
+    shared_mutex.unlock();
+
+    test_contention();
+    test_threshold_and_rate();
+#if defined(BOOST_STACKTRACE_CONTENTION_PROFILER_WRAP_PTHREAD_MUTEX)
+    test_robust_mutex();
+#endif
+
+    return boost::report_errors();
+}
@@ -0,0 +1,131 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/cpu_profiler.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using boost::stacktrace::cpu_profiler;
+using boost::stacktrace::stacktrace;
+
+const char* const kFile = "./cpu_profiler_test.pb.gz";
+
+void test_sampling() {
+    cpu_profiler profiler(997);
+    BOOST_TEST(!profiler.running());
+    BOOST_TEST_EQ(profiler.samples(), 0u);
+
+    std::atomic<bool> go(false);
+    std::thread worker([&go]() {
+        while (!go.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        busy_function_with_known_name(std::chrono::milliseconds(300));
+    });
+
+    if (!cpu_profiler::is_supported()) {
+        BOOST_TEST(!profiler.start());
+        go = true;
+        worker.join();
+        BOOST_TEST(profiler.folded().empty());
+        return;
+    }
+
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.running());
+    BOOST_TEST_EQ(profiler.frequency(), 997u);
+
+    cpu_profiler another;
+    BOOST_TEST(!another.start());
+
+    go = true;
+    busy_function_with_known_name(std::chrono::milliseconds(300));
+    worker.join();
+    profiler.stop();
+    profiler.stop();
+    BOOST_TEST(!profiler.running());
+
+    const std::uint64_t samples = profiler.samples();
+    BOOST_TEST_GT(samples, 50u);
+    BOOST_TEST_EQ(profiler.dropped(), 0u);
+
+    const std::string folded = profiler.folded();
+    std::ostringstream os;
+    profiler.write_folded(os);
+    BOOST_TEST_EQ(os.str(), folded);
+    if (stacktrace()) { // not the noop implementation
+        BOOST_TEST(folded.find("function_with_known_name") != std::string::npos);
+    }
+
+    BOOST_TEST(profiler.write_pprof(kFile));
+    std::ifstream in(kFile, std::ios::binary);
+    const std::string profile((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    BOOST_TEST(profile.compare(0, 2, "\x1F\x8B") == 0);
+    in.close();
+    std::remove(kFile);
+
+    // Profiler could be started again, samples are accumulated
+    BOOST_TEST(another.start());
+    another.stop();
+    BOOST_TEST(profiler.start());
+    busy_function_with_known_name(std::chrono::milliseconds(50));
+    profiler.stop();
+    BOOST_TEST_GE(profiler.samples(), samples);
+
+    profiler.clear();
+    BOOST_TEST_EQ(profiler.samples(), 0u);
+    BOOST_TEST(profiler.folded().empty());
+}
+
+void test_overhead_budget() {
+    if (!cpu_profiler::is_supported()) {
+        return;
+    }
+
+    cpu_profiler profiler(997, 0.0);
+    BOOST_TEST(profiler.start());
+    busy_function_with_known_name(std::chrono::milliseconds(1300));
+    BOOST_TEST_LT(profiler.frequency(), 997u);
+    profiler.stop();
+    BOOST_TEST_GT(profiler.samples(), 0u);
+}
+
+void test_thread_start_time() {
+#if defined(__linux__)
+    const std::uint64_t self = boost::stacktrace::detail::current_thread_id();
+    const std::uint64_t start_time = boost::stacktrace::detail::thread_start_time(self);
+    BOOST_TEST_GT(start_time, 0u);
+    BOOST_TEST_EQ(boost::stacktrace::detail::thread_start_time(self), start_time);
+
+    std::uint64_t worker_start_time = 0;
+    std::thread worker([&worker_start_time]() {
+        worker_start_time = boost::stacktrace::detail::thread_start_time(boost::stacktrace::detail::current_thread_id());
+    });
+    worker.join();
+    BOOST_TEST_GE(worker_start_time, start_time);
+
+    BOOST_TEST_EQ(boost::stacktrace::detail::thread_start_time(0), 0u);
+#endif
+}
+
+int main() {
+    test_sampling();
+    test_overhead_budget();
+    test_thread_start_time();
+
+    return boost::report_errors();
+}
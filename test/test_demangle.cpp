@@ -0,0 +1,178 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/detail/demangle.hpp>
+
+#include <boost/core/demangle.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using boost::stacktrace::detail::demangle_to;
+
+namespace {
+
+struct name_sample {
+    const char* mangled;
+    const char* demangled;
+};
+
+const name_sample samples[] = {
+    {"_Z3foov", "foo()"},
+    {"_Z3fooic", "foo(int, char)"},
+    {"_ZN5boost10stacktrace5frame4nameEv", "boost::stacktrace::frame::name()"},
+    {"_ZNK5boost10stacktrace5frame4nameEv", "boost::stacktrace::frame::name() const"},
+    {"_ZN12_GLOBAL__N_18functionEPKcRKSs",
+        "(anonymous namespace)::function(char const*, std::string const&)"},
+    {"_ZNSt6vectorIiSaIiEE9push_backERKi", "std::vector<int, std::allocator<int> >::push_back(int const&)"},
+    {"_ZNSt6vectorIN5boost10stacktrace5frameESaIS2_EE12emplace_backIJS2_EEEvDpOT_",
+        "void std::vector<boost::stacktrace::frame, std::allocator<boost::stacktrace::frame> >::emplace_back<boost::stacktrace::frame>(boost::stacktrace::frame&&)"},
+    {"_ZSt10_ConstructIPKvJEEvPT_DpOT0_", "void std::_Construct<void const*>(void const**)"},
+    {"_Z4testIiLi3ELb1EEvT_", "void test<int, 3, true>(int)"},
+    {"_ZN1AC2Ev", "A::A()"},
+    {"_ZN1AD1Ev", "A::~A()"},
+    {"_ZN1AplERKS_", "A::operator+(A const&)"},
+    {"_ZN1AltIiEEbv", "bool A::operator< <int>()"},
+    {"_ZN1Acv1BEv", "A::operator B()"},
+    {"_ZZ4mainENKUliE_clEi", "main::{lambda(int)#1}::operator()(int) const"},
+    {"_ZZ4mainENKUlvE0_clEv", "main::{lambda()#2}::operator()() const"},
+    {"_Z1fPFviE", "f(void (*)(int))"},
+    {"_Z1fRKSt8functionIFvvEE", "f(std::function<void ()> const&)"},
+    {"_Z1fPVKi", "f(int const volatile*)"},
+    {"_Z1fB5cxx11v", "f[abi:cxx11]()"},
+    {"_ZL6helperv", "helper()"},
+    {"_ZZ1fvE1x", "f()::x"},
+    {"_ZTV1A", "vtable for A"},
+    {"_ZTI1A", "typeinfo for A"},
+    {"_ZThn8_N1B1fEv", "non-virtual thunk to B::f()"},
+    {"_ZGVZ1fvE1x", "guard variable for f()::x"},
+    {"_Z3foov.cold", "foo() [clone .cold]"},
+    {"_Z3fooi.constprop.0.isra.0", "foo(int) [clone .constprop.0] [clone .isra.0]"},
+};
+
+// Names that were written differently from `__cxa_demangle`. Each one must either be demangled exactly as
+// the system demangler does it or be left to it.
+const char* const system_samples[] = {
+    // Functions returning pointers to functions
+    "_ZN5boost10stacktrace6detail13void_ptr_castIPFiiEvEET_PT0_",
+    "_ZN5boost10stacktrace6detail13void_ptr_castIPFvvEvEET_PT0_",
+    "_ZN5boost10stacktrace6detail13void_ptr_castIPFviizEvEET_PT0_",
+    "_Z1fIiEPFivEv",
+    "_Z1fIiERFivEv",
+    "_ZN1A1fIiEEPFivEv",
+    "_Z1fIiEPFPFivEvEv",
+
+    // Empty packs that are not the last argument
+    "_ZNSt6threadC1IZ4mainEUlvE_JEvEEOT_DpOT0_",
+    "_ZNSt6threadC2IZN12_GLOBAL__N_112test_threadsEvEUlvE_JEvEEOT_DpOT0_",
+    "_Z1fIJEiEvv",
+    "_Z1fIJEJEiEvv",
+    "_Z1fIiJEEvv",
+    "_Z1fI1AIJEiEEvv",
+    "_Z1fI1AIiJEEEvv",
+    "_Z1fIJEEvDpT_i",
+    "_Z1fIJEEviDpT_i",
+    "_Z1fIiJEEvDpT0_T_",
+    "_Z1fIJEiEvDpT_T0_",
+
+    // Local names of template functions used as template arguments
+    "_Z1fIZ1gIiEvvEUlvE_EvT_",
+    "_Z1fIiZ1gIiEvvEUlvE_EvT0_",
+    "_ZN5boost10stacktrace6detail15format_to_charsIZNS0_7to_jsonISaINS0_5frameEEEEmRKNS0_16basic_stacktraceIT_EEPcmEUlNS1_9text_sinkEE_EEmSB_mS7_",
+    "_ZN6google8protobuf8internal18EpsCopyInputStream16ReadPackedVarintIZNS1_12VarintParserIbLb0EEEPKcPvS6_PNS1_12ParseContextEEUlmE_EES6_S6_T_",
+
+    // Generic lambdas and templated conversion operators
+    "_ZZN1A1fEvENKUlT_iE_clIjEEDaS0_i",
+    "_ZN1AcvT_IiEEv",
+    "_ZN1AcvSt4pairIT_T0_EIiiEEv",
+};
+
+} // anonymous namespace
+
+void test_system_names() {
+    for (const char* mangled: system_samples) {
+        const std::string system = boost::core::demangle(mangled);
+        char buf[1024];
+        const std::size_t size = demangle_to(mangled, buf, sizeof(buf));
+        if (size && system != mangled) {
+            const std::string res(buf, size);
+            if (res != system) {
+                std::cerr << mangled << ": " << res << '\n';
+            }
+            BOOST_TEST_EQ(res, system);
+        }
+        BOOST_TEST_EQ(boost::stacktrace::detail::demangle(mangled), system);
+    }
+}
+
+void test_known_names() {
+    for (const name_sample& s: samples) {
+        char buf[1024];
+        const std::size_t size = demangle_to(s.mangled, buf, sizeof(buf));
+        const std::string res(buf, size);
+        if (res != s.demangled) {
+            std::cerr << s.mangled << ": " << res << '\n';
+        }
+        BOOST_TEST_EQ(res, s.demangled);
+        BOOST_TEST_EQ(boost::stacktrace::detail::demangle(s.mangled), s.demangled);
+
+        // Same as the system demangler
+        const std::string system = boost::core::demangle(s.mangled);
+        if (system != s.mangled) {
+            BOOST_TEST_EQ(res, system);
+        }
+    }
+}
+
+void test_not_supported() {
+    char buf[1024];
+    BOOST_TEST_EQ(demangle_to("", buf, sizeof(buf)), 0u);
+    BOOST_TEST_EQ(demangle_to("main", buf, sizeof(buf)), 0u);
+    BOOST_TEST_EQ(demangle_to("_Z", buf, sizeof(buf)), 0u);
+    BOOST_TEST_EQ(demangle_to("_ZN3foo", buf, sizeof(buf)), 0u);
+    BOOST_TEST_EQ(demangle_to("_Z1fv", nullptr, 0), 0u);
+    BOOST_TEST_EQ(demangle_to(nullptr, buf, sizeof(buf)), 0u);
+
+    // Arrays are left to the system demangler
+    const char* array_ref = "_Z1fRA1_c";
+    BOOST_TEST_EQ(demangle_to(array_ref, buf, sizeof(buf)), 0u);
+    BOOST_TEST_EQ(boost::stacktrace::detail::demangle(array_ref), boost::core::demangle(array_ref));
+
+    // Names that are not mangled are returned as is
+    BOOST_TEST_EQ(boost::stacktrace::detail::demangle("main"), "main");
+    BOOST_TEST_EQ(boost::stacktrace::detail::demangle("i"), "i");
+}
+
+void test_small_buffer() {
+    const char* mangled = "_ZN5boost10stacktrace5frame4nameEv";
+    char buf[64];
+    std::memset(buf, 'X', sizeof(buf));
+    BOOST_TEST_EQ(demangle_to(mangled, buf, 10), 0u);
+    BOOST_TEST_EQ(buf[10], 'X');
+
+    const std::size_t size = std::strlen("boost::stacktrace::frame::name()");
+    BOOST_TEST_EQ(demangle_to(mangled, buf, size), size);
+}
+
+void test_memo() {
+    // Repeated lookups of the same names and collisions in the table
+    for (int i = 0; i < 3; ++i) {
+        for (const name_sample& s: samples) {
+            BOOST_TEST_EQ(boost::stacktrace::detail::demangle(s.mangled), s.demangled);
+        }
+    }
+}
+
+int main() {
+    test_known_names();
+    test_system_names();
+    test_not_supported();
+    test_small_buffer();
+    test_memo();
+
+    return boost::report_errors();
+}
@@ -0,0 +1,97 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE stacktrace make_trace() {
+    return stacktrace();
+}
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE void function_with_known_line() {
+    static volatile int i = 0;
+    ++i;
+}
+static const std::size_t function_line = __LINE__ - 4;
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    const std::string suf = suffix;
+    return s.size() >= suf.size() && s.compare(s.size() - suf.size(), suf.size(), suf) == 0;
+}
+
+void test_call_site() {
+    const stacktrace st = make_trace(); const std::size_t line = __LINE__;
+    BOOST_TEST(st.size() > 1);
+
+    // Skipping the frames of make_trace and of the inlined stacktrace constructor
+    std::size_t i = 1;
+    while (i < st.size() && st[i].name().find("test_call_site") == std::string::npos) {
+        ++i;
+    }
+    BOOST_TEST(i < st.size());
+    if (i == st.size()) {
+        return;
+    }
+
+    BOOST_TEST(st[i].source_line() > 0);
+#ifndef __OPTIMIZE__
+    // With optimizations the return address could belong to an inlined function
+    BOOST_TEST(ends_with(st[i].source_file(), "test_dwarf.cpp"));
+    BOOST_TEST(to_string(st[i]).find("test_dwarf.cpp:") != std::string::npos);
+    BOOST_TEST_EQ(st[i].source_line(), line);
+#else
+    (void)line;
+#endif
+}
+
+void test_function_address() {
+    const frame f(&function_with_known_line);
+    BOOST_TEST(ends_with(f.source_file(), "test_dwarf.cpp"));
+    // With optimizations the first instruction may belong to the function body
+    BOOST_TEST_GE(f.source_line(), function_line);
+    BOOST_TEST_LE(f.source_line(), function_line + 2);
+}
+
+void test_unknown_addresses() {
+    static const char data[] = "not a code";
+    BOOST_TEST_EQ(frame(data).source_line(), 0u);
+    BOOST_TEST_EQ(frame(reinterpret_cast<const void*>(16)).source_file(), "");
+    BOOST_TEST_EQ(frame().source_line(), 0u);
+}
+
+void test_threads() {
+    const stacktrace st = make_trace();
+    const std::string expected = to_string(st);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&st, &expected]() {
+            for (int i = 0; i < 20; ++i) {
+                BOOST_TEST_EQ(to_string(st), expected);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+int main() {
+    test_call_site();
+    test_function_address();
+    test_unknown_addresses();
+    test_threads();
+
+    return boost::report_errors();
+}
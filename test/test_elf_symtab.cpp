@@ -0,0 +1,82 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Must be built without exporting the symbols (no -rdynamic), so that ::dladdr knows nothing
+// about the functions below.
+
+#include <boost/stacktrace.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+namespace {
+
+BOOST_NOINLINE stacktrace function_in_anonymous_namespace() {
+    return stacktrace();
+}
+
+} // anonymous namespace
+
+BOOST_NOINLINE static stacktrace static_function_with_args(int, const char*) {
+    return function_in_anonymous_namespace();
+}
+
+struct some_class {
+    BOOST_NOINLINE static stacktrace member() {
+        return static_function_with_args(0, "");
+    }
+};
+
+void test_local_names() {
+    const stacktrace st = some_class::member();
+    const std::string s = to_string(st);
+    std::cout << s << '\n';
+
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_ELF_SYMTAB
+    BOOST_TEST(s.find("function_in_anonymous_namespace") != std::string::npos);
+    BOOST_TEST(s.find("static_function_with_args(int, char const*)") != std::string::npos);
+    BOOST_TEST(s.find("some_class::member()") != std::string::npos);
+    BOOST_TEST(s.find("test_local_names") != std::string::npos);
+
+    BOOST_TEST_EQ(frame(&static_function_with_args).name(), "static_function_with_args(int, char const*)");
+    BOOST_TEST_EQ(frame(&some_class::member).name(), "some_class::member()");
+#endif
+}
+
+void test_not_functions() {
+    static const char data[] = "data";
+    BOOST_TEST_EQ(frame(data).name(), "");
+    BOOST_TEST_EQ(frame(reinterpret_cast<const void*>(16)).name(), "");
+}
+
+void test_threads() {
+    const std::string expected = frame(&static_function_with_args).name();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&expected]() {
+            for (int i = 0; i < 50; ++i) {
+                BOOST_TEST_EQ(frame(&static_function_with_args).name(), expected);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+int main() {
+    test_local_names();
+    test_not_functions();
+    test_threads();
+
+    return boost::report_errors();
+}
@@ -0,0 +1,174 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/flight_recorder.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#if !defined(BOOST_WINDOWS)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+using boost::stacktrace::flight_recorder;
+using boost::stacktrace::flight_recorder_entry;
+
+namespace {
+
+const char* const kFile = "./flight_recorder_test.ring";
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE std::size_t record_nested(flight_recorder& rec, int depth) {
+    if (depth) {
+        return record_nested(rec, depth - 1) + 0;
+    }
+    return rec.record();
+}
+
+void test_not_opened() {
+    flight_recorder rec;
+    BOOST_TEST(!rec);
+    BOOST_TEST_EQ(rec.record(), 0u);
+
+    BOOST_TEST(flight_recorder::read("./flight_recorder_test_missing.ring").empty());
+}
+
+void test_ring() {
+    std::remove(kFile);
+
+    const bool is_noop = !boost::stacktrace::stacktrace();
+    {
+        flight_recorder rec(kFile, 4, 16);
+        BOOST_TEST(rec);
+        for (int i = 0; i < 10; ++i) {
+            const std::size_t frames = record_nested(rec, i % 3);
+            BOOST_TEST(is_noop || frames > 0);
+            BOOST_TEST(frames <= 16);
+        }
+    }
+
+    std::vector<flight_recorder_entry> entries = flight_recorder::read(kFile);
+    BOOST_TEST_EQ(entries.size(), 4u);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        BOOST_TEST_EQ(entries[i].sequence, 6u + i);
+        BOOST_TEST(entries[i].timestamp_ns != 0u);
+        BOOST_TEST(is_noop || entries[i].trace);
+        BOOST_TEST(entries[i].trace.size() <= 16);
+    }
+    BOOST_TEST(entries[0].timestamp_ns <= entries[3].timestamp_ns);
+
+    entries = flight_recorder::read(kFile, 2);
+    BOOST_TEST_EQ(entries.size(), 2u);
+    BOOST_TEST_EQ(entries[0].sequence, 8u);
+    BOOST_TEST_EQ(entries[1].sequence, 9u);
+
+    // Reopening with the same geometry keeps the records and continues the sequence
+    {
+        flight_recorder rec(kFile, 4, 16);
+        BOOST_TEST(rec);
+        rec.record();
+    }
+    entries = flight_recorder::read(kFile, 1);
+    BOOST_TEST_EQ(entries.size(), 1u);
+    BOOST_TEST_EQ(entries[0].sequence, 10u);
+
+    // Reopening with different geometry resets the file
+    {
+        flight_recorder rec(kFile, 8, 16);
+        BOOST_TEST(rec);
+    }
+    BOOST_TEST(flight_recorder::read(kFile).empty());
+
+    std::remove(kFile);
+}
+
+void test_threads() {
+    std::remove(kFile);
+    {
+        flight_recorder rec(kFile, 64, 32);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&rec]() {
+                for (int j = 0; j < 100; ++j) {
+                    record_nested(rec, j % 5);
+                }
+            });
+        }
+        for (std::size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+    }
+
+    const std::vector<flight_recorder_entry> entries = flight_recorder::read(kFile);
+    BOOST_TEST_EQ(entries.size(), 64u);
+    for (std::size_t i = 1; i < entries.size(); ++i) {
+        BOOST_TEST(entries[i - 1].sequence < entries[i].sequence);
+    }
+    BOOST_TEST_EQ(entries.back().sequence, 399u);
+
+    std::remove(kFile);
+}
+
+#if !defined(BOOST_WINDOWS)
+void test_slot_being_written() {
+    namespace bsd = boost::stacktrace::detail;
+    std::remove(kFile);
+    {
+        flight_recorder rec(kFile, 2, 8);
+        rec.record();
+        rec.record();
+
+        // Another writer that reserved the slot 0 a ring ago has not finished yet
+        const int fd = ::open(kFile, O_RDWR);
+        BOOST_TEST_NE(fd, -1);
+        const std::size_t size = sizeof(bsd::flight_recorder_header) + 2 * bsd::flight_recorder_slot_size(8);
+        void* p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        BOOST_TEST(p != MAP_FAILED);
+        bsd::flight_recorder_slot* slot0 = reinterpret_cast<bsd::flight_recorder_slot*>(
+            static_cast<unsigned char*>(p) + sizeof(bsd::flight_recorder_header)
+        );
+        slot0->sequence.store(1 | bsd::flight_recorder_writing);
+        ::munmap(p, size);
+
+        rec.record();   // number 2 goes to the slot 0 and is dropped
+        rec.record();   // number 3
+
+        const std::vector<flight_recorder_entry> entries = flight_recorder::read(kFile);
+        BOOST_TEST_EQ(entries.size(), 1u);
+        BOOST_TEST_EQ(entries[0].sequence, 3u);
+    }
+
+    // Incomplete records of the previous owner do not block the slot after reopening
+    {
+        flight_recorder rec(kFile, 2, 8);
+        rec.record();   // number 4
+    }
+    const std::vector<flight_recorder_entry> entries = flight_recorder::read(kFile);
+    BOOST_TEST_EQ(entries.size(), 2u);
+    BOOST_TEST_EQ(entries[0].sequence, 3u);
+    BOOST_TEST_EQ(entries[1].sequence, 4u);
+
+    std::remove(kFile);
+}
+#endif
+
+} // anonymous namespace
+
+int main() {
+    test_not_opened();
+#if !defined(BOOST_WINDOWS)
+    test_ring();
+    test_threads();
+    test_slot_being_written();
+#endif
+
+    return boost::report_errors();
+}
@@ -0,0 +1,148 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/folded_stacks.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using boost::stacktrace::folded_stacks;
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    not_a_tail_call(res.size());
+    return res;
+}
+
+BOOST_NOINLINE void root_function() { depth = 1; }
+BOOST_NOINLINE void middle_function() { depth = 2; }
+BOOST_NOINLINE void leaf_function() { depth = 3; }
+
+namespace {
+
+std::string folded_name(const frame& f) {
+    std::string res = f.name();
+    if (res.empty()) {
+        res = boost::stacktrace::detail::to_hex_array(f.address()).data();
+    }
+    return res;
+}
+
+} // anonymous namespace
+
+void test_counting() {
+    const frame frames[] = { frame(&leaf_function), frame(&middle_function), frame(&root_function) };
+    const std::string prefix = folded_name(frames[2]) + ";" + folded_name(frames[1]) + ";";
+
+    folded_stacks stacks;
+    BOOST_TEST(stacks.empty());
+
+    const std::size_t id = stacks.add(frames, 3);
+    BOOST_TEST_EQ(stacks.add(frames, 3, 4), id);
+    stacks.add_weight(id, 2);
+    const std::size_t other = stacks.add(frames + 1, 2, 10);
+    BOOST_TEST_NE(other, id);
+    stacks.add(frames, 0, 100); // empty stacks are not written
+
+    BOOST_TEST_EQ(stacks.size(), 3u);
+    BOOST_TEST_EQ(stacks.total_weight(), 117u);
+
+    const std::string expected = prefix + folded_name(frames[0]) + " 7\n"
+        + folded_name(frames[2]) + ";" + folded_name(frames[1]) + " 10\n";
+    BOOST_TEST_EQ(stacks.str(), expected);
+
+    // Names are remembered, new frames are symbolized on the next output
+    stacks.add(frames + 2, 1);
+    std::ostringstream oss;
+    oss << stacks;
+    BOOST_TEST_EQ(oss.str(), expected + folded_name(frames[2]) + " 1\n");
+
+    std::string appended = "x\n";
+    stacks.append_to(appended);
+    BOOST_TEST_EQ(appended, "x\n" + oss.str());
+
+    std::size_t visited = 0;
+    stacks.for_each_stack([&](const frame* f, std::size_t size, std::uint64_t weight) {
+        if (visited == 0) {
+            BOOST_TEST_EQ(size, 3u);
+            BOOST_TEST_EQ(weight, 7u);
+            BOOST_TEST(f[0] == frames[0] && f[2] == frames[2]);
+        } else if (visited == 2) {
+            BOOST_TEST_EQ(size, 0u);
+            BOOST_TEST_EQ(weight, 100u);
+        }
+        ++visited;
+    });
+    BOOST_TEST_EQ(visited, 4u);
+
+    stacks.clear();
+    BOOST_TEST(stacks.empty());
+    BOOST_TEST_EQ(stacks.total_weight(), 0u);
+    BOOST_TEST_EQ(stacks.str(), std::string());
+}
+
+void test_same_functions() {
+    // Different call sites inside the same function produce a single line
+    const frame first[] = { frame(&leaf_function), frame(&root_function) };
+    const frame second[] = {
+        frame(static_cast<const char*>(reinterpret_cast<const void*>(&leaf_function)) + 1),
+        frame(&root_function)
+    };
+
+    folded_stacks stacks;
+    const std::size_t id = stacks.add(first, 2);
+    BOOST_TEST_NE(stacks.add(second, 2, 2), id);
+
+    const std::string first_line = folded_name(first[1]) + ";" + folded_name(first[0]);
+    const std::string second_line = folded_name(second[1]) + ";" + folded_name(second[0]);
+    if (first_line == second_line) {
+        BOOST_TEST_EQ(stacks.str(), first_line + " 3\n");
+    } else {
+        BOOST_TEST_EQ(stacks.str(), first_line + " 1\n" + second_line + " 2\n");
+    }
+}
+
+void test_stacktraces() {
+    folded_stacks stacks;
+    stacktrace st;
+    std::size_t id = 0;
+    for (int i = 0; i < 10; ++i) {
+        st = function_with_known_name();
+        id = stacks.add(st);
+    }
+
+    const std::string text = stacks.str();
+    std::cout << text;
+    BOOST_TEST_EQ(stacks.total_weight(), 10u);
+
+    if (st) { // not the noop implementation
+        BOOST_TEST_EQ(stacks.size(), 1u);
+        BOOST_TEST_EQ(stacks.add(st, 0), id);
+        BOOST_TEST(text.find("function_with_known_name") != std::string::npos);
+        BOOST_TEST(text.find("main;") != std::string::npos);
+        BOOST_TEST(text.find(" 10\n") == text.size() - 4);
+        BOOST_TEST_EQ(text.find('\n'), text.size() - 1);
+    } else {
+        BOOST_TEST_EQ(text, std::string());
+    }
+}
+
+int main() {
+    test_counting();
+    test_same_functions();
+    test_stacktraces();
+
+    return boost::report_errors();
+}
@@ -0,0 +1,114 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/forked_dump.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_WINDOWS) && !defined(BOOST_STACKTRACE_USE_NOOP)
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const char* report_path = "./test_forked_dump.report";
+volatile bool dump_result = false;
+volatile int returns_from_raise = 0;
+
+std::string read_report() {
+    std::ifstream in(report_path);
+    std::string res((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::cout << res;
+    return res;
+}
+
+extern "C" void signal_handler(int signum) {
+    ::signal(signum, SIG_DFL);
+    dump_result = boost::stacktrace::forked_dump_to(report_path);
+}
+
+} // anonymous namespace
+
+BOOST_NOINLINE void crashing_function() {
+    std::raise(SIGSEGV);
+    ++returns_from_raise; // not a tail call
+}
+
+BOOST_NOINLINE void function_that_dumps() {
+    dump_result = boost::stacktrace::forked_dump_to(report_path);
+}
+
+void test_direct_call() {
+    function_that_dumps();
+    BOOST_TEST(dump_result);
+
+    const std::string report = read_report();
+    BOOST_TEST(report.find("0# function_that_dumps()") != std::string::npos);
+    BOOST_TEST(report.find("test_direct_call") != std::string::npos);
+    BOOST_TEST(report.find("Symbolization failed") == std::string::npos);
+}
+
+void test_crash() {
+    std::remove(report_path);
+
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        ::signal(SIGSEGV, &signal_handler);
+        crashing_function();
+        ::_exit(dump_result ? 0 : 1);
+    }
+
+    int status = 0;
+    BOOST_TEST_EQ(::waitpid(pid, &status, 0), pid);
+    BOOST_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    const std::string report = read_report();
+    BOOST_TEST(report.find("crashing_function()") != std::string::npos);
+    BOOST_TEST(report.find("test_crash()") != std::string::npos);
+}
+
+void test_timeout() {
+    // Zero timeout kills the child right away and falls back to the raw addresses
+    const bool res = boost::stacktrace::forked_dump_to(report_path, std::chrono::milliseconds(0));
+    const std::string report = read_report();
+    if (!res) {
+        BOOST_TEST_EQ(report.find("Symbolization failed, raw frames:\n 0# 0x"), 0u);
+    }
+}
+
+void test_ignored_sigchld() {
+    // The child is reaped automatically and its result is lost, the raw addresses are written after its output
+    ::signal(SIGCHLD, SIG_IGN);
+    const bool res = boost::stacktrace::forked_dump_to(report_path);
+    ::signal(SIGCHLD, SIG_DFL);
+    BOOST_TEST(!res);
+
+    const std::string report = read_report();
+    BOOST_TEST(report.find("Symbolization failed, raw frames:\n 0# 0x") != std::string::npos);
+}
+
+int main() {
+    test_direct_call();
+    test_crash();
+    test_timeout();
+    test_ignored_sigchld();
+
+    std::remove(report_path);
+    return boost::report_errors();
+}
+
+#else
+
+int main() {}
+
+#endif
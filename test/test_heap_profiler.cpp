@@ -0,0 +1,150 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_STACKTRACE_HEAP_PROFILER_REPLACE_OPERATOR_NEW
+#include <boost/stacktrace/heap_profiler.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::heap_profile_entry;
+using boost::stacktrace::heap_profiler;
+using boost::stacktrace::stacktrace;
+
+const char* const kFile = "./heap_profiler_test.pb.gz";
+const std::size_t kBlockSize = 4096;
+
+std::vector<std::unique_ptr<char[]> > blocks;
+
+BOOST_NOINLINE void function_with_known_name(std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        blocks.emplace_back(new char[kBlockSize]);
+        blocks.back()[0] = 0; // not a tail call
+    }
+}
+
+void test_estimations() {
+    blocks.reserve(2000);
+    heap_profiler profiler(1024);
+    BOOST_TEST(!profiler.running());
+    BOOST_TEST_EQ(profiler.sample_interval(), 1024u);
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.start());
+    BOOST_TEST(profiler.running());
+
+    heap_profiler another;
+    BOOST_TEST(!another.start());
+
+    function_with_known_name(1000);
+    blocks.resize(400);
+    profiler.stop();
+    BOOST_TEST(!profiler.running());
+    function_with_known_name(100); // not sampled
+
+    BOOST_TEST_GT(profiler.samples(), 900u);
+    const std::vector<heap_profile_entry> entries = profiler.snapshot();
+    BOOST_TEST(!entries.empty());
+
+    std::uint64_t inuse_bytes = 0;
+    std::uint64_t alloc_bytes = 0;
+    std::uint64_t alloc_objects = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].stack && !has_known_name(entries[i].stack)) {
+            continue;
+        }
+        inuse_bytes += entries[i].inuse_bytes;
+        alloc_bytes += entries[i].alloc_bytes;
+        alloc_objects += entries[i].alloc_objects;
+        BOOST_TEST_LE(entries[i].inuse_bytes, entries[i].alloc_bytes);
+        BOOST_TEST(i == 0 || entries[i - 1].inuse_bytes >= entries[i].inuse_bytes);
+    }
+
+    // Each block is sampled with the probability 1 - e^-4, estimations are close to the real values
+    BOOST_TEST_GT(alloc_objects, 900u);
+    BOOST_TEST_LT(alloc_objects, 1100u);
+    BOOST_TEST_GT(alloc_bytes, 900u * kBlockSize);
+    BOOST_TEST_LT(alloc_bytes, 1100u * kBlockSize);
+    BOOST_TEST_GT(inuse_bytes, 300u * kBlockSize);
+    BOOST_TEST_LT(inuse_bytes, 500u * kBlockSize);
+
+    BOOST_TEST(profiler.write_pprof(kFile));
+    std::ifstream in(kFile, std::ios::binary);
+    const std::string profile((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    BOOST_TEST(profile.compare(0, 2, "\x1F\x8B") == 0);
+    in.close();
+    std::remove(kFile);
+
+    // In-use memory is reset on restart, allocated memory is kept
+    BOOST_TEST(profiler.start());
+    blocks.clear();
+    profiler.stop();
+    const std::vector<heap_profile_entry> restarted = profiler.snapshot();
+    std::uint64_t restarted_alloc_bytes = 0;
+    for (std::size_t i = 0; i < restarted.size(); ++i) {
+        BOOST_TEST_EQ(restarted[i].inuse_bytes, 0u);
+        if (!restarted[i].stack || has_known_name(restarted[i].stack)) {
+            restarted_alloc_bytes += restarted[i].alloc_bytes;
+        }
+    }
+    BOOST_TEST_EQ(restarted_alloc_bytes, alloc_bytes);
+
+    profiler.clear();
+    BOOST_TEST(profiler.snapshot().empty());
+    BOOST_TEST_EQ(profiler.samples(), 0u);
+}
+
+void test_threads() {
+    heap_profiler profiler(256);
+    BOOST_TEST(profiler.start());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            std::vector<std::string*> strings;
+            for (int i = 0; i < 100000; ++i) {
+                strings.push_back(new std::string(64, 'x'));
+                if (strings.size() > 100) {
+                    delete strings.front();
+                    strings.erase(strings.begin());
+                }
+            }
+            for (std::size_t i = 0; i < strings.size(); ++i) {
+                delete strings[i];
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    profiler.stop();
+
+    const std::vector<heap_profile_entry> entries = profiler.snapshot();
+    std::uint64_t alloc_bytes = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        alloc_bytes += entries[i].alloc_bytes;
+    }
+    BOOST_TEST_GT(profiler.samples(), 1000u);
+    BOOST_TEST_GT(alloc_bytes, 4u * 100000u * 64u / 2);
+}
+
+int main() {
+    // Works without a running profiler
+    heap_profiler::record_allocation(&kBlockSize, 8);
+    heap_profiler::record_deallocation(&kBlockSize);
+
+    test_estimations();
+    test_threads();
+
+    return boost::report_errors();
+}
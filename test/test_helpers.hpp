@@ -0,0 +1,56 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Functions that the tests look for in the captured stacks.
+
+#ifndef BOOST_STACKTRACE_TEST_HELPERS_HPP
+#define BOOST_STACKTRACE_TEST_HELPERS_HPP
+
+#include <boost/stacktrace/stacktrace.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Uses the value after the call, so the call is not a tail call and its frame stays in the stack
+inline void not_a_tail_call(std::uint64_t value) {
+    static std::atomic<std::uint64_t> sink(0);
+    sink.fetch_add(value);
+}
+
+// Work that the compiler could not remove
+inline std::uint64_t burn_cpu(std::uint64_t value) {
+    for (int i = 0; i < 1000; ++i) {
+        value = value * 6364136223846793005u + 1442695040888963407u;
+    }
+    return value;
+}
+
+// Keeps the CPU busy for the duration
+inline BOOST_NOINLINE void busy_function_with_known_name(std::chrono::milliseconds duration) {
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    std::uint64_t value = 1;
+    while (std::chrono::steady_clock::now() < end) {
+        value = burn_cpu(value);
+    }
+    not_a_tail_call(value);
+}
+
+inline bool has_name(const boost::stacktrace::stacktrace& st, const char* name) {
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        if (st[i].name().find(name) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool has_known_name(const boost::stacktrace::stacktrace& st) {
+    return has_name(st, "function_with_known_name");
+}
+
+#endif // BOOST_STACKTRACE_TEST_HELPERS_HPP
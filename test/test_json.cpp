@@ -0,0 +1,122 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/json.hpp>
+#include <boost/stacktrace/detail/json_writer.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    depth = res.size(); // not a tail call
+    return res;
+}
+
+namespace {
+
+// Counts the top level objects of the array, returns -1 if the structure is broken
+int count_objects(const std::string& json) {
+    int nesting = 0;
+    int objects = 0;
+    bool in_string = false;
+    for (std::size_t i = 0; i < json.size(); ++i) {
+        const char c = json[i];
+        if (in_string) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                in_string = false;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                return -1;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"': in_string = true; break;
+        case '[': case '{': ++nesting; objects += (c == '{' && nesting == 2); break;
+        case ']': case '}': --nesting; break;
+        }
+        if (nesting < 0) {
+            return -1;
+        }
+    }
+    return (nesting == 0 && !in_string) ? objects : -1;
+}
+
+std::string json_string(const std::string& s) {
+    std::string res;
+    boost::stacktrace::detail::append_json_string(res, s.data(), s.size());
+    return res;
+}
+
+} // anonymous namespace
+
+void test_escaping() {
+    BOOST_TEST_EQ(json_string(""), "\"\"");
+    BOOST_TEST_EQ(json_string("foo(int)"), "\"foo(int)\"");
+    BOOST_TEST_EQ(json_string("C:\\dir\\\"a\".cpp"), "\"C:\\\\dir\\\\\\\"a\\\".cpp\"");
+    BOOST_TEST_EQ(json_string("a\nb\tc\x01"), "\"a\\nb\\tc\\u0001\"");
+    BOOST_TEST_EQ(json_string("\xd0\xbf"), "\"\xd0\xbf\"");
+}
+
+void test_stacktrace() {
+    const stacktrace st = function_with_known_name();
+    const std::string json = boost::stacktrace::to_json(st);
+    std::cout << json << '\n';
+
+    BOOST_TEST_EQ(json[0], '[');
+    BOOST_TEST_EQ(json[json.size() - 1], ']');
+    BOOST_TEST_EQ(count_objects(json), static_cast<int>(st.size()));
+    BOOST_TEST_EQ(json.find('\n'), std::string::npos);
+
+    std::string appended = "x";
+    boost::stacktrace::append_to_json(appended, st);
+    BOOST_TEST_EQ(appended, "x" + json);
+
+    char buf[64];
+    BOOST_TEST_EQ(boost::stacktrace::to_json(st, buf, sizeof(buf)), json.size());
+    BOOST_TEST_EQ(std::string(buf), json.substr(0, sizeof(buf) - 1));
+
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        const frame& f = st[i];
+        const std::string object = boost::stacktrace::to_json(f);
+        BOOST_TEST_EQ(count_objects("[" + object + "]"), 1);
+        BOOST_TEST_EQ(object.find("\"index\""), std::string::npos);
+        BOOST_TEST(json.find("{\"index\":" + std::to_string(i) + ",") != std::string::npos);
+
+        const std::string name = f.name();
+        if (!name.empty()) {
+            BOOST_TEST(object.find("\"function\":" + json_string(name)) != std::string::npos);
+        }
+    }
+
+    if (st) { // not the noop implementation
+        BOOST_TEST(json.find("function_with_known_name") != std::string::npos);
+        BOOST_TEST(json.find("\"module\":\"") != std::string::npos);
+        BOOST_TEST(json.find("\"offset\":\"0x") != std::string::npos);
+    }
+}
+
+void test_empty() {
+    BOOST_TEST_EQ(boost::stacktrace::to_json(stacktrace(0, 0)), "[]");
+    BOOST_TEST_EQ(boost::stacktrace::to_json(frame()), "null");
+}
+
+int main() {
+    test_escaping();
+    test_stacktrace();
+    test_empty();
+
+    return boost::report_errors();
+}
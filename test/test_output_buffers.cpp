@@ -0,0 +1,110 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    depth = res.size(); // not a tail call
+    return res;
+}
+
+void test_append_to_string() {
+    const stacktrace st = function_with_known_name();
+    const std::string expected = boost::stacktrace::to_string(st);
+
+    std::string out = "prefix\n";
+    boost::stacktrace::append_to_string(out, st);
+    BOOST_TEST_EQ(out, "prefix\n" + expected);
+
+    // Reusing the buffer
+    out.clear();
+    boost::stacktrace::append_to_string(out, st);
+    BOOST_TEST_EQ(out, expected);
+
+    out.clear();
+    boost::stacktrace::append_to_string(out, stacktrace(0, 0));
+    BOOST_TEST_EQ(out, std::string());
+
+    for (const frame& f: st) {
+        out.clear();
+        boost::stacktrace::append_to_string(out, f);
+        BOOST_TEST_EQ(out, boost::stacktrace::to_string(f));
+    }
+
+    out.clear();
+    boost::stacktrace::append_to_string(out, frame());
+    BOOST_TEST_EQ(out, std::string());
+}
+
+void test_chars() {
+    const stacktrace st = function_with_known_name();
+    const std::string expected = boost::stacktrace::to_string(st);
+
+    char buf[4096];
+    BOOST_TEST_EQ(boost::stacktrace::to_string(st, buf, sizeof(buf)), expected.size());
+    if (expected.size() < sizeof(buf)) {
+        BOOST_TEST_EQ(std::string(buf), expected);
+    }
+
+    // Truncated output is still zero terminated
+    std::memset(buf, 'X', sizeof(buf));
+    const std::size_t written = boost::stacktrace::to_string(st, buf, 10);
+    BOOST_TEST_EQ(written, expected.size());
+    if (written) {
+        BOOST_TEST_EQ(std::strlen(buf), 9u);
+        BOOST_TEST_EQ(std::string(buf), expected.substr(0, 9));
+        BOOST_TEST_EQ(buf[10], 'X');
+    }
+
+    buf[0] = 'X';
+    BOOST_TEST_EQ(boost::stacktrace::to_string(st, buf, 0), expected.size());
+    BOOST_TEST_EQ(buf[0], 'X');
+
+    if (st) {
+        const std::string frame_text = boost::stacktrace::to_string(st[0]);
+        BOOST_TEST_EQ(boost::stacktrace::to_string(st[0], buf, sizeof(buf)), frame_text.size());
+        BOOST_TEST_EQ(std::string(buf), frame_text);
+    }
+}
+
+void test_ostream() {
+    const stacktrace st = function_with_known_name();
+
+    std::ostringstream oss;
+    oss << st;
+    BOOST_TEST_EQ(oss.str(), boost::stacktrace::to_string(st));
+
+    if (st) {
+        std::ostringstream frame_oss;
+        frame_oss << st[0];
+        BOOST_TEST_EQ(frame_oss.str(), boost::stacktrace::to_string(st[0]));
+    }
+
+    if (st) { // not the noop implementation
+        BOOST_TEST(oss.str().find("function_with_known_name") != std::string::npos);
+    }
+    std::cout << st;
+}
+
+int main() {
+    test_append_to_string();
+    test_chars();
+    test_ostream();
+
+    return boost::report_errors();
+}
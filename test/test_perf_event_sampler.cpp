@@ -0,0 +1,112 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/perf_event_sampler.hpp>
+#include <boost/stacktrace/cpu_profiler.hpp>
+#include <boost/stacktrace/detail/thread_id.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using boost::stacktrace::cpu_profiler;
+using boost::stacktrace::cpu_profiler_mode;
+using boost::stacktrace::perf_event_sampler;
+using boost::stacktrace::stacktrace;
+
+void test_sampler() {
+    perf_event_sampler sampler(997);
+    BOOST_TEST_EQ(sampler.threads(), 0u);
+    BOOST_TEST_EQ(sampler.period(), 1000000000u / 997);
+
+    const std::uint64_t this_thread = boost::stacktrace::detail::current_thread_id();
+    if (!sampler.add_thread(this_thread)) {
+        std::cout << "perf events are not available, skipping the test\n";
+        return;
+    }
+    BOOST_TEST(sampler.add_thread(this_thread));
+    BOOST_TEST_EQ(sampler.threads(), 1u);
+
+    busy_function_with_known_name(std::chrono::milliseconds(200));
+
+    std::size_t samples = 0;
+    std::size_t known = 0;
+    const std::size_t polled = sampler.poll([&](std::uint64_t tid, const stacktrace& st) {
+        BOOST_TEST_EQ(tid, this_thread);
+        ++samples;
+        known += has_known_name(st);
+    });
+    BOOST_TEST_EQ(polled, samples);
+    BOOST_TEST_GT(samples, 20u);
+    BOOST_TEST_EQ(sampler.lost(), 0u);
+    if (stacktrace()) { // not the noop implementation
+        BOOST_TEST_GT(known, samples / 2);
+    }
+
+    // Threads of the process are found, exited ones are closed after the last poll
+    const std::size_t threads = sampler.update_threads(); // sanitizers may have threads of their own
+    BOOST_TEST_GE(threads, 1u);
+    std::atomic<bool> go(false);
+    std::atomic<std::uint64_t> worker_id(0);
+    std::thread worker([&]() {
+        worker_id = boost::stacktrace::detail::current_thread_id();
+        while (!go.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        busy_function_with_known_name(std::chrono::milliseconds(100));
+    });
+    while (!worker_id.load()) {
+        std::this_thread::yield();
+    }
+    const std::size_t with_worker = sampler.update_threads();
+    BOOST_TEST_GE(with_worker, threads + 1);
+    sampler.set_period(1000000);
+    BOOST_TEST_EQ(sampler.period(), 1000000u);
+    go = true;
+    worker.join();
+
+    const std::size_t without_worker = sampler.update_threads();
+    BOOST_TEST_LT(without_worker, with_worker);
+    std::size_t worker_samples = 0;
+    sampler.poll([&](std::uint64_t tid, const stacktrace&) {
+        worker_samples += (tid == worker_id.load());
+    });
+    BOOST_TEST_GT(worker_samples, 10u);
+    BOOST_TEST_EQ(sampler.threads(), without_worker);
+}
+
+void test_profiler_mode() {
+    cpu_profiler profiler(997, 0.01, 1024, cpu_profiler_mode::perf_events);
+    if (!profiler.start()) {
+        return;
+    }
+
+    // Signal based profiler runs independently
+    cpu_profiler signals;
+    BOOST_TEST_EQ(signals.start(), cpu_profiler::is_supported());
+
+    busy_function_with_known_name(std::chrono::milliseconds(200));
+    profiler.stop();
+    signals.stop();
+
+    BOOST_TEST_GT(profiler.samples(), 20u);
+    BOOST_TEST_EQ(profiler.dropped(), 0u);
+    if (stacktrace()) { // not the noop implementation
+        BOOST_TEST(profiler.folded().find("function_with_known_name") != std::string::npos);
+    }
+}
+
+int main() {
+    test_sampler();
+    test_profiler_mode();
+
+    return boost::report_errors();
+}
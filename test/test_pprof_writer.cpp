@@ -0,0 +1,301 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/pprof_writer.hpp>
+#include <boost/stacktrace/detail/gzip_writer.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using boost::stacktrace::pprof_writer;
+using boost::stacktrace::stacktrace;
+
+const char* const kFile = "./pprof_writer_test.pb.gz";
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    depth = res.size(); // not a tail call
+    return res;
+}
+
+namespace {
+
+std::string read_file(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Decompresses gzip with a single deflate block of fixed Huffman codes, as produced by the gzip_writer.
+// Returns false on malformed input.
+class fixed_inflater {
+    const std::string& in_;
+    std::size_t bit_;
+
+    unsigned bits(unsigned count) {
+        unsigned res = 0;
+        for (unsigned i = 0; i < count; ++i, ++bit_) {
+            res |= ((static_cast<unsigned char>(in_[bit_ / 8]) >> (bit_ % 8)) & 1u) << i;
+        }
+        return res;
+    }
+
+    unsigned code(unsigned count) {
+        unsigned res = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            res = (res << 1) | bits(1);
+        }
+        return res;
+    }
+
+    unsigned symbol() {
+        unsigned c = code(7);
+        if (c <= 0x17) {
+            return 256 + c;
+        }
+        c = (c << 1) | bits(1);
+        if (c >= 0x30 && c <= 0xBF) {
+            return c - 0x30;
+        }
+        if (c >= 0xC0 && c <= 0xC7) {
+            return 280 + c - 0xC0;
+        }
+        c = (c << 1) | bits(1);
+        return 144 + c - 0x190;
+    }
+
+public:
+    explicit fixed_inflater(const std::string& in) : in_(in), bit_(10 * 8) {}
+
+    bool inflate(std::string& out) {
+        static const unsigned length_base[] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+        static const unsigned length_extra[] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+        static const unsigned distance_base[] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+        static const unsigned distance_extra[] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+        if (in_.size() < 18 || in_.compare(0, 3, "\x1F\x8B\x08") != 0 || bits(1) != 1 || bits(2) != 1) {
+            return false;
+        }
+
+        const std::size_t end_bit = (in_.size() - 8) * 8;
+        while (bit_ < end_bit) {
+            const unsigned s = symbol();
+            if (s < 256) {
+                out += static_cast<char>(s);
+                continue;
+            }
+            if (s == 256) {
+                break;
+            }
+
+            const unsigned length = length_base[s - 257] + bits(length_extra[s - 257]);
+            const unsigned d = code(5);
+            const unsigned distance = distance_base[d] + bits(distance_extra[d]);
+            if (distance > out.size()) {
+                return false;
+            }
+            for (unsigned i = 0; i < length; ++i) {
+                out += out[out.size() - distance];
+            }
+        }
+
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            crc = boost::stacktrace::detail::crc32_table()[(crc ^ static_cast<unsigned char>(out[i])) & 0xFF] ^ (crc >> 8);
+        }
+        std::uint32_t trailer[2] = {0, 0};
+        for (std::size_t i = 0; i < 8; ++i) {
+            trailer[i / 4] |= static_cast<std::uint32_t>(static_cast<unsigned char>(in_[in_.size() - 8 + i])) << (8 * (i % 4));
+        }
+        return trailer[0] == (crc ^ 0xFFFFFFFFu) && trailer[1] == static_cast<std::uint32_t>(out.size());
+    }
+};
+
+struct protobuf_field {
+    unsigned number;
+    std::uint64_t value;    // for varints
+    std::string bytes;      // for length delimited fields
+};
+
+bool read_varint(const std::string& in, std::size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        const unsigned char c = static_cast<unsigned char>(in[pos++]);
+        value |= static_cast<std::uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse(const std::string& in, std::vector<protobuf_field>& fields) {
+    std::size_t pos = 0;
+    while (pos < in.size()) {
+        std::uint64_t tag;
+        protobuf_field f;
+        if (!read_varint(in, pos, tag)) {
+            return false;
+        }
+        f.number = static_cast<unsigned>(tag >> 3);
+        if ((tag & 7) == 0) {
+            if (!read_varint(in, pos, f.value)) {
+                return false;
+            }
+        } else if ((tag & 7) == 2) {
+            std::uint64_t size;
+            if (!read_varint(in, pos, size) || size > in.size() - pos) {
+                return false;
+            }
+            f.bytes = in.substr(pos, static_cast<std::size_t>(size));
+            pos += static_cast<std::size_t>(size);
+        } else {
+            return false;
+        }
+        fields.push_back(f);
+    }
+    return true;
+}
+
+std::vector<std::uint64_t> packed(const std::string& in) {
+    std::vector<std::uint64_t> res;
+    std::size_t pos = 0;
+    std::uint64_t v;
+    while (pos < in.size() && read_varint(in, pos, v)) {
+        res.push_back(v);
+    }
+    return res;
+}
+
+} // anonymous namespace
+
+void test_gzip() {
+    std::string data;
+    for (int i = 0; i < 20000; ++i) {
+        data += "frame " + std::to_string(i % 97) + " ";
+        data += static_cast<char>(i * 7919 % 251);
+    }
+
+    {
+        boost::stacktrace::detail::gzip_writer out(std::fopen(kFile, "wb"));
+        BOOST_TEST(out.is_open());
+        out.write(data.data(), 10);
+        out.write(data.data() + 10, data.size() - 10);
+        BOOST_TEST(out.finish());
+    }
+
+    const std::string compressed = read_file(kFile);
+    BOOST_TEST_LT(compressed.size(), data.size() * 3 / 4);
+
+    std::string inflated;
+    BOOST_TEST(fixed_inflater(compressed).inflate(inflated));
+    BOOST_TEST(inflated == data);
+
+    {
+        boost::stacktrace::detail::gzip_writer out(std::fopen(kFile, "wb"));
+    }
+    inflated.clear();
+    BOOST_TEST(fixed_inflater(read_file(kFile)).inflate(inflated));
+    BOOST_TEST_EQ(inflated, std::string());
+
+    std::remove(kFile);
+}
+
+void test_profile() {
+    const stacktrace st = function_with_known_name();
+    {
+        pprof_writer writer(kFile, {{"alloc_objects", "count"}, {"alloc_space", "bytes"}});
+        BOOST_TEST(writer);
+        writer.set_period({"space", "bytes"}, 512 * 1024);
+        for (int i = 0; i < 1000; ++i) {
+            writer.add(st, {1, i});
+        }
+        writer.add(stacktrace(0, 0), {1, 1});
+        BOOST_TEST(writer.close());
+        BOOST_TEST(writer.close());
+    }
+
+    std::string profile;
+    BOOST_TEST(fixed_inflater(read_file(kFile)).inflate(profile));
+    std::remove(kFile);
+
+    std::vector<protobuf_field> fields;
+    BOOST_TEST(parse(profile, fields));
+
+    std::vector<std::string> strings;
+    std::size_t samples = 0;
+    std::size_t locations = 0;
+    std::size_t functions = 0;
+    std::size_t sample_types = 0;
+    std::uint64_t period = 0;
+    std::int64_t total_space = 0;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const protobuf_field& f = fields[i];
+        std::vector<protobuf_field> message;
+        BOOST_TEST(f.number < 6 || f.number == 11 ? parse(f.bytes, message) : true);
+
+        switch (f.number) {
+        case 1: ++sample_types; break;
+        case 2:
+            ++samples;
+            for (std::size_t j = 0; j < message.size(); ++j) {
+                if (message[j].number == 1) {
+                    BOOST_TEST_EQ(packed(message[j].bytes).size(), st.size());
+                } else if (message[j].number == 2) {
+                    const std::vector<std::uint64_t> values = packed(message[j].bytes);
+                    BOOST_TEST_EQ(values.size(), 2u);
+                    total_space += static_cast<std::int64_t>(values[1]);
+                }
+            }
+            break;
+        case 4: ++locations; break;
+        case 5: ++functions; break;
+        case 6: strings.push_back(f.bytes); break;
+        case 12: period = f.value; break;
+        }
+    }
+
+    BOOST_TEST_EQ(samples, 1001u);
+    BOOST_TEST_EQ(sample_types, 2u);
+    BOOST_TEST_EQ(period, 512u * 1024u);
+    BOOST_TEST_EQ(total_space, 999 * 1000 / 2 + 1);
+    BOOST_TEST_EQ(locations, st.size());
+    BOOST_TEST_LE(functions, locations);
+    BOOST_TEST(!strings.empty() && strings[0].empty());
+    BOOST_TEST(std::find(strings.begin(), strings.end(), "alloc_space") != strings.end());
+    BOOST_TEST(std::find(strings.begin(), strings.end(), "bytes") != strings.end());
+
+    if (st) { // not the noop implementation
+        bool found = false;
+        for (std::size_t i = 0; i < strings.size(); ++i) {
+            found = found || strings[i].find("function_with_known_name") != std::string::npos;
+        }
+        BOOST_TEST(found);
+        BOOST_TEST(functions > 0);
+    }
+}
+
+void test_missing_directory() {
+    pprof_writer writer("./no/such/directory/profile.pb.gz");
+    BOOST_TEST(!writer);
+    writer.add(function_with_known_name());
+    BOOST_TEST(!writer.close());
+}
+
+int main() {
+    test_gzip();
+    test_profile();
+    test_missing_directory();
+
+    return boost::report_errors();
+}
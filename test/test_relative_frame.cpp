@@ -0,0 +1,132 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/relative_frame.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::relative_frame;
+using boost::stacktrace::stacktrace;
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE void foo1() { std::puts("foo1"); }
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE void foo2() { std::puts("foo2"); }
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE stacktrace make_trace(int depth) {
+    if (depth) {
+        return make_trace(depth - 1);
+    }
+    return stacktrace();
+}
+
+std::string describe(const relative_frame& f) {
+    std::ostringstream ss;
+    ss << f;
+    return ss.str();
+}
+
+void test_construction() {
+    const relative_frame empty;
+    BOOST_TEST(!empty);
+    BOOST_TEST(empty.empty());
+    BOOST_TEST_EQ(empty.module_id(), 0u);
+    BOOST_TEST_EQ(empty.offset(), 0u);
+    BOOST_TEST(empty == relative_frame(frame()));
+
+    const relative_frame f(0x1234, 0x10);
+    BOOST_TEST(f);
+    BOOST_TEST_EQ(f.module_id(), 0x1234u);
+    BOOST_TEST_EQ(f.offset(), 0x10u);
+    BOOST_TEST(f != empty);
+    BOOST_TEST(empty < f);
+    BOOST_TEST(relative_frame(0x1234, 0x10) == f);
+    BOOST_TEST_EQ(hash_value(relative_frame(0x1234, 0x10)), hash_value(f));
+    BOOST_TEST(describe(f).find('+') != std::string::npos);
+}
+
+void test_same_module() {
+    const frame f1(&foo1);
+    const frame f2(&foo2);
+    const relative_frame r1(f1);
+    const relative_frame r2(f2);
+
+    BOOST_TEST_EQ(r1.module_id(), r2.module_id());
+    BOOST_TEST_EQ(
+        static_cast<std::ptrdiff_t>(r1.offset() - r2.offset()),
+        static_cast<std::ptrdiff_t>(reinterpret_cast<std::uintptr_t>(f1.address()) - reinterpret_cast<std::uintptr_t>(f2.address()))
+    );
+    BOOST_TEST(r1 != r2);
+    BOOST_TEST(r1 == relative_frame(f1));
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+    BOOST_TEST(r1.module_id() != 0u);
+    BOOST_TEST(!r1.module_name().empty());
+    BOOST_TEST(relative_frame(frame(&std::puts)).module_id() != r1.module_id());
+#endif
+}
+
+void test_stacktraces() {
+    stacktrace traces[2];
+    for (int i = 0; i < 2; ++i) {
+        traces[i] = make_trace(3);
+    }
+    const stacktrace& st1 = traces[0];
+    const stacktrace& st2 = traces[1];
+
+    const std::vector<relative_frame> r1 = boost::stacktrace::to_relative(st1);
+    const std::vector<relative_frame> r2 = boost::stacktrace::to_relative(st2);
+    BOOST_TEST_EQ(r1.size(), st1.size());
+    BOOST_TEST(r1 == r2);
+    BOOST_TEST_EQ(boost::hash_range(r1.begin(), r1.end()), boost::hash_range(r2.begin(), r2.end()));
+
+    for (std::size_t i = 0; i < st1.size(); ++i) {
+        BOOST_TEST(r1[i] == relative_frame(st1[i]));
+    }
+}
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+// Relative frames must not depend on the load address, so another process must get the same values
+void test_other_process(const char* self) {
+    const std::string expected = describe(relative_frame(frame(&foo1)));
+
+    const std::string cmd = std::string(self) + " print";
+    std::FILE* p = ::popen(cmd.c_str(), "r");
+    BOOST_TEST(p);
+    if (!p) {
+        return;
+    }
+    char buf[256] = {};
+    BOOST_TEST(std::fgets(buf, sizeof(buf), p));
+    ::pclose(p);
+
+    std::string received = buf;
+    if (!received.empty() && received[received.size() - 1] == '\n') {
+        received.erase(received.size() - 1);
+    }
+    BOOST_TEST_EQ(received, expected);
+}
+#endif
+
+int main(int argc, const char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "print") == 0) {
+        std::printf("%s\n", describe(relative_frame(frame(&foo1))).c_str());
+        return 0;
+    }
+
+    test_construction();
+    test_same_module();
+    test_stacktraces();
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_DL_ITERATE_PHDR)
+    test_other_process(argv[0]);
+#endif
+
+    return boost::report_errors();
+}
@@ -0,0 +1,181 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/safe_symbolizer.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#if defined(BOOST_STACKTRACE_DETAIL_HAS_ELF_SYMTAB) && !defined(BOOST_STACKTRACE_USE_NOOP)
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using boost::stacktrace::safe_symbolizer;
+
+std::atomic<std::size_t> allocations(0);
+std::atomic<std::size_t> allocations_until_failure(0);  // 0 disables the failures
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (allocations_until_failure && --allocations_until_failure == 0) {
+        throw std::bad_alloc();
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+const safe_symbolizer* symbolizer = nullptr;
+int output_fd = -1;
+std::size_t allocations_in_handler = 0;
+volatile std::size_t frames_written = 0;
+
+BOOST_NOINLINE void function_in_anonymous_namespace(int fd) {
+    frames_written = symbolizer->write_current(fd); // not a tail call
+}
+
+extern "C" void signal_handler(int) {
+    const std::size_t before = allocations;
+    function_in_anonymous_namespace(output_fd);
+    allocations_in_handler = allocations - before;
+}
+
+std::string read_file(int fd) {
+    std::string res;
+    ::lseek(fd, 0, SEEK_SET);
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+        res.append(buf, static_cast<std::size_t>(n));
+    }
+    return res;
+}
+
+int make_temporary_file() {
+    char path[] = "test_safe_symbolizer.XXXXXX";
+    const int fd = ::mkstemp(path);
+    ::unlink(path);
+    return fd;
+}
+
+} // anonymous namespace
+
+BOOST_NOINLINE void function_with_known_address() {
+    static volatile int i = 0;
+    ++i;
+}
+
+void test_format() {
+    char buf[safe_symbolizer::max_line_size];
+    const std::size_t size = symbolizer->format(reinterpret_cast<const void*>(&function_with_known_address), buf, sizeof(buf));
+    const std::string s(buf, size);
+    std::cout << s << '\n';
+    BOOST_TEST_EQ(s.substr(0, s.find(" in ")), "function_with_known_address()+0x0");
+    BOOST_TEST(s.find(" in ") != std::string::npos);
+
+    // Truncation
+    BOOST_TEST_EQ(symbolizer->format(reinterpret_cast<const void*>(&function_with_known_address), buf, 8), 8u);
+    BOOST_TEST_EQ(std::string(buf, 8), "function");
+
+    // Address outside of the modules
+    const std::size_t unknown_size = symbolizer->format(reinterpret_cast<const void*>(1), buf, sizeof(buf));
+    BOOST_TEST_EQ(std::string(buf, unknown_size), "0x1");
+}
+
+void test_write_to() {
+    const int fd = make_temporary_file();
+    BOOST_TEST(fd >= 0);
+
+    const void* frames[3] = {reinterpret_cast<const void*>(&function_with_known_address), reinterpret_cast<const void*>(1), nullptr};
+    BOOST_TEST_EQ(symbolizer->write_to(fd, frames, 3), 2u);
+
+    const std::string s = read_file(fd);
+    std::cout << s;
+    BOOST_TEST_EQ(s.find(" 0# function_with_known_address()+0x0 in "), 0u);
+    BOOST_TEST(s.find("\n 1# 0x1\n") != std::string::npos);
+    ::close(fd);
+}
+
+void test_signal_handler() {
+    output_fd = make_temporary_file();
+    BOOST_TEST(output_fd >= 0);
+
+    std::signal(SIGUSR1, &signal_handler);
+    std::raise(SIGUSR1);
+    std::signal(SIGUSR1, SIG_DFL);
+
+    const std::string s = read_file(output_fd);
+    std::cout << s;
+    BOOST_TEST_EQ(allocations_in_handler, 0u);
+    BOOST_TEST(frames_written > 0);
+    BOOST_TEST(s.find("function_in_anonymous_namespace(int)+0x") != std::string::npos);
+    BOOST_TEST(s.find("main+0x") != std::string::npos);
+    ::close(output_fd);
+}
+
+void test_failed_refresh() {
+    safe_symbolizer s;
+    bool refreshed = false;
+    for (std::size_t n = 1; !refreshed; n *= 2) {
+        allocations_until_failure = n;
+        try {
+            s.refresh();
+            refreshed = true;
+        } catch (const std::bad_alloc&) {}
+        allocations_until_failure = 0;
+
+        // Old tables are intact after a failure
+        char buf[safe_symbolizer::max_line_size];
+        const std::size_t size = s.format(reinterpret_cast<const void*>(&function_with_known_address), buf, sizeof(buf));
+        BOOST_TEST_EQ(std::string(buf, size).find("function_with_known_address()+0x0 in "), 0u);
+    }
+}
+
+int main() {
+    const safe_symbolizer s;
+    symbolizer = &s;
+
+    test_format();
+    test_write_to();
+    test_signal_handler();
+    test_failed_refresh();
+
+    return boost::report_errors();
+}
+
+#else
+
+int main() {}
+
+#endif
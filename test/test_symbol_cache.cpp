@@ -0,0 +1,205 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_STACKTRACE_ENABLE_SYMBOL_CACHE
+
+#include <boost/stacktrace.hpp>
+#include <boost/stacktrace/symbolizer.hpp>
+#include <boost/stacktrace/detail/location_from_symbol.hpp>
+#include <boost/stacktrace/detail/symbol_cache.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_CACHE
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using boost::stacktrace::frame;
+namespace detail = boost::stacktrace::detail;
+
+BOOST_NOINLINE void function_from_cache() {
+    static volatile int i = 0;
+    ++i;
+}
+
+BOOST_NOINLINE void function_to_cache() {
+    static volatile int i = 0;
+    ++i;
+}
+
+const std::size_t cache_size = 1 << 20;
+
+const std::uint16_t backends_count = static_cast<std::uint16_t>(boost::stacktrace::symbolizer_backend::backtrace) + 1;
+
+detail::symbol_cache_key make_key(std::uint64_t module_id, std::uint64_t offset, std::uint16_t backend = 0) {
+    const detail::symbol_cache_key key = {module_id, offset, backend};
+    return key;
+}
+
+std::string text_for(std::uint64_t module_id, std::uint64_t offset) {
+    return "frame " + std::to_string(module_id) + ":" + std::to_string(offset);
+}
+
+void test_shared_file(const std::string& path) {
+    detail::symbol_cache_file first(path.c_str(), cache_size);
+    detail::symbol_cache_file second(path.c_str(), cache_size);
+    BOOST_TEST(first);
+    BOOST_TEST(second);
+
+    std::string text;
+    std::uint16_t flags = 0;
+    BOOST_TEST(!first.find(make_key(1, 2), text, flags));
+    BOOST_TEST(first.insert(make_key(1, 2), "foo", 7));
+    BOOST_TEST(!second.insert(make_key(1, 2), "bar", 0));
+    BOOST_TEST(second.find(make_key(1, 2), text, flags));
+    BOOST_TEST_EQ(text, "foo");
+    BOOST_TEST_EQ(flags, 7u);
+    BOOST_TEST(!second.find(make_key(2, 1), text, flags));
+    BOOST_TEST(second.insert(make_key(2, 1), std::string(), 0));
+    BOOST_TEST(first.find(make_key(2, 1), text, flags));
+    BOOST_TEST_EQ(text, "");
+    BOOST_TEST_EQ(flags, 0u);
+
+    // Results of different implementations do not mix
+    BOOST_TEST(!first.find(make_key(1, 2, 1), text, flags));
+    BOOST_TEST(first.insert(make_key(1, 2, 1), "baz", 0));
+    BOOST_TEST(second.find(make_key(1, 2, 1), text, flags));
+    BOOST_TEST_EQ(text, "baz");
+    BOOST_TEST(second.find(make_key(1, 2), text, flags));
+    BOOST_TEST_EQ(text, "foo");
+}
+
+void test_concurrent_processes(const std::string& path) {
+    const int processes = 4;
+    const std::uint64_t keys = 2000;
+
+    for (int p = 0; p < processes; ++p) {
+        if (::fork() == 0) {
+            detail::symbol_cache_file cache(path.c_str(), cache_size);
+            // Every process inserts all the keys, starting from different ones
+            for (std::uint64_t i = 0; i < keys; ++i) {
+                const std::uint64_t offset = (i + p * keys / processes) % keys;
+                cache.insert(make_key(100, offset), text_for(100, offset), 0);
+            }
+            std::_Exit(0);
+        }
+    }
+    for (int p = 0; p < processes; ++p) {
+        int status = 0;
+        ::wait(&status);
+        BOOST_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    detail::symbol_cache_file cache(path.c_str(), cache_size);
+    std::string text;
+    std::uint16_t flags = 0;
+    for (std::uint64_t offset = 0; offset < keys; ++offset) {
+        BOOST_TEST(cache.find(make_key(100, offset), text, flags));
+        BOOST_TEST_EQ(text, text_for(100, offset));
+    }
+}
+
+void test_foreign_file(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    const std::string garbage(cache_size, 'X');
+    std::fwrite(garbage.data(), 1, garbage.size(), f);
+    std::fclose(f);
+    BOOST_TEST(!detail::symbol_cache_file(path.c_str(), cache_size));
+    std::remove(path.c_str());
+
+    BOOST_TEST(!detail::symbol_cache_file("/definitely/missing/dir/cache", cache_size));
+}
+
+void test_symlink_refused(const std::string& path) {
+    const std::string link = path + ".link";
+    std::remove(link.c_str());
+    BOOST_TEST_EQ(::symlink(path.c_str(), link.c_str()), 0);
+
+    // Neither the link nor the missing file it points to are opened
+    BOOST_TEST(!detail::symbol_cache_file(link.c_str(), cache_size));
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    BOOST_TEST(!f);
+    if (f) {
+        std::fclose(f);
+    }
+
+    std::remove(link.c_str());
+    std::remove(path.c_str());
+
+    // Opening a FIFO for reading and writing does not block
+    BOOST_TEST_EQ(::mkfifo(path.c_str(), 0600), 0);
+    BOOST_TEST(!detail::symbol_cache_file(path.c_str(), cache_size));
+    std::remove(path.c_str());
+}
+
+void test_frames_from_cache(const std::string& path) {
+    detail::symbol_cache_key key;
+    if (!detail::make_symbol_cache_key(reinterpret_cast<const void*>(&function_from_cache), 0, key)) {
+        std::cout << "Test binary has no build-id, frames are not cached\n";
+        return;
+    }
+
+    // Result of other process, for whatever implementation this process uses
+    detail::symbol_cache_file other(path.c_str(), cache_size);
+    for (key.backend = 0; key.backend < backends_count; ++key.backend) {
+        BOOST_TEST(other.insert(key, "function resolved by other process", 0));
+    }
+
+    // Module name is added on lookup, the cached text has no source location
+    const std::string from_cache = to_string(frame(&function_from_cache));
+    const detail::location_from_symbol loc(reinterpret_cast<const void*>(&function_from_cache));
+    BOOST_TEST_EQ(from_cache, std::string("function resolved by other process in ") + loc.name());
+
+    const std::string resolved = to_string(frame(&function_to_cache));
+    BOOST_TEST(resolved.find("function_to_cache") != std::string::npos);
+    BOOST_TEST(detail::make_symbol_cache_key(reinterpret_cast<const void*>(&function_to_cache), 0, key));
+    std::size_t found = 0;
+    for (key.backend = 0; key.backend < backends_count; ++key.backend) {
+        std::string text;
+        std::uint16_t flags = 0;
+        if (other.find(key, text, flags)) {
+            ++found;
+            BOOST_TEST_EQ(resolved.compare(0, text.size(), text), 0);
+            BOOST_TEST(text.find(" in ") == std::string::npos || (flags & 1));
+        }
+    }
+    BOOST_TEST_EQ(found, 1u);
+    BOOST_TEST_EQ(to_string(frame(&function_to_cache)), resolved);
+}
+
+int main() {
+    const std::string path = "test_symbol_cache." + std::to_string(::getpid()) + ".cache";
+    const std::string frames_path = path + ".frames";
+    std::remove(path.c_str());
+    std::remove(frames_path.c_str());
+
+    // The cache is enabled on the first symbolization in the process
+    ::setenv("BOOST_STACKTRACE_SYMBOL_CACHE", frames_path.c_str(), 1);
+
+    test_shared_file(path);
+    test_concurrent_processes(path);
+    std::remove(path.c_str());
+    test_foreign_file(path);
+    test_symlink_refused(path);
+#ifndef BOOST_STACKTRACE_USE_NOOP
+    test_frames_from_cache(frames_path);
+#endif
+
+    std::remove(frames_path.c_str());
+    return boost::report_errors();
+}
+
+#else
+
+int main() {}
+
+#endif
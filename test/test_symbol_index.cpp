@@ -0,0 +1,129 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#ifdef BOOST_STACKTRACE_DETAIL_HAS_SYMBOL_INDEX
+
+#include <boost/stacktrace/detail/symbol_index_writer.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+namespace detail = boost::stacktrace::detail;
+
+namespace {
+
+BOOST_NOINLINE stacktrace function_in_anonymous_namespace() {
+    return stacktrace();
+}
+
+} // anonymous namespace
+
+BOOST_NOINLINE void function_with_known_line() {
+    static volatile int i = 0;
+    ++i;
+}
+static const std::size_t function_line = __LINE__ - 4;
+
+std::string self_path() {
+    const auto table = detail::module_table::current();
+    const detail::module_info* m = table->find(reinterpret_cast<const void*>(&function_with_known_line));
+    return m ? m->name : std::string();
+}
+
+void test_resolution_from_index() {
+    const frame f(&function_with_known_line);
+    BOOST_TEST_EQ(f.name(), "function_with_known_line()");
+    // With optimizations the first instruction may belong to the function body
+    BOOST_TEST_GE(f.source_line(), function_line);
+    BOOST_TEST_LE(f.source_line(), function_line + 2);
+    BOOST_TEST(f.source_file().find("test_symbol_index.cpp") != std::string::npos);
+
+    const std::string s = to_string(function_in_anonymous_namespace());
+    std::cout << s << '\n';
+    BOOST_TEST(s.find("function_in_anonymous_namespace") != std::string::npos);
+    BOOST_TEST(s.find("test_symbol_index.cpp:") != std::string::npos);
+}
+
+void test_index_file(const std::string& path) {
+    const detail::symbol_index_file index(path.c_str());
+    BOOST_TEST(index);
+    BOOST_TEST_EQ(index.function(0), static_cast<const char*>(nullptr));
+
+    // Corrupted and truncated indexes are rejected
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string broken_path = path + ".broken";
+
+    std::ofstream(broken_path.c_str(), std::ios::binary) << content.substr(0, content.size() / 2);
+    BOOST_TEST(!detail::symbol_index_file(broken_path.c_str()));
+
+    content[0] = 'X';
+    std::ofstream(broken_path.c_str(), std::ios::binary | std::ios::trunc) << content;
+    BOOST_TEST(!detail::symbol_index_file(broken_path.c_str()));
+    std::remove(broken_path.c_str());
+
+    BOOST_TEST(!detail::symbol_index_file("/definitely/missing.symidx"));
+}
+
+void test_index_matching(const std::string& self, const std::string& path) {
+    const detail::symbol_index_file index(path.c_str());
+    const std::string build_id = index.build_id();
+    BOOST_TEST(index.matches(build_id, self.c_str()));
+    if (!build_id.empty()) {
+        BOOST_TEST(!index.matches(std::string(), self.c_str()));
+        BOOST_TEST(!index.matches(build_id.substr(1), self.c_str()));
+    }
+
+    // Index without a build-id is checked by the size and the modification time of the module
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    detail::symbol_index_header h;
+    std::memcpy(&h, content.data(), sizeof(h));
+    h.build_id_size = 0;
+    std::memcpy(&content[0], &h, sizeof(h));
+    const std::string no_id_path = path + ".no_id";
+    std::ofstream(no_id_path.c_str(), std::ios::binary) << content;
+
+    const detail::symbol_index_file no_id(no_id_path.c_str());
+    BOOST_TEST(no_id.matches(std::string(), self.c_str()));
+    BOOST_TEST(!no_id.matches(std::string(), path.c_str()));
+    BOOST_TEST(!no_id.matches(std::string(), "/definitely/missing"));
+    BOOST_TEST(!no_id.matches(std::string("\x01", 1), self.c_str()));
+    std::remove(no_id_path.c_str());
+}
+
+int main() {
+    const std::string self = self_path();
+    BOOST_TEST(!self.empty());
+
+    // The index must be written before the first symbolization in this process
+    const std::string index_path = self + ".symidx";
+    const detail::symbol_index_builder builder(self);
+    BOOST_TEST(builder.functions_count() > 0);
+    BOOST_TEST(builder.write(index_path));
+
+    test_resolution_from_index();
+    test_index_file(index_path);
+    test_index_matching(self, index_path);
+
+    std::remove(index_path.c_str());
+    return boost::report_errors();
+}
+
+#else
+
+int main() {}
+
+#endif
@@ -0,0 +1,133 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Runs the boost_stacktrace_symbolize tool, whose path is passed as the first argument,
+// on the traces saved by this program.
+
+#include <boost/stacktrace/flight_recorder.hpp>
+#include <boost/stacktrace/safe_dump_to.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#   include <link.h>       // ::dl_iterate_phdr
+#   include <unistd.h>     // ::readlink
+#endif
+
+const char* const kDump = "./symbolize_tool_test.dump";
+const char* const kRing = "./symbolize_tool_test.ring";
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE void function_with_known_name(boost::stacktrace::flight_recorder& rec) {
+    boost::stacktrace::safe_dump_to(kDump);
+    rec.record();
+}
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE void caller_with_known_name(boost::stacktrace::flight_recorder& rec) {
+    function_with_known_name(rec);
+    std::cout << ""; // not a tail call
+}
+
+#if defined(__linux__)
+
+namespace {
+
+int first_module_base(::dl_phdr_info* info, std::size_t, void* data) {
+    *static_cast<std::uintptr_t*>(data) = static_cast<std::uintptr_t>(info->dlpi_addr);
+    return 1;
+}
+
+// Symbolized traces, each starts with its label and ends with an empty line
+std::vector<std::string> split_traces(const std::string& text) {
+    std::vector<std::string> res;
+    for (std::size_t pos = 0; pos < text.size(); ) {
+        std::size_t end = text.find("\n\n", pos);
+        end = (end == std::string::npos ? text.size() : end + 2);
+        res.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    return res;
+}
+
+// Frames that are printed as addresses only, without the name of a module
+std::size_t count_raw_frames(const std::string& text) {
+    std::size_t res = 0;
+    for (std::size_t pos = text.find("# 0x"); pos != std::string::npos; pos = text.find("# 0x", pos + 1)) {
+        const std::size_t end = text.find('\n', pos);
+        res += (text.find(' ', pos + 2) > end);
+    }
+    return res;
+}
+
+} // anonymous namespace
+
+void test_symbolize_tool(const char* tool) {
+    {
+        boost::stacktrace::flight_recorder rec(kRing, 4);
+        BOOST_TEST(rec);
+        caller_with_known_name(rec);
+    }
+
+    char self[4096];
+    const ::ssize_t len = ::readlink("/proc/self/exe", self, sizeof(self) - 1);
+    BOOST_TEST_GT(len, 0);
+    self[len > 0 ? len : 0] = '\0';
+
+    std::uintptr_t base = 0;
+    ::dl_iterate_phdr(&first_module_base, &base);
+
+    const std::string command = std::string(tool) + " --binary " + self
+        + " --base " + boost::stacktrace::detail::to_hex_array(base).data()
+        + " --jobs 2 " + kDump + ' ' + kRing;
+    std::string output;
+    ::FILE* p = ::popen(command.c_str(), "r");
+    BOOST_TEST(p);
+    if (p) {
+        char buf[512];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), p)) != 0; ) {
+            output.append(buf, n);
+        }
+        BOOST_TEST_EQ(::pclose(p), 0);
+    }
+    std::cout << output;
+
+    std::remove(kDump);
+    std::remove(kRing);
+
+    // Optimized builds may inline the functions, addr2line reports the innermost one
+    const std::vector<std::string> traces = split_traces(output);
+    BOOST_TEST_EQ(traces.size(), 2u);
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        BOOST_TEST(traces[i].find(i == 0 ? "./symbolize_tool_test.dump#0:" : "./symbolize_tool_test.ring#0 thread") == 0);
+        BOOST_TEST(traces[i].find("function_with_known_name") != std::string::npos
+            || traces[i].find("caller_with_known_name") != std::string::npos);
+    }
+
+    // Frames of libc are outside of the binary and are not attributed to it
+    BOOST_TEST_GE(count_raw_frames(output), 2u);
+}
+
+#endif // defined(__linux__)
+
+int main(int argc, const char* argv[]) {
+#if defined(__linux__)
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <path to boost_stacktrace_symbolize>\n";
+        return 2;
+    }
+    test_symbolize_tool(argv[1]);
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    return boost::report_errors();
+}
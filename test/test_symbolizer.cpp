@@ -0,0 +1,120 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/symbolizer.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+
+using boost::stacktrace::frame;
+using boost::stacktrace::stacktrace;
+using boost::stacktrace::symbolizer;
+using boost::stacktrace::symbolizer_backend;
+
+volatile std::size_t depth = 0;
+
+BOOST_NOINLINE stacktrace function_with_known_name() {
+    stacktrace res;
+    depth = res.size(); // not a tail call
+    return res;
+}
+
+void test_same_as_free_functions() {
+    const stacktrace st = function_with_known_name();
+    symbolizer s;
+
+    const std::string text = s.to_string(st);
+    std::cout << text;
+    BOOST_TEST_EQ(text, boost::stacktrace::to_string(st));
+    BOOST_TEST_EQ(s.to_string(&st.as_vector()[0], st.size()), text);
+
+    for (const frame& f: st) {
+        BOOST_TEST_EQ(s.to_string(f), boost::stacktrace::to_string(f));
+        BOOST_TEST_EQ(s.name(f), f.name());
+        BOOST_TEST_EQ(s.source_file(f), f.source_file());
+        BOOST_TEST_EQ(s.source_line(f), f.source_line());
+    }
+
+#ifndef BOOST_STACKTRACE_USE_NOOP
+    BOOST_TEST(st);
+    BOOST_TEST(s.name(st[0]).find("function_with_known_name") != std::string::npos);
+#endif
+}
+
+void test_reuse() {
+    symbolizer s;
+    const frame f(&function_with_known_name);
+
+    const std::string first = s.to_string(f);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_TEST_EQ(s.to_string(f), first);
+    }
+
+    s.clear();
+    BOOST_TEST_EQ(s.to_string(f), first);
+
+    BOOST_TEST_EQ(s.to_string(frame()), std::string());
+    BOOST_TEST_EQ(s.name(frame()), std::string());
+    BOOST_TEST_EQ(s.to_string(stacktrace(0, 0)), std::string());
+}
+
+void test_runtime_backends() {
+    const stacktrace st = function_with_known_name();
+
+    BOOST_TEST(boost::stacktrace::symbolizer_backend_available(symbolizer_backend::default_backend));
+    BOOST_TEST(boost::stacktrace::symbolizer_backend_available(symbolizer_backend::noop));
+    BOOST_TEST_EQ(symbolizer().to_string(st), symbolizer(symbolizer_backend::default_backend).to_string(st));
+
+    symbolizer noop(symbolizer_backend::noop);
+    BOOST_TEST_EQ(noop.to_string(st), std::string());
+    BOOST_TEST_EQ(boost::stacktrace::to_string(st, symbolizer_backend::noop), std::string());
+    if (st) {
+        BOOST_TEST_EQ(noop.name(st[0]), std::string());
+        BOOST_TEST_EQ(noop.source_line(st[0]), 0u);
+    }
+
+#if !defined(BOOST_STACKTRACE_LINK) && !defined(BOOST_STACKTRACE_ENABLE_RUNTIME_BACKENDS) && !defined(BOOST_STACKTRACE_USE_DWARF)
+    // Not compiled into the header only translation units by default
+    BOOST_TEST(!boost::stacktrace::symbolizer_backend_available(symbolizer_backend::dwarf));
+#endif
+
+    const symbolizer_backend backends[] = {
+        symbolizer_backend::basic,
+        symbolizer_backend::dwarf,
+        symbolizer_backend::addr2line,
+        symbolizer_backend::backtrace
+    };
+    for (symbolizer_backend b: backends) {
+        symbolizer s(b);
+        if (!boost::stacktrace::symbolizer_backend_available(b)) {
+            BOOST_TEST(s.backend() == symbolizer_backend::default_backend);
+            continue;
+        }
+
+        BOOST_TEST(s.backend() == b);
+        const std::string text = s.to_string(st);
+        std::cout << "Backend " << static_cast<int>(b) << ":\n" << text;
+        BOOST_TEST_EQ(text, boost::stacktrace::to_string(st, b));
+
+        s.clear();
+        BOOST_TEST(s.backend() == b);
+        BOOST_TEST_EQ(s.to_string(st), text);
+
+#ifndef BOOST_STACKTRACE_USE_NOOP
+        BOOST_TEST(s.name(st[0]).find("function_with_known_name") != std::string::npos);
+        BOOST_TEST(text.find("function_with_known_name") != std::string::npos);
+#endif
+    }
+}
+
+int main() {
+    test_same_as_free_functions();
+    test_reuse();
+    test_runtime_backends();
+
+    return boost::report_errors();
+}
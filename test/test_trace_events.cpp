@@ -0,0 +1,119 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/trace_events.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/lightweight_test.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::stacktrace;
+using boost::stacktrace::trace_event_recorder;
+
+BOOST_NOINLINE bool function_with_known_name(trace_event_recorder& recorder) {
+    const bool res = recorder.record("snapshot \"quoted\"");
+    not_a_tail_call(res);
+    return res;
+}
+
+namespace {
+
+std::size_t count(const std::string& s, const std::string& what) {
+    std::size_t res = 0;
+    for (std::size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        ++res;
+    }
+    return res;
+}
+
+} // anonymous namespace
+
+void test_export() {
+    trace_event_recorder recorder;
+    BOOST_TEST(function_with_known_name(recorder));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&recorder]() {
+            for (int i = 0; i < 10; ++i) {
+                function_with_known_name(recorder);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    const stacktrace st;
+    BOOST_TEST(recorder.record("captured", st));
+
+    BOOST_TEST_EQ(recorder.size(), 32u);
+    BOOST_TEST_EQ(recorder.dropped(), 0u);
+
+    const std::string json = recorder.to_json();
+    std::cout << json.substr(0, 2048) << '\n';
+
+    BOOST_TEST_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+    BOOST_TEST_EQ(json.substr(json.size() - 3), "}}\n");
+    BOOST_TEST_EQ(count(json, "\"ph\":\"i\""), 32u);
+    BOOST_TEST_EQ(count(json, "{\"name\":\"snapshot \\\"quoted\\\"\""), 31u);
+    BOOST_TEST_EQ(count(json, "{\"name\":\"captured\""), 1u);
+    BOOST_TEST(json.find("\"stackFrames\":{") != std::string::npos);
+
+    std::ostringstream oss;
+    recorder.write(oss);
+    BOOST_TEST_EQ(oss.str(), json);
+
+    if (st) { // not the noop implementation
+        BOOST_TEST_EQ(count(json, "\"sf\":\""), 32u);
+        // Stacks of the main thread and of the other threads have different prefixes, the rest is shared
+        const std::size_t nodes = count(json, "\"name\":\"function_with_known_name");
+        BOOST_TEST(nodes == 1 || nodes == 2);
+        BOOST_TEST(json.find("\"parent\":\"") != std::string::npos);
+    }
+
+    recorder.clear();
+    BOOST_TEST_EQ(recorder.size(), 0u);
+    BOOST_TEST_EQ(count(recorder.to_json(), "\"ph\""), 0u);
+}
+
+void test_dropped() {
+    trace_event_recorder recorder(64);
+    std::size_t recorded = 0;
+    for (int i = 0; i < 100; ++i) {
+        recorded += recorder.record("small", stacktrace());
+    }
+    BOOST_TEST_EQ(recorded + recorder.dropped(), 100u);
+
+    const stacktrace st;
+    if (st.size() > 8) {
+        BOOST_TEST(recorder.dropped() > 0);
+    }
+
+    recorder.collect();
+    BOOST_TEST(recorder.record("after_collect", stacktrace(0, 1)));
+    BOOST_TEST_EQ(recorder.size(), recorded + 1);
+}
+
+void test_null_name() {
+    trace_event_recorder recorder;
+    BOOST_TEST(recorder.record(nullptr));
+    BOOST_TEST(recorder.record(nullptr, stacktrace()));
+    BOOST_TEST_EQ(count(recorder.to_json(), "{\"name\":\"\""), 2u);
+}
+
+int main() {
+    test_export();
+    test_dropped();
+    test_null_name();
+
+    return boost::report_errors();
+}
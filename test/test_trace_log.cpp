@@ -0,0 +1,164 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/stacktrace/trace_log.hpp>
+#include <boost/stacktrace/detail/spsc_ring.hpp>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <csignal>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <vector>
+
+using boost::stacktrace::trace_log_writer;
+using boost::stacktrace::trace_log_reader;
+using boost::stacktrace::trace_log_record;
+
+namespace {
+
+const char* const kFile = "./trace_log_test.log";
+
+BOOST_NOINLINE BOOST_SYMBOL_VISIBLE bool push_nested(trace_log_writer& log, int depth) {
+    if (depth) {
+        return push_nested(log, depth - 1) && true;
+    }
+    return log.push();
+}
+
+void test_missing_file() {
+    trace_log_reader reader("./trace_log_test_missing.log");
+    BOOST_TEST(!reader);
+    BOOST_TEST(reader.begin() == reader.end());
+}
+
+void test_single_thread() {
+    std::remove(kFile);
+
+    const boost::stacktrace::stacktrace st;
+    {
+        trace_log_writer log(kFile);
+        BOOST_TEST(log);
+        BOOST_TEST(log.push(st));
+        BOOST_TEST(push_nested(log, 3));
+        log.flush();
+
+        trace_log_reader reader(kFile);
+        BOOST_TEST(reader);
+        std::size_t count = 0;
+        for (trace_log_reader::const_iterator it = reader.begin(); it != reader.end(); ++it) {
+            ++count;
+        }
+        BOOST_TEST_EQ(count, 2u);
+
+        const boost::stacktrace::frame::native_frame_ptr_t no_frames[1] = {0};
+        BOOST_TEST(log.push(no_frames, 0));
+    }
+
+    trace_log_reader reader(kFile);
+    BOOST_TEST(reader);
+
+    std::vector<trace_log_record> records(reader.begin(), reader.end());
+    BOOST_TEST_EQ(records.size(), 3u);
+    BOOST_TEST(records[0].to_stacktrace() == st);
+    BOOST_TEST_EQ(records[0].size(), st.size());
+    BOOST_TEST(records[0].timestamp_ns() <= records[1].timestamp_ns());
+    BOOST_TEST_EQ(records[0].thread_id(), records[1].thread_id());
+    BOOST_TEST_EQ(records[2].size(), 0u);
+    BOOST_TEST(!records[2].to_stacktrace());
+
+    // Appending to the existing file
+    {
+        trace_log_writer log(kFile);
+        BOOST_TEST(log.push(st));
+    }
+    trace_log_reader reader2(kFile);
+    std::vector<trace_log_record> records2(reader2.begin(), reader2.end());
+    BOOST_TEST_EQ(records2.size(), 4u);
+    BOOST_TEST(records2[3].to_stacktrace() == st);
+
+    std::remove(kFile);
+}
+
+void test_threads() {
+    std::remove(kFile);
+
+    const int threads_count = 4;
+    const int pushes = 1000;
+    std::uint64_t dropped = 0;
+    {
+        trace_log_writer log(kFile, 4096);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&log]() {
+                for (int j = 0; j < pushes; ++j) {
+                    push_nested(log, j % 7);
+                }
+            });
+        }
+        for (std::size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+        log.flush();
+        dropped = log.dropped();
+    }
+
+    trace_log_reader reader(kFile);
+    std::map<std::uint64_t, std::size_t> per_thread;
+    std::size_t count = 0;
+    for (trace_log_reader::const_iterator it = reader.begin(); it != reader.end(); ++it) {
+        ++per_thread[(*it).thread_id()];
+        ++count;
+    }
+    BOOST_TEST_EQ(count + dropped, static_cast<std::size_t>(threads_count * pushes));
+    BOOST_TEST(per_thread.size() <= static_cast<std::size_t>(threads_count));
+
+    std::remove(kFile);
+}
+
+boost::stacktrace::detail::spsc_ring* nested_ring = nullptr;
+bool nested_pushed = true;
+
+extern "C" void push_from_handler(int) {
+    nested_pushed = nested_ring->try_push(1, [](std::size_t) -> std::uint64_t { return 2; });
+}
+
+// A push from a signal handler that interrupted another push of the same thread is dropped
+void test_nested_push() {
+    boost::stacktrace::detail::spsc_ring ring(16);
+    nested_ring = &ring;
+    std::signal(SIGUSR1, &push_from_handler);
+    const bool pushed = ring.try_push(2, [](std::size_t i) -> std::uint64_t {
+        if (i == 0) {
+            std::raise(SIGUSR1);
+        }
+        return 1;
+    });
+    std::signal(SIGUSR1, SIG_DFL);
+
+    BOOST_TEST(pushed);
+    BOOST_TEST(!nested_pushed);
+    BOOST_TEST_EQ(ring.available(), 2u);
+    BOOST_TEST_EQ(ring.peek(0), 1u);
+    BOOST_TEST_EQ(ring.peek(1), 1u);
+
+    // Not nested
+    push_from_handler(SIGUSR1);
+    BOOST_TEST(nested_pushed);
+    BOOST_TEST_EQ(ring.available(), 3u);
+}
+
+} // anonymous namespace
+
+int main() {
+    test_missing_file();
+    test_single_thread();
+    test_threads();
+    test_nested_push();
+
+    return boost::report_errors();
+}
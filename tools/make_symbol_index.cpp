@@ -0,0 +1,106 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// boost_stacktrace_make_index: build step that writes a sidecar symbol index for a binary, so that
+// boost::stacktrace resolves the names and source locations of that binary without parsing
+// anything at runtime.
+//
+// Usage:
+//  boost_stacktrace_make_index [--output <path> | --build-id-dir <dir>] <binary>...
+
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
+
+#include <boost/stacktrace/detail/symbol_index_writer.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct options {
+    std::string output;
+    std::string build_id_dir;
+    std::vector<std::string> binaries;
+};
+
+void usage(const char* self) {
+    std::cerr
+        << "Usage: " << self << " [--output <path> | --build-id-dir <dir>] <binary>...\n\n"
+        << "Writes the function names and the line tables of each <binary> (or of its separate debug file)\n"
+        << "into a sidecar index that is used by boost::stacktrace at runtime. By default the index\n"
+        << "is written next to the binary as <binary>.symidx.\n\n"
+        << "  --output <path>       path of the index, only for a single <binary>\n"
+        << "  --build-id-dir <dir>  write the index as <dir>/<hex build-id>.symidx, for the libraries built\n"
+        << "                        with the BOOST_STACKTRACE_SYMBOL_INDEX_DIR macro defined to <dir>\n";
+}
+
+bool parse_options(int argc, const char* argv[], options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        if (arg == "--output" && has_value) {
+            opts.output = argv[++i];
+        } else if (arg == "--build-id-dir" && has_value) {
+            opts.build_id_dir = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            opts.binaries.push_back(arg);
+        }
+    }
+
+    if (!opts.output.empty() && (!opts.build_id_dir.empty() || opts.binaries.size() != 1)) {
+        return false;
+    }
+    return !opts.binaries.empty();
+}
+
+} // anonymous namespace
+
+int main(int argc, const char* argv[]) {
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int result = 0;
+    for (std::size_t i = 0; i < opts.binaries.size(); ++i) {
+        const std::string& binary = opts.binaries[i];
+        if (!boost::stacktrace::detail::elf_file(binary.c_str())) {
+            std::cerr << "'" << binary << "' is not an ELF file of the native class and byte order\n";
+            result = 1;
+            continue;
+        }
+
+        std::string output = opts.output;
+        if (!opts.build_id_dir.empty()) {
+            const std::string build_id = boost::stacktrace::detail::elf_file(binary.c_str()).build_id();
+            if (build_id.empty()) {
+                std::cerr << "'" << binary << "' has no build-id, it could not be indexed by build-id\n";
+                result = 1;
+                continue;
+            }
+            output = opts.build_id_dir + '/' + boost::stacktrace::detail::symbol_index_file_name(build_id);
+        } else if (output.empty()) {
+            output = binary + ".symidx";
+        }
+
+        const boost::stacktrace::detail::symbol_index_builder builder(binary);
+        if (!builder.write(output)) {
+            std::cerr << "Failed to write '" << output << "'\n";
+            result = 1;
+            continue;
+        }
+        std::cout << output << ": " << builder.functions_count() << " functions, "
+                  << builder.lines_count() << " line table rows\n";
+    }
+
+    return result;
+}
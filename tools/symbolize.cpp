@@ -0,0 +1,395 @@
+// Copyright Antony Polukhin, 2016-2025.
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// boost_stacktrace_symbolize: offline symbolization of the traces that were saved by
+// boost::stacktrace::safe_dump_to, boost::stacktrace::flight_recorder or
+// boost::stacktrace::trace_log_writer.
+//
+// Usage:
+//  boost_stacktrace_symbolize [--binary <path> [--debug-file <path>] [--base <hex>]] [--module <path>=<hex>]...
+//                             [--jobs <N>] <file>...
+
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
+
+#ifndef BOOST_STACKTRACE_USE_ADDR2LINE
+#   define BOOST_STACKTRACE_USE_ADDR2LINE
+#endif
+
+#include <boost/stacktrace.hpp>
+#include <boost/stacktrace/flight_recorder.hpp>
+#include <boost/stacktrace/trace_log.hpp>
+#include <boost/stacktrace/detail/addr2line_impls.hpp>
+#include <boost/stacktrace/detail/to_dec_array.hpp>
+#include <boost/stacktrace/detail/to_hex_array.hpp>
+
+#if defined(__ELF__)
+#   include <boost/stacktrace/detail/elf_file.hpp>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Module of the process that captured the traces. Addresses from [begin, end) are resolved
+// against the `debug_file` as `address - base`.
+struct module {
+    std::string path;
+    std::string debug_file;
+    std::uintptr_t base = 0;
+    std::uintptr_t begin = 0;
+    std::uintptr_t end = 0;
+};
+
+struct options {
+    std::vector<module> modules;
+    unsigned jobs = 0;
+    std::vector<std::string> inputs;
+};
+
+struct trace {
+    std::string label;
+    std::vector<std::uintptr_t> frames;
+};
+
+void usage(const char* self) {
+    std::cerr
+        << "Usage: " << self << " [--binary <path> [--debug-file <path>] [--base <hex>]] [--module <path>=<hex>]...\n"
+        << "       [--jobs <N>] <file>...\n\n"
+        << "Symbolizes the traces from <file>s. Each file could be a raw dump produced by boost::stacktrace::safe_dump_to\n"
+        << "(many zero terminated dumps per file are allowed), a boost::stacktrace::flight_recorder file or a\n"
+        << "boost::stacktrace::trace_log_writer file.\n\n"
+        << "  --binary <path>        binary that captured the traces\n"
+        << "  --debug-file <path>    file with the debug information for the binary, defaults to the binary itself\n"
+        << "  --base <hex>           load address of the binary in the process that captured the traces,\n"
+        << "                         required for position independent executables\n"
+        << "  --module <path>=<hex>  shared library or other module and its load address in the process that\n"
+        << "                         captured the traces, could be repeated\n"
+        << "  --jobs <N>             count of threads to use, defaults to the count of CPUs\n\n"
+        << "Frames that are not inside any of the modules are printed as addresses.\n";
+}
+
+bool parse_options(int argc, const char* argv[], options& opts) {
+    module binary;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        if (arg == "--binary" && has_value) {
+            binary.path = argv[++i];
+        } else if (arg == "--debug-file" && has_value) {
+            binary.debug_file = argv[++i];
+        } else if (arg == "--base" && has_value) {
+            binary.base = static_cast<std::uintptr_t>(std::strtoull(argv[++i], 0, 16));
+        } else if (arg == "--module" && has_value) {
+            const std::string value = argv[++i];
+            const std::size_t pos = value.rfind('=');
+            if (pos == 0 || pos == std::string::npos || pos + 1 == value.size()) {
+                return false;
+            }
+            module m;
+            m.path = value.substr(0, pos);
+            m.debug_file = m.path;
+            m.base = static_cast<std::uintptr_t>(std::strtoull(value.c_str() + pos + 1, 0, 16));
+            opts.modules.push_back(m);
+        } else if (arg == "--jobs" && has_value) {
+            opts.jobs = static_cast<unsigned>(std::strtoul(argv[++i], 0, 10));
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            opts.inputs.push_back(arg);
+        }
+    }
+
+    if (!binary.path.empty()) {
+        if (binary.debug_file.empty()) {
+            binary.debug_file = binary.path;
+        }
+        opts.modules.insert(opts.modules.begin(), binary);
+    } else if (!binary.debug_file.empty() || binary.base) {
+        return false;
+    }
+    if (!opts.jobs) {
+        opts.jobs = (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
+    return !opts.modules.empty() && !opts.inputs.empty();
+}
+
+// Fills the address ranges of the modules from their code sections. Without the ELF section
+// headers a module spans from its base to the base of the next module.
+void compute_module_ranges(std::vector<module>& modules) {
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        module& m = modules[i];
+#if defined(__ELF__)
+        std::vector<std::pair<std::uintptr_t, std::uintptr_t> > ranges = boost::stacktrace::detail::elf_file(m.path.c_str()).code_ranges();
+        if (ranges.empty()) {
+            ranges = boost::stacktrace::detail::elf_file(m.debug_file.c_str()).code_ranges();
+        }
+        for (std::size_t j = 0; j < ranges.size(); ++j) {
+            if (j == 0 || ranges[j].first < m.begin) {
+                m.begin = ranges[j].first;
+            }
+            if (ranges[j].second > m.end) {
+                m.end = ranges[j].second;
+            }
+        }
+        m.begin += m.base;
+        m.end += m.base;
+#else
+        m.begin = m.base;
+        m.end = static_cast<std::uintptr_t>(-1);
+        for (std::size_t j = 0; j < modules.size(); ++j) {
+            if (modules[j].base > m.base && modules[j].base < m.end) {
+                m.end = modules[j].base;
+            }
+        }
+#endif
+    }
+}
+
+const module* find_module(const std::vector<module>& modules, std::uintptr_t addr) {
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        if (modules[i].begin <= addr && addr < modules[i].end) {
+            return &modules[i];
+        }
+    }
+    return 0;
+}
+
+std::string make_label(const std::string& file, std::size_t index) {
+    return file + '#' + boost::stacktrace::detail::to_dec_array(index).data();
+}
+
+template <class Allocator>
+std::vector<std::uintptr_t> to_addresses(const boost::stacktrace::basic_stacktrace<Allocator>& st) {
+    std::vector<std::uintptr_t> res;
+    res.reserve(st.size());
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        res.push_back(reinterpret_cast<std::uintptr_t>(st[i].address()));
+    }
+    return res;
+}
+
+bool has_magic(const std::vector<char>& data, const char (&magic)[8]) {
+    return data.size() >= sizeof(magic) && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+bool read_traces(const std::string& file, std::vector<trace>& traces) {
+    std::ifstream in(file.c_str(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (has_magic(data, boost::stacktrace::detail::flight_recorder_magic)) {
+        const std::vector<boost::stacktrace::flight_recorder_entry> entries = boost::stacktrace::flight_recorder::read(file.c_str());
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            trace t;
+            t.label = make_label(file, static_cast<std::size_t>(entries[i].sequence))
+                + " thread " + boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(entries[i].thread_id)).data()
+                + " time " + boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(entries[i].timestamp_ns)).data();
+            t.frames = to_addresses(entries[i].trace);
+            traces.push_back(std::move(t));
+        }
+        return true;
+    }
+
+    if (has_magic(data, boost::stacktrace::detail::trace_log_magic)) {
+        boost::stacktrace::trace_log_reader reader(file.c_str());
+        std::size_t index = 0;
+        for (boost::stacktrace::trace_log_reader::const_iterator it = reader.begin(); it != reader.end(); ++it, ++index) {
+            const boost::stacktrace::trace_log_record r = *it;
+            trace t;
+            t.label = make_label(file, index)
+                + " thread " + boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(r.thread_id())).data()
+                + " time " + boost::stacktrace::detail::to_dec_array(static_cast<std::size_t>(r.timestamp_ns())).data();
+            for (std::size_t i = 0; i < r.size(); ++i) {
+                t.frames.push_back(reinterpret_cast<std::uintptr_t>(r[i].address()));
+            }
+            traces.push_back(std::move(t));
+        }
+        return true;
+    }
+
+    // Raw dumps: arrays of native_frame_ptr_t, each terminated by a zero frame
+    const std::size_t count = data.size() / sizeof(std::uintptr_t);
+    trace current;
+    std::size_t index = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uintptr_t addr;
+        std::memcpy(&addr, data.data() + i * sizeof(addr), sizeof(addr));
+        if (addr) {
+            current.frames.push_back(addr);
+            continue;
+        }
+        if (!current.frames.empty()) {
+            current.label = make_label(file, index++);
+            traces.push_back(std::move(current));
+            current = trace();
+        }
+    }
+    if (!current.frames.empty()) {
+        current.label = make_label(file, index);
+        traces.push_back(std::move(current));
+    }
+    return true;
+}
+
+bool read_line(::FILE* f, std::string& line) {
+    line.clear();
+    char buf[256];
+    while (::fgets(buf, sizeof(buf), f)) {
+        line += buf;
+        if (!line.empty() && line[line.size() - 1] == '\n') {
+            line.erase(line.size() - 1);
+            return true;
+        }
+    }
+    return !line.empty();
+}
+
+// Resolves `addrs` with a single addr2line process. Output of `addr2line -Cfe` is
+// exactly two lines per address: function name and `file:line`.
+void resolve_chunk(const module& m, const std::uintptr_t* addrs, std::size_t count, std::string* out) {
+    std::vector<std::array<char, 2 + sizeof(void*) * 2 + 1> > hex;
+    std::vector<const char*> args;
+    hex.reserve(count);
+    args.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        hex.push_back(boost::stacktrace::detail::to_hex_array(addrs[i] - m.base));
+        args.push_back(hex.back().data());
+    }
+
+    boost::stacktrace::detail::addr2line_pipe p("-Cfe", m.debug_file.c_str(), args.data(), args.size());
+    std::string function;
+    std::string location;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!p || !read_line(p, function) || !read_line(p, location)) {
+            break;
+        }
+
+        std::string& res = out[i];
+        if (function != "??") {
+            res = function;
+        }
+        if (location.compare(0, 2, "??") != 0 && location.size() > 2 && location.compare(location.size() - 2, 2, ":0") != 0) {
+            if (res.empty()) {
+                res = boost::stacktrace::detail::to_hex_array(addrs[i]).data();
+            }
+            res += " at ";
+            res += location;
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (out[i].empty()) {
+            out[i] = boost::stacktrace::detail::to_hex_array(addrs[i]).data();
+            out[i] += " in ";
+            out[i] += m.path;
+        }
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, const char* argv[]) {
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<trace> traces;
+    for (std::size_t i = 0; i < opts.inputs.size(); ++i) {
+        if (!read_traces(opts.inputs[i], traces)) {
+            std::cerr << "Failed to read '" << opts.inputs[i] << "'\n";
+            return 1;
+        }
+    }
+
+    compute_module_ranges(opts.modules);
+
+    // Each unique address is resolved exactly once
+    std::vector<std::uintptr_t> addrs;
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        addrs.insert(addrs.end(), traces[i].frames.begin(), traces[i].frames.end());
+    }
+    std::sort(addrs.begin(), addrs.end());
+    addrs.erase(std::unique(addrs.begin(), addrs.end()), addrs.end());
+    std::vector<std::string> resolved(addrs.size());
+
+    // Addresses are sorted, so the addresses of a module are adjacent. Each chunk belongs to a single module.
+    struct chunk {
+        const module* m;
+        std::size_t first;
+        std::size_t count;
+    };
+    const std::size_t chunk_size = 256;
+    std::vector<chunk> chunks;
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+        const module* m = find_module(opts.modules, addrs[i]);
+        if (!m) {
+            resolved[i] = boost::stacktrace::detail::to_hex_array(addrs[i]).data();
+        } else if (!chunks.empty() && chunks.back().m == m && chunks.back().first + chunks.back().count == i
+            && chunks.back().count < chunk_size)
+        {
+            ++chunks.back().count;
+        } else {
+            const chunk c = {m, i, 1};
+            chunks.push_back(c);
+        }
+    }
+
+    std::atomic<std::size_t> next_chunk(0);
+    std::vector<std::thread> workers;
+    const std::size_t workers_count = (std::min)(static_cast<std::size_t>(opts.jobs), chunks.size());
+    for (std::size_t i = 0; i < workers_count; ++i) {
+        workers.emplace_back([&]() {
+            for (std::size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+                resolve_chunk(*chunks[c].m, &addrs[chunks[c].first], chunks[c].count, &resolved[chunks[c].first]);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    std::unordered_map<std::uintptr_t, const std::string*> names;
+    names.reserve(addrs.size());
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+        names[addrs[i]] = &resolved[i];
+    }
+
+    std::string out;
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        out = traces[i].label;
+        out += ":\n";
+        for (std::size_t j = 0; j < traces[i].frames.size(); ++j) {
+            if (j < 10) {
+                out += ' ';
+            }
+            out += boost::stacktrace::detail::to_dec_array(j).data();
+            out += "# ";
+            out += *names[traces[i].frames[j]];
+            out += '\n';
+        }
+        out += '\n';
+        std::cout << out;
+    }
+
+    return 0;
+}